@@ -308,6 +308,14 @@ Given(/^the turn penalty file$/, function (data, callback) {
   fs.writeFile(this.penaltiesCacheFile, data, callback);
 });
 
+Given(/^the speed profile file$/, function (data, callback) {
+  fs.writeFile(this.speedProfilesCacheFile, data, callback);
+});
+
+Given(/^the segment profile file$/, function (data, callback) {
+  fs.writeFile(this.segmentProfilesCacheFile, data, callback);
+});
+
 Given(/^the profile "([^"]*)"$/, function (profile, callback) {
   this.setProfile(profile);
   callback();
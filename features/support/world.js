@@ -116,6 +116,8 @@ class OSRMWorld extends World {
     this.rasterCacheFile    = `${basename}_raster.asc`;
     this.speedsCacheFile    = `${basename}_speeds.csv`;
     this.penaltiesCacheFile = `${basename}_penalties.csv`;
+    this.speedProfilesCacheFile   = `${basename}_speed_profiles.csv`;
+    this.segmentProfilesCacheFile = `${basename}_segment_profiles.csv`;
     this.profileCacheFile   = `${basename}_profile.lua`;
   }
 
@@ -151,6 +153,8 @@ class OSRMWorld extends World {
       'rastersource_file' : this.rasterCacheFile,
       'speeds_file'       : this.speedsCacheFile,
       'penalties_file'    : this.penaltiesCacheFile,
+      'speed_profiles_file'   : this.speedProfilesCacheFile,
+      'segment_profiles_file' : this.segmentProfilesCacheFile,
       'timezone_names'    : process.platform === 'win32' ? 'win' : 'iana'
     };
 
@@ -0,0 +1,58 @@
+@routing @speed @traffic @with_mld
+Feature: Traffic - speed profiles
+
+    Background: A one-way ring whose road ab slows down on Monday morning
+        # a-y-x-w-b
+        # |       |
+        # d-------c
+        Given the node locations
+          | node |    lat |      lon | id |
+          | a    | 0.0009 |      0.0 | 1  |
+          | b    | 0.0009 |   0.0009 | 2  |
+          | c    |    0.0 |   0.0009 | 3  |
+          | d    |    0.0 |      0.0 | 4  |
+          | x    | 0.0009 |  0.00045 | 5  |
+          | y    | 0.0009 | 0.000225 | 6  |
+          | w    | 0.0009 | 0.000675 | 7  |
+        And the ways
+          | nodes | highway | oneway |
+          | ab    | primary | yes    |
+          | bc    | primary | yes    |
+          | cd    | primary | yes    |
+          | da    | primary | yes    |
+        And the profile "testbot"
+        And the customize extra arguments "--speed-profile-file {speed_profiles_file} --segment-profile-file {segment_profiles_file}"
+        # 36 km/h, the static speed, except for Monday morning with 9 km/h at 08:00 UTC
+        And the speed profile file
+        """
+        1,0,36
+        1,28800,9
+        1,57600,36
+        """
+        And the segment profile file
+        """
+        1,2,1
+        """
+
+    Scenario: The duration of a road with a profile depends on the departure time
+        # 1970-01-04 was a Sunday, 1970-01-05 a Monday
+        When I route I should get
+          | from | to | param:depart_at | route    | time     |
+          | x    | c  |                 | ab,bc,bc | 15s +-1  |
+          | x    | c  | 302400          | ab,bc,bc | 15s +-1  |
+          | x    | c  | 360000          | ab,bc,bc | 18s +-1  |
+          | x    | c  | 374400          | ab,bc,bc | 30s +-1  |
+
+    Scenario: The last road up to the destination keeps its static duration
+        When I route I should get
+          | from | to | param:depart_at | route    | time     |
+          | y    | w  | 302400          | ab,ab    | 5s +-1   |
+          | y    | w  | 374400          | ab,ab    | 5s +-1   |
+          | d    | x  | 302400          | da,ab,ab | 15s +-1  |
+          | d    | x  | 374400          | da,ab,ab | 15s +-1  |
+
+    Scenario: A destination behind the start on the same road is reached around the ring
+        When I route I should get
+          | from | to | param:depart_at | route             | time    |
+          | w    | y  | 302400          | ab,bc,cd,da,ab,ab | 35s +-1 |
+          | w    | y  | 374400          | ab,bc,cd,da,ab,ab | 42s +-1 |
@@ -0,0 +1,95 @@
+#ifndef OSRM_CONTRACTOR_ARC_METRIC_HPP
+#define OSRM_CONTRACTOR_ARC_METRIC_HPP
+
+#include "contractor/query_edge.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <tuple>
+#include <vector>
+
+namespace osrm::contractor::detail
+{
+// Metric of one direction of an arc of a hierarchy that is customized for new weights
+struct ArcMetric
+{
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    EdgeDuration duration = MAXIMAL_EDGE_DURATION;
+    EdgeDistance distance = MAXIMAL_EDGE_DISTANCE;
+    // middle node of a shortcut or turn id of an input edge
+    NodeID id = SPECIAL_NODEID;
+    bool shortcut = false;
+
+    bool IsValid() const { return weight != INVALID_EDGE_WEIGHT; }
+
+    bool operator<(const ArcMetric &other) const
+    {
+        return std::tie(weight, duration) < std::tie(other.weight, other.duration);
+    }
+
+    bool operator==(const ArcMetric &other) const
+    {
+        return std::tie(weight, duration, distance, id, shortcut) ==
+               std::tie(other.weight, other.duration, other.distance, other.id, other.shortcut);
+    }
+};
+
+// Returns the metric of the path first -> middle -> second
+inline ArcMetric concatenate(const ArcMetric &first, const ArcMetric &second, const NodeID middle)
+{
+    if (!first.IsValid() || !second.IsValid())
+        return {};
+
+    return {first.weight + second.weight,
+            first.duration + second.duration,
+            first.distance + second.distance,
+            middle,
+            true};
+}
+
+// Relaxes the arc with the path first -> middle -> second
+inline void
+relaxTriangle(ArcMetric &arc, const ArcMetric &first, const ArcMetric &second, const NodeID middle)
+{
+    const auto path = concatenate(first, second, middle);
+    if (path < arc)
+        arc = path;
+}
+
+// Appends the query edges of the arc between source and target, which is stored at source
+inline void appendQueryEdges(std::vector<QueryEdge> &edges,
+                             const NodeID source,
+                             const NodeID target,
+                             const ArcMetric &up,
+                             const ArcMetric &down)
+{
+    const auto add_edge = [&](const ArcMetric &metric, const bool forward, const bool backward)
+    {
+        edges.emplace_back(source,
+                           target,
+                           QueryEdge::EdgeData{metric.id,
+                                               metric.shortcut,
+                                               metric.weight,
+                                               metric.duration,
+                                               metric.distance,
+                                               forward,
+                                               backward});
+    };
+
+    if (up.IsValid() && down.IsValid() && up == down)
+    {
+        add_edge(up, true, true);
+        return;
+    }
+    if (up.IsValid())
+    {
+        add_edge(up, true, false);
+    }
+    if (down.IsValid())
+    {
+        add_edge(down, false, true);
+    }
+}
+} // namespace osrm::contractor::detail
+
+#endif // OSRM_CONTRACTOR_ARC_METRIC_HPP
@@ -39,8 +39,9 @@ namespace osrm::contractor
 struct ContractorConfig final : storage::IOConfig
 {
     ContractorConfig()
-        : IOConfig(
-              {".osrm.ebg", ".osrm.ebg_nodes", ".osrm.properties"}, {}, {".osrm.hsgr", ".osrm.enw"})
+        : IOConfig({".osrm.ebg", ".osrm.ebg_nodes", ".osrm.properties"},
+                   {".osrm.partition"},
+                   {".osrm.hsgr", ".osrm.enw", ".osrm.cch"})
     {
     }
 
@@ -66,6 +67,14 @@ struct ContractorConfig final : storage::IOConfig
 
     std::filesystem::path output_path;
     unsigned requested_num_threads = 0;
+    // Customize a metric independent hierarchy (.osrm.cch) instead of contracting the graph
+    bool cch = false;
+    // Keep the node order and shortcuts of the existing .osrm.hsgr and only recompute weights
+    bool metric_only = false;
+    // Add shortcuts for witnesses that the new weights broke when recomputing the weights
+    bool repair_witnesses = false;
+    // Reuse the node order of one exclude filter for all others instead of contracting each
+    bool share_exclude_contraction = false;
 };
 } // namespace osrm::contractor
 
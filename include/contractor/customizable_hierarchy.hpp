@@ -0,0 +1,94 @@
+#ifndef OSRM_CONTRACTOR_CUSTOMIZABLE_HIERARCHY_HPP
+#define OSRM_CONTRACTOR_CUSTOMIZABLE_HIERARCHY_HPP
+
+#include "contractor/query_edge.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+#include "partitioner/multi_level_partition.hpp"
+
+#include "storage/io_fwd.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osrm::contractor
+{
+class CustomizableHierarchy;
+
+namespace serialization
+{
+inline void
+read(storage::tar::FileReader &reader, const std::string &name, CustomizableHierarchy &hierarchy);
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const CustomizableHierarchy &hierarchy);
+} // namespace serialization
+
+// Returns a checksum of the cells of all nodes, used to detect a stale .osrm.cch
+std::uint32_t getPartitionChecksum(const partitioner::MultiLevelPartition &partition,
+                                   NodeID number_of_nodes);
+
+/**
+ * Customizable Contraction Hierarchy (CCH) of the edge-based graph.
+ *
+ * The contraction order and the shortcuts only depend on the topology of the graph. Nodes are
+ * contracted in a nested dissection order taken from the multi-level partition of
+ * osrm-partition: first the interior nodes of every level 1 cell (in minimum degree order),
+ * then the level 1 boundary nodes that are interior to their level 2 cell and so on up to the
+ * boundary nodes of the top level. Contracting a node connects all of its remaining neighbours,
+ * so the arcs form a chordal supergraph of the input that is valid for every metric.
+ *
+ * Customize() computes the weights of all arcs for one metric: an arc (u, w) is the minimum of
+ * its input edges and all paths u -> v -> w over a lower triangle v. All nodes of the same height
+ * in the elimination tree are customized in parallel. The result is a regular contraction
+ * hierarchy that is served by the CH routing algorithms.
+ */
+class CustomizableHierarchy
+{
+  public:
+    CustomizableHierarchy() = default;
+    CustomizableHierarchy(const partitioner::MultiLevelPartition &partition,
+                          NodeID number_of_nodes,
+                          const std::vector<extractor::EdgeBasedEdge> &edges);
+
+    NodeID GetNumberOfNodes() const { return ranks.size(); }
+    EdgeID GetNumberOfArcs() const { return heads.size(); }
+    std::size_t GetHeight() const { return height_offsets.empty() ? 0 : height_offsets.size() - 1; }
+    std::uint32_t GetPartitionChecksum() const { return partition_checksum; }
+
+    // Returns the contracted graph for the weights of the edges, restricted to the nodes that
+    // are set in the node filter. Edges need to be part of the graph the hierarchy was built for.
+    std::vector<QueryEdge> Customize(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                     const std::vector<bool> &node_filter) const;
+
+    friend void serialization::read(storage::tar::FileReader &reader,
+                                    const std::string &name,
+                                    CustomizableHierarchy &hierarchy);
+    friend void serialization::write(storage::tar::FileWriter &writer,
+                                     const std::string &name,
+                                     const CustomizableHierarchy &hierarchy);
+
+  private:
+    // Returns the arc from the lower to the higher ranked node
+    EdgeID FindArc(NodeID first_rank, NodeID second_rank) const;
+
+    // rank of every node and node of every rank
+    std::vector<NodeID> ranks;
+    std::vector<NodeID> nodes;
+    // arcs to higher ranked nodes, sorted by the rank of their head
+    std::vector<EdgeID> first_arc;
+    std::vector<NodeID> heads;
+    // arcs from lower ranked nodes, sorted by the rank of their tail
+    std::vector<EdgeID> first_lower_arc;
+    std::vector<EdgeID> lower_arcs;
+    std::vector<NodeID> lower_tails;
+    // ranks grouped by their height in the elimination tree
+    std::vector<std::uint32_t> height_offsets;
+    std::vector<NodeID> height_ranks;
+    std::uint32_t partition_checksum = 0;
+};
+} // namespace osrm::contractor
+
+#endif // OSRM_CONTRACTOR_CUSTOMIZABLE_HIERARCHY_HPP
@@ -48,6 +48,31 @@ inline void writeGraph(const std::filesystem::path &path,
         serialization::write(writer, "/ch/metrics/" + pair.first, pair.second);
     }
 }
+
+// reads .osrm.cch file
+inline void readCustomizableHierarchy(const std::filesystem::path &path,
+                                      CustomizableHierarchy &hierarchy,
+                                      std::uint32_t &connectivity_checksum)
+{
+    const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
+    storage::tar::FileReader reader{path, fingerprint};
+
+    reader.ReadInto("/cch/connectivity_checksum", connectivity_checksum);
+    serialization::read(reader, "/cch/hierarchy", hierarchy);
+}
+
+// writes .osrm.cch file
+inline void writeCustomizableHierarchy(const std::filesystem::path &path,
+                                       const CustomizableHierarchy &hierarchy,
+                                       const std::uint32_t connectivity_checksum)
+{
+    const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
+    storage::tar::FileWriter writer{path, fingerprint};
+
+    writer.WriteElementCount64("/cch/connectivity_checksum", 1);
+    writer.WriteFrom("/cch/connectivity_checksum", connectivity_checksum);
+    serialization::write(writer, "/cch/hierarchy", hierarchy);
+}
 } // namespace osrm::contractor::files
 
 #endif
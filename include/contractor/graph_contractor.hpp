@@ -18,6 +18,24 @@ GraphAndFilter contractFullGraph(ContractorGraph contractor_graph);
 GraphAndFilter contractExcludableGraph(ContractorGraph contractor_graph_,
                                        const std::vector<std::vector<bool>> &filters);
 
+// Time spent on contracting the graph of one exclude filter
+struct ExcludeClassStatistics
+{
+    // stages shared with other filters, they count for each of them
+    double shared_seconds = 0;
+    // stages that only contract the graph of this filter
+    double own_seconds = 0;
+};
+
+// With share_filter_groups the core that is left after contracting the nodes of all filters is
+// only contracted for the filter that allows the most nodes. Filters that allow a subset of its
+// nodes reuse its node order and shortcuts and only add the shortcuts that depend on their
+// excluded nodes.
+GraphAndFilter contractExcludableGraph(ContractorGraph contractor_graph_,
+                                       const std::vector<std::vector<bool>> &filters,
+                                       const bool share_filter_groups,
+                                       std::vector<ExcludeClassStatistics> &statistics);
+
 // Number of edge slots an edge index can address. The edge list cannot grow beyond it.
 constexpr std::size_t EDGE_LIST_LIMIT = std::numeric_limits<ContractorGraph::EdgeIterator>::max();
 
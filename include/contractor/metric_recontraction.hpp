@@ -0,0 +1,58 @@
+#ifndef OSRM_CONTRACTOR_METRIC_RECONTRACTION_HPP
+#define OSRM_CONTRACTOR_METRIC_RECONTRACTION_HPP
+
+#include "contractor/query_edge.hpp"
+#include "contractor/query_graph.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm::contractor
+{
+
+struct RecontractionStatistics
+{
+    // arcs of the previous hierarchy
+    std::size_t reused_arcs = 0;
+    // edges of the graph that were not part of the previous hierarchy
+    std::size_t inserted_edges = 0;
+    std::size_t witness_searches = 0;
+    // shortcuts added because a witness of the previous contraction is gone
+    std::size_t repaired_shortcuts = 0;
+};
+
+/**
+ * Recomputes a contraction hierarchy for new edge weights without contracting the graph again.
+ *
+ * The node order and the shortcuts are taken from the edges of `hierarchy` that are set in
+ * `hierarchy_filter`, every edge is stored at the node that was contracted first. All weights
+ * are recomputed bottom-up: an arc (u, w) is the minimum of its input edges and of all paths
+ * u -> v -> w over a lower node v that is connected to both of them.
+ *
+ * Without `repair_witnesses` the arcs are customized in parallel, but pairs of nodes that the
+ * previous contraction connected by a witness path are never connected: if the new weights
+ * make that witness slower the hierarchy may return a longer route, and if they close it the
+ * hierarchy may find no route at all. With `repair_witnesses` the nodes are contracted again
+ * one after another in the previous order, with a witness search for each missing pair that
+ * adds a shortcut if the witness is gone. The result is exact then.
+ */
+std::vector<QueryEdge> recontractMetric(const QueryGraph &hierarchy,
+                                        const std::vector<bool> &hierarchy_filter,
+                                        const std::vector<extractor::EdgeBasedEdge> &edges,
+                                        const std::vector<bool> &node_filter,
+                                        const bool repair_witnesses,
+                                        RecontractionStatistics &statistics);
+
+// Same for edges of a graph that is contracted already in parts, e.g. the core of a hierarchy
+std::vector<QueryEdge> recontractMetric(const QueryGraph &hierarchy,
+                                        const std::vector<bool> &hierarchy_filter,
+                                        const std::vector<QueryEdge> &edges,
+                                        const std::vector<bool> &node_filter,
+                                        const bool repair_witnesses,
+                                        RecontractionStatistics &statistics);
+
+} // namespace osrm::contractor
+
+#endif // OSRM_CONTRACTOR_METRIC_RECONTRACTION_HPP
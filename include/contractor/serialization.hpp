@@ -2,6 +2,7 @@
 #define OSRM_CONTRACTOR_SERIALIZATION_HPP
 
 #include "contractor/contracted_metric.hpp"
+#include "contractor/customizable_hierarchy.hpp"
 
 #include "util/serialization.hpp"
 
@@ -42,6 +43,38 @@ void read(storage::tar::FileReader &reader,
                                      metric.edge_filter[index]);
     }
 }
+
+inline void
+read(storage::tar::FileReader &reader, const std::string &name, CustomizableHierarchy &hierarchy)
+{
+    storage::serialization::read(reader, name + "/ranks", hierarchy.ranks);
+    storage::serialization::read(reader, name + "/nodes", hierarchy.nodes);
+    storage::serialization::read(reader, name + "/first_arc", hierarchy.first_arc);
+    storage::serialization::read(reader, name + "/heads", hierarchy.heads);
+    storage::serialization::read(reader, name + "/first_lower_arc", hierarchy.first_lower_arc);
+    storage::serialization::read(reader, name + "/lower_arcs", hierarchy.lower_arcs);
+    storage::serialization::read(reader, name + "/lower_tails", hierarchy.lower_tails);
+    storage::serialization::read(reader, name + "/height_offsets", hierarchy.height_offsets);
+    storage::serialization::read(reader, name + "/height_ranks", hierarchy.height_ranks);
+    reader.ReadInto(name + "/partition_checksum", hierarchy.partition_checksum);
+}
+
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const CustomizableHierarchy &hierarchy)
+{
+    storage::serialization::write(writer, name + "/ranks", hierarchy.ranks);
+    storage::serialization::write(writer, name + "/nodes", hierarchy.nodes);
+    storage::serialization::write(writer, name + "/first_arc", hierarchy.first_arc);
+    storage::serialization::write(writer, name + "/heads", hierarchy.heads);
+    storage::serialization::write(writer, name + "/first_lower_arc", hierarchy.first_lower_arc);
+    storage::serialization::write(writer, name + "/lower_arcs", hierarchy.lower_arcs);
+    storage::serialization::write(writer, name + "/lower_tails", hierarchy.lower_tails);
+    storage::serialization::write(writer, name + "/height_offsets", hierarchy.height_offsets);
+    storage::serialization::write(writer, name + "/height_ranks", hierarchy.height_ranks);
+    writer.WriteElementCount64(name + "/partition_checksum", 1);
+    writer.WriteFrom(name + "/partition_checksum", hierarchy.partition_checksum);
+}
 } // namespace osrm::contractor::serialization
 
 #endif
@@ -1,14 +1,23 @@
 #ifndef OSRM_CELLS_CUSTOMIZER_HPP
 #define OSRM_CELLS_CUSTOMIZER_HPP
 
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/multi_level_partition.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/query_heap.hpp"
 
 #include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace osrm::customizer
 {
@@ -30,6 +39,14 @@ class CellCustomizer
 
     CellCustomizer(const partitioner::MultiLevelPartition &partition) : partition(partition) {}
 
+    // Cells with a microcode program are customized by evaluating it, all others with a
+    // Dijkstra search per source node
+    CellCustomizer(const partitioner::MultiLevelPartition &partition,
+                   const partitioner::CellMicrocode &microcode)
+        : partition(partition), microcode(&microcode)
+    {
+    }
+
     template <typename GraphT>
     void Customize(const GraphT &graph,
                    Heap &heap,
@@ -118,23 +135,324 @@ class CellCustomizer
     {
         Heap heap_exemplar(graph.GetNumberOfNodes());
         HeapPtr heaps(heap_exemplar);
+        MicrocodeScratchPtr scratches;
 
         for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
         {
             tbb::parallel_for(tbb::blocked_range<std::size_t>(0, partition.GetNumberOfCells(level)),
                               [&](const tbb::blocked_range<std::size_t> &range)
                               {
-                                  auto &heap = heaps.local();
                                   for (auto id = range.begin(), end = range.end(); id != end; ++id)
                                   {
-                                      Customize(
-                                          graph, heap, cells, allowed_nodes, metric, level, id);
+                                      CustomizeCell(graph,
+                                                    heaps,
+                                                    scratches,
+                                                    cells,
+                                                    allowed_nodes,
+                                                    metric,
+                                                    level,
+                                                    id);
+                                  }
+                              });
+        }
+    }
+
+    // Returns the sorted ids of the cells on each level that contain one of the given nodes.
+    // Every cell is contained in exactly one cell of the level above, so this includes all
+    // ancestors of the cells on the first level.
+    std::vector<std::vector<CellID>> GetCellsContaining(const std::vector<NodeID> &nodes) const
+    {
+        std::vector<std::vector<CellID>> level_cells(partition.GetNumberOfLevels());
+        for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            auto &cells = level_cells[level];
+            cells.reserve(nodes.size());
+            for (const auto node : nodes)
+            {
+                cells.push_back(partition.GetCell(level, node));
+            }
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        }
+        return level_cells;
+    }
+
+    // Only recomputes the cells in level_cells, e.g. the ones returned by GetCellsContaining.
+    // All other cells keep the values the metric already holds, so it has to be the result of
+    // a previous customization of the same cells.
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   const partitioner::CellStorage &cells,
+                   const std::vector<bool> &allowed_nodes,
+                   CellMetric &metric,
+                   const std::vector<std::vector<CellID>> &level_cells) const
+    {
+        BOOST_ASSERT(level_cells.size() == partition.GetNumberOfLevels());
+
+        Heap heap_exemplar(graph.GetNumberOfNodes());
+        HeapPtr heaps(heap_exemplar);
+        MicrocodeScratchPtr scratches;
+
+        for (std::size_t level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            const auto &ids = level_cells[level];
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, ids.size()),
+                              [&](const tbb::blocked_range<std::size_t> &range)
+                              {
+                                  for (auto index = range.begin(), end = range.end(); index != end;
+                                       ++index)
+                                  {
+                                      CustomizeCell(graph,
+                                                    heaps,
+                                                    scratches,
+                                                    cells,
+                                                    allowed_nodes,
+                                                    metric,
+                                                    level,
+                                                    ids[index]);
                                   }
                               });
         }
     }
 
   private:
+    // Distance matrices of the cell a microcode program is evaluated on
+    struct MicrocodeScratch
+    {
+        std::vector<std::int64_t> weights;
+        std::vector<std::int64_t> durations;
+        std::vector<EdgeDistance::value_type> distances;
+        std::vector<std::pair<NodeID, std::uint32_t>> local_ids;
+        std::vector<std::uint32_t> destination_ids;
+    };
+    using MicrocodeScratchPtr = tbb::enumerable_thread_specific<MicrocodeScratch>;
+
+    // Larger than any path in a cell, but small enough that adding two of them can't overflow
+    static constexpr std::int64_t MICROCODE_INVALID = std::numeric_limits<std::int64_t>::max() / 4;
+
+    // Evaluates the microcode program of a cell: loads the arcs of the cell into a distance
+    // matrix, eliminates the non-boundary vertices and closes the distances between the
+    // boundary vertices. Weights and durations match the Dijkstra search above, distances
+    // match it within float rounding, as they are summed in a different order.
+    template <typename GraphT>
+    void Customize(const GraphT &graph,
+                   MicrocodeScratch &scratch,
+                   const partitioner::CellStorage &cells,
+                   const std::vector<bool> &allowed_nodes,
+                   CellMetric &metric,
+                   LevelID level,
+                   CellID id) const
+    {
+        BOOST_ASSERT(microcode != nullptr && microcode->HasProgram(level, id));
+        const auto program = microcode->GetProgram(level, id);
+        const std::size_t num_vertices = program.vertices.size();
+        const std::size_t num_boundary_vertices = program.num_boundary_vertices;
+
+        auto &local_ids = scratch.local_ids;
+        local_ids.clear();
+        for (std::uint32_t index = 0; index < num_vertices; ++index)
+        {
+            local_ids.emplace_back(program.vertices[index], index);
+        }
+        std::sort(local_ids.begin(), local_ids.end());
+        const auto local = [&](const NodeID node) -> std::size_t
+        {
+            auto iter = std::lower_bound(
+                local_ids.begin(), local_ids.end(), std::make_pair(node, std::uint32_t{0}));
+            if (iter == local_ids.end() || iter->first != node)
+            {
+                throw util::exception("Cell microcode does not match the graph, re-run "
+                                      "osrm-partition" +
+                                      SOURCE_REF);
+            }
+            return iter->second;
+        };
+
+        auto &weights = scratch.weights;
+        auto &durations = scratch.durations;
+        auto &distances = scratch.distances;
+        weights.assign(num_vertices * num_vertices, MICROCODE_INVALID);
+        durations.assign(num_vertices * num_vertices, MICROCODE_INVALID);
+        distances.assign(num_vertices * num_vertices,
+                         from_alias<EdgeDistance::value_type>(INVALID_EDGE_DISTANCE));
+        for (std::size_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            weights[vertex * num_vertices + vertex] = 0;
+            durations[vertex * num_vertices + vertex] = 0;
+            distances[vertex * num_vertices + vertex] = 0;
+        }
+
+        // branch-free so the compiler can vectorise the inner loops below
+        const auto relax = [&](const std::size_t index,
+                               const std::int64_t weight,
+                               const std::int64_t duration,
+                               const EdgeDistance::value_type distance)
+        {
+            const bool shorter = std::tie(weight, duration, distance) <
+                                 std::tie(weights[index], durations[index], distances[index]);
+            weights[index] = shorter ? weight : weights[index];
+            durations[index] = shorter ? duration : durations[index];
+            distances[index] = shorter ? distance : distances[index];
+        };
+
+        // arcs: sub-cell cliques and base graph edges, as relaxed by RelaxNode
+        for (std::size_t from = 0; from < num_vertices; ++from)
+        {
+            const auto node = program.vertices[from];
+            if (!allowed_nodes[node])
+            {
+                continue;
+            }
+
+            if (level > 1)
+            {
+                const auto subcell =
+                    cells.GetCell(metric, level - 1, partition.GetCell(level - 1, node));
+                auto destination = subcell.GetDestinationNodes().begin();
+                auto duration = subcell.GetOutDuration(node).begin();
+                auto distance = subcell.GetOutDistance(node).begin();
+                for (const auto weight : subcell.GetOutWeight(node))
+                {
+                    if (weight != INVALID_EDGE_WEIGHT && allowed_nodes[*destination] &&
+                        *destination != node)
+                    {
+                        relax(from * num_vertices + local(*destination),
+                              from_alias<EdgeWeight::value_type>(weight),
+                              from_alias<EdgeDuration::value_type>(*duration),
+                              from_alias<EdgeDistance::value_type>(*distance));
+                    }
+                    ++destination;
+                    ++duration;
+                    ++distance;
+                }
+            }
+
+            for (const auto edge : graph.GetInternalEdgeRange(level, node))
+            {
+                const NodeID to = graph.GetTarget(edge);
+                const auto &data = graph.GetEdgeData(edge);
+                if (!data.forward || !allowed_nodes[to] || to == node ||
+                    (level > 1 &&
+                     partition.GetCell(level - 1, node) == partition.GetCell(level - 1, to)))
+                {
+                    continue;
+                }
+                relax(from * num_vertices + local(to),
+                      from_alias<EdgeWeight::value_type>(data.weight),
+                      from_alias<EdgeDuration::value_type>(to_alias<EdgeDuration>(data.duration)),
+                      from_alias<EdgeDistance::value_type>(data.distance));
+            }
+        }
+
+        // eliminate the non-boundary vertices
+        auto instruction = program.code.begin();
+        for (std::size_t vertex = num_boundary_vertices; vertex < num_vertices; ++vertex)
+        {
+            const std::size_t num_in = *instruction++;
+            const std::size_t num_out = *instruction++;
+            const auto in_begin = instruction;
+            const auto out_begin = in_begin + num_in;
+            instruction = out_begin + num_out;
+
+            const auto vertex_row = vertex * num_vertices;
+            for (auto in = in_begin; in != out_begin; ++in)
+            {
+                const auto row = *in * num_vertices;
+                const auto to_vertex = row + vertex;
+                if (weights[to_vertex] == MICROCODE_INVALID)
+                {
+                    continue;
+                }
+                for (auto out = out_begin; out != instruction; ++out)
+                {
+                    relax(row + *out,
+                          weights[to_vertex] + weights[vertex_row + *out],
+                          durations[to_vertex] + durations[vertex_row + *out],
+                          distances[to_vertex] + distances[vertex_row + *out]);
+                }
+            }
+        }
+        BOOST_ASSERT(instruction == program.code.end());
+
+        // close the distances between the boundary vertices
+        for (std::size_t via = 0; via < num_boundary_vertices; ++via)
+        {
+            const auto via_row = via * num_vertices;
+            for (std::size_t from = 0; from < num_boundary_vertices; ++from)
+            {
+                const auto row = from * num_vertices;
+                const auto to_via = row + via;
+                if (from == via || weights[to_via] == MICROCODE_INVALID)
+                {
+                    continue;
+                }
+                for (std::size_t to = 0; to < num_boundary_vertices; ++to)
+                {
+                    relax(row + to,
+                          weights[to_via] + weights[via_row + to],
+                          durations[to_via] + durations[via_row + to],
+                          distances[to_via] + distances[via_row + to]);
+                }
+            }
+        }
+
+        auto cell = cells.GetCell(metric, level, id);
+        const auto destinations = cell.GetDestinationNodes();
+        auto &destination_ids = scratch.destination_ids;
+        destination_ids.clear();
+        for (const auto destination : destinations)
+        {
+            destination_ids.push_back(local(destination));
+        }
+
+        for (const auto source : cell.GetSourceNodes())
+        {
+            if (!allowed_nodes[source])
+            {
+                continue;
+            }
+
+            const auto row = local(source) * num_vertices;
+            auto weight = cell.GetOutWeight(source).begin();
+            auto duration = cell.GetOutDuration(source).begin();
+            auto distance = cell.GetOutDistance(source).begin();
+            for (std::size_t column = 0; column < destination_ids.size(); ++column)
+            {
+                const auto index = row + destination_ids[column];
+                const bool reachable = allowed_nodes[destinations.begin()[column]] &&
+                                       weights[index] < MICROCODE_INVALID;
+                *weight++ = reachable
+                                ? EdgeWeight{static_cast<EdgeWeight::value_type>(weights[index])}
+                                : INVALID_EDGE_WEIGHT;
+                *duration++ =
+                    reachable ? EdgeDuration{static_cast<EdgeDuration::value_type>(
+                                    durations[index])}
+                              : MAXIMAL_EDGE_DURATION;
+                *distance++ = reachable ? EdgeDistance{distances[index]} : INVALID_EDGE_DISTANCE;
+            }
+        }
+    }
+
+    template <typename GraphT>
+    void CustomizeCell(const GraphT &graph,
+                       HeapPtr &heaps,
+                       MicrocodeScratchPtr &scratches,
+                       const partitioner::CellStorage &cells,
+                       const std::vector<bool> &allowed_nodes,
+                       CellMetric &metric,
+                       LevelID level,
+                       CellID id) const
+    {
+        if (microcode != nullptr && microcode->HasProgram(level, id))
+        {
+            Customize(graph, scratches.local(), cells, allowed_nodes, metric, level, id);
+        }
+        else
+        {
+            Customize(graph, heaps.local(), cells, allowed_nodes, metric, level, id);
+        }
+    }
+
     template <typename GraphT>
     void RelaxNode(const GraphT &graph,
                    const partitioner::CellStorage &cells,
@@ -233,6 +551,7 @@ class CellCustomizer
     }
 
     const partitioner::MultiLevelPartition &partition;
+    const partitioner::CellMicrocode *microcode = nullptr;
 };
 } // namespace osrm::customizer
 
@@ -18,8 +18,8 @@ struct CustomizationConfig final : storage::IOConfig
                     ".osrm.ebg_nodes",
                     ".osrm.properties",
                     ".osrm.enw"},
-                   {},
-                   {".osrm.cell_metrics", ".osrm.mldgr"}),
+                   {".osrm.cell_microcode"},
+                   {".osrm.cell_metrics", ".osrm.mldgr", ".osrm.speed_profiles"}),
           requested_num_threads(0)
     {
     }
@@ -41,6 +41,18 @@ struct CustomizationConfig final : storage::IOConfig
 
     std::filesystem::path output_path;
     unsigned requested_num_threads;
+    // Only recustomize the cells touched by this or the previous update
+    bool incremental = false;
+    // With incremental, skip the cells of updated segments whose weights did not change since
+    // the previous update. Only valid if nothing else updated the dataset in between, like
+    // between the runs of osrm-traffic-daemon.
+    bool skip_unchanged_cells = false;
+    // Customize the cells covered by .osrm.cell_microcode by evaluating their programs
+    bool microcode = false;
+    // Dictionary of periodic speed profiles and the profiles of the segments, written to
+    // .osrm.speed_profiles for time-dependent queries
+    std::vector<std::string> speed_profile_lookup_paths;
+    std::vector<std::string> segment_profile_lookup_paths;
 
     updater::UpdaterConfig updater_config;
 };
@@ -7,7 +7,10 @@
 
 #include "util/integer_range.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm::customizer::files
 {
@@ -41,11 +44,37 @@ inline void readCellMetrics(const std::filesystem::path &path,
     }
 }
 
+// reads the state of the customization that wrote the .osrm.cell_metrics file, returns false
+// for files that don't contain it
+inline bool readCustomizationState(const std::filesystem::path &path,
+                                   std::uint32_t &connectivity_checksum,
+                                   std::vector<NodeID> &updated_nodes)
+{
+    const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
+    storage::tar::FileReader reader{path, fingerprint};
+
+    std::vector<storage::tar::FileReader::FileEntry> entries;
+    reader.List(std::back_inserter(entries));
+    if (std::none_of(entries.begin(),
+                     entries.end(),
+                     [](const auto &entry)
+                     { return entry.name == "/mld/customization/connectivity_checksum"; }))
+    {
+        return false;
+    }
+
+    reader.ReadInto("/mld/customization/connectivity_checksum", connectivity_checksum);
+    storage::serialization::read(reader, "/mld/customization/updated_nodes", updated_nodes);
+    return true;
+}
+
 // writes .osrm.cell_metrics file
 template <typename CellMetricT>
 inline void
 writeCellMetrics(const std::filesystem::path &path,
-                 const std::unordered_map<std::string, std::vector<CellMetricT>> &metrics)
+                 const std::unordered_map<std::string, std::vector<CellMetricT>> &metrics,
+                 const std::uint32_t connectivity_checksum,
+                 const std::vector<NodeID> &updated_nodes)
 {
     static_assert(std::is_same<CellMetricView, CellMetricT>::value ||
                       std::is_same<CellMetric, CellMetricT>::value,
@@ -68,6 +97,36 @@ writeCellMetrics(const std::filesystem::path &path,
             serialization::write(writer, prefix + "/" + std::to_string(id++), exclude_metric);
         }
     }
+
+    // used by osrm-customize --incremental to find the cells that need to be updated
+    writer.WriteFrom("/mld/customization/connectivity_checksum", connectivity_checksum);
+    storage::serialization::write(writer, "/mld/customization/updated_nodes", updated_nodes);
+}
+
+// reads .osrm.speed_profiles file
+template <typename SpeedProfilesT>
+inline void readSpeedProfiles(const std::filesystem::path &path, SpeedProfilesT &profiles)
+{
+    static_assert(std::is_same<SpeedProfilesView, SpeedProfilesT>::value ||
+                      std::is_same<SpeedProfiles, SpeedProfilesT>::value,
+                  "");
+
+    storage::tar::FileReader reader{path, storage::tar::FileReader::VerifyFingerprint};
+
+    serialization::read(reader, "/mld/speed_profiles", profiles);
+}
+
+// writes .osrm.speed_profiles file
+template <typename SpeedProfilesT>
+inline void writeSpeedProfiles(const std::filesystem::path &path, const SpeedProfilesT &profiles)
+{
+    static_assert(std::is_same<SpeedProfilesView, SpeedProfilesT>::value ||
+                      std::is_same<SpeedProfiles, SpeedProfilesT>::value,
+                  "");
+
+    storage::tar::FileWriter writer{path, storage::tar::FileWriter::GenerateFingerprint};
+
+    serialization::write(writer, "/mld/speed_profiles", profiles);
 }
 
 // reads .osrm.mldgr file
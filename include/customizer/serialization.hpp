@@ -2,6 +2,7 @@
 #define OSRM_CUSTOMIZER_SERIALIZATION_HPP
 
 #include "customizer/edge_based_graph.hpp"
+#include "customizer/speed_profiles.hpp"
 
 #include "partitioner/cell_storage.hpp"
 
@@ -32,6 +33,28 @@ inline void write(storage::tar::FileWriter &writer,
     storage::serialization::write(writer, name + "/distances", metric.distances);
 }
 
+template <storage::Ownership Ownership>
+inline void read(storage::tar::FileReader &reader,
+                 const std::string &name,
+                 detail::SpeedProfilesImpl<Ownership> &profiles)
+{
+    storage::serialization::read(reader, name + "/node_profiles", profiles.node_profiles);
+    storage::serialization::read(reader, name + "/profile_offsets", profiles.profile_offsets);
+    storage::serialization::read(reader, name + "/breakpoints", profiles.breakpoints);
+    storage::serialization::read(reader, name + "/static_levels", profiles.static_levels);
+}
+
+template <storage::Ownership Ownership>
+inline void write(storage::tar::FileWriter &writer,
+                  const std::string &name,
+                  const detail::SpeedProfilesImpl<Ownership> &profiles)
+{
+    storage::serialization::write(writer, name + "/node_profiles", profiles.node_profiles);
+    storage::serialization::write(writer, name + "/profile_offsets", profiles.profile_offsets);
+    storage::serialization::write(writer, name + "/breakpoints", profiles.breakpoints);
+    storage::serialization::write(writer, name + "/static_levels", profiles.static_levels);
+}
+
 template <typename EdgeDataT, storage::Ownership Ownership>
 inline void read(storage::tar::FileReader &reader,
                  const std::string &name,
@@ -0,0 +1,122 @@
+#ifndef OSRM_CUSTOMIZER_SPEED_PROFILES_HPP
+#define OSRM_CUSTOMIZER_SPEED_PROFILES_HPP
+
+#include "storage/io_fwd.hpp"
+#include "storage/shared_memory_ownership.hpp"
+
+#include "util/typedefs.hpp"
+#include "util/vector_view.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace osrm::customizer
+{
+
+inline constexpr std::uint32_t SECONDS_PER_WEEK = 7 * 24 * 60 * 60;
+inline constexpr std::uint32_t INVALID_SPEED_PROFILE_ID = std::numeric_limits<std::uint32_t>::max();
+
+// Speed of a profile from this second of the week, counted from Monday 00:00, on
+struct SpeedBreakpoint
+{
+    std::uint32_t time;
+    float speed;
+};
+
+// Returns the second of the week, counted from Monday 00:00 UTC, of a UNIX timestamp
+inline std::uint32_t toTimeOfWeek(const std::int64_t timestamp)
+{
+    // 1970-01-01 was a Thursday
+    constexpr std::int64_t EPOCH_TIME_OF_WEEK = 3 * 24 * 60 * 60;
+    const auto time_of_week = (timestamp + EPOCH_TIME_OF_WEEK) % SECONDS_PER_WEEK;
+    return static_cast<std::uint32_t>(time_of_week < 0 ? time_of_week + SECONDS_PER_WEEK
+                                                       : time_of_week);
+}
+
+namespace detail
+{
+// Periodic speed profiles of edge-based nodes. Every profile is a piecewise-linear function of
+// the time of the week, given by its breakpoints sorted by time, that wraps around from the last
+// breakpoint of the week to the first one. Nodes share profiles from a dictionary, so one
+// profile usually serves all roads of a kind in a region.
+template <storage::Ownership Ownership> struct SpeedProfilesImpl
+{
+    template <typename T> using Vector = util::ViewOrVector<T, Ownership>;
+
+    // profile of every edge-based node, INVALID_SPEED_PROFILE_ID for static speeds
+    Vector<std::uint32_t> node_profiles;
+    // the breakpoints of profile i are [profile_offsets[i], profile_offsets[i + 1])
+    Vector<std::uint32_t> profile_offsets;
+    Vector<SpeedBreakpoint> breakpoints;
+    // Highest level on which the cell of a node contains no node with a profile. The
+    // shortcuts of these cells stay valid at any time of the week, all others have to be
+    // searched on a lower level.
+    Vector<LevelID> static_levels;
+
+    bool Empty() const { return node_profiles.empty(); }
+
+    std::uint32_t GetProfile(const NodeID node) const
+    { return Empty() ? INVALID_SPEED_PROFILE_ID : node_profiles[node]; }
+
+    LevelID GetStaticLevel(const NodeID node) const
+    { return Empty() ? INVALID_LEVEL_ID : static_levels[node]; }
+
+    std::size_t GetNumberOfProfiles() const
+    { return profile_offsets.empty() ? 0 : profile_offsets.size() - 1; }
+
+    // Speed in km/h of a profile at a second of the week
+    double GetSpeed(const std::uint32_t profile, const std::uint32_t time_of_week) const
+    {
+        BOOST_ASSERT(profile + 1 < profile_offsets.size());
+        BOOST_ASSERT(time_of_week < SECONDS_PER_WEEK);
+        const auto first = breakpoints.begin() + profile_offsets[profile];
+        const auto last = breakpoints.begin() + profile_offsets[profile + 1];
+        BOOST_ASSERT(first != last);
+
+        const auto next = std::upper_bound(first,
+                                           last,
+                                           time_of_week,
+                                           [](const std::uint32_t time, const auto &breakpoint)
+                                           { return time < breakpoint.time; });
+
+        // wrap around the end of the week
+        const auto &before = next == first ? *std::prev(last) : *std::prev(next);
+        const auto &after = next == last ? *first : *next;
+        const double before_time =
+            next == first ? static_cast<double>(before.time) - SECONDS_PER_WEEK : before.time;
+        const double after_time =
+            next == last ? static_cast<double>(after.time) + SECONDS_PER_WEEK : after.time;
+
+        if (after_time <= before_time)
+            return before.speed;
+        const auto ratio = (time_of_week - before_time) / (after_time - before_time);
+        return before.speed + ratio * (after.speed - before.speed);
+    }
+
+    // Factor by which the static weight and duration of a node change at a second of the
+    // week, computed from the time it takes to travel the length of the node at the speed
+    // of its profile
+    double GetFactor(const NodeID node,
+                     const EdgeDuration static_duration,
+                     const EdgeDistance distance,
+                     const std::uint32_t time_of_week) const
+    {
+        const auto profile = GetProfile(node);
+        if (profile == INVALID_SPEED_PROFILE_ID || static_duration <= EdgeDuration{0})
+            return 1.;
+
+        // durations are stored in deciseconds
+        const auto duration = from_alias<double>(distance) * 36. / GetSpeed(profile, time_of_week);
+        return duration / from_alias<double>(static_duration);
+    }
+};
+} // namespace detail
+
+using SpeedProfiles = detail::SpeedProfilesImpl<storage::Ownership::Container>;
+using SpeedProfilesView = detail::SpeedProfilesImpl<storage::Ownership::View>;
+} // namespace osrm::customizer
+
+#endif
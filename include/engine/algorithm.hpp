@@ -55,6 +55,9 @@ template <typename AlgorithmT> struct HasGetTileTurns final : std::false_type
 template <typename AlgorithmT> struct HasExcludeFlags final : std::false_type
 {
 };
+template <typename AlgorithmT> struct HasTimeDependentSearch final : std::false_type
+{
+};
 
 // Trait to mark supported routing algorithms
 template <typename AlgorithmT> struct IsRoutingAlgorithm final : std::false_type
@@ -118,6 +121,9 @@ template <> struct HasGetTileTurns<mld::Algorithm> final : std::true_type
 template <> struct HasExcludeFlags<mld::Algorithm> final : std::true_type
 {
 };
+template <> struct HasTimeDependentSearch<mld::Algorithm> final : std::true_type
+{
+};
 } // namespace osrm::engine::routing_algorithms
 
 #endif
@@ -30,6 +30,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/base_parameters.hpp"
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 namespace osrm::engine::api
@@ -45,6 +47,8 @@ namespace osrm::engine::api
  *  - overview: adds overview geometry either Full, Simplified (according to highest zoom level) or
  *              False (not at all)
  *  - continue_straight: enable or disable continue_straight (disabled by default)
+ *  - depart_at: UNIX timestamp of the departure, evaluates the speed profiles of the roads at
+ *               the time they are travelled (MLD only)
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -175,6 +179,7 @@ struct RouteParameters : public BaseParameters
     OverviewType overview = OverviewType::Simplified;
     std::optional<bool> continue_straight;
     std::vector<std::size_t> waypoints;
+    std::optional<std::int64_t> depart_at;
 
     bool operator==(const RouteParameters &) const = default;
 
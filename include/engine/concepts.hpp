@@ -26,6 +26,7 @@ namespace osrm::engine::routing_algorithms
  *      SupportsDistanceAnnotationType<Algorithm>
  *      HasGetTileTurns<Algorithm>
  *      HasExcludeFlags<Algorithm>
+ *      HasTimeDependentSearch<Algorithm>
  *  - the above trait specializations must expose a compile-time ::value convertible to bool
  */
 template <typename T>
@@ -43,6 +44,7 @@ concept RoutingAlgorithm = requires {
     typename SupportsDistanceAnnotationType<T>;
     typename HasGetTileTurns<T>;
     typename HasExcludeFlags<T>;
+    typename HasTimeDependentSearch<T>;
 
     /* trait values are usable as compile-time booleans */
     { HasAlternativePathSearch<T>::value } -> std::convertible_to<bool>;
@@ -53,6 +55,7 @@ concept RoutingAlgorithm = requires {
     { SupportsDistanceAnnotationType<T>::value } -> std::convertible_to<bool>;
     { HasGetTileTurns<T>::value } -> std::convertible_to<bool>;
     { HasExcludeFlags<T>::value } -> std::convertible_to<bool>;
+    { HasTimeDependentSearch<T>::value } -> std::convertible_to<bool>;
 } && IsRoutingAlgorithm<T>::value;
 
 } // namespace osrm::engine::routing_algorithms
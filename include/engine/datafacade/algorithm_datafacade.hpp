@@ -3,6 +3,7 @@
 
 #include "contractor/query_edge.hpp"
 #include "customizer/edge_based_graph.hpp"
+#include "customizer/speed_profiles.hpp"
 #include "extractor/edge_based_edge.hpp"
 #include "engine/algorithm.hpp"
 
@@ -99,6 +100,9 @@ template <> class AlgorithmDataFacade<MLD>
 
     virtual const customizer::CellMetricView &GetCellMetric() const = 0;
 
+    // empty if the dataset was customized without speed profiles
+    virtual const customizer::SpeedProfilesView &GetSpeedProfiles() const = 0;
+
     virtual EdgeRange GetBorderEdgeRange(const LevelID level,
                                          const NodeID edge_based_node_id) const = 0;
 
@@ -626,6 +626,7 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
     partitioner::MultiLevelPartitionView mld_partition;
     partitioner::CellStorageView mld_cell_storage;
     customizer::CellMetricView mld_cell_metric;
+    customizer::SpeedProfilesView mld_speed_profiles;
     using QueryGraph = customizer::MultiLevelEdgeBasedGraphView;
     using GraphNode = QueryGraph::NodeArrayEntry;
     using GraphEdge = QueryGraph::EdgeArrayEntry;
@@ -641,6 +642,15 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
             make_filtered_cell_metric_view(index, "/mld/metrics/" + metric_name, exclude_index);
         mld_cell_storage = make_cell_storage_view(index, "/mld/cellstorage");
         query_graph = make_multi_level_graph_view(index, "/mld/multilevelgraph");
+
+        bool has_speed_profiles = false;
+        index.List("/mld/speed_profiles/",
+                   osrm::util::make_function_output_iterator([&](const auto &)
+                                                             { has_speed_profiles = true; }));
+        if (has_speed_profiles)
+        {
+            mld_speed_profiles = make_speed_profiles_view(index, "/mld/speed_profiles");
+        }
     }
 
     // allocator that keeps the allocation data
@@ -661,6 +671,9 @@ template <> class ContiguousInternalMemoryAlgorithmDataFacade<MLD> : public Algo
 
     const customizer::CellMetricView &GetCellMetric() const override { return mld_cell_metric; }
 
+    const customizer::SpeedProfilesView &GetSpeedProfiles() const override
+    { return mld_speed_profiles; }
+
     // search graph access
     unsigned GetNumberOfNodes() const override final { return query_graph.GetNumberOfNodes(); }
 
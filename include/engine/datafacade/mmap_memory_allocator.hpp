@@ -20,7 +20,8 @@ namespace osrm::engine::datafacade
 class MMapMemoryAllocator final : public ContiguousBlockAllocator
 {
   public:
-    explicit MMapMemoryAllocator(const storage::StorageConfig &config);
+    explicit MMapMemoryAllocator(const storage::StorageConfig &config,
+                                 const bool huge_pages = false);
     ~MMapMemoryAllocator() override final;
 
     // interface to give access to the datafacades
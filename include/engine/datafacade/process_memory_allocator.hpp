@@ -19,7 +19,8 @@ namespace osrm::engine::datafacade
 class ProcessMemoryAllocator final : public ContiguousBlockAllocator
 {
   public:
-    explicit ProcessMemoryAllocator(const storage::StorageConfig &config);
+    explicit ProcessMemoryAllocator(const storage::StorageConfig &config,
+                                    const bool huge_pages = false);
     ~ProcessMemoryAllocator() override final;
 
     // interface to give access to the datafacades
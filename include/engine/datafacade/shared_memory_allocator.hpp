@@ -7,6 +7,7 @@
 #include "storage/shared_memory.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace osrm::engine::datafacade
 {
@@ -26,6 +27,9 @@ class SharedMemoryAllocator final : public ContiguousBlockAllocator
     const storage::SharedDataIndex &GetIndex() override final;
 
   private:
+    void MapRegion(const storage::ProjID proj_id,
+                   std::vector<storage::SharedDataIndex::AllocatedRegion> &regions);
+
     storage::SharedDataIndex index;
     std::vector<std::unique_ptr<storage::SharedMemory>> memory_regions;
 };
@@ -30,8 +30,8 @@ class ExternalProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
   public:
     using Facade = DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
-    ExternalProvider(const storage::StorageConfig &config)
-        : facade_factory(std::make_shared<datafacade::MMapMemoryAllocator>(config))
+    ExternalProvider(const storage::StorageConfig &config, const bool huge_pages = false)
+        : facade_factory(std::make_shared<datafacade::MMapMemoryAllocator>(config, huge_pages))
     {
     }
 
@@ -50,8 +50,8 @@ class ImmutableProvider final : public DataFacadeProvider<AlgorithmT, FacadeT>
   public:
     using Facade = DataFacadeProvider<AlgorithmT, FacadeT>::Facade;
 
-    ImmutableProvider(const storage::StorageConfig &config)
-        : facade_factory(std::make_shared<datafacade::ProcessMemoryAllocator>(config))
+    ImmutableProvider(const storage::StorageConfig &config, const bool huge_pages = false)
+        : facade_factory(std::make_shared<datafacade::ProcessMemoryAllocator>(config, huge_pages))
     {
     }
 
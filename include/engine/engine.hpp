@@ -71,13 +71,15 @@ class Engine final : public EngineInterface
             }
             util::Log(logDEBUG) << "Using direct memory mapping with algorithm "
                                 << routing_algorithms::name<Algorithm>();
-            facade_provider = std::make_unique<ExternalProvider<Algorithm>>(config.storage_config);
+            facade_provider = std::make_unique<ExternalProvider<Algorithm>>(
+                config.storage_config, config.use_huge_pages);
         }
         else
         {
             util::Log(logDEBUG) << "Using internal memory with algorithm "
                                 << routing_algorithms::name<Algorithm>();
-            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(config.storage_config);
+            facade_provider = std::make_unique<ImmutableProvider<Algorithm>>(
+                config.storage_config, config.use_huge_pages);
         }
     }
 
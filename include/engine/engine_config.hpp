@@ -83,6 +83,9 @@ struct EngineConfig final
     bool use_shared_memory = true;
     std::filesystem::path memory_file;
     bool use_mmap = true;
+    // Back the mmapped or process memory with transparent huge pages. Shared memory regions are
+    // placed by osrm-datastore --huge-pages instead.
+    bool use_huge_pages = false;
     Algorithm algorithm = Algorithm::CH;
     std::vector<storage::FeatureDataset> disable_feature_dataset;
     std::string verbosity;
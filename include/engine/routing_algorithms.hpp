@@ -11,6 +11,10 @@
 #include "engine/routing_algorithms/map_matching.hpp"
 #include "engine/routing_algorithms/shortest_path.hpp"
 #include "engine/routing_algorithms/tile_turns.hpp"
+#include "engine/routing_algorithms/time_dependent_shortest_path.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 
 namespace osrm::engine
 {
@@ -31,6 +35,10 @@ class RoutingAlgorithmsInterface
     virtual InternalRouteResult
     DirectShortestPathSearch(const PhantomEndpointCandidates &endpoint_candidates) const = 0;
 
+    virtual InternalRouteResult
+    TimeDependentShortestPathSearch(const PhantomEndpointCandidates &endpoint_candidates,
+                                    const std::int64_t departure_time) const = 0;
+
     virtual std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
     ManyToManySearch(const std::vector<PhantomNodeCandidates> &candidates_list,
                      const std::vector<std::size_t> &source_indices,
@@ -58,6 +66,7 @@ class RoutingAlgorithmsInterface
     virtual bool SupportsDistanceAnnotationType() const = 0;
     virtual bool HasGetTileTurns() const = 0;
     virtual bool HasExcludeFlags() const = 0;
+    virtual bool HasTimeDependentSearch() const = 0;
     virtual bool IsValid() const = 0;
 };
 
@@ -85,6 +94,10 @@ class RoutingAlgorithms final : public RoutingAlgorithmsInterface
     InternalRouteResult DirectShortestPathSearch(
         const PhantomEndpointCandidates &endpoint_candidates) const final override;
 
+    InternalRouteResult
+    TimeDependentShortestPathSearch(const PhantomEndpointCandidates &endpoint_candidates,
+                                    const std::int64_t departure_time) const final override;
+
     std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
     ManyToManySearch(const std::vector<PhantomNodeCandidates> &candidates_list,
                      const std::vector<std::size_t> &source_indices,
@@ -128,6 +141,9 @@ class RoutingAlgorithms final : public RoutingAlgorithmsInterface
     bool HasExcludeFlags() const final override
     { return routing_algorithms::HasExcludeFlags<Algorithm>::value; }
 
+    bool HasTimeDependentSearch() const final override
+    { return routing_algorithms::HasTimeDependentSearch<Algorithm>::value; }
+
     bool IsValid() const final override { return static_cast<bool>(facade); }
 
   private:
@@ -157,6 +173,22 @@ InternalRouteResult RoutingAlgorithms<Algorithm>::DirectShortestPathSearch(
     const PhantomEndpointCandidates &endpoint_candidates) const
 { return routing_algorithms::directShortestPathSearch(heaps, *facade, endpoint_candidates); }
 
+template <routing_algorithms::RoutingAlgorithm Algorithm>
+InternalRouteResult RoutingAlgorithms<Algorithm>::TimeDependentShortestPathSearch(
+    const PhantomEndpointCandidates &endpoint_candidates, const std::int64_t departure_time) const
+{
+    if constexpr (routing_algorithms::HasTimeDependentSearch<Algorithm>::value)
+    {
+        return routing_algorithms::timeDependentShortestPathSearch(
+            heaps, *facade, endpoint_candidates, departure_time);
+    }
+    else
+    {
+        throw util::exception(std::string("Time-dependent search is not implemented for ") +
+                              routing_algorithms::name<Algorithm>() + SOURCE_REF);
+    }
+}
+
 template <routing_algorithms::RoutingAlgorithm Algorithm>
 inline routing_algorithms::SubMatchingList RoutingAlgorithms<Algorithm>::MapMatching(
     const routing_algorithms::CandidateLists &candidates_list,
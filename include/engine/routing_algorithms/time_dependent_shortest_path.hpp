@@ -0,0 +1,28 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_TIME_DEPENDENT_SHORTEST_PATH_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_TIME_DEPENDENT_SHORTEST_PATH_HPP
+
+#include "engine/algorithm.hpp"
+#include "engine/datafacade.hpp"
+#include "engine/internal_route_result.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <cstdint>
+
+namespace osrm::engine::routing_algorithms
+{
+
+/// Shortest path between two coordinates for a departure at a UNIX timestamp. The weights and
+/// durations of roads with a speed profile are scaled to the speed of the profile at the time
+/// they are entered, all other roads keep their customized weights.
+template <typename Algorithm>
+InternalRouteResult
+timeDependentShortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
+                                const DataFacade<Algorithm> &facade,
+                                const PhantomEndpointCandidates &endpoint_candidates,
+                                const std::int64_t departure_time);
+
+} // namespace osrm::engine::routing_algorithms
+
+#endif
@@ -133,6 +133,23 @@ struct ManyToManyMultiLayerDijkstraHeapData : MultiLayerDijkstraHeapData
     }
 };
 
+struct TimeDependentMultiLayerDijkstraHeapData : MultiLayerDijkstraHeapData
+{
+    EdgeDuration duration;
+    //! See ManyToManyHeapData::approach, the duration of the walk delays the departure.
+    EdgeWeight approach;
+    EdgeDuration approach_duration;
+    TimeDependentMultiLayerDijkstraHeapData(NodeID p,
+                                            bool from,
+                                            EdgeDuration duration,
+                                            EdgeWeight approach,
+                                            EdgeDuration approach_duration)
+        : MultiLayerDijkstraHeapData(p, from), duration(duration), approach(approach),
+          approach_duration(approach_duration)
+    {
+    }
+};
+
 struct MLDUnpackingCacheKey
 {
     NodeID source;
@@ -196,10 +213,16 @@ template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
                                                  EdgeWeight,
                                                  MapMatchingMultiLayerDijkstraHeapData,
                                                  util::TwoLevelStorage<NodeID, int>>;
+    using TimeDependentQueryHeap = util::QueryHeap<NodeID,
+                                                   NodeID,
+                                                   EdgeWeight,
+                                                   TimeDependentMultiLayerDijkstraHeapData,
+                                                   util::TwoLevelStorage<NodeID, int>>;
 
     using SearchEngineHeapPtr = std::unique_ptr<QueryHeap>;
     using ManyToManyHeapPtr = std::unique_ptr<ManyToManyQueryHeap>;
     using MapMatchingHeapPtr = std::unique_ptr<MapMatchingQueryHeap>;
+    using TimeDependentHeapPtr = std::unique_ptr<TimeDependentQueryHeap>;
     using UnpackingCachePtr = std::unique_ptr<MLDUnpackingCache>;
 
     static thread_local SearchEngineHeapPtr forward_heap_1;
@@ -208,6 +231,7 @@ template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
     static thread_local MapMatchingHeapPtr map_matching_reverse_heap_1;
 
     static thread_local ManyToManyHeapPtr many_to_many_heap;
+    static thread_local TimeDependentHeapPtr time_dependent_heap;
     static thread_local UnpackingCachePtr unpacking_cache;
     static thread_local unsigned unpacking_cache_node_count;
     static thread_local unsigned unpacking_cache_edge_count;
@@ -220,6 +244,9 @@ template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
     void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes,
                                                        unsigned number_of_boundary_nodes);
 
+    void InitializeOrClearTimeDependentThreadLocalStorage(unsigned number_of_nodes,
+                                                          unsigned number_of_boundary_nodes);
+
     void InitializeUnpackingCache(unsigned number_of_nodes, unsigned number_of_edges);
 };
 } // namespace osrm::engine
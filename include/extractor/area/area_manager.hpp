@@ -4,7 +4,6 @@
 #include "extractor/extraction_relation.hpp"
 #include <oneapi/tbb/concurrent_map.h>
 #include <oneapi/tbb/concurrent_set.h>
-#include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/mutex.h>
 #include <osmium/area/assembler_config.hpp>
 #include <osmium/osm.hpp>
@@ -57,7 +56,7 @@ class AreaManager
      * This collects the closed ways and the outer ring members of the relations we have
      * registered for meshing. They are also used for collecting the intersecting ways.
      */
-    tbb::concurrent_vector<osmium::object_id_type> registered_closed_ways;
+    tbb::concurrent_set<osmium::object_id_type> registered_closed_ways;
     /** Map of way_id -> rel_id: if way is a member of rel */
     tbb::concurrent_map<osmium::object_id_type, osmium::object_id_type> m_way_relation;
     /** Map of node_id -> rel_id: if node is a member of rel */
@@ -9,6 +9,7 @@
 
 #include "storage/tar_fwd.hpp"
 
+#include <filesystem>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -37,6 +38,9 @@ class ExtractionContainers
 
     void WriteCharData(const std::string &file_name);
 
+    std::size_t sort_memory_budget;
+    std::filesystem::path sort_directory;
+
   public:
     using NodeIDVector = std::vector<OSMNodeID>;
     using NodeVector = std::vector<QueryNode>;
@@ -72,7 +76,10 @@ class ExtractionContainers
     std::vector<UnresolvedManeuverOverride> internal_maneuver_overrides;
     NodeVector used_nodes;
 
-    ExtractionContainers();
+    // With a sort memory budget in bytes the node and edge lists are sorted in runs that are
+    // spilled to sort_directory, so they do not have to be held in memory during the sort
+    explicit ExtractionContainers(std::size_t sort_memory_budget = 0,
+                                  std::filesystem::path sort_directory = {});
 
     void PrepareData(ScriptingEnvironment &scripting_environment,
                      const std::string &names_data_path);
@@ -80,14 +80,19 @@ struct ExtractorConfig final : storage::IOConfig
     std::filesystem::path profile_path;
     std::vector<std::filesystem::path> location_dependent_data_paths;
     std::filesystem::path output_path;
+    std::filesystem::path sort_directory;
     std::string data_version;
 
     unsigned requested_num_threads = 0;
     unsigned small_component_size = 1000;
+    // in MiB, 0 sorts the node and edge lists in memory
+    unsigned sort_memory_budget = 0;
 
     bool use_metadata = false;
     bool parse_conditionals = false;
     bool use_locations_cache = true;
+    // keeps the node-location cache in a file in the sort directory instead of in memory
+    bool use_locations_cache_file = false;
     bool dump_nbg_graph = false;
 };
 } // namespace osrm::extractor
@@ -3,14 +3,15 @@
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
-#include <boost/geometry/index/rtree.hpp>
 
 #include <osmium/osm/way.hpp>
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace osrm::extractor
 {
@@ -25,27 +26,52 @@ struct LocationDependentData
     using box_t = boost::geometry::model::box<point_t>;
 
     using polygon_position_t = std::size_t;
-    using rtree_t = boost::geometry::index::rtree<std::pair<box_t, polygon_position_t>,
-                                                  boost::geometry::index::rstar<8>>;
 
     using property_t = std::variant<std::monostate, double, std::string, bool>;
     using properties_t = std::unordered_map<std::string, property_t>;
 
     LocationDependentData(const std::vector<std::filesystem::path> &file_paths);
 
-    bool empty() const { return rtree.empty(); }
+    bool empty() const { return polygons.empty(); }
 
+    // Returns the properties of all polygons that contain the point, in the order of the polygons
     std::vector<std::size_t> GetPropertyIndexes(const point_t &point) const;
 
     property_t FindByKey(const std::vector<std::size_t> &property_indexes, const char *key) const;
 
   private:
+    struct polygon_data_t
+    {
+        box_t envelope;
+        polygon_bands_t bands;
+        std::size_t properties_index;
+    };
+
+    // The cell index divides the envelope of all polygons into a grid of square cells with up to
+    // MAX_CELLS_PER_SIDE cells per side. Every cell lists the polygons that cover it completely,
+    // and with BOUNDARY_CELL the polygons whose boundary crosses it. Only the latter need a
+    // point-in-polygon test.
+    static constexpr std::size_t MAX_CELLS_PER_SIDE = 1024;
+    static constexpr std::uint32_t BOUNDARY_CELL = 1u << 31;
+
     void loadLocationDependentData(const std::filesystem::path &file_path,
-                                   std::vector<rtree_t::value_type> &bounding_boxes);
+                                   std::vector<std::vector<segment_t>> &polygon_segments);
 
-    rtree_t rtree;
-    std::vector<std::pair<polygon_bands_t, std::size_t>> polygons;
+    void buildCellIndex(const std::vector<std::vector<segment_t>> &polygon_segments);
+    std::size_t GetColumn(const double x) const;
+    std::size_t GetRow(const double y) const;
+    bool IsInside(const point_t &point, const polygon_position_t position) const;
+
+    std::vector<polygon_data_t> polygons;
     std::vector<properties_t> properties;
+
+    box_t grid_envelope;
+    double cell_size = 0;
+    std::size_t columns = 0;
+    std::size_t rows = 0;
+    // entries of cell i are cell_entries[cell_offsets[i]] to cell_entries[cell_offsets[i + 1]]
+    std::vector<std::uint32_t> cell_offsets;
+    std::vector<std::uint32_t> cell_entries;
 };
 } // namespace osrm::extractor
 
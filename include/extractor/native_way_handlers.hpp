@@ -0,0 +1,98 @@
+#ifndef OSRM_EXTRACTOR_NATIVE_WAY_HANDLERS_HPP
+#define OSRM_EXTRACTOR_NATIVE_WAY_HANDLERS_HPP
+
+#include "extractor/extraction_way.hpp"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace osmium
+{
+class Way;
+} // namespace osmium
+
+namespace osrm::extractor
+{
+
+// The values of the profile table that the native way handlers read. Sequences keep their
+// order, sets only their members.
+struct NativeWayHandlersConfig
+{
+    enum class OnewayHandling
+    {
+        Disabled,    // nil or false
+        All,         // true
+        Specific,    // 'specific'
+        Conditional, // 'conditional'
+        Unknown      // any other value, which no oneway tag matches
+    };
+
+    std::vector<std::string> access_tags_hierarchy;
+    std::unordered_set<std::string> access_tag_whitelist;
+    std::unordered_set<std::string> access_tag_blacklist;
+    std::unordered_set<std::string> restricted_access_tag_list;
+    std::unordered_set<std::string> restricted_highway_whitelist;
+    // speeds by key and value, in the order in which the profile table lists the keys
+    std::vector<std::pair<std::string, std::unordered_map<std::string, double>>> speeds;
+    double default_speed = 0;
+    OnewayHandling oneway_handling = OnewayHandling::Disabled;
+    std::vector<std::string> restrictions;
+    std::optional<std::unordered_set<std::string>> classes;
+};
+
+// Intermediate values of a way that the handlers share, the fields of the `data` table of
+// the Lua handlers
+struct NativeWayHandlersData
+{
+    std::optional<std::string> highway;
+    std::optional<std::string> forward_access;
+    std::optional<std::string> backward_access;
+    std::optional<std::string> oneway;
+    bool is_forward_oneway = false;
+    bool is_reverse_oneway = false;
+};
+
+/**
+ * C++ implementations of the access, oneway, speed and classes handlers of
+ * profiles/lib/way_handlers.lua with the same results. They look up tags on the osmium way
+ * directly and read the profile from a config that is converted once, instead of crossing into
+ * C++ for every tag lookup.
+ *
+ * Like their Lua counterparts the handlers return false if the way is not routable.
+ */
+class NativeWayHandlers
+{
+  public:
+    explicit NativeWayHandlers(NativeWayHandlersConfig config);
+
+    bool Access(const osmium::Way &way, ExtractionWay &result, NativeWayHandlersData &data) const;
+    bool Oneway(const osmium::Way &way, ExtractionWay &result, NativeWayHandlersData &data) const;
+    bool Speed(const osmium::Way &way, ExtractionWay &result, NativeWayHandlersData &data) const;
+    bool Classes(const osmium::Way &way, ExtractionWay &result, NativeWayHandlersData &data) const;
+
+    const NativeWayHandlersConfig &GetConfig() const { return config; }
+
+  private:
+    // a key with its :forward and :backward variants
+    struct DirectionalKey
+    {
+        std::string key;
+        std::string forward;
+        std::string backward;
+    };
+
+    std::optional<std::string> ResolveAccess(const char *value) const;
+
+    NativeWayHandlersConfig config;
+    std::vector<DirectionalKey> access_keys;
+    std::vector<std::string> oneway_keys;
+    DirectionalKey toll_key;
+    DirectionalKey route_key;
+};
+} // namespace osrm::extractor
+
+#endif // OSRM_EXTRACTOR_NATIVE_WAY_HANDLERS_HPP
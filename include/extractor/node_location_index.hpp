@@ -0,0 +1,93 @@
+#ifndef OSRM_EXTRACTOR_NODE_LOCATION_INDEX_HPP
+#define OSRM_EXTRACTOR_NODE_LOCATION_INDEX_HPP
+
+#include "util/vector_view.hpp"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <filesystem>
+
+namespace osmium
+{
+class Way;
+} // namespace osmium
+
+namespace osrm::extractor
+{
+
+/**
+ * Locations of OSM nodes, indexed by node ID. By default the locations are kept in memory in an
+ * osmium::index::map::FlexMem, which switches from a sorted list to dense blocks when the
+ * input is large.
+ *
+ * Alternatively the locations of positive node IDs are kept in a file that is mapped into memory,
+ * like the dense file arrays of osmium. The file grows with the largest node ID, at 8 bytes per
+ * ID. It stays sparse on filesystems that support sparse files (ext4, xfs, APFS, ...), but is
+ * written out in full on others (NTFS, FAT, many network filesystems).
+ *
+ * Negative node IDs, as used by editors for new objects, are always kept in memory in an index of
+ * their own.
+ *
+ * The nodes are stored from a single thread and must come before all ways, like they do in
+ * sorted OSM files. Once the first way has been stored the index does not change anymore, so
+ * the locations of ways can be looked up from any number of threads without a lock.
+ */
+class NodeLocationIndex
+{
+  public:
+    // Keeps the locations in memory
+    NodeLocationIndex();
+    // Keeps the locations of positive node IDs in a file in the given directory, which is
+    // removed with the index
+    explicit NodeLocationIndex(const std::filesystem::path &directory);
+    ~NodeLocationIndex();
+
+    NodeLocationIndex(const NodeLocationIndex &) = delete;
+    NodeLocationIndex &operator=(const NodeLocationIndex &) = delete;
+
+    // Stores the locations of the nodes in the buffer, buffers must be passed in input order.
+    // Throws if a node follows a way.
+    void Store(const osmium::memory::Buffer &buffer);
+
+    // Returns an undefined location for nodes that have not been stored. Only valid once a buffer
+    // with a way has been stored.
+    osmium::Location Get(const osmium::object_id_type node_id) const;
+
+    // Sets the locations of the nodes of all ways in the buffer. Returns the number of node
+    // references whose location is unknown.
+    std::size_t SetWayLocations(osmium::memory::Buffer &buffer) const;
+
+  private:
+    using MemoryIndex = osmium::index::map::FlexMem<osmium::unsigned_object_id_type,
+                                                    osmium::Location>;
+
+    // Coordinates are stored shifted into the unsigned range, so that the zero bytes of the
+    // sparse file never decode to a valid location.
+    struct Entry
+    {
+        std::uint32_t lon;
+        std::uint32_t lat;
+    };
+    static constexpr std::uint32_t COORDINATE_OFFSET = std::uint32_t{1} << 31;
+
+    void Reserve(const std::uint64_t node_id);
+    void Set(const osmium::object_id_type node_id, const osmium::Location location);
+
+    // empty if the locations are kept in memory
+    std::filesystem::path path;
+    boost::iostreams::mapped_file region;
+    util::vector_view<Entry> entries;
+
+    MemoryIndex positive_locations;
+    MemoryIndex negative_locations;
+    bool seen_ways = false;
+};
+} // namespace osrm::extractor
+
+#endif // OSRM_EXTRACTOR_NODE_LOCATION_INDEX_HPP
@@ -132,6 +132,9 @@ struct ProfileProperties
     unsigned weight_precision = 1;
     bool force_split_edges = false;
     bool call_tagless_node_function = true;
+    //! the profile declares that process_way only depends on the tags of a way, so its
+    //! results are cached by tag set. Ways that are members of relations are always processed.
+    bool memoize_way_function = false;
     //! emit an open area's whole visibility graph rather than the pruned mesh.  The
     //! pruned mesh -- the shortest-path tree rooted at each entry point -- is already
     //! exact for any journey with one end at an entry point, so this is only needed for
@@ -7,12 +7,16 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/assert.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <storage/io.hpp>
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm::extractor
 {
@@ -32,41 +36,32 @@ struct RasterDatum
     RasterDatum(std::int32_t _datum) : datum(_datum) {}
 };
 
+// Rasters converted by osrm-convert-raster are stored in square tiles, so that a lookup only
+// pages in the tile around the coordinate instead of the whole raster.
+//
+// A file starts with a TiledRasterHeader and is followed by the tiles row by row. Every tile
+// stores tile_size rows of tile_size values in host byte order. Tiles at the right and bottom
+// edge are padded to the full size.
+struct TiledRasterHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t tile_size;
+    std::uint64_t width;
+    std::uint64_t height;
+};
+static_assert(sizeof(TiledRasterHeader) == 32, "tiled raster header must not have padding");
+
+inline constexpr char TILED_RASTER_MAGIC[8] = {'O', 'S', 'R', 'M', 'R', 'S', 'T', '\0'};
+inline constexpr std::uint32_t TILED_RASTER_VERSION = 1;
+inline constexpr std::uint32_t DEFAULT_RASTER_TILE_SIZE = 128;
+
 class RasterGrid
 {
   public:
-    RasterGrid(const std::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim)
-    {
-        xdim = _xdim;
-        ydim = _ydim;
-        _data.resize(ydim * xdim);
-        BOOST_ASSERT(ydim * xdim <= _data.capacity());
-
-        // Construct FileReader
-        storage::io::FileReader file_reader(filepath, storage::io::FileReader::HasNoFingerprint);
-        std::string buffer;
-        buffer.resize(xdim * 11); // INT32_MAX = 2147483647 = 10 chars + 1 white space = 11
-        BOOST_ASSERT(xdim * 11 <= buffer.size());
-
-        for (unsigned int y = 0; y < ydim; y++)
-        {
-            // read one line from file.
-            file_reader.ReadLine(buffer.data(), xdim * 11);
-            boost::algorithm::trim(buffer);
-
-            std::vector<std::string> result;
-            boost::split(
-                result, buffer, boost::is_any_of(" \r\n\0"), boost::algorithm::token_compress_on);
-            unsigned int x = 0;
-            for (const auto &s : result)
-            {
-                if (x < xdim)
-                    _data[(y * xdim) + x] = atoi(s.c_str());
-                ++x;
-            }
-            BOOST_ASSERT(x == xdim);
-        }
-    }
+    // Loads a raster with xdim columns and ydim rows. Tiled rasters are mapped into memory and
+    // paged in on lookup, ASCII grids are parsed into memory.
+    RasterGrid(const std::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim);
 
     RasterGrid(const RasterGrid &) = default;
     RasterGrid &operator=(const RasterGrid &) = default;
@@ -74,14 +69,40 @@ class RasterGrid
     RasterGrid(RasterGrid &&) = default;
     RasterGrid &operator=(RasterGrid &&) = default;
 
-    std::int32_t operator()(std::size_t x, std::size_t y) { return _data[y * xdim + x]; }
-    std::int32_t operator()(std::size_t x, std::size_t y) const { return _data[(y)*xdim + (x)]; }
+    std::int32_t operator()(std::size_t x, std::size_t y) const
+    {
+        if (tiles == nullptr)
+        {
+            return _data[y * xdim + x];
+        }
+        const auto tile = (y / tile_size) * xtiles + x / tile_size;
+        return tiles[(tile * tile_size + y % tile_size) * tile_size + x % tile_size];
+    }
 
   private:
+    void ReadAscii(const std::filesystem::path &filepath);
+    void MapTiles(const std::filesystem::path &filepath);
+
     std::vector<std::int32_t> _data;
+    // shared by the copies of the grid, which all point into the same mapping
+    std::shared_ptr<boost::iostreams::mapped_file_source> mapping;
+    const std::int32_t *tiles = nullptr;
+    std::size_t tile_size = 0;
+    std::size_t xtiles = 0;
     std::size_t xdim, ydim;
 };
 
+// Returns true if the file starts with the header of a tiled raster
+bool isTiledRaster(const std::filesystem::path &filepath);
+
+// Converts an ASCII grid with ncols columns and nrows rows into a tiled raster. Only one row of
+// tiles is kept in memory.
+void convertToTiledRaster(const std::filesystem::path &ascii_path,
+                          const std::filesystem::path &tiled_path,
+                          std::size_t ncols,
+                          std::size_t nrows,
+                          std::uint32_t tile_size = DEFAULT_RASTER_TILE_SIZE);
+
 /**
     \brief Stores raster source data in memory and provides lookup functions.
 */
@@ -79,6 +79,9 @@ class ScriptingEnvironment
 
     virtual bool HasLocationDependentData() const = 0;
 
+    // Logs statistics of the processing after parsing
+    virtual void LogStatistics() {}
+
     /** The `relations` parameter to @ref process_way etc. */
     ExtractionRelationContainer m_relations_stash;
     /** The `obstacle map` global shared by all threads. */
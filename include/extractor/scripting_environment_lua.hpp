@@ -2,14 +2,19 @@
 #define SCRIPTING_ENVIRONMENT_LUA_HPP
 
 #include "extractor/location_dependent_data.hpp"
+#include "extractor/native_way_handlers.hpp"
 #include "extractor/raster_source.hpp"
 #include "extractor/scripting_environment.hpp"
 
+#include <osmium/osm/tag.hpp>
 #include <tbb/enumerable_thread_specific.h>
 
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // TODO(themarex): array-bounds check is disabled because of a false-positive in sol2
 #pragma GCC diagnostic push
@@ -20,6 +25,26 @@
 namespace osrm::extractor
 {
 
+// Results of process_way by the tag set of a way, for profiles that declare with
+// memoize_way_function that process_way only depends on the tags
+struct WayResultCache
+{
+    // bounds the memory of the cache of every thread, the most frequent tag sets are usually
+    // seen early
+    static constexpr std::size_t MAX_TAG_SETS = 1 << 16;
+
+    // Returns the tags sorted by key and value as one string
+    const std::string &MakeKey(const osmium::TagList &tags);
+
+    std::unordered_map<std::string, ExtractionWay> results;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+  private:
+    std::vector<std::pair<const char *, const char *>> sorted_tags;
+    std::string key;
+};
+
 struct LuaScriptingContext final
 {
     LuaScriptingContext(const LocationDependentData &location_dependent_data)
@@ -34,6 +59,9 @@ struct LuaScriptingContext final
     void ProcessWay(const osmium::Way &,
                     ExtractionWay &result,
                     const ExtractionRelationContainer &relations);
+    void ProcessWayMemoized(const osmium::Way &,
+                            ExtractionWay &result,
+                            const ExtractionRelationContainer &relations);
     void ProcessRelation(const osmium::Relation &, const ExtractionRelationContainer &relations);
 
     ProfileProperties properties;
@@ -59,6 +87,11 @@ struct LuaScriptingContext final
     const LocationDependentData &location_dependent_data;
     LocationDependentData::point_t last_location_point;
     std::vector<std::size_t> last_location_indexes;
+
+    WayResultCache way_cache;
+
+    // set up from profile_table on the first call of a native_way_handlers function
+    std::unique_ptr<NativeWayHandlers> native_way_handlers;
 };
 
 /**
@@ -96,6 +129,8 @@ class Sol2ScriptingEnvironment final : public ScriptingEnvironment
 
     bool HasLocationDependentData() const override { return !location_dependent_data.empty(); }
 
+    void LogStatistics() override;
+
   private:
     LuaScriptingContext &GetSol2Context();
 
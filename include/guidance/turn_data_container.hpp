@@ -93,6 +93,30 @@ template <storage::Ownership Ownership> class TurnDataContainerImpl
             others.begin(), others.end(), [this](const TurnData &other) { push_back(other); });
     }
 
+    std::size_t size() const { return turn_instructions.size(); }
+
+    // Makes room for turns that are filled in with set, which can be called from several threads
+    // for different turns
+    void resize(const std::size_t size)
+        requires(Ownership != storage::Ownership::View)
+    {
+        turn_instructions.resize(size);
+        lane_data_ids.resize(size);
+        entry_class_ids.resize(size);
+        pre_turn_bearings.resize(size);
+        post_turn_bearings.resize(size);
+    }
+
+    void set(const EdgeID id, const TurnData &data)
+        requires(Ownership != storage::Ownership::View)
+    {
+        turn_instructions[id] = data.turn_instruction;
+        lane_data_ids[id] = data.lane_data_id;
+        entry_class_ids[id] = data.entry_class_id;
+        pre_turn_bearings[id] = data.pre_turn_bearing;
+        post_turn_bearings[id] = data.post_turn_bearing;
+    }
+
     friend void serialization::read<Ownership>(storage::tar::FileReader &reader,
                                                const std::string &name,
                                                TurnDataContainerImpl &turn_data_container);
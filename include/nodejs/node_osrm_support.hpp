@@ -1106,6 +1106,20 @@ inline route_parameters_ptr argumentsToRouteParameter(const Napi::CallbackInfo &
         }
     }
 
+    if (obj.Has("depart_at"))
+    {
+        auto value = obj.Get("depart_at");
+        if (value.IsEmpty())
+            return route_parameters_ptr();
+
+        if (!value.IsNumber())
+        {
+            ThrowError(args.Env(), "'depart_at' param must be a UNIX timestamp");
+            return route_parameters_ptr();
+        }
+        params->depart_at = value.ToNumber().Int64Value();
+    }
+
     if (obj.Has("alternatives"))
     {
         auto value = obj.Get("alternatives");
@@ -0,0 +1,440 @@
+#ifndef OSRM_PARTITIONER_CELL_MICROCODE_HPP
+#define OSRM_PARTITIONER_CELL_MICROCODE_HPP
+
+#include "partitioner/cell_storage.hpp"
+#include "partitioner/multi_level_partition.hpp"
+
+#include "storage/io_fwd.hpp"
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace osrm::partitioner
+{
+class CellMicrocode;
+
+namespace serialization
+{
+inline void
+read(storage::tar::FileReader &reader, const std::string &name, CellMicrocode &microcode);
+inline void
+write(storage::tar::FileWriter &writer, const std::string &name, const CellMicrocode &microcode);
+} // namespace serialization
+
+// Metric independent customization programs ("microcode") for the cells of a partition.
+//
+// The vertices of a cell are all nodes a customization search in it can visit: the nodes of
+// the cell on level 1 and the boundary nodes of its sub-cells on higher levels. The boundary
+// vertices of the cell come first, followed by the other vertices in elimination order.
+// Eliminating a vertex v relaxes d(u, w) with d(u, v) + d(v, w) for all of its remaining
+// in-neighbours u and out-neighbours w, including the shortcuts added by earlier eliminations.
+// These neighbourhoods only depend on the topology, so they are computed once by
+// osrm-partition and stored as one instruction stream per cell:
+//
+//   #in, #out, in_1 .. in_#in, out_1 .. out_#out    for every eliminated vertex
+//
+// Once all non-boundary vertices are eliminated, the customizer closes the distances between
+// the boundary vertices with a dense Floyd-Warshall sweep.
+class CellMicrocode
+{
+  public:
+    using Instruction = std::uint16_t;
+
+    static constexpr auto INVALID_OFFSET = std::numeric_limits<std::uint64_t>::max();
+
+    // The customizer evaluates a program on dense matrices of a weight, a duration and a distance
+    // per pair of vertices, so a cell with n vertices needs n * n times this many bytes per thread
+    static constexpr std::size_t SCRATCH_BYTES_PER_VERTEX_PAIR =
+        2 * sizeof(std::int64_t) + sizeof(EdgeDistance::value_type);
+    // Memory of the scratch matrices per thread that the largest cells with a program can use
+    static constexpr std::size_t MAX_SCRATCH_BYTES = 80 * 1024 * 1024;
+    // The largest n with n * n * SCRATCH_BYTES_PER_VERTEX_PAIR <= MAX_SCRATCH_BYTES
+    static constexpr std::size_t MAX_CELL_VERTICES = []
+    {
+        std::size_t vertices = 0;
+        while ((vertices + 1) * (vertices + 1) * SCRATCH_BYTES_PER_VERTEX_PAIR <=
+               MAX_SCRATCH_BYTES)
+        {
+            ++vertices;
+        }
+        return vertices;
+    }();
+    static_assert(MAX_CELL_VERTICES <= std::numeric_limits<Instruction>::max());
+
+    struct CellData
+    {
+        std::uint64_t vertex_offset = INVALID_OFFSET;
+        std::uint64_t code_offset = INVALID_OFFSET;
+        std::uint64_t code_size = 0;
+        std::uint32_t num_vertices = 0;
+        std::uint32_t num_boundary_vertices = 0;
+    };
+
+    struct Program
+    {
+        std::span<const NodeID> vertices;
+        std::uint32_t num_boundary_vertices;
+        std::span<const Instruction> code;
+    };
+
+    CellMicrocode() = default;
+
+    // Only cells with at most max_cell_vertices vertices get a program, the others are
+    // customized with a Dijkstra search per source node.
+    template <typename GraphT>
+    CellMicrocode(const MultiLevelPartition &partition,
+                  const CellStorage &storage,
+                  const GraphT &graph,
+                  std::size_t max_cell_vertices)
+    {
+        max_cell_vertices = std::min(max_cell_vertices, MAX_CELL_VERTICES);
+
+        std::uint64_t number_of_cells = 0;
+        for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            level_to_cell_offset.push_back(number_of_cells);
+            number_of_cells += partition.GetNumberOfCells(level);
+        }
+        level_to_cell_offset.push_back(number_of_cells);
+        cells.resize(number_of_cells);
+
+        if (partition.GetNumberOfLevels() < 2)
+        {
+            return;
+        }
+
+        // bucket the nodes by their cell on the first level
+        const auto num_first_level_cells = partition.GetNumberOfCells(1);
+        std::vector<std::uint64_t> first_level_offsets(num_first_level_cells + 1, 0);
+        for (NodeID node = 0; node < graph.GetNumberOfNodes(); ++node)
+        {
+            ++first_level_offsets[partition.GetCell(1, node) + 1];
+        }
+        std::partial_sum(
+            first_level_offsets.begin(), first_level_offsets.end(), first_level_offsets.begin());
+        std::vector<NodeID> first_level_nodes(graph.GetNumberOfNodes());
+        {
+            auto insert_offsets = first_level_offsets;
+            for (NodeID node = 0; node < graph.GetNumberOfNodes(); ++node)
+            {
+                first_level_nodes[insert_offsets[partition.GetCell(1, node)]++] = node;
+            }
+        }
+
+        for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            std::vector<CellProgram> programs(partition.GetNumberOfCells(level));
+            tbb::parallel_for(
+                tbb::blocked_range<CellID>(0, partition.GetNumberOfCells(level)),
+                [&](const tbb::blocked_range<CellID> &range)
+                {
+                    for (auto cell = range.begin(); cell != range.end(); ++cell)
+                    {
+                        std::vector<NodeID> cell_vertices;
+                        if (level == 1)
+                        {
+                            cell_vertices.assign(
+                                first_level_nodes.begin() + first_level_offsets[cell],
+                                first_level_nodes.begin() + first_level_offsets[cell + 1]);
+                        }
+                        else
+                        {
+                            for (auto subcell = partition.BeginChildren(level, cell);
+                                 subcell < partition.EndChildren(level, cell);
+                                 ++subcell)
+                            {
+                                const auto boundary = storage.GetUnfilledCell(level - 1, subcell);
+                                cell_vertices.insert(cell_vertices.end(),
+                                                     boundary.GetSourceNodes().begin(),
+                                                     boundary.GetSourceNodes().end());
+                                cell_vertices.insert(cell_vertices.end(),
+                                                     boundary.GetDestinationNodes().begin(),
+                                                     boundary.GetDestinationNodes().end());
+                            }
+                            std::sort(cell_vertices.begin(), cell_vertices.end());
+                            cell_vertices.erase(
+                                std::unique(cell_vertices.begin(), cell_vertices.end()),
+                                cell_vertices.end());
+                        }
+
+                        if (!cell_vertices.empty() && cell_vertices.size() <= max_cell_vertices)
+                        {
+                            programs[cell] = MakeProgram(partition,
+                                                         storage,
+                                                         graph,
+                                                         level,
+                                                         cell,
+                                                         std::move(cell_vertices));
+                        }
+                    }
+                });
+
+            const auto level_offset = level_to_cell_offset[LevelIDToIndex(level)];
+            for (CellID cell = 0; cell < programs.size(); ++cell)
+            {
+                const auto &program = programs[cell];
+                if (program.vertices.empty())
+                    continue;
+
+                auto &data = cells[level_offset + cell];
+                data.vertex_offset = vertices.size();
+                data.code_offset = code.size();
+                data.code_size = program.code.size();
+                data.num_vertices = program.vertices.size();
+                data.num_boundary_vertices = program.num_boundary_vertices;
+                vertices.insert(vertices.end(), program.vertices.begin(), program.vertices.end());
+                code.insert(code.end(), program.code.begin(), program.code.end());
+            }
+        }
+    }
+
+    bool HasProgram(LevelID level, CellID id) const
+    { return GetCellData(level, id).vertex_offset != INVALID_OFFSET; }
+
+    Program GetProgram(LevelID level, CellID id) const
+    {
+        const auto &data = GetCellData(level, id);
+        BOOST_ASSERT(data.vertex_offset != INVALID_OFFSET);
+        return Program{{vertices.data() + data.vertex_offset, data.num_vertices},
+                       data.num_boundary_vertices,
+                       {code.data() + data.code_offset, data.code_size}};
+    }
+
+    std::uint32_t GetNumberOfCells(LevelID level) const
+    {
+        const auto level_index = LevelIDToIndex(level);
+        if (level_index + 1 >= level_to_cell_offset.size())
+            return 0;
+        return level_to_cell_offset[level_index + 1] - level_to_cell_offset[level_index];
+    }
+
+    std::uint32_t GetNumberOfPrograms(LevelID level) const
+    {
+        const auto level_index = LevelIDToIndex(level);
+        return std::count_if(cells.begin() + level_to_cell_offset[level_index],
+                             cells.begin() + level_to_cell_offset[level_index + 1],
+                             [](const auto &data) { return data.vertex_offset != INVALID_OFFSET; });
+    }
+
+    std::uint64_t GetNumberOfInstructions() const { return code.size(); }
+
+    friend void serialization::read(storage::tar::FileReader &reader,
+                                    const std::string &name,
+                                    CellMicrocode &microcode);
+    friend void serialization::write(storage::tar::FileWriter &writer,
+                                     const std::string &name,
+                                     const CellMicrocode &microcode);
+
+  private:
+    struct CellProgram
+    {
+        std::vector<NodeID> vertices;
+        std::uint32_t num_boundary_vertices = 0;
+        std::vector<Instruction> code;
+    };
+
+    static std::size_t LevelIDToIndex(LevelID level) { return level - 1; }
+
+    const CellData &GetCellData(LevelID level, CellID id) const
+    {
+        const auto level_index = LevelIDToIndex(level);
+        BOOST_ASSERT(level_index < level_to_cell_offset.size());
+        BOOST_ASSERT(level_to_cell_offset[level_index] + id < cells.size());
+        return cells[level_to_cell_offset[level_index] + id];
+    }
+
+    // cell_vertices need to be sorted by node id
+    template <typename GraphT>
+    static CellProgram MakeProgram(const MultiLevelPartition &partition,
+                                   const CellStorage &storage,
+                                   const GraphT &graph,
+                                   LevelID level,
+                                   CellID cell,
+                                   std::vector<NodeID> cell_vertices)
+    {
+        const std::size_t num_vertices = cell_vertices.size();
+        const auto local = [&](const NodeID node) -> std::size_t
+        {
+            auto iter = std::lower_bound(cell_vertices.begin(), cell_vertices.end(), node);
+            BOOST_ASSERT(iter != cell_vertices.end() && *iter == node);
+            return std::distance(cell_vertices.begin(), iter);
+        };
+
+        // adjacency matrix of all arcs a customization search can relax in this cell
+        std::vector<std::uint8_t> arcs(num_vertices * num_vertices, 0);
+        const auto add_arc = [&](const std::size_t from, const std::size_t to)
+        {
+            if (from != to)
+                arcs[from * num_vertices + to] = 1;
+        };
+        if (level > 1)
+        {
+            for (auto subcell = partition.BeginChildren(level, cell);
+                 subcell < partition.EndChildren(level, cell);
+                 ++subcell)
+            {
+                const auto subcell_boundary = storage.GetUnfilledCell(level - 1, subcell);
+                for (const auto source : subcell_boundary.GetSourceNodes())
+                {
+                    for (const auto destination : subcell_boundary.GetDestinationNodes())
+                    {
+                        add_arc(local(source), local(destination));
+                    }
+                }
+            }
+        }
+        for (std::size_t from = 0; from < num_vertices; ++from)
+        {
+            const auto node = cell_vertices[from];
+            for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            {
+                const auto target = graph.GetTarget(edge);
+                if (!graph.GetEdgeData(edge).forward ||
+                    partition.GetCell(level, target) != cell ||
+                    (level > 1 &&
+                     partition.GetCell(level - 1, target) == partition.GetCell(level - 1, node)))
+                {
+                    continue;
+                }
+                add_arc(from, local(target));
+            }
+        }
+
+        std::vector<std::uint8_t> is_boundary(num_vertices, 0);
+        const auto boundary = storage.GetUnfilledCell(level, cell);
+        for (const auto node : boundary.GetSourceNodes())
+            is_boundary[local(node)] = 1;
+        for (const auto node : boundary.GetDestinationNodes())
+            is_boundary[local(node)] = 1;
+
+        // eliminate the non-boundary vertices, always picking the one with the fewest
+        // remaining neighbours to keep the number of shortcuts small
+        std::vector<std::uint8_t> eliminated(num_vertices, 0);
+        const auto degree = [&](const std::size_t vertex)
+        {
+            std::uint32_t result = 0;
+            for (std::size_t other = 0; other < num_vertices; ++other)
+            {
+                result += !eliminated[other] && other != vertex &&
+                          (arcs[vertex * num_vertices + other] ||
+                           arcs[other * num_vertices + vertex]);
+            }
+            return result;
+        };
+        std::vector<std::uint32_t> degrees(num_vertices, 0);
+        for (std::size_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            if (!is_boundary[vertex])
+                degrees[vertex] = degree(vertex);
+        }
+
+        std::vector<std::uint32_t> elimination_order;
+        std::vector<std::uint32_t> steps;
+        std::vector<std::uint32_t> in_neighbours, out_neighbours;
+        const auto num_interior = num_vertices - std::count(is_boundary.begin(),
+                                                            is_boundary.end(),
+                                                            std::uint8_t{1});
+        for (std::size_t step = 0; step < num_interior; ++step)
+        {
+            std::size_t vertex = num_vertices;
+            for (std::size_t candidate = 0; candidate < num_vertices; ++candidate)
+            {
+                if (!is_boundary[candidate] && !eliminated[candidate] &&
+                    (vertex == num_vertices || degrees[candidate] < degrees[vertex]))
+                {
+                    vertex = candidate;
+                }
+            }
+            BOOST_ASSERT(vertex < num_vertices);
+
+            in_neighbours.clear();
+            out_neighbours.clear();
+            for (std::size_t other = 0; other < num_vertices; ++other)
+            {
+                if (eliminated[other] || other == vertex)
+                    continue;
+                if (arcs[other * num_vertices + vertex])
+                    in_neighbours.push_back(other);
+                if (arcs[vertex * num_vertices + other])
+                    out_neighbours.push_back(other);
+            }
+
+            eliminated[vertex] = 1;
+            elimination_order.push_back(vertex);
+            for (const auto from : in_neighbours)
+            {
+                for (const auto to : out_neighbours)
+                {
+                    add_arc(from, to);
+                }
+            }
+
+            steps.push_back(in_neighbours.size());
+            steps.push_back(out_neighbours.size());
+            steps.insert(steps.end(), in_neighbours.begin(), in_neighbours.end());
+            steps.insert(steps.end(), out_neighbours.begin(), out_neighbours.end());
+
+            for (const auto neighbour : in_neighbours)
+            {
+                if (!is_boundary[neighbour])
+                    degrees[neighbour] = degree(neighbour);
+            }
+            for (const auto neighbour : out_neighbours)
+            {
+                if (!is_boundary[neighbour])
+                    degrees[neighbour] = degree(neighbour);
+            }
+        }
+
+        // boundary vertices first, then the others in elimination order
+        CellProgram program;
+        std::vector<Instruction> new_index(num_vertices);
+        for (std::size_t vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            if (is_boundary[vertex])
+            {
+                new_index[vertex] = program.vertices.size();
+                program.vertices.push_back(cell_vertices[vertex]);
+            }
+        }
+        program.num_boundary_vertices = program.vertices.size();
+        for (const auto vertex : elimination_order)
+        {
+            new_index[vertex] = program.vertices.size();
+            program.vertices.push_back(cell_vertices[vertex]);
+        }
+
+        program.code.reserve(steps.size());
+        for (std::size_t index = 0; index < steps.size();)
+        {
+            const auto num_operands = steps[index] + steps[index + 1];
+            program.code.push_back(steps[index++]);
+            program.code.push_back(steps[index++]);
+            for (std::size_t operand = 0; operand < num_operands; ++operand)
+            {
+                program.code.push_back(new_index[steps[index++]]);
+            }
+        }
+
+        return program;
+    }
+
+    std::vector<NodeID> vertices;
+    std::vector<Instruction> code;
+    std::vector<CellData> cells;
+    std::vector<std::uint64_t> level_to_cell_offset;
+};
+} // namespace osrm::partitioner
+
+#endif // OSRM_PARTITIONER_CELL_MICROCODE_HPP
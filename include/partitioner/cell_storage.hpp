@@ -380,23 +380,29 @@ template <storage::Ownership Ownership> class CellStorageImpl
         }
     }
 
-    // Returns a new metric that can be used with this container
-    customizer::CellMetric MakeMetric() const
+    // Returns the number of entries of each vector of a metric for this container
+    std::size_t GetMetricSize() const
     {
-        customizer::CellMetric metric;
-
         if (cells.empty())
         {
-            return metric;
+            return 0;
         }
 
         const auto &last_cell = cells.back();
         ValueOffset total_size =
             last_cell.value_offset + last_cell.num_source_nodes * last_cell.num_destination_nodes;
+        return total_size + 1;
+    }
+
+    // Returns a new metric that can be used with this container
+    customizer::CellMetric MakeMetric() const
+    {
+        customizer::CellMetric metric;
 
-        metric.weights.resize(total_size + 1, INVALID_EDGE_WEIGHT);
-        metric.durations.resize(total_size + 1, MAXIMAL_EDGE_DURATION);
-        metric.distances.resize(total_size + 1, INVALID_EDGE_DISTANCE);
+        const auto size = GetMetricSize();
+        metric.weights.resize(size, INVALID_EDGE_WEIGHT);
+        metric.durations.resize(size, MAXIMAL_EDGE_DURATION);
+        metric.distances.resize(size, INVALID_EDGE_DISTANCE);
 
         return metric;
     }
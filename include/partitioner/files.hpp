@@ -64,6 +64,24 @@ inline void writeCells(const std::filesystem::path &path, CellStorageT &storage)
     serialization::write(writer, "/mld/cellstorage", storage);
 }
 
+// reads .osrm.cell_microcode file
+inline void readCellMicrocode(const std::filesystem::path &path, CellMicrocode &microcode)
+{
+    const auto fingerprint = storage::tar::FileReader::VerifyFingerprint;
+    storage::tar::FileReader reader{path, fingerprint};
+
+    serialization::read(reader, "/mld/cellmicrocode", microcode);
+}
+
+// writes .osrm.cell_microcode file
+inline void writeCellMicrocode(const std::filesystem::path &path, const CellMicrocode &microcode)
+{
+    const auto fingerprint = storage::tar::FileWriter::GenerateFingerprint;
+    storage::tar::FileWriter writer{path, fingerprint};
+
+    serialization::write(writer, "/mld/cellmicrocode", microcode);
+}
+
 // reads .osrm.mldgr file
 template <typename MultiLevelGraphT>
 inline void readGraph(const std::filesystem::path &path,
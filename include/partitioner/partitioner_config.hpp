@@ -19,6 +19,7 @@ struct PartitionerConfig final : storage::IOConfig
                     ".osrm.nbg_nodes",
                     ".osrm.partition",
                     ".osrm.cells",
+                    ".osrm.cell_microcode",
                     ".osrm.maneuver_overrides"}),
           requested_num_threads(0), balance(1.2), boundary_factor(0.25), num_optimizing_cuts(10),
           small_component_size(1000),
@@ -46,6 +47,10 @@ struct PartitionerConfig final : storage::IOConfig
     std::size_t num_optimizing_cuts;
     std::size_t small_component_size;
     std::vector<std::size_t> max_cell_sizes;
+    // Cells with at most this many vertices get a customization microcode, 0 disables it
+    std::size_t microcode_max_cell_size = 0;
+    // Order the nodes of a cell along a Hilbert curve when renumbering
+    bool hilbert_order = false;
 };
 } // namespace osrm::partitioner
 
@@ -9,6 +9,7 @@
 #include "partitioner/bisection_to_partition.hpp"
 #include "partitioner/edge_based_graph.hpp"
 
+#include "util/coordinate.hpp"
 #include "util/dynamic_graph.hpp"
 #include "util/static_graph.hpp"
 
@@ -17,6 +18,18 @@ namespace osrm::partitioner
 std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
                                            const std::vector<Partition> &partitions);
 
+// Like makePermutation, but orders the nodes of every cell and border level by the given
+// Hilbert codes instead of their original IDs
+std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
+                                           const std::vector<Partition> &partitions,
+                                           const std::vector<std::uint64_t> &hilbert_codes);
+
+// Hilbert codes of the edge-based nodes, taken from the first of their segments
+std::vector<std::uint64_t>
+makeHilbertCodes(const std::size_t number_of_nodes,
+                 const util::vector_view<const extractor::EdgeBasedNodeSegment> &segments,
+                 const std::vector<util::Coordinate> &coordinates);
+
 template <typename EdgeDataT>
 inline void renumber(util::DynamicGraph<EdgeDataT> &graph,
                      const std::vector<std::uint32_t> &permutation)
@@ -1,6 +1,7 @@
 #ifndef OSRM_PARTITIONER_SERIALIZATION_HPP
 #define OSRM_PARTITIONER_SERIALIZATION_HPP
 
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/edge_based_graph.hpp"
 #include "partitioner/multi_level_graph.hpp"
@@ -61,6 +62,26 @@ inline void write(storage::tar::FileWriter &writer,
     storage::serialization::write(
         writer, name + "/level_to_cell_offset", storage.level_to_cell_offset);
 }
+
+inline void
+read(storage::tar::FileReader &reader, const std::string &name, CellMicrocode &microcode)
+{
+    storage::serialization::read(reader, name + "/vertices", microcode.vertices);
+    storage::serialization::read(reader, name + "/code", microcode.code);
+    storage::serialization::read(reader, name + "/cells", microcode.cells);
+    storage::serialization::read(
+        reader, name + "/level_to_cell_offset", microcode.level_to_cell_offset);
+}
+
+inline void
+write(storage::tar::FileWriter &writer, const std::string &name, const CellMicrocode &microcode)
+{
+    storage::serialization::write(writer, name + "/vertices", microcode.vertices);
+    storage::serialization::write(writer, name + "/code", microcode.code);
+    storage::serialization::write(writer, name + "/cells", microcode.cells);
+    storage::serialization::write(
+        writer, name + "/level_to_cell_offset", microcode.level_to_cell_offset);
+}
 } // namespace osrm::partitioner::serialization
 
 #endif
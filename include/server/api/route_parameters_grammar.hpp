@@ -68,7 +68,11 @@ inline const auto continue_straight_rule =
      x3::bool_[([](auto &ctx)
                 { x3::get<params_tag>(ctx).get().continue_straight = x3::_attr(ctx); })]);
 
-inline const auto route_rule = alternatives_rule | continue_straight_rule;
+inline const auto depart_at_rule =
+    x3::lit("depart_at=") >
+    x3::long_long[([](auto &ctx) { x3::get<params_tag>(ctx).get().depart_at = x3::_attr(ctx); })];
+
+inline const auto route_rule = alternatives_rule | continue_straight_rule | depart_at_rule;
 
 inline const auto steps_rule =
     x3::lit("steps=") >
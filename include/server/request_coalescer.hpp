@@ -0,0 +1,71 @@
+#ifndef SERVER_REQUEST_COALESCER_HPP
+#define SERVER_REQUEST_COALESCER_HPP
+
+#include "engine/api/base_result.hpp"
+#include "engine/status.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace osrm::server
+{
+
+/**
+ * Single-flight execution of identical queries.
+ *
+ * The first caller for a given key (the leader) runs the query. Callers arriving with the same
+ * key while the leader is still running (followers) block until it finishes and receive a copy
+ * of its status and result instead of running the search again. Nothing is retained once the
+ * leader is done: the next request with that key starts a new flight.
+ *
+ * `exact` identifies the request byte-for-byte. Requests that only agree after normalisation
+ * share successful results, but an error result is only shared with requests that are exactly
+ * identical; everybody else re-runs its own query so that error messages (e.g. the position of
+ * a parse error) always describe the caller's own request.
+ */
+class RequestCoalescer
+{
+  public:
+    using ResultT = engine::api::ResultT;
+    using QueryT = std::function<engine::Status(ResultT &)>;
+
+    engine::Status
+    Run(const std::string &key, const std::string &exact, ResultT &result, const QueryT &query);
+
+    // Number of queries currently being executed by a leader.
+    std::size_t InFlight() const;
+    // Number of requests currently waiting for a leader's result.
+    std::size_t Waiting() const;
+
+  private:
+    struct Flight
+    {
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done = false;
+
+        std::string exact;
+        std::size_t followers = 0;
+
+        engine::Status status = engine::Status::Error;
+        ResultT result;
+        std::exception_ptr error;
+    };
+
+    mutable std::mutex flights_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+};
+
+// Deep copy of a query result. FlatBufferBuilder is move-only, so its finished buffer is
+// pushed into a fresh builder.
+void CopyResult(const engine::api::ResultT &from, engine::api::ResultT &to);
+
+} // namespace osrm::server
+
+#endif // SERVER_REQUEST_COALESCER_HPP
@@ -1,6 +1,7 @@
 #ifndef SERVER_SERVICE_HANLDER_HPP
 #define SERVER_SERVICE_HANLDER_HPP
 
+#include "server/request_coalescer.hpp"
 #include "server/service/base_service.hpp"
 
 #include "engine/api/base_api.hpp"
@@ -37,7 +38,9 @@ class ServiceHandlerInterface
 class ServiceHandler final : public ServiceHandlerInterface
 {
   public:
-    ServiceHandler(osrm::EngineConfig &config);
+    // With `coalesce_requests` set, concurrent requests with identical (normalised) parameters
+    // run the query once and share the result, see RequestCoalescer.
+    ServiceHandler(osrm::EngineConfig &config, bool coalesce_requests = false);
     using ResultT = osrm::engine::api::ResultT;
 
     virtual engine::Status RunQuery(api::ParsedURL parsed_url, ResultT &result) override;
@@ -47,6 +50,7 @@ class ServiceHandler final : public ServiceHandlerInterface
   private:
     std::unordered_map<std::string, std::unique_ptr<service::BaseService>> service_map;
     OSRM routing_machine;
+    std::unique_ptr<RequestCoalescer> coalescer;
 };
 } // namespace server
 } // namespace osrm
@@ -5,15 +5,18 @@
 
 #include "util/iterator_adapters.hpp"
 
+#include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace osrm::storage
 {
 
 // This class wraps one or more shared memory regions with the associated data layout
-// to abstract away in which region a block of memory is stored.
+// to abstract away in which region a block of memory is stored. If several regions contain a
+// block with the same name, the one that comes last wins.
 class SharedDataIndex
 {
   public:
@@ -38,9 +41,25 @@ class SharedDataIndex
 
     template <typename OutIter> void List(const std::string &name_prefix, OutIter out) const
     {
+        if (regions.size() == 1)
+        {
+            regions.front().layout->List(name_prefix, out);
+            return;
+        }
+
+        // Regions may overlay each other, report names only once
+        std::unordered_set<std::string> returned_names;
         for (const auto &region : regions)
         {
-            region.layout->List(name_prefix, out);
+            region.layout->List(name_prefix,
+                                osrm::util::make_function_output_iterator(
+                                    [&](const std::string &name)
+                                    {
+                                        if (returned_names.insert(name).second)
+                                        {
+                                            *out++ = name;
+                                        }
+                                    }));
         }
     }
 
@@ -189,6 +189,11 @@ class TarDataLayout final : public BaseDataLayout
 // bits are used.
 using ProjID = uint16_t;
 
+// A region holding this block only contains the blocks that differ from the region whose ProjID
+// is stored in it (its base). Readers map the base region as well and let the blocks of this
+// region take precedence. See osrm-datastore --only-metric --share-unchanged-blocks.
+constexpr const char *BASE_REGION_BLOCK = "/common/base_region";
+
 struct SharedRegion
 {
     static constexpr const int MAX_NAME_LENGTH = 254;
@@ -262,6 +267,8 @@ struct SharedRegionRegister
         }
     }
 
+    void Deregister(const RegionID key) { regions[key] = SharedRegion{}; }
+
     const auto &GetRegion(const RegionID key) const { return regions[key]; }
 
     auto &GetRegion(const RegionID key) { return regions[key]; }
@@ -29,7 +29,7 @@ class SharedMemory
     SharedMemory &operator=(const SharedMemory &) = delete;
 
   public:
-    SharedMemory(const ProjID proj_id, const uint64_t size = 0);
+    SharedMemory(const ProjID proj_id, const uint64_t size = 0, const bool huge_pages = false);
 
     void *Ptr() const { return region.get_address(); }
     std::size_t Size() const { return region.get_size(); }
@@ -50,7 +50,14 @@ class SharedMemory
  */
 std::filesystem::path getLockDir();
 
-std::unique_ptr<SharedMemory> makeSharedMemory(const ProjID proj_id, const uint64_t size = 0);
+/**
+ * @brief Opens the shared memory region of proj_id, creating it if a size is given
+ *
+ * With huge_pages a newly created region is backed by explicit huge pages (SHM_HUGETLB) if
+ * the system has enough of them reserved, and by transparent huge pages otherwise.
+ */
+std::unique_ptr<SharedMemory>
+makeSharedMemory(const ProjID proj_id, const uint64_t size = 0, const bool huge_pages = false);
 
 /**
  * @brief Tests if a shared memory region exists
@@ -46,7 +46,11 @@ class Storage
   public:
     Storage(StorageConfig config);
 
-    int Run(int max_wait, const std::string &name, bool only_metric);
+    int Run(int max_wait,
+            const std::string &name,
+            bool only_metric,
+            bool share_unchanged_blocks = false,
+            bool huge_pages = false);
     void PopulateStaticData(const SharedDataIndex &index);
     void PopulateUpdatableData(const SharedDataIndex &index);
     void PopulateLayout(storage::BaseDataLayout &layout,
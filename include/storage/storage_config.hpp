@@ -105,6 +105,7 @@ struct StorageConfig final : IOConfig
                    {".osrm.hsgr",
                     ".osrm.cells",
                     ".osrm.cell_metrics",
+                    ".osrm.speed_profiles",
                     ".osrm.mldgr",
                     ".osrm.partition",
                     ".osrm.openareas",
@@ -9,7 +9,15 @@
 
 #include <archive.h>
 #include <archive_entry.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <zlib.h>
 
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -22,6 +30,24 @@ namespace osrm::storage::tar
 {
 namespace detail
 {
+// Blocks at least this large are split into chunks that are read with concurrent positioned
+// reads. A single sequential fread keeps only one request in flight, which leaves most of the
+// bandwidth of NVMe or striped devices unused when loading multi-GB blocks.
+constexpr std::size_t PARALLEL_READ_THRESHOLD = 64 * 1024 * 1024;
+constexpr std::size_t PARALLEL_READ_CHUNK_SIZE = 16 * 1024 * 1024;
+
+// A compressed block named `name` is stored as two tar entries: `name` + COMPRESSED_SUFFIX holds
+// the concatenated compressed streams of consecutive frames of COMPRESSION_FRAME_SIZE raw bytes,
+// and `name` + FRAME_INDEX_SUFFIX holds the uint64 values [codec, raw size, frame size, end offset
+// of every frame]. Frames are independent, so they can be decompressed in parallel and in any
+// order. FileReader hides both entries and presents the block under its original name and size.
+constexpr std::size_t COMPRESSION_THRESHOLD = 1024 * 1024;
+constexpr std::size_t COMPRESSION_FRAME_SIZE = 4 * 1024 * 1024;
+// Identifies the codec and layout of the frames, a new codec or layout gets a new value
+constexpr std::uint64_t FRAME_CODEC_ZLIB = 1;
+constexpr const char *COMPRESSED_SUFFIX = ".zframes";
+constexpr const char *FRAME_INDEX_SUFFIX = ".zframes.index";
+
 inline int fseek64(std::FILE *file, std::int64_t offset, int origin)
 {
 #ifdef _WIN32
@@ -118,6 +144,14 @@ class FileReader
                                      SOURCE_REF);
         }
 
+        if (entry.IsCompressed())
+        {
+            std::vector<T> buffer(number_of_elements);
+            ReadCompressed(name, entry, reinterpret_cast<char *>(buffer.data()));
+            std::copy(buffer.begin(), buffer.end(), out);
+            return;
+        }
+
         if (detail::fseek64(file, static_cast<std::int64_t>(entry.offset), SEEK_SET) != 0)
         {
             throw util::RuntimeError(path.string() + " : " + name,
@@ -162,28 +196,31 @@ class FileReader
                                      SOURCE_REF);
         }
 
-        if (detail::fseek64(file, static_cast<std::int64_t>(entry.offset), SEEK_SET) != 0)
+        if (entry.IsCompressed())
         {
-            throw util::RuntimeError(path.string() + " : " + name,
-                                     ErrorCode::FileIOError,
-                                     SOURCE_REF,
-                                     std::strerror(errno));
+            ReadCompressed(name, entry, reinterpret_cast<char *>(data));
+            return;
         }
 
-        if (std::fread(reinterpret_cast<char *>(data), 1, entry.size, file) != entry.size)
+#if !defined(_WIN32)
+        if (entry.size >= detail::PARALLEL_READ_THRESHOLD)
         {
-            throw util::RuntimeError(path.string() + " : " + name,
-                                     ErrorCode::FileReadError,
-                                     SOURCE_REF,
-                                     std::strerror(errno));
+            ReadParallel(name, entry.offset, entry.size, reinterpret_cast<char *>(data));
+            return;
         }
+#endif
+
+        ReadRange(name, entry.offset, entry.size, reinterpret_cast<char *>(data));
     }
 
     struct FileEntry
     {
         std::string name;
         std::size_t size;
+        // Position of the raw bytes in the file. Compressed entries have no raw bytes to map,
+        // their offset points to the compressed frames.
         std::size_t offset;
+        bool compressed = false;
     };
 
     template <typename OutIter> void List(OutIter out)
@@ -251,6 +288,7 @@ class FileReader
 
         archive_read_free(a);
 
+        std::unordered_map<std::string, IndexEntry> raw_index;
         for (std::size_t i = 0; i < all_entries.size(); ++i)
         {
             if (!all_entries[i].is_regular)
@@ -261,9 +299,198 @@ class FileReader
                 (i + 1 < all_entries.size()) ? all_entries[i + 1].header_pos : end_of_archive_pos;
             std::size_t data_offset = static_cast<std::size_t>(next_pos) - padded_size;
 
-            index[all_entries[i].name] = IndexEntry{data_offset, all_entries[i].size};
-            entries.push_back(FileEntry{all_entries[i].name, all_entries[i].size, data_offset});
+            raw_index[all_entries[i].name] = IndexEntry{data_offset, all_entries[i].size};
+        }
+
+        for (const auto &raw_entry : all_entries)
+        {
+            if (!raw_entry.is_regular || raw_entry.name.ends_with(detail::FRAME_INDEX_SUFFIX))
+                continue;
+
+            auto entry = raw_index.at(raw_entry.name);
+            auto name = raw_entry.name;
+            if (name.ends_with(detail::COMPRESSED_SUFFIX))
+            {
+                name.resize(name.size() - std::strlen(detail::COMPRESSED_SUFFIX));
+                entry = ReadFrameIndex(name, entry, raw_index);
+            }
+
+            entries.push_back(FileEntry{name, entry.size, entry.offset, entry.IsCompressed()});
+            index[name] = std::move(entry);
+        }
+    }
+
+    struct IndexEntry
+    {
+        std::size_t offset;
+        // size of the data after decompression
+        std::size_t size;
+        std::size_t frame_size = 0;
+        // end of every compressed frame relative to offset, empty for raw entries
+        std::vector<std::uint64_t> frame_ends = {};
+
+        bool IsCompressed() const { return !frame_ends.empty(); }
+    };
+
+    IndexEntry ReadFrameIndex(const std::string &name,
+                              const IndexEntry &frames_entry,
+                              const std::unordered_map<std::string, IndexEntry> &raw_index)
+    {
+        const auto index_entry = raw_index.find(name + detail::FRAME_INDEX_SUFFIX);
+        if (index_entry == raw_index.end() ||
+            index_entry->second.size % sizeof(std::uint64_t) != 0 ||
+            index_entry->second.size == 0)
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF,
+                                     "missing or invalid frame index");
+        }
+
+        std::vector<std::uint64_t> values(index_entry->second.size / sizeof(std::uint64_t));
+        ReadRange(name,
+                  index_entry->second.offset,
+                  index_entry->second.size,
+                  reinterpret_cast<char *>(values.data()));
+
+        if (values[0] != detail::FRAME_CODEC_ZLIB)
+        {
+            throw util::RuntimeError(path.string() + " : " + name + " : unsupported codec " +
+                                         std::to_string(values[0]) + " of compressed frames",
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF,
+                                     "file written by a newer version");
+        }
+        if (values.size() < 4)
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF,
+                                     "missing or invalid frame index");
+        }
+
+        IndexEntry entry{frames_entry.offset,
+                         values[1],
+                         values[2],
+                         std::vector<std::uint64_t>(values.begin() + 3, values.end())};
+        const auto expected_frames =
+            entry.frame_size == 0 ? 0 : (entry.size + entry.frame_size - 1) / entry.frame_size;
+        if (entry.frame_ends.size() != expected_frames ||
+            entry.frame_ends.back() != frames_entry.size ||
+            !std::is_sorted(entry.frame_ends.begin(), entry.frame_ends.end()))
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF,
+                                     "frame index does not match the compressed data");
         }
+        return entry;
+    }
+
+    // Reads size bytes at offset. With positioned reads the file position is not used, so
+    // concurrent calls are safe. Windows falls back to seek and read, which is not.
+    void ReadRange(const std::string &name, std::size_t offset, std::size_t size, char *data)
+    {
+#if !defined(_WIN32)
+        const auto descriptor = fileno(file);
+        const auto end = offset + size;
+        while (offset < end)
+        {
+            const auto bytes_read =
+                pread(descriptor, data, end - offset, static_cast<off_t>(offset));
+            if (bytes_read < 0 && errno == EINTR)
+                continue;
+            if (bytes_read == 0)
+            {
+                throw util::RuntimeError(
+                    path.string() + " : " + name, ErrorCode::UnexpectedEndOfFile, SOURCE_REF);
+            }
+            if (bytes_read < 0)
+            {
+                throw util::RuntimeError(path.string() + " : " + name,
+                                         ErrorCode::FileReadError,
+                                         SOURCE_REF,
+                                         std::strerror(errno));
+            }
+            offset += static_cast<std::size_t>(bytes_read);
+            data += bytes_read;
+        }
+#else
+        if (detail::fseek64(file, static_cast<std::int64_t>(offset), SEEK_SET) != 0)
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::FileIOError,
+                                     SOURCE_REF,
+                                     std::strerror(errno));
+        }
+
+        if (std::fread(data, 1, size, file) != size)
+        {
+            throw util::RuntimeError(path.string() + " : " + name,
+                                     ErrorCode::FileReadError,
+                                     SOURCE_REF,
+                                     std::strerror(errno));
+        }
+#endif
+    }
+
+#if !defined(_WIN32)
+    void ReadParallel(const std::string &name, std::size_t offset, std::size_t size, char *data)
+    {
+        const auto number_of_chunks =
+            (size + detail::PARALLEL_READ_CHUNK_SIZE - 1) / detail::PARALLEL_READ_CHUNK_SIZE;
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, number_of_chunks, 1),
+            [&](const tbb::blocked_range<std::size_t> &range)
+            {
+                for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+                {
+                    const auto chunk_offset = chunk * detail::PARALLEL_READ_CHUNK_SIZE;
+                    const auto chunk_size =
+                        std::min(detail::PARALLEL_READ_CHUNK_SIZE, size - chunk_offset);
+                    ReadRange(name, offset + chunk_offset, chunk_size, data + chunk_offset);
+                }
+            });
+    }
+#endif
+
+    // Every frame is read and inflated on its own, so only one compressed frame per thread is
+    // held in memory besides the output.
+    void ReadCompressed(const std::string &name, const IndexEntry &entry, char *data)
+    {
+        const auto decompress_frames = [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            std::vector<char> buffer;
+            for (auto frame = range.begin(); frame != range.end(); ++frame)
+            {
+                const auto frame_begin = frame == 0 ? 0 : entry.frame_ends[frame - 1];
+                buffer.resize(entry.frame_ends[frame] - frame_begin);
+                ReadRange(name, entry.offset + frame_begin, buffer.size(), buffer.data());
+
+                const auto raw_offset = frame * entry.frame_size;
+                const auto raw_size = std::min(entry.frame_size, entry.size - raw_offset);
+                uLongf inflated_size = raw_size;
+                const auto ret = uncompress(reinterpret_cast<Bytef *>(data + raw_offset),
+                                            &inflated_size,
+                                            reinterpret_cast<const Bytef *>(buffer.data()),
+                                            buffer.size());
+                if (ret != Z_OK || inflated_size != raw_size)
+                {
+                    throw util::RuntimeError(path.string() + " : " + name,
+                                             ErrorCode::FileReadError,
+                                             SOURCE_REF,
+                                             "corrupt compressed frame");
+                }
+            }
+        };
+
+        const tbb::blocked_range<std::size_t> all_frames(0, entry.frame_ends.size(), 1);
+#if !defined(_WIN32)
+        tbb::parallel_for(all_frames, decompress_frames);
+#else
+        decompress_frames(all_frames);
+#endif
     }
 
     bool ReadAndCheckFingerprint()
@@ -308,12 +535,6 @@ class FileReader
         return true;
     }
 
-    struct IndexEntry
-    {
-        std::size_t offset;
-        std::size_t size;
-    };
-
     std::filesystem::path path;
     std::FILE *file = nullptr;
     std::unordered_map<std::string, IndexEntry> index;
@@ -329,7 +550,17 @@ class FileWriter
         HasNoFingerprint
     };
 
-    FileWriter(const std::filesystem::path &path, FingerprintFlag flag) : path(path)
+    enum CompressionFlag
+    {
+        Uncompressed,
+        // Blocks written with WriteFrom that are larger than detail::COMPRESSION_THRESHOLD
+        CompressBlocks
+    };
+
+    FileWriter(const std::filesystem::path &path,
+               FingerprintFlag flag,
+               CompressionFlag compression = Uncompressed)
+        : path(path), compression(compression)
     {
         a = archive_write_new();
         int ret = archive_write_set_format_pax_restricted(a);
@@ -372,17 +603,7 @@ class FileWriter
     template <typename T, typename Iter>
     void WriteStreaming(const std::string &name, Iter iter, const std::uint64_t number_of_elements)
     {
-        auto number_of_bytes = number_of_elements * sizeof(T);
-
-        struct archive_entry *ae = archive_entry_new();
-        archive_entry_set_pathname(ae, name.c_str());
-        archive_entry_set_size(ae, static_cast<la_int64_t>(number_of_bytes));
-        archive_entry_set_filetype(ae, AE_IFREG);
-        archive_entry_set_perm(ae, 0644);
-
-        int ret = archive_write_header(a, ae);
-        archive_entry_free(ae);
-        detail::checkArchiveError(a, ret, path, name);
+        WriteHeader(name, number_of_elements * sizeof(T));
 
         for (auto idx : util::irange<std::size_t>(0, number_of_elements))
         {
@@ -399,8 +620,23 @@ class FileWriter
     template <typename T>
     void WriteFrom(const std::string &name, const T *data, const std::size_t number_of_elements)
     {
-        auto number_of_bytes = number_of_elements * sizeof(T);
+        const auto number_of_bytes = number_of_elements * sizeof(T);
+        const auto data_ptr = reinterpret_cast<const char *>(data);
 
+        if (compression == CompressBlocks && number_of_bytes >= detail::COMPRESSION_THRESHOLD &&
+            !name.ends_with(".meta"))
+        {
+            WriteCompressed(name, data_ptr, number_of_bytes);
+            return;
+        }
+
+        WriteHeader(name, number_of_bytes);
+        WriteData(name, data_ptr, number_of_bytes);
+    }
+
+  private:
+    void WriteHeader(const std::string &name, const std::uint64_t number_of_bytes)
+    {
         struct archive_entry *ae = archive_entry_new();
         archive_entry_set_pathname(ae, name.c_str());
         archive_entry_set_size(ae, static_cast<la_int64_t>(number_of_bytes));
@@ -410,9 +646,10 @@ class FileWriter
         int ret = archive_write_header(a, ae);
         archive_entry_free(ae);
         detail::checkArchiveError(a, ret, path, name);
+    }
 
-        const char *data_ptr = reinterpret_cast<const char *>(data);
-        std::size_t remaining = number_of_bytes;
+    void WriteData(const std::string &name, const char *data_ptr, std::size_t remaining)
+    {
         while (remaining > 0)
         {
             const auto written = archive_write_data(a, data_ptr, remaining);
@@ -426,7 +663,64 @@ class FileWriter
         }
     }
 
-  private:
+    // Frames are compressed in parallel and then appended in order, see detail::COMPRESSED_SUFFIX
+    void WriteCompressed(const std::string &name, const char *data, const std::size_t size)
+    {
+        const auto number_of_frames =
+            (size + detail::COMPRESSION_FRAME_SIZE - 1) / detail::COMPRESSION_FRAME_SIZE;
+        std::vector<std::vector<Bytef>> frames(number_of_frames);
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, number_of_frames, 1),
+            [&](const tbb::blocked_range<std::size_t> &range)
+            {
+                for (auto frame = range.begin(); frame != range.end(); ++frame)
+                {
+                    const auto raw_offset = frame * detail::COMPRESSION_FRAME_SIZE;
+                    const auto raw_size =
+                        std::min(detail::COMPRESSION_FRAME_SIZE, size - raw_offset);
+                    uLongf compressed_size = compressBound(raw_size);
+                    frames[frame].resize(compressed_size);
+                    const auto ret =
+                        compress2(frames[frame].data(),
+                                  &compressed_size,
+                                  reinterpret_cast<const Bytef *>(data + raw_offset),
+                                  raw_size,
+                                  Z_DEFAULT_COMPRESSION);
+                    if (ret != Z_OK)
+                    {
+                        throw util::RuntimeError(path.string() + " : " + name,
+                                                 ErrorCode::FileWriteError,
+                                                 SOURCE_REF,
+                                                 "could not compress block");
+                    }
+                    frames[frame].resize(compressed_size);
+                }
+            });
+
+        std::vector<std::uint64_t> frame_index = {
+            detail::FRAME_CODEC_ZLIB, size, detail::COMPRESSION_FRAME_SIZE};
+        std::uint64_t frame_end = 0;
+        for (const auto &frame : frames)
+        {
+            frame_end += frame.size();
+            frame_index.push_back(frame_end);
+        }
+
+        const auto index_name = name + detail::FRAME_INDEX_SUFFIX;
+        WriteHeader(index_name, frame_index.size() * sizeof(std::uint64_t));
+        WriteData(index_name,
+                  reinterpret_cast<const char *>(frame_index.data()),
+                  frame_index.size() * sizeof(std::uint64_t));
+
+        const auto frames_name = name + detail::COMPRESSED_SUFFIX;
+        WriteHeader(frames_name, frame_end);
+        for (const auto &frame : frames)
+        {
+            WriteData(frames_name, reinterpret_cast<const char *>(frame.data()), frame.size());
+        }
+    }
+
     void WriteFingerprint()
     {
         const auto fingerprint = util::FingerPrint::GetValid();
@@ -434,6 +728,7 @@ class FileWriter
     }
 
     std::filesystem::path path;
+    CompressionFlag compression;
     struct archive *a = nullptr;
 };
 } // namespace osrm::storage::tar
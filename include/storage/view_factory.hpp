@@ -7,6 +7,7 @@
 #include "contractor/query_graph.hpp"
 
 #include "customizer/edge_based_graph.hpp"
+#include "customizer/speed_profiles.hpp"
 
 #include "extractor/area_routing_data.hpp"
 #include "extractor/class_data.hpp"
@@ -346,6 +347,17 @@ inline auto make_cell_metric_view(const SharedDataIndex &index, const std::strin
     return cell_metric_excludes;
 }
 
+inline auto make_speed_profiles_view(const SharedDataIndex &index, const std::string &name)
+{
+    customizer::SpeedProfilesView profiles;
+    profiles.node_profiles = make_vector_view<std::uint32_t>(index, name + "/node_profiles");
+    profiles.profile_offsets = make_vector_view<std::uint32_t>(index, name + "/profile_offsets");
+    profiles.breakpoints =
+        make_vector_view<customizer::SpeedBreakpoint>(index, name + "/breakpoints");
+    profiles.static_levels = make_vector_view<LevelID>(index, name + "/static_levels");
+    return profiles;
+}
+
 inline auto make_multi_level_graph_view(const SharedDataIndex &index, const std::string &name)
 {
     auto node_list = make_vector_view<customizer::MultiLevelEdgeBasedGraphView::NodeArrayEntry>(
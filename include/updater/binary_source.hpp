@@ -0,0 +1,61 @@
+#ifndef OSRM_UPDATER_BINARY_SOURCE_HPP
+#define OSRM_UPDATER_BINARY_SOURCE_HPP
+
+#include "updater/source.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osrm::updater::binary
+{
+
+// Segment speed and turn penalty files that are loaded without parsing text.
+//
+// A file starts with a Header and is followed by its records in strictly ascending key order.
+// Plain records are fixed size structs of 64 bit integers and doubles in host byte order.
+// Delta encoded records store every key as LEB128 varints of the difference to the previous
+// record, followed by the same doubles as plain records.
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t number_of_records;
+    // size of all records in bytes, excluding this header
+    std::uint64_t records_size;
+};
+static_assert(sizeof(Header) == 32, "binary traffic file header must not have padding");
+
+inline constexpr char SEGMENT_SPEED_MAGIC[8] = {'O', 'S', 'R', 'M', 'S', 'P', 'D', '\0'};
+inline constexpr char TURN_PENALTY_MAGIC[8] = {'O', 'S', 'R', 'M', 'T', 'R', 'N', '\0'};
+inline constexpr std::uint32_t FORMAT_VERSION = 1;
+inline constexpr std::uint32_t DELTA_ENCODED = 1u << 0;
+
+// Returns true if the data starts with the header of a binary segment speed or turn penalty
+// file. Everything else is parsed as CSV.
+bool isBinaryFile(const char *data, const std::size_t size);
+
+// Decode the records of a binary file, the source index of the values is not set.
+void readRecords(const std::string &filename,
+                 const char *data,
+                 const std::size_t size,
+                 std::vector<std::pair<Segment, SpeedSource>> &records);
+void readRecords(const std::string &filename,
+                 const char *data,
+                 const std::size_t size,
+                 std::vector<std::pair<Turn, PenaltySource>> &records);
+
+// Write the values of a lookup table to a binary file. The source index of the values is not
+// stored, it is assigned from the position of the file on the command line when loading.
+void writeSegmentValues(const std::string &filename,
+                        const SegmentLookupTable &values,
+                        const bool delta_encode);
+void writeTurnValues(const std::string &filename,
+                     const TurnLookupTable &values,
+                     const bool delta_encode);
+} // namespace osrm::updater::binary
+
+#endif
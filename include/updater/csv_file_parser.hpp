@@ -1,6 +1,7 @@
 #ifndef OSRM_UPDATER_CSV_FILE_PARSER_HPP
 #define OSRM_UPDATER_CSV_FILE_PARSER_HPP
 
+#include "updater/binary_source.hpp"
 #include "updater/source.hpp"
 
 #include "util/exception.hpp"
@@ -16,6 +17,7 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/spirit/home/x3.hpp>
 
+#include <algorithm>
 #include <filesystem>
 #include <functional>
 #include <vector>
@@ -24,6 +26,8 @@ namespace osrm::updater
 {
 
 // Functor to parse a list of CSV files using "key,value,comment" grammar.
+// Segment speed and turn penalty files that start with the header of a binary file are decoded
+// by binary::readRecords instead.
 // Key and Value structures must be a model of Random Access Sequence.
 // Also the Value structure must have source member that will be filled
 // with the corresponding file index in the CSV filenames vector.
@@ -64,30 +68,52 @@ template <typename Key, typename Value> struct CSVFilesParser
 
                                   { // Merge local CSV results into a flat global vector
                                       tbb::spin_mutex::scoped_lock _{mutex};
-                                      lookup.insert(end(lookup),
-                                                    std::make_move_iterator(begin(local)),
-                                                    std::make_move_iterator(end(local)));
+                                      if (lookup.empty())
+                                      {
+                                          lookup = std::move(local);
+                                      }
+                                      else
+                                      {
+                                          lookup.insert(end(lookup),
+                                                        std::make_move_iterator(begin(local)),
+                                                        std::make_move_iterator(end(local)));
+                                      }
                                   }
                               });
 
-            // With flattened map-ish view of all the files, make a stable sort on key and source
-            // and unique them on key to keep only the value with the largest file index
-            // and the largest line number in a file.
-            // The operands order is swapped to make descending ordering on (key, source)
-            tbb::parallel_sort(begin(lookup),
-                               end(lookup),
-                               [](const auto &lhs, const auto &rhs)
-                               {
-                                   return std::tie(rhs.first, rhs.second.source) <
-                                          std::tie(lhs.first, lhs.second.source);
-                               });
-
-            // Unique only on key to take the source precedence into account and remove duplicates.
-            const auto it = std::unique(begin(lookup),
-                                        end(lookup),
-                                        [](const auto &lhs, const auto &rhs)
-                                        { return lhs.first == rhs.first; });
-            lookup.erase(it, end(lookup));
+            // A single binary file is already sorted by key without duplicates and only needs
+            // to be put into descending order.
+            const auto is_ascending =
+                std::adjacent_find(begin(lookup),
+                                   end(lookup),
+                                   [](const auto &lhs, const auto &rhs)
+                                   { return !(lhs.first < rhs.first); }) == end(lookup);
+            if (is_ascending)
+            {
+                std::reverse(begin(lookup), end(lookup));
+            }
+            else
+            {
+                // With flattened map-ish view of all the files, make a stable sort on key and
+                // source and unique them on key to keep only the value with the largest file
+                // index and the largest line number in a file.
+                // The operands order is swapped to make descending ordering on (key, source)
+                tbb::parallel_sort(begin(lookup),
+                                   end(lookup),
+                                   [](const auto &lhs, const auto &rhs)
+                                   {
+                                       return std::tie(rhs.first, rhs.second.source) <
+                                              std::tie(lhs.first, lhs.second.source);
+                                   });
+
+                // Unique only on key to take the source precedence into account and remove
+                // duplicates.
+                const auto it = std::unique(begin(lookup),
+                                            end(lookup),
+                                            [](const auto &lhs, const auto &rhs)
+                                            { return lhs.first == rhs.first; });
+                lookup.erase(it, end(lookup));
+            }
 
             util::Log() << "In total loaded " << csv_filenames.size() << " file(s) with a total of "
                         << lookup.size() << " unique values";
@@ -116,7 +142,26 @@ template <typename Key, typename Value> struct CSVFilesParser
             auto first = mmap.begin(), last = mmap.end();
 
             BOOST_ASSERT(file_id <= std::numeric_limits<std::uint8_t>::max());
-            const auto ok = parse_fn(first, last, result);
+            bool ok = true;
+            constexpr bool has_binary_format = requires {
+                binary::readRecords(filename, mmap.data(), mmap.size(), result);
+            };
+            if constexpr (has_binary_format)
+            {
+                if (binary::isBinaryFile(mmap.data(), mmap.size()))
+                {
+                    binary::readRecords(filename, mmap.data(), mmap.size(), result);
+                    first = last;
+                }
+                else
+                {
+                    ok = parse_fn(first, last, result);
+                }
+            }
+            else
+            {
+                ok = parse_fn(first, last, result);
+            }
 
             // Set the file source index on all parsed values
             for (auto &[key, val] : result)
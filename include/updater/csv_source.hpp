@@ -7,6 +7,10 @@ namespace osrm::updater::csv
 {
 SegmentLookupTable readSegmentValues(const std::vector<std::string> &paths);
 TurnLookupTable readTurnValues(const std::vector<std::string> &paths);
+// profile_id,seconds_since_monday,speed
+SpeedProfileLookupTable readSpeedProfiles(const std::vector<std::string> &paths);
+// from_osm_id,to_osm_id,profile_id
+SegmentProfileLookupTable readSegmentProfiles(const std::vector<std::string> &paths);
 } // namespace osrm::updater::csv
 
 #endif
@@ -79,8 +79,42 @@ struct PenaltySource final
     std::uint8_t source;
 };
 
+// A breakpoint of a periodic speed profile, the time is in seconds since Monday 00:00
+struct ProfileTime final
+{
+    std::uint32_t profile, time;
+
+    ProfileTime() : profile(0), time(0) {}
+    ProfileTime(const std::uint32_t profile, const std::uint32_t time)
+        : profile(profile), time(time)
+    {
+    }
+
+    bool operator<(const ProfileTime &rhs) const
+    { return std::tie(profile, time) < std::tie(rhs.profile, rhs.time); }
+
+    bool operator==(const ProfileTime &rhs) const
+    { return std::tie(profile, time) == std::tie(rhs.profile, rhs.time); }
+};
+
+struct ProfileSpeedSource final
+{
+    ProfileSpeedSource() : speed(0.), source(0) {}
+    double speed;
+    std::uint8_t source;
+};
+
+struct ProfileSource final
+{
+    ProfileSource() : profile(0), source(0) {}
+    std::uint32_t profile;
+    std::uint8_t source;
+};
+
 using SegmentLookupTable = LookupTable<Segment, SpeedSource>;
 using TurnLookupTable = LookupTable<Turn, PenaltySource>;
+using SpeedProfileLookupTable = LookupTable<ProfileTime, ProfileSpeedSource>;
+using SegmentProfileLookupTable = LookupTable<Segment, ProfileSource>;
 } // namespace osrm::updater
 
 #endif
@@ -24,6 +24,24 @@ class Updater
         std::vector<EdgeWeight> &node_weights,
         std::vector<EdgeDuration> &node_durations, // TODO: remove when optional
         std::uint32_t &connectivity_checksum) const;
+
+    // Also returns the sorted ids of all edge-based nodes whose outgoing edges got new weights
+    // from the speed, turn penalty or conditional turn updates of this run.
+    EdgeID LoadAndUpdateEdgeExpandedGraph(
+        std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+        std::vector<EdgeWeight> &node_weights,
+        std::vector<EdgeDuration> &node_durations, // TODO: remove when optional
+        std::vector<NodeID> &updated_nodes,
+        std::uint32_t &connectivity_checksum) const;
+    // Also returns the sorted subset of updated_nodes whose segment weights or turn penalties
+    // differ from the ones the previous update wrote, or that got a conditional turn update.
+    EdgeID LoadAndUpdateEdgeExpandedGraph(
+        std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+        std::vector<EdgeWeight> &node_weights,
+        std::vector<EdgeDuration> &node_durations, // TODO: remove when optional
+        std::vector<NodeID> &updated_nodes,
+        std::vector<NodeID> &changed_nodes,
+        std::uint32_t &connectivity_checksum) const;
     EdgeID LoadAndUpdateEdgeExpandedGraph(
         std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
         std::vector<EdgeWeight> &node_weights,
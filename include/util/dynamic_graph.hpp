@@ -190,7 +190,6 @@ template <typename EdgeDataT, typename EdgeIteratorT = std::uint32_t> class Dyna
         DynamicGraph other;
 
         other.number_of_nodes = number_of_nodes;
-        other.number_of_edges = static_cast<std::uint32_t>(number_of_edges);
         other.edge_list.reserve(edge_list.size());
         other.node_array.resize(node_array.size());
 
@@ -217,6 +216,7 @@ template <typename EdgeDataT, typename EdgeIteratorT = std::uint32_t> class Dyna
                                return Node{first_edge, 0};
                            }
                        });
+        other.number_of_edges = static_cast<std::uint32_t>(other.edge_list.size());
 
         return other;
     }
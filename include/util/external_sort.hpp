@@ -0,0 +1,299 @@
+#ifndef OSRM_UTIL_EXTERNAL_SORT_HPP
+#define OSRM_UTIL_EXTERNAL_SORT_HPP
+
+#include "storage/io.hpp"
+#include "util/integer_range.hpp"
+
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace osrm::util
+{
+
+/**
+ * Sorts more elements than fit into a memory budget.
+ *
+ * Elements are split into runs of half the budget, which are sorted with tbb::parallel_sort and
+ * spilled to temporary files. A run is written in the background while the next one is sorted.
+ * Merging reads every run in blocks and always has the next block of a run in flight while the
+ * current one is consumed, so sorting, reading and writing overlap. The runs are combined with a
+ * k-way merge over a heap.
+ */
+template <typename T, typename Compare = std::less<T>> class ExternalSorter
+{
+    static_assert(std::is_trivially_copyable_v<T>, "runs are written bytewise");
+
+  public:
+    ExternalSorter(std::filesystem::path directory_,
+                   const std::size_t memory_budget,
+                   Compare compare_ = {})
+        : directory(std::move(directory_)),
+          run_size(std::max<std::size_t>(memory_budget / 2 / sizeof(T), MIN_BLOCK_SIZE)),
+          memory_budget(memory_budget), compare(std::move(compare_))
+    {
+        std::random_device random;
+        prefix = "osrm-sort-" + std::to_string(random()) + "-";
+    }
+
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    ~ExternalSorter()
+    {
+        if (pending_write.valid())
+        {
+            pending_write.wait();
+        }
+        for (const auto &path : run_paths)
+        {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    }
+
+    void Push(const T &value)
+    {
+        buffer.push_back(value);
+        if (buffer.size() == run_size)
+        {
+            // hand the full buffer over to the writer and collect the next run in a new one
+            auto run = std::make_shared<std::vector<T>>(std::move(buffer));
+            buffer = {};
+            buffer.reserve(run_size);
+            tbb::parallel_sort(run->begin(), run->end(), compare);
+            WriteRun(run->data(), run->size(), run);
+        }
+    }
+
+    // Sorts the elements of values in runs and spills them, the memory of values is released.
+    void Spill(std::vector<T> &values)
+    {
+        for (std::size_t first = 0; first < values.size(); first += run_size)
+        {
+            const auto last = std::min(first + run_size, values.size());
+            tbb::parallel_sort(values.begin() + first, values.begin() + last, compare);
+            WriteRun(values.data() + first, last - first);
+        }
+        if (pending_write.valid())
+        {
+            pending_write.get();
+        }
+        values.clear();
+        values.shrink_to_fit();
+    }
+
+    std::size_t Size() const { return number_of_elements + buffer.size(); }
+
+    std::size_t NumberOfRuns() const { return run_paths.size(); }
+
+    // Calls consume with every element in sorted order. Equal elements are passed in the order
+    // of their runs. All elements are consumed, so the sorter is empty afterwards.
+    template <typename Consumer> void Merge(Consumer &&consume)
+    {
+        tbb::parallel_sort(buffer.begin(), buffer.end(), compare);
+        if (pending_write.valid())
+        {
+            pending_write.get();
+        }
+
+        // the buffer takes part in the merge like a run that has been read completely
+        std::vector<RunReader> runs;
+        runs.reserve(run_paths.size() + 1);
+        const auto block_size = std::max<std::size_t>(
+            memory_budget / 2 / std::max<std::size_t>(run_paths.size(), 1) / sizeof(T),
+            MIN_BLOCK_SIZE);
+        for (const auto index : util::irange<std::size_t>(0, run_paths.size()))
+        {
+            runs.emplace_back(run_paths[index], run_sizes[index], block_size);
+        }
+        if (!buffer.empty())
+        {
+            runs.emplace_back(std::move(buffer));
+        }
+
+        // min-heap of runs by their current element, ties are broken by the run index
+        const auto greater = [&](const std::size_t lhs, const std::size_t rhs)
+        {
+            const auto &left = runs[lhs].Current();
+            const auto &right = runs[rhs].Current();
+            if (compare(right, left))
+                return true;
+            if (compare(left, right))
+                return false;
+            return lhs > rhs;
+        };
+        std::vector<std::size_t> heap;
+        for (const auto index : util::irange<std::size_t>(0, runs.size()))
+        {
+            if (!runs[index].Done())
+            {
+                heap.push_back(index);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            auto &run = runs[heap.back()];
+            consume(run.Current());
+            run.Next();
+            if (run.Done())
+            {
+                heap.pop_back();
+            }
+            else
+            {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+
+        Clear();
+    }
+
+    // Moves all elements into output in sorted order
+    void Merge(std::vector<T> &output)
+    {
+        output.clear();
+        output.reserve(Size());
+        Merge([&output](const T &value) { output.push_back(value); });
+    }
+
+  private:
+    static constexpr std::size_t MIN_BLOCK_SIZE = 1024;
+
+    // Reads a run in blocks and prefetches the next block in the background
+    class RunReader
+    {
+      public:
+        RunReader(const std::filesystem::path &path,
+                  const std::size_t size,
+                  const std::size_t block_size)
+            : reader(std::make_unique<storage::io::FileReader>(
+                  path, storage::io::FileReader::HasNoFingerprint)),
+              remaining(size), block_size(block_size)
+        {
+            Prefetch();
+            Advance();
+        }
+
+        explicit RunReader(std::vector<T> values) : block(std::move(values)) {}
+
+        RunReader(RunReader &&) = default;
+
+        ~RunReader()
+        {
+            if (next_block.valid())
+            {
+                next_block.wait();
+            }
+        }
+
+        bool Done() const { return position == block.size() && !next_block.valid(); }
+
+        const T &Current() const { return block[position]; }
+
+        void Next()
+        {
+            if (++position == block.size() && next_block.valid())
+            {
+                Advance();
+            }
+        }
+
+      private:
+        void Prefetch()
+        {
+            if (remaining == 0)
+                return;
+
+            const auto count = std::min(remaining, block_size);
+            remaining -= count;
+            next_block = std::async(std::launch::async,
+                                    [reader = reader.get(), count]
+                                    {
+                                        std::vector<T> values(count);
+                                        reader->ReadInto(values.data(), count);
+                                        return values;
+                                    });
+        }
+
+        void Advance()
+        {
+            block = next_block.get();
+            position = 0;
+            Prefetch();
+        }
+
+        std::unique_ptr<storage::io::FileReader> reader;
+        std::size_t remaining = 0;
+        std::size_t block_size = 0;
+        std::vector<T> block;
+        std::size_t position = 0;
+        std::future<std::vector<T>> next_block;
+    };
+
+    // Waits for the previous run to be written and starts writing the next one. The data has
+    // to stay valid until the write finished, unless it is owned by the run.
+    void WriteRun(const T *data,
+                  const std::size_t size,
+                  std::shared_ptr<const std::vector<T>> owner = {})
+    {
+        if (pending_write.valid())
+        {
+            pending_write.get();
+        }
+
+        auto path = directory / (prefix + std::to_string(run_paths.size()) + ".tmp");
+        run_paths.push_back(path);
+        run_sizes.push_back(size);
+        number_of_elements += size;
+
+        pending_write = std::async(std::launch::async,
+                                   [path = std::move(path), data, size, owner = std::move(owner)]
+                                   {
+                                       storage::io::FileWriter writer(
+                                           path, storage::io::FileWriter::HasNoFingerprint);
+                                       writer.WriteFrom(data, size);
+                                   });
+    }
+
+    void Clear()
+    {
+        for (const auto &path : run_paths)
+        {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+        run_paths.clear();
+        run_sizes.clear();
+        number_of_elements = 0;
+        buffer.clear();
+        buffer.shrink_to_fit();
+    }
+
+    std::filesystem::path directory;
+    std::string prefix;
+    std::size_t run_size;
+    std::size_t memory_budget;
+    Compare compare;
+
+    std::vector<T> buffer;
+    std::vector<std::filesystem::path> run_paths;
+    std::vector<std::size_t> run_sizes;
+    std::size_t number_of_elements = 0;
+    std::future<void> pending_write;
+};
+} // namespace osrm::util
+
+#endif // OSRM_UTIL_EXTERNAL_SORT_HPP
@@ -0,0 +1,31 @@
+#ifndef OSRM_UTIL_HUGE_PAGES_HPP
+#define OSRM_UTIL_HUGE_PAGES_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace osrm::util
+{
+
+// Size of the default huge page of the system (Hugepagesize in /proc/meminfo), 0 if unknown.
+std::size_t GetHugePageSize();
+
+// Number of NUMA nodes the system exposes, 1 if unknown.
+std::size_t GetNumaNodeCount();
+
+// Asks the kernel to back the mapping with transparent huge pages (MADV_HUGEPAGE). Only the
+// huge-page aligned interior of the range is advised. Returns false if the advice was rejected
+// or is not supported on this platform.
+bool AdviseHugePages(void *ptr, std::size_t size);
+
+/**
+ * Logs how the pages of [ptr, ptr + size) are backed: the kernel page size, how much of the
+ * resident memory sits on huge pages and how many page table entries are needed to map the
+ * range. Everything the kernel reports in /proc/self/smaps for the mappings covering the range
+ * is summed up, so this is a no-op on platforms without it.
+ */
+void LogPageStats(const std::string &name, const void *ptr, std::size_t size);
+
+} // namespace osrm::util
+
+#endif // OSRM_UTIL_HUGE_PAGES_HPP
@@ -28,6 +28,11 @@ inline DataMap mmapTarFile(const std::filesystem::path &path,
 
     for (const auto &entry : entries)
     {
+        if (entry.compressed)
+        {
+            throw util::exception(path.string() + " : " + entry.name +
+                                  " is compressed and cannot be memory mapped" + SOURCE_REF);
+        }
         auto begin = raw_file.data() + entry.offset;
         auto end = begin + entry.size;
         map[entry.name] = DataRange{begin, end};
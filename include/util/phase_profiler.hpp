@@ -0,0 +1,122 @@
+#ifndef OSRM_UTIL_PHASE_PROFILER_HPP
+#define OSRM_UTIL_PHASE_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osrm::util
+{
+
+// Resource usage of a phase of a tool. CPU time, memory and I/O are counted for the whole
+// process, including all worker threads.
+struct PhaseRecord
+{
+    // names of the enclosing phases and of the phase itself, separated by '/'
+    std::string name;
+    std::size_t depth = 0;
+    // number of threads the phase was allowed to use
+    unsigned threads = 1;
+    double wall_seconds = 0;
+    double cpu_seconds = 0;
+    // peak resident memory of the process at the end of the phase and its growth in the phase
+    std::size_t peak_rss_bytes = 0;
+    std::size_t peak_rss_delta_bytes = 0;
+    std::uint64_t blocks_read = 0;
+    std::uint64_t blocks_written = 0;
+    std::uint64_t major_page_faults = 0;
+
+    // Share of the available threads that were busy: close to 1 for phases that keep all threads
+    // busy, low for serial or I/O-bound phases.
+    double ThreadUtilisation() const
+    {
+        return wall_seconds > 0 ? cpu_seconds / (wall_seconds * threads) : 0;
+    }
+};
+
+/**
+ * Collects the wall time, CPU time, peak memory and I/O of the phases of the preprocessing tools.
+ * The tools enable it on request and write the phases as JSON once they are done, the phases are
+ * marked with PhaseTimer in the library code. Nothing is recorded while the profiler is disabled.
+ *
+ * Phases nest like scopes and are started and stopped from the thread that drives the tool.
+ */
+class PhaseProfiler
+{
+  public:
+    static PhaseProfiler &GetInstance();
+
+    PhaseProfiler(const PhaseProfiler &) = delete;
+    PhaseProfiler &operator=(const PhaseProfiler &) = delete;
+
+    void Enable();
+    void Disable();
+    bool IsEnabled() const;
+    // Removes all recorded phases
+    void Clear();
+
+    // The finished phases in the order they started
+    std::vector<PhaseRecord> GetPhases() const;
+
+    // Writes the phases with the name of the tool and the peak memory of the process
+    void WriteJSON(const std::filesystem::path &path, const std::string &tool) const;
+
+  private:
+    friend class PhaseTimer;
+
+    static constexpr std::size_t INVALID_PHASE = std::numeric_limits<std::size_t>::max();
+
+    // The usage at the start of a phase, the record holds the name until the phase ends
+    struct OpenPhase
+    {
+        std::size_t record;
+        std::chrono::steady_clock::time_point wall_start;
+        double cpu_start;
+        std::size_t peak_rss_start;
+        std::uint64_t blocks_read_start;
+        std::uint64_t blocks_written_start;
+        std::uint64_t major_page_faults_start;
+    };
+
+    PhaseProfiler() = default;
+
+    // Returns the index of the record of the phase
+    std::size_t Start(const std::string &name);
+    void Stop(const std::size_t record);
+
+    mutable std::mutex mutex;
+    bool enabled = false;
+    std::vector<PhaseRecord> records;
+    // the phases that have not been stopped yet, innermost last
+    std::vector<OpenPhase> open_phases;
+};
+
+/**
+ * Records a phase from its construction until Stop is called or it goes out of scope:
+ *
+ *   util::PhaseTimer phase("edge expansion");
+ *   ...
+ *   phase.Stop();
+ */
+class PhaseTimer
+{
+  public:
+    explicit PhaseTimer(const std::string &name);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    void Stop();
+
+  private:
+    std::size_t record;
+};
+} // namespace osrm::util
+
+#endif // OSRM_UTIL_PHASE_PROFILER_HPP
@@ -27,12 +27,15 @@ function setup()
       use_turn_restrictions         = false,
       continue_straight_at_waypoint = false,
       mode_change_penalty           = 30,
+      memoize_way_function          = true,
     },
 
     default_mode              = mode.cycling,
     default_speed             = default_speed,
     walking_speed             = walking_speed,
     oneway_handling           = true,
+    -- use the C++ version of the classes way handler
+    use_native_way_handlers   = true,
     turn_penalty              = 6,
     turn_bias                 = 1.4,
     use_public_transport      = true,
@@ -713,6 +716,9 @@ function process_way(profile, way, result)
     implied_oneway = false
   }
 
+  -- the native handlers are faster and give the same results as their Lua counterparts
+  local native = profile.use_native_way_handlers and native_way_handlers or WayHandlers
+
   local handlers = Sequence {
     -- set the default mode for this profile. if can be changed later
     -- in case it turns we're e.g. on a ferry
@@ -749,7 +755,7 @@ function process_way(profile, way, result)
     WayHandlers.names,
 
     -- set classes
-    WayHandlers.classes,
+    native.classes,
 
     -- set weight properties of the way
     WayHandlers.weights
@@ -28,11 +28,14 @@ function setup()
       continue_straight_at_waypoint  = true,
       use_turn_restrictions          = true,
       left_hand_driving              = false,
+      memoize_way_function           = true,
     },
 
     default_mode              = mode.driving,
     default_speed             = 10,
     oneway_handling           = true,
+    -- use the C++ versions of the access, oneway, speed and classes way handlers
+    use_native_way_handlers   = true,
     side_road_multiplier      = 0.8,
     turn_penalty              = 7.5,
     speed_reduction           = 0.8,
@@ -458,6 +461,9 @@ function process_way(profile, way, result, relations)
     return
   end
 
+  -- the native handlers are faster and give the same results as their Lua counterparts
+  local native = profile.use_native_way_handlers and native_way_handlers or WayHandlers
+
   handlers = Sequence {
     -- set the default mode for this profile. if can be changed later
     -- in case it turns we're e.g. on a ferry
@@ -475,10 +481,10 @@ function process_way(profile, way, result, relations)
 
     -- determine access status by checking our hierarchy of
     -- access tags, e.g: motorcar, motor_vehicle, vehicle
-    WayHandlers.access,
+    native.access,
 
     -- check whether forward/backward directions are routable
-    WayHandlers.oneway,
+    native.oneway,
 
     -- check a road's destination
     WayHandlers.destinations,
@@ -494,7 +500,7 @@ function process_way(profile, way, result, relations)
     WayHandlers.hov,
 
     -- compute speed taking into account way type, maxspeed tags, etc.
-    WayHandlers.speed,
+    native.speed,
     WayHandlers.maxspeed,
     WayHandlers.surface,
 
@@ -504,7 +510,7 @@ function process_way(profile, way, result, relations)
     WayHandlers.penalties,
 
     -- compute class labels
-    WayHandlers.classes,
+    native.classes,
 
     -- handle turn lanes and road classification, used for guidance
     WayHandlers.turn_lanes,
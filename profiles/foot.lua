@@ -20,11 +20,13 @@ function setup()
       use_turn_restrictions         = false,
       -- preserve short road crossings for pedestrian safety analysis
       max_collapse_distance         = 10,
+      memoize_way_function          = true,
     },
 
     default_mode            = mode.walking,
     default_speed           = walking_speed,
     oneway_handling         = 'specific',     -- respect 'oneway:foot' but not 'oneway'
+    use_native_way_handlers = true,           -- C++ versions of access, oneway and speed
 
     barrier_blacklist = Set {
       'yes',
@@ -236,6 +238,9 @@ function process_way(profile, way, result)
     return
   end
 
+  -- the native handlers are faster and give the same results as their Lua counterparts
+  local native = profile.use_native_way_handlers and native_way_handlers or WayHandlers
+
   local handlers = Sequence {
     -- set the default mode for this profile. if can be changed later
     -- in case it turns we're e.g. on a ferry
@@ -248,14 +253,14 @@ function process_way(profile, way, result)
 
     -- determine access status by checking our hierarchy of
     -- access tags, e.g: motorcar, motor_vehicle, vehicle
-    WayHandlers.access,
+    native.access,
 
     -- block ways whose sidewalk is separately mapped (sidewalk:*=separate),
     -- unless foot access is explicitly whitelisted
     handle_sidewalk_separate,
 
     -- check whether forward/backward directons are routable
-    WayHandlers.oneway,
+    native.oneway,
 
     -- check whether forward/backward directons are routable
     WayHandlers.destinations,
@@ -265,7 +270,7 @@ function process_way(profile, way, result)
     WayHandlers.movables,
 
     -- compute speed taking into account way type, maxspeed tags, etc.
-    WayHandlers.speed,
+    native.speed,
     WayHandlers.surface,
 
     -- handle conveying tag on escalators and moving walkways
@@ -62,6 +62,10 @@ function run_benchmarks_for_folder {
     $BENCHMARKS_FOLDER/route-bench "$FOLDER/test/data/mld/monaco.osrm" mld > "$RESULTS_FOLDER/route_mld.bench"
     echo "Running route-bench CH"
     $BENCHMARKS_FOLDER/route-bench "$FOLDER/test/data/ch/monaco.osrm" ch > "$RESULTS_FOLDER/route_ch.bench"
+    echo "Running contract-bench"
+    $BENCHMARKS_FOLDER/contract-bench "$FOLDER/test/data/ch/monaco.osrm" > "$RESULTS_FOLDER/contract.bench"
+    echo "Running guidance-bench"
+    $BENCHMARKS_FOLDER/guidance-bench "$FOLDER/test/data/monaco.osm.pbf" "$FOLDER/profiles/car.lua" > "$RESULTS_FOLDER/guidance.bench"
     echo "Running alias"
     $BENCHMARKS_FOLDER/alias-bench > "$RESULTS_FOLDER/alias.bench"
     echo "Running json-render-bench"
@@ -0,0 +1,70 @@
+#include "contractor/contractor_graph.hpp"
+#include "contractor/graph_contractor.hpp"
+#include "contractor/graph_contractor_adaptors.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+#include "extractor/files.hpp"
+
+#include "updater/updater.hpp"
+
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+// Contracts the edge-based graph of a dataset, e.g. test/data/ch/monaco.osrm, and reports the
+// fastest of a few runs together with the size of the hierarchy. The size shows whether a
+// faster contraction was bought with a worse node order.
+int main(int argc, const char *argv[])
+try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <base.osrm> [iterations]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string base = argv[1];
+    const int iterations = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    updater::UpdaterConfig updater_config;
+    updater_config.UseDefaultOutputNames(base);
+    std::vector<EdgeWeight> node_weights;
+    extractor::files::readEdgeBasedNodeWeights(base + ".osrm.enw", node_weights);
+    std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+    std::uint32_t connectivity_checksum;
+    const auto number_of_nodes = updater::Updater(updater_config)
+                                     .LoadAndUpdateEdgeExpandedGraph(
+                                         edge_based_edge_list, node_weights, connectivity_checksum);
+
+    double fastest_ms = std::numeric_limits<double>::max();
+    std::size_t number_of_edges = 0;
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        auto graph = contractor::toContractorGraph(number_of_nodes, edge_based_edge_list);
+        TIMER_START(contraction);
+        contractor::contractGraph(graph);
+        TIMER_STOP(contraction);
+        fastest_ms = std::min(fastest_ms, TIMER_MSEC(contraction));
+        number_of_edges = graph.GetNumberOfEdges();
+    }
+
+    std::cout << "contraction of " << number_of_nodes << " nodes" << std::endl;
+    std::cout << fastest_ms << "ms" << std::endl;
+    std::cout << number_of_edges << " edges" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "Error: " << e.what();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+#include "customizer/cell_customizer.hpp"
+
+#include "partitioner/cell_microcode.hpp"
+#include "partitioner/cell_storage.hpp"
+#include "partitioner/edge_based_graph_reader.hpp"
+#include "partitioner/files.hpp"
+#include "partitioner/multi_level_partition.hpp"
+
+#include "updater/updater.hpp"
+
+#include "util/exception.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+// Customizes all cells of a partitioned dataset once by Dijkstra search and once with the
+// microcode programs of osrm-partition --microcode-max-cell-size, and compares the results.
+int main(int argc, const char *argv[])
+try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <base.osrm>\n";
+        return EXIT_FAILURE;
+    }
+    const std::string base = argv[1];
+
+    partitioner::MultiLevelPartition mlp;
+    partitioner::files::readPartition(base + ".osrm.partition", mlp);
+    partitioner::CellStorage storage;
+    partitioner::files::readCells(base + ".osrm.cells", storage);
+
+    // the graph osrm-customize works on, without traffic updates
+    updater::UpdaterConfig updater_config;
+    updater_config.UseDefaultOutputNames(base);
+    std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
+    std::vector<EdgeWeight> node_weights;
+    std::vector<EdgeDuration> node_durations;
+    std::uint32_t connectivity_checksum;
+    const auto num_nodes = updater::Updater(updater_config)
+                               .LoadAndUpdateEdgeExpandedGraph(edge_based_edge_list,
+                                                               node_weights,
+                                                               node_durations,
+                                                               connectivity_checksum);
+    auto directed = partitioner::splitBidirectionalEdges(edge_based_edge_list);
+    auto tidied =
+        partitioner::prepareEdgesForUsageInGraph<partitioner::MultiLevelEdgeBasedGraph::InputEdge>(
+            std::move(directed));
+    const partitioner::MultiLevelEdgeBasedGraph graph(mlp, num_nodes, tidied);
+
+    const std::vector<bool> allowed_nodes(graph.GetNumberOfNodes(), true);
+
+    TIMER_START(search);
+    auto search_metric = storage.MakeMetric();
+    customizer::CellCustomizer{mlp}.Customize(graph, storage, allowed_nodes, search_metric);
+    TIMER_STOP(search);
+    util::Log() << "Dijkstra search: " << TIMER_MSEC(search) << "ms";
+
+    const auto microcode_path = base + ".osrm.cell_microcode";
+    if (!std::filesystem::exists(microcode_path))
+    {
+        util::Log(logWARNING) << "No " << microcode_path
+                              << ", run osrm-partition with --microcode-max-cell-size";
+        return EXIT_SUCCESS;
+    }
+    partitioner::CellMicrocode microcode;
+    partitioner::files::readCellMicrocode(microcode_path, microcode);
+    for (std::size_t level = 1; level < mlp.GetNumberOfLevels(); ++level)
+    {
+        util::Log() << "Level " << level << ": " << microcode.GetNumberOfPrograms(level) << " of "
+                    << mlp.GetNumberOfCells(level) << " cells have a microcode program";
+    }
+
+    TIMER_START(evaluate);
+    auto microcode_metric = storage.MakeMetric();
+    customizer::CellCustomizer{mlp, microcode}.Customize(
+        graph, storage, allowed_nodes, microcode_metric);
+    TIMER_STOP(evaluate);
+    util::Log() << "Microcode: " << TIMER_MSEC(evaluate) << "ms";
+
+    std::size_t weight_mismatches = 0;
+    std::size_t duration_mismatches = 0;
+    std::size_t distance_mismatches = 0;
+    for (std::size_t index = 0; index < search_metric.weights.size(); ++index)
+    {
+        weight_mismatches += search_metric.weights[index] != microcode_metric.weights[index];
+        duration_mismatches += search_metric.durations[index] != microcode_metric.durations[index];
+        distance_mismatches += search_metric.distances[index] != microcode_metric.distances[index];
+    }
+    util::Log() << "Mismatches of " << search_metric.weights.size()
+                << " entries: " << weight_mismatches << " weights, " << duration_mismatches
+                << " durations, " << distance_mismatches << " distances";
+
+    return weight_mismatches + duration_mismatches + distance_mismatches == 0 ? EXIT_SUCCESS
+                                                                              : EXIT_FAILURE;
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "Error: " << e.what();
+    return EXIT_FAILURE;
+}
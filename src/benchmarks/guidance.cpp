@@ -0,0 +1,85 @@
+#include "extractor/extractor_config.hpp"
+
+#include "util/log.hpp"
+#include "util/phase_profiler.hpp"
+
+#include "osrm/extractor.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+
+using namespace osrm;
+
+const constexpr char ANNOTATION_PHASE[] = "extract/guidance/annotation";
+
+// Extracts a fixed dataset, e.g. test/data/monaco.osm.pbf, a few times and reports the fastest
+// guidance turn annotation. The whole extraction runs, but only the annotation is timed, through
+// the phases of the phase profiler.
+int main(int argc, const char *argv[])
+try
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <input.osm.pbf> <profile.lua> [iterations] [threads]\n";
+        return EXIT_FAILURE;
+    }
+    const int iterations = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    const auto output_directory = std::filesystem::temp_directory_path() / "osrm-guidance-bench";
+    std::filesystem::create_directories(output_directory);
+
+    extractor::ExtractorConfig config;
+    config.input_path = argv[1];
+    config.profile_path = argv[2];
+    config.requested_num_threads =
+        argc > 4 ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+    config.UseDefaultOutputNames(output_directory / config.input_path.filename());
+
+    util::LogPolicy::GetInstance().SetLevel(logWARNING);
+    auto &profiler = util::PhaseProfiler::GetInstance();
+    profiler.Enable();
+
+    util::PhaseRecord fastest;
+    fastest.wall_seconds = std::numeric_limits<double>::max();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        profiler.Clear();
+        osrm::extract(config);
+
+        const auto phases = profiler.GetPhases();
+        const auto annotation =
+            std::find_if(phases.begin(),
+                         phases.end(),
+                         [](const auto &phase) { return phase.name == ANNOTATION_PHASE; });
+        if (annotation == phases.end())
+        {
+            std::cerr << "No guidance annotation phase was recorded\n";
+            return EXIT_FAILURE;
+        }
+        if (annotation->wall_seconds < fastest.wall_seconds)
+        {
+            fastest = *annotation;
+        }
+    }
+
+    std::filesystem::remove_all(output_directory);
+
+    std::cout << "guidance annotation of " << config.input_path.filename().string() << " with "
+              << fastest.threads << " threads" << std::endl;
+    std::cout << 1000 * fastest.wall_seconds << "ms" << std::endl;
+    std::cout << fastest.ThreadUtilisation() << " thread utilisation" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "Error: " << e.what();
+    return EXIT_FAILURE;
+}
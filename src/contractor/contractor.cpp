@@ -1,18 +1,34 @@
 #include "contractor/contractor.hpp"
+#include "contractor/contracted_edge_container.hpp"
+#include "contractor/customizable_hierarchy.hpp"
 #include "contractor/files.hpp"
 #include "contractor/graph_contractor.hpp"
 #include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/metric_recontraction.hpp"
 
+#include "extractor/class_data.hpp"
 #include "extractor/files.hpp"
+#include "extractor/profile_properties.hpp"
+
+#include "partitioner/files.hpp"
+#include "partitioner/multi_level_partition.hpp"
 
 #include "updater/updater.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/exclude_flag.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
 #include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <tbb/global_control.h>
@@ -20,12 +36,189 @@
 namespace osrm::contractor
 {
 
+namespace
+{
+// Reads the hierarchy of the last run if it belongs to the same graph and partition, builds it
+// otherwise
+CustomizableHierarchy loadOrBuildHierarchy(const ContractorConfig &config,
+                                           const NodeID number_of_nodes,
+                                           const std::vector<extractor::EdgeBasedEdge> &edges,
+                                           const std::uint32_t connectivity_checksum)
+{
+    const auto partition_path = config.GetPath(".osrm.partition");
+    if (!std::filesystem::exists(partition_path))
+    {
+        throw util::exception("osrm-contract --cch needs " + partition_path.string() +
+                              ", run osrm-partition first" + SOURCE_REF);
+    }
+    partitioner::MultiLevelPartition partition;
+    partitioner::files::readPartition(partition_path, partition);
+
+    const auto hierarchy_path = config.GetOutputPath(".osrm.cch");
+    if (std::filesystem::exists(hierarchy_path))
+    {
+        CustomizableHierarchy hierarchy;
+        std::uint32_t hierarchy_checksum = 0;
+        files::readCustomizableHierarchy(hierarchy_path, hierarchy, hierarchy_checksum);
+        if (hierarchy_checksum == connectivity_checksum &&
+            hierarchy.GetNumberOfNodes() == number_of_nodes &&
+            hierarchy.GetPartitionChecksum() == getPartitionChecksum(partition, number_of_nodes))
+        {
+            util::Log() << "Reusing the customizable contraction hierarchy of "
+                        << hierarchy_path.string();
+            return hierarchy;
+        }
+        util::Log(logWARNING) << hierarchy_path.string()
+                              << " does not match the graph or partition, rebuilding it";
+    }
+
+    TIMER_START(build_hierarchy);
+    util::PhaseTimer build_hierarchy_phase("building hierarchy");
+    CustomizableHierarchy hierarchy(partition, number_of_nodes, edges);
+    files::writeCustomizableHierarchy(hierarchy_path, hierarchy, connectivity_checksum);
+    build_hierarchy_phase.Stop();
+    TIMER_STOP(build_hierarchy);
+    util::Log() << "Building the customizable contraction hierarchy took "
+                << TIMER_SEC(build_hierarchy) << " sec";
+
+    return hierarchy;
+}
+
+GraphAndFilter customizeExcludableHierarchy(const CustomizableHierarchy &hierarchy,
+                                            const std::vector<extractor::EdgeBasedEdge> &edges,
+                                            const std::vector<std::vector<bool>> &filters)
+{
+    ContractedEdgeContainer edge_container;
+    for (const auto &filter : filters)
+    {
+        edge_container.Merge(hierarchy.Customize(edges, filter));
+    }
+
+    return GraphAndFilter{QueryGraph{hierarchy.GetNumberOfNodes(), edge_container.edges},
+                          edge_container.MakeEdgeFilters()};
+}
+
+// Reads the contracted graph of the last run if it belongs to the same graph and exclude classes
+std::optional<ContractedMetric> loadPreviousHierarchy(const ContractorConfig &config,
+                                                      const std::string &metric_name,
+                                                      const NodeID number_of_nodes,
+                                                      const std::size_t number_of_filters,
+                                                      const std::uint32_t connectivity_checksum)
+{
+    const auto graph_path = config.GetOutputPath(".osrm.hsgr");
+    if (!std::filesystem::exists(graph_path))
+    {
+        util::Log(logWARNING) << "--metric-only needs the " << graph_path.string()
+                              << " of a previous run, contracting the graph";
+        return std::nullopt;
+    }
+
+    std::unordered_map<std::string, ContractedMetric> metrics = {{metric_name, {}}};
+    std::uint32_t graph_checksum = 0;
+    files::readGraph(graph_path, metrics, graph_checksum);
+    auto &metric = metrics[metric_name];
+    if (graph_checksum != connectivity_checksum ||
+        metric.graph.GetNumberOfNodes() != number_of_nodes ||
+        metric.edge_filter.size() != number_of_filters)
+    {
+        util::Log(logWARNING) << graph_path.string()
+                              << " does not match the graph, contracting the graph";
+        return std::nullopt;
+    }
+
+    return std::move(metric);
+}
+
+GraphAndFilter recontractExcludableGraph(const ContractedMetric &previous,
+                                         const std::vector<extractor::EdgeBasedEdge> &edges,
+                                         const std::vector<std::vector<bool>> &filters,
+                                         const bool repair_witnesses)
+{
+    ContractedEdgeContainer edge_container;
+    for (const auto index : util::irange<std::size_t>(0, filters.size()))
+    {
+        TIMER_START(recontraction);
+        RecontractionStatistics statistics;
+        edge_container.Merge(recontractMetric(previous.graph,
+                                              previous.edge_filter[index],
+                                              edges,
+                                              filters[index],
+                                              repair_witnesses,
+                                              statistics));
+        TIMER_STOP(recontraction);
+        util::Log() << "Exclude class " << index << ": recomputed " << statistics.reused_arcs
+                    << " arcs and " << statistics.inserted_edges << " new edges in "
+                    << TIMER_SEC(recontraction) << " sec";
+        if (repair_witnesses)
+        {
+            util::Log() << "Exclude class " << index << ": " << statistics.witness_searches
+                        << " witness searches added " << statistics.repaired_shortcuts
+                        << " shortcuts";
+        }
+    }
+
+    return GraphAndFilter{QueryGraph{previous.graph.GetNumberOfNodes(), edge_container.edges},
+                          edge_container.MakeEdgeFilters()};
+}
+
+// Names of the classes excluded by every filter, in the order of the filters
+std::vector<std::string> getExcludeClassNames(const extractor::ProfileProperties &properties)
+{
+    std::vector<std::string> names;
+    for (const auto mask : properties.excludable_classes)
+    {
+        if (mask == extractor::INVALID_CLASS_DATA)
+            continue;
+
+        std::string name;
+        for (const auto index : util::irange<std::size_t>(0, properties.class_names.size()))
+        {
+            if (mask & extractor::getClassData(index))
+                name += (name.empty() ? "" : ",") + properties.GetClassNameForIndex(index);
+        }
+        names.push_back(name.empty() ? "none" : name);
+    }
+    return names;
+}
+
+void logExcludeClassStatistics(const QueryGraph &query_graph,
+                               const std::vector<std::vector<bool>> &edge_filters,
+                               const std::vector<std::string> &class_names,
+                               const std::vector<ExcludeClassStatistics> &statistics)
+{
+    for (const auto index : util::irange<std::size_t>(0, edge_filters.size()))
+    {
+        std::size_t number_of_edges = 0;
+        std::size_t number_of_shortcuts = 0;
+        for (const auto edge : util::irange<EdgeID>(0, query_graph.GetNumberOfEdges()))
+        {
+            if (!edge_filters[index][edge])
+                continue;
+            ++number_of_edges;
+            number_of_shortcuts += query_graph.GetEdgeData(edge).shortcut;
+        }
+
+        util::Log log;
+        log << "Exclude " << (index < class_names.size() ? class_names[index] : "?") << ": "
+            << number_of_edges << " edges, " << number_of_shortcuts << " shortcuts";
+        if (index < statistics.size())
+        {
+            log << ", contracted in " << statistics[index].shared_seconds << " sec shared and "
+                << statistics[index].own_seconds << " sec on its own";
+        }
+    }
+}
+} // namespace
+
 int Contractor::Run()
 {
     tbb::global_control gc(tbb::global_control::max_allowed_parallelism,
                            config.requested_num_threads);
 
     TIMER_START(preparing);
+    util::PhaseTimer contract_phase("contract");
+
+    util::PhaseTimer loading_phase("loading graph");
 
     util::Log() << "Reading node weights.";
     std::vector<EdgeWeight> node_weights;
@@ -40,15 +233,18 @@ int Contractor::Run()
     std::uint32_t connectivity_checksum = 0;
     EdgeID number_of_edge_based_nodes = updater.LoadAndUpdateEdgeExpandedGraph(
         edge_based_edge_list, node_weights, connectivity_checksum);
+    loading_phase.Stop();
 
     // Contracting the edge-expanded graph
 
     TIMER_START(contraction);
+    util::PhaseTimer contraction_phase("contraction");
 
     std::string metric_name;
     // filters on way classes like: 'toll', 'motorway', 'ferry', 'restricted', 'tunnel', ...
     // max. 7 classes can be defined
     std::vector<std::vector<bool>> node_filters;
+    std::vector<std::string> exclude_class_names;
     {
         extractor::EdgeBasedNodeDataContainer node_data;
         extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
@@ -59,20 +255,60 @@ int Contractor::Run()
 
         node_filters =
             util::excludeFlagsToNodeFilter(number_of_edge_based_nodes, node_data, properties);
+        exclude_class_names = getExcludeClassNames(properties);
     }
 
     QueryGraph query_graph;
     std::vector<std::vector<bool>> edge_filters;
-    std::tie(query_graph, edge_filters) = contractExcludableGraph(
-        toContractorGraph(number_of_edge_based_nodes, edge_based_edge_list), node_filters);
+    std::vector<ExcludeClassStatistics> exclude_statistics;
+    std::optional<ContractedMetric> previous_hierarchy;
+    if (config.metric_only)
+    {
+        previous_hierarchy = loadPreviousHierarchy(config,
+                                                   metric_name,
+                                                   number_of_edge_based_nodes,
+                                                   node_filters.size(),
+                                                   connectivity_checksum);
+    }
+
+    if (previous_hierarchy)
+    {
+        std::tie(query_graph, edge_filters) = recontractExcludableGraph(
+            *previous_hierarchy, edge_based_edge_list, node_filters, config.repair_witnesses);
+        previous_hierarchy.reset();
+    }
+    else if (config.cch)
+    {
+        const auto hierarchy = loadOrBuildHierarchy(
+            config, number_of_edge_based_nodes, edge_based_edge_list, connectivity_checksum);
+        TIMER_START(customization);
+        util::PhaseTimer customization_phase("customization");
+        std::tie(query_graph, edge_filters) =
+            customizeExcludableHierarchy(hierarchy, edge_based_edge_list, node_filters);
+        customization_phase.Stop();
+        TIMER_STOP(customization);
+        util::Log() << "Customization took " << TIMER_SEC(customization) << " sec";
+    }
+    else
+    {
+        std::tie(query_graph, edge_filters) = contractExcludableGraph(
+            toContractorGraph(number_of_edge_based_nodes, edge_based_edge_list),
+            node_filters,
+            config.share_exclude_contraction,
+            exclude_statistics);
+    }
+    contraction_phase.Stop();
     TIMER_STOP(contraction);
+    logExcludeClassStatistics(query_graph, edge_filters, exclude_class_names, exclude_statistics);
     util::Log() << "Contracted graph has " << query_graph.GetNumberOfEdges() << " edges.";
     util::Log() << "Contraction took " << TIMER_SEC(contraction) << " sec";
 
     std::unordered_map<std::string, ContractedMetric> metrics = {
         {metric_name, {std::move(query_graph), std::move(edge_filters)}}};
 
+    util::PhaseTimer writing_phase("writing");
     files::writeGraph(config.GetOutputPath(".osrm.hsgr"), metrics, connectivity_checksum);
+    writing_phase.Stop();
 
     TIMER_STOP(preparing);
 
@@ -99,6 +99,13 @@ void search(ContractorHeap &heap,
             }
         }
 
+        // Targets are settled even if they can not be contracted, but a witness must not pass
+        // through them: an exclude filter that removes the target would lose the path.
+        if (!contractible[node])
+        {
+            continue;
+        }
+
         if (relaxNode(heap, graph, contractible, node, node_weight, forbidden_node))
         {
             return;
@@ -0,0 +1,478 @@
+#include "contractor/customizable_hierarchy.hpp"
+#include "contractor/arc_metric.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <utility>
+
+namespace osrm::contractor
+{
+
+namespace
+{
+using detail::ArcMetric;
+using detail::relaxTriangle;
+
+// Orders the nodes of a level 1 cell that have no neighbours outside of it by minimum degree
+// elimination, which keeps the number of shortcuts inside of the cell small.
+// The interior nodes need to be sorted by id.
+std::vector<NodeID> orderByMinimumDegree(const std::vector<NodeID> &interior,
+                                         const std::vector<EdgeID> &first_neighbour,
+                                         const std::vector<NodeID> &neighbours)
+{
+    // neighbourhoods of the interior nodes that are not eliminated yet, by index in `interior`
+    const auto local = [&](const NodeID node)
+    {
+        const auto iter = std::lower_bound(interior.begin(), interior.end(), node);
+        return iter != interior.end() && *iter == node ? std::distance(interior.begin(), iter)
+                                                       : -1;
+    };
+    std::vector<std::vector<NodeID>> adjacency(interior.size());
+    for (const auto index : util::irange<std::size_t>(0, interior.size()))
+    {
+        const auto node = interior[index];
+        adjacency[index].assign(neighbours.begin() + first_neighbour[node],
+                                neighbours.begin() + first_neighbour[node + 1]);
+        adjacency[index].erase(std::unique(adjacency[index].begin(), adjacency[index].end()),
+                               adjacency[index].end());
+    }
+
+    using DegreeAndIndex = std::pair<std::size_t, std::size_t>;
+    std::priority_queue<DegreeAndIndex, std::vector<DegreeAndIndex>, std::greater<>> queue;
+    for (const auto index : util::irange<std::size_t>(0, interior.size()))
+    {
+        queue.emplace(adjacency[index].size(), index);
+    }
+
+    std::vector<bool> eliminated(interior.size(), false);
+    std::vector<NodeID> order;
+    order.reserve(interior.size());
+    std::vector<NodeID> merged;
+    while (!queue.empty())
+    {
+        const auto [degree, index] = queue.top();
+        queue.pop();
+        if (eliminated[index] || degree != adjacency[index].size())
+            continue;
+
+        eliminated[index] = true;
+        const auto node = interior[index];
+        order.push_back(node);
+
+        // connect all remaining neighbours
+        const auto &eliminated_adjacency = adjacency[index];
+        for (const auto neighbour : eliminated_adjacency)
+        {
+            const auto neighbour_index = local(neighbour);
+            if (neighbour_index < 0)
+                continue;
+
+            auto &neighbour_adjacency = adjacency[neighbour_index];
+            merged.clear();
+            std::set_union(neighbour_adjacency.begin(),
+                           neighbour_adjacency.end(),
+                           eliminated_adjacency.begin(),
+                           eliminated_adjacency.end(),
+                           std::back_inserter(merged));
+            merged.erase(std::remove_if(merged.begin(),
+                                        merged.end(),
+                                        [&](const NodeID other)
+                                        { return other == node || other == neighbour; }),
+                         merged.end());
+            neighbour_adjacency.swap(merged);
+            queue.emplace(neighbour_adjacency.size(), neighbour_index);
+        }
+        adjacency[index].clear();
+        adjacency[index].shrink_to_fit();
+    }
+
+    return order;
+}
+} // namespace
+
+std::uint32_t getPartitionChecksum(const partitioner::MultiLevelPartition &partition,
+                                   const NodeID number_of_nodes)
+{
+    std::vector<CellID> cells(number_of_nodes);
+    uLong checksum = crc32(0L, Z_NULL, 0);
+    for (const auto level : util::irange<LevelID>(1, partition.GetNumberOfLevels()))
+    {
+        for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+        {
+            cells[node] = partition.GetCell(level, node);
+        }
+        checksum = crc32(checksum,
+                         reinterpret_cast<const Bytef *>(cells.data()),
+                         cells.size() * sizeof(CellID));
+    }
+    return checksum;
+}
+
+CustomizableHierarchy::CustomizableHierarchy(const partitioner::MultiLevelPartition &partition,
+                                             const NodeID number_of_nodes,
+                                             const std::vector<extractor::EdgeBasedEdge> &edges)
+    : partition_checksum(getPartitionChecksum(partition, number_of_nodes))
+{
+    const LevelID number_of_levels = partition.GetNumberOfLevels();
+
+    // undirected neighbourhoods without loops and parallel edges
+    std::vector<EdgeID> first_neighbour(number_of_nodes + 1, 0);
+    for (const auto &edge : edges)
+    {
+        if (edge.source != edge.target)
+        {
+            ++first_neighbour[edge.source + 1];
+            ++first_neighbour[edge.target + 1];
+        }
+    }
+    std::partial_sum(first_neighbour.begin(), first_neighbour.end(), first_neighbour.begin());
+    std::vector<NodeID> neighbours(first_neighbour.back());
+    {
+        auto offsets = first_neighbour;
+        for (const auto &edge : edges)
+        {
+            if (edge.source != edge.target)
+            {
+                neighbours[offsets[edge.source]++] = edge.target;
+                neighbours[offsets[edge.target]++] = edge.source;
+            }
+        }
+    }
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                      [&](const auto &range)
+                      {
+                          for (auto node = range.begin(); node != range.end(); ++node)
+                          {
+                              std::sort(neighbours.begin() + first_neighbour[node],
+                                        neighbours.begin() + first_neighbour[node + 1]);
+                          }
+                      });
+
+    // A node that is on the boundary of its cell on level l separates the cells of level l
+    // inside of its level l + 1 cell, so it is contracted after all nodes of these cells.
+    std::vector<LevelID> boundary_levels(number_of_nodes, 0);
+    for (const auto &edge : edges)
+    {
+        const auto level = partition.GetHighestDifferentLevel(edge.source, edge.target);
+        boundary_levels[edge.source] = std::max(boundary_levels[edge.source], level);
+        boundary_levels[edge.target] = std::max(boundary_levels[edge.target], level);
+    }
+    const auto separated_cell = [&](const NodeID node)
+    {
+        const LevelID level = boundary_levels[node] + 1;
+        return level < number_of_levels ? partition.GetCell(level, node) : CellID{0};
+    };
+    const auto inner_cell = [&](const NodeID node)
+    {
+        const LevelID level = boundary_levels[node];
+        return level > 0 ? partition.GetCell(level, node) : CellID{0};
+    };
+
+    nodes.resize(number_of_nodes);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    const auto order_key = [&](const NodeID node)
+    {
+        return std::make_tuple(boundary_levels[node], separated_cell(node), inner_cell(node), node);
+    };
+    std::sort(nodes.begin(),
+              nodes.end(),
+              [&](const NodeID lhs, const NodeID rhs) { return order_key(lhs) < order_key(rhs); });
+
+    // the interior nodes of each level 1 cell are contiguous, order them by minimum degree
+    const auto number_of_interior_nodes = std::distance(
+        nodes.begin(),
+        std::find_if(nodes.begin(),
+                     nodes.end(),
+                     [&](const NodeID node) { return boundary_levels[node] > 0; }));
+    {
+        std::vector<std::size_t> cell_offsets;
+        for (const auto index : util::irange<std::size_t>(0, number_of_interior_nodes))
+        {
+            if (index == 0 || separated_cell(nodes[index]) != separated_cell(nodes[index - 1]))
+                cell_offsets.push_back(index);
+        }
+        cell_offsets.push_back(number_of_interior_nodes);
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cell_offsets.size() - 1),
+                          [&](const auto &range)
+                          {
+                              for (auto cell = range.begin(); cell != range.end(); ++cell)
+                              {
+                                  const auto begin = nodes.begin() + cell_offsets[cell];
+                                  const auto end = nodes.begin() + cell_offsets[cell + 1];
+                                  const std::vector<NodeID> interior(begin, end);
+                                  const auto order =
+                                      orderByMinimumDegree(interior, first_neighbour, neighbours);
+                                  BOOST_ASSERT(order.size() == interior.size());
+                                  std::copy(order.begin(), order.end(), begin);
+                              }
+                          });
+    }
+
+    ranks.resize(number_of_nodes);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        ranks[nodes[rank]] = rank;
+    }
+
+    // Contracting a node connects its higher ranked neighbours. It is enough to add them to the
+    // lowest of them, which passes them on when it is contracted itself.
+    std::vector<std::vector<NodeID>> upward(number_of_nodes);
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                      [&](const auto &range)
+                      {
+                          for (auto rank = range.begin(); rank != range.end(); ++rank)
+                          {
+                              const auto node = nodes[rank];
+                              for (auto index = first_neighbour[node];
+                                   index < first_neighbour[node + 1];
+                                   ++index)
+                              {
+                                  const auto neighbour_rank = ranks[neighbours[index]];
+                                  if (neighbour_rank > rank)
+                                      upward[rank].push_back(neighbour_rank);
+                              }
+                              std::sort(upward[rank].begin(), upward[rank].end());
+                              upward[rank].erase(
+                                  std::unique(upward[rank].begin(), upward[rank].end()),
+                                  upward[rank].end());
+                          }
+                      });
+    neighbours.clear();
+    neighbours.shrink_to_fit();
+
+    // The higher ranked neighbours of a node are all inside of the level l + 1 cell it
+    // separates, so the nodes that separate different cells of the same level are independent.
+    std::vector<NodeID> merged;
+    for (NodeID begin = 0; begin < number_of_nodes;)
+    {
+        const auto level = boundary_levels[nodes[begin]];
+        NodeID end = begin;
+        std::vector<NodeID> group_offsets;
+        while (end < number_of_nodes && boundary_levels[nodes[end]] == level)
+        {
+            if (end == begin || separated_cell(nodes[end]) != separated_cell(nodes[end - 1]))
+                group_offsets.push_back(end);
+            ++end;
+        }
+        group_offsets.push_back(end);
+
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, group_offsets.size() - 1),
+            [&](const auto &range)
+            {
+                std::vector<NodeID> merged;
+                for (auto group = range.begin(); group != range.end(); ++group)
+                {
+                    for (auto rank = group_offsets[group]; rank < group_offsets[group + 1]; ++rank)
+                    {
+                        const auto &arcs = upward[rank];
+                        if (arcs.size() < 2)
+                            continue;
+
+                        auto &parent_arcs = upward[arcs.front()];
+                        merged.clear();
+                        std::set_union(parent_arcs.begin(),
+                                       parent_arcs.end(),
+                                       std::next(arcs.begin()),
+                                       arcs.end(),
+                                       std::back_inserter(merged));
+                        parent_arcs.swap(merged);
+                    }
+                }
+            });
+        begin = end;
+    }
+
+    first_arc.resize(number_of_nodes + 1);
+    first_arc[0] = 0;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        first_arc[rank + 1] = first_arc[rank] + upward[rank].size();
+    }
+    heads.resize(first_arc.back());
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        std::copy(upward[rank].begin(), upward[rank].end(), heads.begin() + first_arc[rank]);
+        upward[rank] = {};
+    }
+
+    // arcs by head, the tails are sorted since they are added in rank order
+    first_lower_arc.assign(number_of_nodes + 1, 0);
+    for (const auto head : heads)
+    {
+        ++first_lower_arc[head + 1];
+    }
+    std::partial_sum(first_lower_arc.begin(), first_lower_arc.end(), first_lower_arc.begin());
+    lower_arcs.resize(heads.size());
+    lower_tails.resize(heads.size());
+    {
+        auto offsets = first_lower_arc;
+        for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        {
+            for (auto arc = first_arc[rank]; arc < first_arc[rank + 1]; ++arc)
+            {
+                const auto offset = offsets[heads[arc]]++;
+                lower_arcs[offset] = arc;
+                lower_tails[offset] = rank;
+            }
+        }
+    }
+
+    // The arcs of a node only depend on the arcs of lower nodes, so all nodes of the same height
+    // in the elimination tree can be customized at the same time.
+    std::vector<std::uint32_t> heights(number_of_nodes, 0);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (auto arc = first_arc[rank]; arc < first_arc[rank + 1]; ++arc)
+        {
+            heights[heads[arc]] = std::max(heights[heads[arc]], heights[rank] + 1);
+        }
+    }
+    const auto height =
+        number_of_nodes > 0 ? *std::max_element(heights.begin(), heights.end()) + 1 : 0;
+    height_offsets.assign(height + 1, 0);
+    for (const auto rank_height : heights)
+    {
+        ++height_offsets[rank_height + 1];
+    }
+    std::partial_sum(height_offsets.begin(), height_offsets.end(), height_offsets.begin());
+    height_ranks.resize(number_of_nodes);
+    {
+        auto offsets = height_offsets;
+        for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        {
+            height_ranks[offsets[heights[rank]]++] = rank;
+        }
+    }
+
+    util::Log() << "Customizable contraction hierarchy has " << heads.size() << " arcs ("
+                << (number_of_nodes > 0 ? static_cast<double>(heads.size()) / number_of_nodes
+                                        : 0.)
+                << " per node) and an elimination tree of height " << height;
+}
+
+EdgeID CustomizableHierarchy::FindArc(const NodeID first_rank, const NodeID second_rank) const
+{
+    const auto [lower, higher] = std::minmax(first_rank, second_rank);
+    const auto begin = heads.begin() + first_arc[lower];
+    const auto end = heads.begin() + first_arc[lower + 1];
+    const auto iter = std::lower_bound(begin, end, higher);
+    if (iter == end || *iter != higher)
+    {
+        throw util::exception("Edge is not part of the customizable contraction hierarchy, "
+                              "delete the .osrm.cch file and re-run osrm-contract --cch" +
+                              SOURCE_REF);
+    }
+    return std::distance(heads.begin(), iter);
+}
+
+std::vector<QueryEdge>
+CustomizableHierarchy::Customize(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                 const std::vector<bool> &node_filter) const
+{
+    const NodeID number_of_nodes = GetNumberOfNodes();
+    BOOST_ASSERT(node_filter.size() == number_of_nodes);
+
+    // metric from the lower to the higher ranked node and back
+    std::vector<ArcMetric> up(heads.size());
+    std::vector<ArcMetric> down(heads.size());
+    std::vector<ArcMetric> loops(number_of_nodes);
+
+    for (const auto &edge : edges)
+    {
+        if (edge.source == edge.target || edge.data.weight == INVALID_EDGE_WEIGHT ||
+            !node_filter[edge.source] || !node_filter[edge.target])
+            continue;
+
+        const auto source_rank = ranks[edge.source];
+        const auto target_rank = ranks[edge.target];
+        const auto arc = FindArc(source_rank, target_rank);
+        const ArcMetric metric{std::max(edge.data.weight, {1}),
+                               to_alias<EdgeDuration>(edge.data.duration),
+                               edge.data.distance,
+                               edge.data.turn_id,
+                               false};
+
+        auto &source_to_target = source_rank < target_rank ? up[arc] : down[arc];
+        auto &target_to_source = source_rank < target_rank ? down[arc] : up[arc];
+        if (edge.data.forward && metric < source_to_target)
+            source_to_target = metric;
+        if (edge.data.backward && metric < target_to_source)
+            target_to_source = metric;
+    }
+
+    for (const auto height : util::irange<std::size_t>(0, GetHeight()))
+    {
+        tbb::parallel_for(
+            tbb::blocked_range<std::uint32_t>(height_offsets[height], height_offsets[height + 1]),
+            [&](const auto &range)
+            {
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    const auto rank = height_ranks[index];
+
+                    // all arcs (lower, rank) are final, relax the triangles they form
+                    for (auto lower_index = first_lower_arc[rank];
+                         lower_index < first_lower_arc[rank + 1];
+                         ++lower_index)
+                    {
+                        const auto lower = lower_tails[lower_index];
+                        const auto lower_arc = lower_arcs[lower_index];
+                        const auto middle = nodes[lower];
+
+                        relaxTriangle(loops[rank], down[lower_arc], up[lower_arc], middle);
+
+                        // the hierarchy is chordal: every higher neighbour of `lower` is a
+                        // neighbour of `rank` as well
+                        auto arc = first_arc[rank];
+                        for (auto other_arc = lower_arc + 1; other_arc < first_arc[lower + 1];
+                             ++other_arc)
+                        {
+                            while (heads[arc] != heads[other_arc])
+                            {
+                                ++arc;
+                                BOOST_ASSERT(arc < first_arc[rank + 1]);
+                            }
+                            relaxTriangle(up[arc], down[lower_arc], up[other_arc], middle);
+                            relaxTriangle(down[arc], down[other_arc], up[lower_arc], middle);
+                        }
+                    }
+                }
+            });
+    }
+
+    // each arc is stored at its lower ranked node, like in a contraction hierarchy
+    std::vector<QueryEdge> query_edges;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        const auto node = nodes[rank];
+        detail::appendQueryEdges(query_edges, node, node, loops[rank], loops[rank]);
+        for (auto arc = first_arc[rank]; arc < first_arc[rank + 1]; ++arc)
+        {
+            detail::appendQueryEdges(query_edges, node, nodes[heads[arc]], up[arc], down[arc]);
+        }
+    }
+
+    tbb::parallel_sort(query_edges.begin(), query_edges.end());
+
+    return query_edges;
+}
+
+} // namespace osrm::contractor
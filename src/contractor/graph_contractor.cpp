@@ -4,6 +4,7 @@
 #include "contractor/contractor_heap.hpp"
 #include "contractor/contractor_search.hpp"
 #include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/metric_recontraction.hpp"
 #include "contractor/query_edge.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
@@ -24,11 +25,14 @@
 #include <oneapi/tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <iomanip>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define SELF_LOOPS
@@ -98,9 +102,10 @@ using CLOCK = std::chrono::high_resolution_clock;
 
 #define TIMER_DECLARE(_X)                                                                          \
     auto _X##_start = CLOCK::now();                                                                \
-    auto _X##_duration = CLOCK::now() - CLOCK::now();
+    auto _X##_duration = CLOCK::duration::zero();
 #define TIMER_START(_X) _X##_start = CLOCK::now()
-#define TIMER_STOP(_X) _X##_duration = (CLOCK::now() - _X##_start)
+// adds up, so the timers of the contraction loop report the total of all rounds
+#define TIMER_STOP(_X) _X##_duration += (CLOCK::now() - _X##_start)
 #define TIMER_MSEC(_X)                                                                             \
     std::fixed << std::setprecision(2)                                                             \
                << (0.000001 *                                                                      \
@@ -120,7 +125,7 @@ struct ContractorNodeData
                        std::vector<bool> uncontracted_nodes_,
                        std::vector<bool> contractible_)
         : is_core(std::move(uncontracted_nodes_)), is_contractible(std::move(contractible_)),
-          priorities(number_of_nodes), depths(number_of_nodes, 0)
+          priorities(number_of_nodes), depths(number_of_nodes, 0), is_outdated(number_of_nodes, 0)
     {
         if (is_contractible.empty())
         {
@@ -137,6 +142,9 @@ struct ContractorNodeData
     std::vector<bool> is_contractible;
     std::vector<NodePriority> priorities;
     std::vector<NodeDepth> depths;
+    /** Set for nodes whose neighbourhood changed since their priority was computed. Not a
+     *  vector<bool>, because PostProcess() writes it in parallel. */
+    std::vector<std::uint8_t> is_outdated;
 };
 
 struct ContractionStats
@@ -395,6 +403,8 @@ float EvaluateNodePriority(const ContractionStats &stats,
  * @brief Post-process an independent node after contraction
  *
  * - Algo 2: Move I to their Level
+ * - Algo 2: Update Priority of Neighbors of I, lazily: the neighbours are only marked as
+ *   outdated, see contractGraph().
  *
  * @param graph
  * @param v
@@ -406,6 +416,7 @@ void PostProcess(ContractorGraph &graph, const NodeID v, ContractorNodeData &nod
     for (const NodeID u : GetNeighbours(graph, v))
     {
         node_data.depths[u] = std::max(depth, node_data.depths[u]);
+        node_data.is_outdated[u] = true;
 
         // "Irrespective of the direction ﬂags, each edge (u, v) is stored only once,
         // namely at the smaller node, which complies with the requirements of both
@@ -497,30 +508,6 @@ void InsertEdges(ContractorGraph &graph,
     }
 }
 
-/**
- * @brief Recalculate the priorities of all neighbouring nodes.
- *
- * @param graph
- * @param v The node id
- * @param data
- * @param node_data
- */
-void UpdateNeighbourPriorities(const ContractorGraph &graph,
-                               const NodeID v,
-                               ContractorNodeData &node_data,
-                               ThreadData &thread_data)
-{
-    for (const NodeID u : GetNeighbours(graph, v))
-    {
-        if (node_data.is_core[u] && node_data.is_contractible[u])
-        {
-            ContractionStats stats;
-            ContractNode<true>(graph, u, thread_data, node_data, nullptr, &stats);
-            node_data.priorities[u] = EvaluateNodePriority(stats, node_data.depths[u]);
-        }
-    }
-}
-
 /**
  * @brief Test if a node is independent.
  *
@@ -533,14 +520,15 @@ void UpdateNeighbourPriorities(const ContractorGraph &graph,
  *
  * @param graph
  * @param v the node to test
+ * @param priority the priority of v, can be newer than the one in priorities
  * @param priorities
  * @return bool true if the node is independent.
  */
 bool IsNodeIndependent(const ContractorGraph &graph,
                        const NodeID v,
+                       const float priority,
                        const std::vector<float> &priorities)
 {
-    const float priority = priorities[v];
     BOOST_ASSERT(priority >= 0);
 
     for (const NodeID hop1 : GetNeighbours(graph, v))
@@ -614,7 +602,6 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
     TIMER_DECLARE(update_core);
     TIMER_DECLARE(adjust_remaining);
     TIMER_DECLARE(renumber);
-    TIMER_DECLARE(compaction);
 
     InsertEdgeStats insert_stats;
 
@@ -675,7 +662,7 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
         if (graph.GetEdgeCapacity() >= edge_list_compaction_threshold)
         {
             const auto slots_before = graph.GetEdgeCapacity();
-            TIMER_START(compaction);
+            TIMER_DECLARE(compaction);
             graph.Renumber(std::vector<NodeID>());
             TIMER_STOP(compaction);
             const auto slots_after = graph.GetEdgeCapacity();
@@ -700,6 +687,11 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
 
         /** List of discovered independent nodes */
         tbb::concurrent_vector<NodeID> independent_nodes;
+        /** Independent nodes with an outdated priority and their new one */
+        tbb::concurrent_vector<std::pair<NodeID, ContractorNodeData::NodePriority>>
+            updated_priorities;
+        /** Independent nodes that are not independent any more with their new priority */
+        std::atomic<std::size_t> number_of_postponed_nodes = 0;
         /** List of new edges to insert into the graph */
         tbb::concurrent_vector<ContractorEdge> inserted_edges;
 
@@ -713,8 +705,25 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
                 // push the discovered independent nodes into
                 // `independent_nodes` and mark them for deletion from
                 // `remaining_nodes`
-                if (IsNodeIndependent(graph, v, node_data.priorities))
+                if (IsNodeIndependent(graph, v, node_data.priorities[v], node_data.priorities))
                 {
+                    // Lazy update: the priority of an outdated node is only simulated once it is
+                    // independent. The node is contracted if it is still independent with its new
+                    // priority. The priority is written after the round, so that all threads
+                    // test against the same priorities.
+                    if (node_data.is_outdated[v])
+                    {
+                        ContractionStats stats;
+                        ContractNode<true>(graph, v, thread_data, node_data, nullptr, &stats);
+                        const auto priority = EvaluateNodePriority(stats, node_data.depths[v]);
+                        updated_priorities.emplace_back(v, priority);
+                        if (!IsNodeIndependent(graph, v, priority, node_data.priorities))
+                        {
+                            ++number_of_postponed_nodes;
+                            return;
+                        }
+                    }
+
                     independent_nodes.emplace_back(v);
 
                     // Algo 2: E ← Necessary Shortcuts
@@ -727,7 +736,15 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
             });
         TIMER_STOP(contract);
 
-        if (independent_nodes.size() == 0)
+        TIMER_START(update_priorities);
+        for (const auto &[v, priority] : updated_priorities)
+        {
+            node_data.priorities[v] = priority;
+            node_data.is_outdated[v] = false;
+        }
+        TIMER_STOP(update_priorities);
+
+        if (independent_nodes.size() == 0 && number_of_postponed_nodes == 0)
             // safety exit
             break;
 
@@ -770,14 +787,26 @@ std::vector<bool> contractGraph(ContractorGraph &graph,
         TIMER_STOP(insert_edges);
 
         // Algo 2: Update Priority of Neighbors of I with Simulated Contractions
+        // Stale priorities let the wrong nodes look independent. Once the postponed nodes are
+        // more than a quarter of the contracted ones, all outdated priorities are simulated
+        // again, as proposed for lazy updates in [Geisberger2008].
         // This again searches the graph, so graph updates cannot happen at the same time.
         TIMER_START(update_priorities);
-        if (remaining_nodes.size() > number_of_core_nodes)
+        if (remaining_nodes.size() > number_of_core_nodes &&
+            4 * number_of_postponed_nodes > independent_nodes.size())
         {
-            tbb::parallel_for_each(
-                independent_nodes,
-                [&](const NodeID v)
-                { UpdateNeighbourPriorities(graph, v, node_data, thread_data); });
+            tbb::parallel_for_each(remaining_nodes,
+                                   [&](const NodeID v)
+                                   {
+                                       if (!node_data.is_outdated[v])
+                                           return;
+                                       ContractionStats stats;
+                                       ContractNode<true>(
+                                           graph, v, thread_data, node_data, nullptr, &stats);
+                                       node_data.priorities[v] =
+                                           EvaluateNodePriority(stats, node_data.depths[v]);
+                                       node_data.is_outdated[v] = false;
+                                   });
         }
         TIMER_STOP(update_priorities);
 
@@ -818,14 +847,36 @@ GraphAndFilter contractFullGraph(ContractorGraph contractor_graph)
     return GraphAndFilter{QueryGraph{num_nodes, edges}, {std::move(edge_filter)}};
 }
 
+namespace
+{
+double secondsSince(const CLOCK::time_point start)
+{
+    return std::chrono::duration<double>(CLOCK::now() - start).count();
+}
+} // namespace
+
 GraphAndFilter contractExcludableGraph(ContractorGraph contractor_graph_,
                                        const std::vector<std::vector<bool>> &filters)
 {
+    std::vector<ExcludeClassStatistics> statistics;
+    return contractExcludableGraph(std::move(contractor_graph_), filters, false, statistics);
+}
+
+GraphAndFilter contractExcludableGraph(ContractorGraph contractor_graph_,
+                                       const std::vector<std::vector<bool>> &filters,
+                                       const bool share_filter_groups,
+                                       std::vector<ExcludeClassStatistics> &statistics)
+{
+    statistics.assign(filters.size(), {});
+    auto start = CLOCK::now();
+
     if (filters.size() == 1)
     {
         if (std::all_of(filters.front().begin(), filters.front().end(), [](auto v) { return v; }))
         {
-            return contractFullGraph(std::move(contractor_graph_));
+            auto graph_and_filter = contractFullGraph(std::move(contractor_graph_));
+            statistics.front().own_seconds = secondsSince(start);
+            return graph_and_filter;
         }
     }
 
@@ -872,14 +923,88 @@ GraphAndFilter contractExcludableGraph(ContractorGraph contractor_graph_,
                                                     { return is_shared_core[node]; });
     }
 
-    for (const auto &filter : filters)
+    const auto shared_seconds = secondsSince(start);
+    for (auto &filter_statistics : statistics)
+        filter_statistics.shared_seconds = shared_seconds;
+
+    // The core is contracted once for the filter that allows the most nodes. All filters that
+    // only allow a subset of its nodes contract the core again in the same order, only adding the
+    // shortcuts of witnesses that run over excluded nodes. Most of their shortcuts are identical
+    // and merged.
+    std::vector<bool> is_derived(filters.size(), false);
+    std::size_t base_index = filters.size();
+    if (share_filter_groups && filters.size() > 1)
+    {
+        std::vector<std::size_t> number_of_allowed(filters.size(), 0);
+        for (const auto filter_index : util::irange<std::size_t>(0, filters.size()))
+        {
+            for (const auto node : util::irange<NodeID>(0, num_nodes))
+            {
+                if (is_shared_core[node] && filters[filter_index][node])
+                    ++number_of_allowed[filter_index];
+            }
+        }
+        base_index = std::distance(
+            number_of_allowed.begin(),
+            std::max_element(number_of_allowed.begin(), number_of_allowed.end()));
+
+        for (const auto filter_index : util::irange<std::size_t>(0, filters.size()))
+        {
+            is_derived[filter_index] = filter_index != base_index;
+            for (const auto node : util::irange<NodeID>(0, num_nodes))
+            {
+                if (is_shared_core[node] && filters[filter_index][node] &&
+                    !filters[base_index][node])
+                    is_derived[filter_index] = false;
+            }
+        }
+    }
+
+    std::vector<QueryEdge> core_edges;
+    std::vector<QueryEdge> base_edges;
+    QueryGraph base_hierarchy;
+    if (base_index < filters.size())
     {
-        auto filtered_core_graph =
-            shared_core_graph.Filter([&filter](const NodeID node) { return filter[node]; });
+        start = CLOCK::now();
+        core_edges = toEdges<QueryEdge>(shared_core_graph);
+        auto base_core_graph = shared_core_graph.Filter(
+            [&filter = filters[base_index]](const NodeID node) { return filter[node]; });
+        contractGraph(base_core_graph, is_shared_core, is_shared_core);
+        base_edges = toEdges<QueryEdge>(std::move(base_core_graph));
+        base_hierarchy = QueryGraph{num_nodes, base_edges};
+        statistics[base_index].own_seconds = secondsSince(start);
+    }
+    const std::vector<bool> base_hierarchy_filter(base_hierarchy.GetNumberOfEdges(), true);
 
-        contractGraph(filtered_core_graph, is_shared_core, is_shared_core);
+    for (const auto filter_index : util::irange<std::size_t>(0, filters.size()))
+    {
+        if (filter_index == base_index)
+        {
+            edge_container.Merge(std::move(base_edges));
+            continue;
+        }
 
-        edge_container.Merge(toEdges<QueryEdge>(std::move(filtered_core_graph)));
+        start = CLOCK::now();
+        if (is_derived[filter_index])
+        {
+            RecontractionStatistics recontraction_statistics;
+            edge_container.Merge(recontractMetric(base_hierarchy,
+                                                  base_hierarchy_filter,
+                                                  core_edges,
+                                                  filters[filter_index],
+                                                  true,
+                                                  recontraction_statistics));
+        }
+        else
+        {
+            auto filtered_core_graph = shared_core_graph.Filter(
+                [&filter = filters[filter_index]](const NodeID node) { return filter[node]; });
+
+            contractGraph(filtered_core_graph, is_shared_core, is_shared_core);
+
+            edge_container.Merge(toEdges<QueryEdge>(std::move(filtered_core_graph)));
+        }
+        statistics[filter_index].own_seconds = secondsSince(start);
     }
 
     return GraphAndFilter{QueryGraph{num_nodes, edge_container.edges},
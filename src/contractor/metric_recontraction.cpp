@@ -0,0 +1,472 @@
+#include "contractor/metric_recontraction.hpp"
+#include "contractor/arc_metric.hpp"
+#include "contractor/contractor_search.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace osrm::contractor
+{
+
+namespace
+{
+using detail::ArcMetric;
+using detail::concatenate;
+using detail::relaxTriangle;
+
+// arc to a higher ranked node
+struct Arc
+{
+    NodeID head;
+    // metric from the lower to the higher ranked node and back
+    ArcMetric up;
+    ArcMetric down;
+};
+
+// arcs of every rank, sorted by the rank of their head
+using UpwardArcs = std::vector<std::vector<Arc>>;
+// ranks of the tails of the arcs to every rank
+using LowerTails = std::vector<std::vector<NodeID>>;
+
+template <typename ArcsT> auto findArc(ArcsT &arcs, const NodeID head) -> decltype(&arcs.front())
+{
+    const auto iter = std::lower_bound(arcs.begin(),
+                                       arcs.end(),
+                                       head,
+                                       [](const Arc &arc, const NodeID head)
+                                       { return arc.head < head; });
+    return iter != arcs.end() && iter->head == head ? &*iter : nullptr;
+}
+
+// Every edge is stored at the node that was contracted first, so any topological order of the
+// edges is a valid contraction order
+std::vector<NodeID> orderHierarchy(const QueryGraph &hierarchy,
+                                   const std::vector<bool> &hierarchy_filter)
+{
+    const NodeID number_of_nodes = hierarchy.GetNumberOfNodes();
+    const auto for_each_head = [&](const NodeID node, auto &&callback)
+    {
+        for (const auto edge : hierarchy.GetAdjacentEdgeRange(node))
+        {
+            const auto target = hierarchy.GetTarget(edge);
+            if (target != node && hierarchy_filter[edge])
+                callback(target);
+        }
+    };
+
+    std::vector<std::uint32_t> number_of_lower(number_of_nodes, 0);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for_each_head(node, [&](const NodeID head) { ++number_of_lower[head]; });
+    }
+
+    std::vector<NodeID> nodes;
+    nodes.reserve(number_of_nodes);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        if (number_of_lower[node] == 0)
+            nodes.push_back(node);
+    }
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        for_each_head(nodes[index],
+                      [&](const NodeID head)
+                      {
+                          if (--number_of_lower[head] == 0)
+                              nodes.push_back(head);
+                      });
+    }
+
+    if (nodes.size() != number_of_nodes)
+    {
+        throw util::exception("The contracted graph has a cycle and can not be reused. Run "
+                              "osrm-contract without --metric-only." +
+                              SOURCE_REF);
+    }
+
+    return nodes;
+}
+
+// Bounded Dijkstra search over the arcs between nodes above a rank
+class WitnessSearch
+{
+  public:
+    WitnessSearch(const UpwardArcs &upward, const LowerTails &lower)
+        : upward(upward), lower(lower), weights(upward.size(), INVALID_EDGE_WEIGHT)
+    {
+    }
+
+    // Finds paths from source (forward) or to source (backward) that are not heavier than limit
+    void Run(const NodeID source, const NodeID bottom, const EdgeWeight limit, const bool forward)
+    {
+        for (const auto node : reached)
+            weights[node] = INVALID_EDGE_WEIGHT;
+        reached.clear();
+
+        using HeapEntry = std::pair<EdgeWeight, NodeID>;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+        const auto relax = [&](const NodeID node, const EdgeWeight weight)
+        {
+            if (weight > limit || weight >= weights[node])
+                return;
+            if (weights[node] == INVALID_EDGE_WEIGHT)
+                reached.push_back(node);
+            weights[node] = weight;
+            heap.emplace(weight, node);
+        };
+
+        relax(source, {0});
+        std::size_t settled = 0;
+        while (!heap.empty() && settled < FULL_SEARCH_SPACE_SIZE)
+        {
+            const auto [weight, node] = heap.top();
+            heap.pop();
+            if (weight > weights[node])
+                continue;
+            ++settled;
+
+            for (const auto &arc : upward[node])
+            {
+                const auto &metric = forward ? arc.up : arc.down;
+                if (metric.IsValid())
+                    relax(arc.head, weight + metric.weight);
+            }
+            for (const auto tail : lower[node])
+            {
+                if (tail <= bottom)
+                    continue;
+                const auto *arc = findArc(upward[tail], node);
+                BOOST_ASSERT(arc);
+                const auto &metric = forward ? arc->down : arc->up;
+                if (metric.IsValid())
+                    relax(tail, weight + metric.weight);
+            }
+        }
+    }
+
+    // Weight of a path that was found, not necessarily the shortest one
+    EdgeWeight GetWeight(const NodeID node) const { return weights[node]; }
+
+  private:
+    const UpwardArcs &upward;
+    const LowerTails &lower;
+    std::vector<EdgeWeight> weights;
+    std::vector<NodeID> reached;
+};
+
+// Relaxes all triangles of the arcs in parallel, nodes of the same height depend on lower
+// nodes only
+void customizeArcs(UpwardArcs &upward,
+                   std::vector<ArcMetric> &loops,
+                   const LowerTails &lower,
+                   const std::vector<NodeID> &nodes)
+{
+    const NodeID number_of_nodes = upward.size();
+
+    std::vector<std::uint32_t> heights(number_of_nodes, 0);
+    std::uint32_t max_height = 0;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        max_height = std::max(max_height, heights[rank]);
+        for (const auto &arc : upward[rank])
+            heights[arc.head] = std::max(heights[arc.head], heights[rank] + 1);
+    }
+    std::vector<std::vector<NodeID>> height_ranks(max_height + 1);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        height_ranks[heights[rank]].push_back(rank);
+
+    for (const auto &ranks : height_ranks)
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, ranks.size()),
+                          [&](const auto &range)
+                          {
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  const auto rank = ranks[index];
+                                  auto &arcs = upward[rank];
+                                  for (const auto tail : lower[rank])
+                                  {
+                                      const auto &tail_arcs = upward[tail];
+                                      const auto *lower_arc = findArc(tail_arcs, rank);
+                                      BOOST_ASSERT(lower_arc);
+                                      const auto middle = nodes[tail];
+
+                                      relaxTriangle(
+                                          loops[rank], lower_arc->down, lower_arc->up, middle);
+
+                                      // unlike in a chordal hierarchy some of the higher
+                                      // neighbours of `tail` are no neighbours of `rank`
+                                      auto arc = arcs.begin();
+                                      for (const auto *other_arc = lower_arc + 1;
+                                           other_arc != tail_arcs.data() + tail_arcs.size();
+                                           ++other_arc)
+                                      {
+                                          while (arc != arcs.end() && arc->head < other_arc->head)
+                                              ++arc;
+                                          if (arc == arcs.end())
+                                              break;
+                                          if (arc->head != other_arc->head)
+                                              continue;
+                                          relaxTriangle(
+                                              arc->up, lower_arc->down, other_arc->up, middle);
+                                          relaxTriangle(
+                                              arc->down, other_arc->down, lower_arc->up, middle);
+                                      }
+                                  }
+                              }
+                          });
+    }
+}
+
+// Contracts the nodes in rank order and adds a shortcut for every pair of neighbours that has
+// no witness path anymore
+void repairArcs(UpwardArcs &upward,
+                std::vector<ArcMetric> &loops,
+                LowerTails &lower,
+                const std::vector<NodeID> &nodes,
+                RecontractionStatistics &statistics)
+{
+    const NodeID number_of_nodes = upward.size();
+    WitnessSearch search(upward, lower);
+    std::vector<std::pair<NodeID, ArcMetric>> missing;
+
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        // only arcs of higher ranks change from here on
+        const auto &arcs = upward[rank];
+        const auto middle = nodes[rank];
+
+        for (const auto index : util::irange<std::size_t>(0, arcs.size()))
+        {
+            const auto tail = arcs[index].head;
+            relaxTriangle(loops[tail], arcs[index].down, arcs[index].up, middle);
+
+            for (const bool forward : {true, false})
+            {
+                missing.clear();
+                EdgeWeight limit{0};
+                for (const auto other : util::irange<std::size_t>(index + 1, arcs.size()))
+                {
+                    const auto path =
+                        forward ? concatenate(arcs[index].down, arcs[other].up, middle)
+                                : concatenate(arcs[other].down, arcs[index].up, middle);
+                    if (!path.IsValid())
+                        continue;
+
+                    if (auto *arc = findArc(upward[tail], arcs[other].head))
+                    {
+                        auto &metric = forward ? arc->up : arc->down;
+                        if (path < metric)
+                            metric = path;
+                        continue;
+                    }
+                    missing.emplace_back(arcs[other].head, path);
+                    limit = std::max(limit, path.weight);
+                }
+                if (missing.empty())
+                    continue;
+
+                search.Run(tail, rank, limit, forward);
+                ++statistics.witness_searches;
+                for (const auto &[head, path] : missing)
+                {
+                    if (search.GetWeight(head) <= path.weight)
+                        continue;
+
+                    auto *arc = findArc(upward[tail], head);
+                    if (!arc)
+                    {
+                        auto &tail_arcs = upward[tail];
+                        const auto position =
+                            std::find_if(tail_arcs.begin(),
+                                         tail_arcs.end(),
+                                         [head = head](const Arc &arc) { return arc.head > head; });
+                        arc = &*tail_arcs.insert(position, Arc{head, {}, {}});
+                        lower[head].push_back(tail);
+                        ++statistics.repaired_shortcuts;
+                    }
+                    (forward ? arc->up : arc->down) = path;
+                }
+            }
+        }
+    }
+}
+
+bool isShortcut(const extractor::EdgeBasedEdge &) { return false; }
+bool isShortcut(const QueryEdge &edge) { return edge.data.shortcut; }
+
+template <typename EdgeT>
+std::vector<QueryEdge> recontract(const QueryGraph &hierarchy,
+                                  const std::vector<bool> &hierarchy_filter,
+                                  const std::vector<EdgeT> &edges,
+                                  const std::vector<bool> &node_filter,
+                                  const bool repair_witnesses,
+                                  RecontractionStatistics &statistics)
+{
+    const NodeID number_of_nodes = hierarchy.GetNumberOfNodes();
+    BOOST_ASSERT(node_filter.size() == number_of_nodes);
+
+    const auto nodes = orderHierarchy(hierarchy, hierarchy_filter);
+    std::vector<NodeID> ranks(number_of_nodes);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+        ranks[nodes[rank]] = rank;
+
+    // the metric of the previous hierarchy is dropped, only its arcs are kept
+    UpwardArcs upward(number_of_nodes);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (const auto edge : hierarchy.GetAdjacentEdgeRange(node))
+        {
+            const auto target = hierarchy.GetTarget(edge);
+            if (target != node && hierarchy_filter[edge])
+                upward[ranks[node]].push_back(Arc{ranks[target], {}, {}});
+        }
+    }
+    const auto sort_arcs = [&]
+    {
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                          [&](const auto &range)
+                          {
+                              for (auto rank = range.begin(); rank != range.end(); ++rank)
+                              {
+                                  auto &arcs = upward[rank];
+                                  const auto by_head = [](const Arc &lhs, const Arc &rhs)
+                                  { return lhs.head < rhs.head; };
+                                  std::sort(arcs.begin(), arcs.end(), by_head);
+                                  arcs.erase(std::unique(arcs.begin(),
+                                                         arcs.end(),
+                                                         [](const Arc &lhs, const Arc &rhs)
+                                                         { return lhs.head == rhs.head; }),
+                                             arcs.end());
+                              }
+                          });
+    };
+    sort_arcs();
+    for (const auto &arcs : upward)
+        statistics.reused_arcs += arcs.size();
+
+    const auto is_used = [&](const EdgeT &edge)
+    {
+        return edge.source != edge.target && edge.data.weight != INVALID_EDGE_WEIGHT &&
+               node_filter[edge.source] && node_filter[edge.target];
+    };
+
+    // edges that are not part of the previous hierarchy (e.g. they were closed) are inserted
+    // as they are, always from the lower to the higher ranked node
+    bool has_new_arcs = false;
+    for (const auto &edge : edges)
+    {
+        if (!is_used(edge))
+            continue;
+        const auto source_rank = ranks[edge.source];
+        const auto target_rank = ranks[edge.target];
+        const auto lower_rank = std::min(source_rank, target_rank);
+        const auto higher_rank = std::max(source_rank, target_rank);
+        if (!findArc(upward[lower_rank], higher_rank))
+        {
+            upward[lower_rank].push_back(Arc{higher_rank, {}, {}});
+            has_new_arcs = true;
+        }
+    }
+    if (has_new_arcs)
+    {
+        sort_arcs();
+        std::size_t number_of_arcs = 0;
+        for (const auto &arcs : upward)
+            number_of_arcs += arcs.size();
+        statistics.inserted_edges += number_of_arcs - statistics.reused_arcs;
+    }
+
+    for (const auto &edge : edges)
+    {
+        if (!is_used(edge))
+            continue;
+
+        const auto source_rank = ranks[edge.source];
+        const auto target_rank = ranks[edge.target];
+        auto *arc = findArc(upward[std::min(source_rank, target_rank)],
+                            std::max(source_rank, target_rank));
+        BOOST_ASSERT(arc);
+        const ArcMetric metric{std::max(edge.data.weight, {1}),
+                               to_alias<EdgeDuration>(edge.data.duration),
+                               edge.data.distance,
+                               edge.data.turn_id,
+                               isShortcut(edge)};
+
+        auto &source_to_target = source_rank < target_rank ? arc->up : arc->down;
+        auto &target_to_source = source_rank < target_rank ? arc->down : arc->up;
+        if (edge.data.forward && metric < source_to_target)
+            source_to_target = metric;
+        if (edge.data.backward && metric < target_to_source)
+            target_to_source = metric;
+    }
+
+    LowerTails lower(number_of_nodes);
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (const auto &arc : upward[rank])
+            lower[arc.head].push_back(rank);
+    }
+
+    std::vector<ArcMetric> loops(number_of_nodes);
+    if (repair_witnesses)
+    {
+        repairArcs(upward, loops, lower, nodes, statistics);
+    }
+    else
+    {
+        customizeArcs(upward, loops, lower, nodes);
+    }
+
+    std::vector<QueryEdge> query_edges;
+    for (const auto rank : util::irange<NodeID>(0, number_of_nodes))
+    {
+        const auto node = nodes[rank];
+        detail::appendQueryEdges(query_edges, node, node, loops[rank], loops[rank]);
+        for (const auto &arc : upward[rank])
+        {
+            detail::appendQueryEdges(query_edges, node, nodes[arc.head], arc.up, arc.down);
+        }
+    }
+
+    tbb::parallel_sort(query_edges.begin(), query_edges.end());
+
+    return query_edges;
+}
+} // namespace
+
+std::vector<QueryEdge> recontractMetric(const QueryGraph &hierarchy,
+                                        const std::vector<bool> &hierarchy_filter,
+                                        const std::vector<extractor::EdgeBasedEdge> &edges,
+                                        const std::vector<bool> &node_filter,
+                                        const bool repair_witnesses,
+                                        RecontractionStatistics &statistics)
+{
+    return recontract(
+        hierarchy, hierarchy_filter, edges, node_filter, repair_witnesses, statistics);
+}
+
+std::vector<QueryEdge> recontractMetric(const QueryGraph &hierarchy,
+                                        const std::vector<bool> &hierarchy_filter,
+                                        const std::vector<QueryEdge> &edges,
+                                        const std::vector<bool> &node_filter,
+                                        const bool repair_witnesses,
+                                        RecontractionStatistics &statistics)
+{
+    return recontract(
+        hierarchy, hierarchy_filter, edges, node_filter, repair_witnesses, statistics);
+}
+
+} // namespace osrm::contractor
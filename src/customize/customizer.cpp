@@ -1,10 +1,15 @@
+#include "extractor/files.hpp"
 #include "extractor/node_data_container.hpp"
+#include "extractor/packed_osm_ids.hpp"
+#include "extractor/segment_data_container.hpp"
 
 #include "customizer/cell_customizer.hpp"
 #include "customizer/customizer.hpp"
 #include "customizer/edge_based_graph.hpp"
 #include "customizer/files.hpp"
+#include "customizer/speed_profiles.hpp"
 
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/cell_statistics.hpp"
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/edge_based_graph_reader.hpp"
@@ -13,16 +18,28 @@
 
 #include "storage/shared_memory_ownership.hpp"
 
+#include "updater/csv_source.hpp"
 #include "updater/updater.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/exclude_flag.hpp"
+#include "util/for_each_pair.hpp"
+#include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 
 #include <boost/assert.hpp>
 
 #include <tbb/global_control.h>
 
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <unordered_map>
+
 namespace osrm::customizer
 {
 
@@ -76,13 +93,19 @@ auto LoadAndUpdateEdgeExpandedGraph(const CustomizationConfig &config,
                                     std::vector<EdgeWeight> &node_weights,
                                     std::vector<EdgeDuration> &node_durations,
                                     std::vector<EdgeDistance> &node_distances,
+                                    std::vector<NodeID> &updated_nodes,
+                                    std::vector<NodeID> &changed_nodes,
                                     std::uint32_t &connectivity_checksum)
 {
     updater::Updater updater(config.updater_config);
 
     std::vector<extractor::EdgeBasedEdge> edge_based_edge_list;
-    EdgeID num_nodes = updater.LoadAndUpdateEdgeExpandedGraph(
-        edge_based_edge_list, node_weights, node_durations, connectivity_checksum);
+    EdgeID num_nodes = updater.LoadAndUpdateEdgeExpandedGraph(edge_based_edge_list,
+                                                              node_weights,
+                                                              node_durations,
+                                                              updated_nodes,
+                                                              changed_nodes,
+                                                              connectivity_checksum);
 
     extractor::files::readEdgeBasedNodeDistances(config.GetPath(".osrm.enw"), node_distances);
 
@@ -114,14 +137,254 @@ std::vector<CellMetric> customizeFilteredMetrics(const partitioner::MultiLevelEd
 
     return metrics;
 }
+
+// Reads the microcode programs if they belong to the same partition
+bool readMicrocode(const std::filesystem::path &path,
+                   const partitioner::MultiLevelPartition &mlp,
+                   partitioner::CellMicrocode &microcode)
+{
+    if (!std::filesystem::exists(path))
+    {
+        util::Log(logWARNING) << "No " << path.string()
+                              << " found, customizing all cells by search. Run osrm-partition "
+                                 "with --microcode-max-cell-size to generate it.";
+        return false;
+    }
+
+    partitioner::files::readCellMicrocode(path, microcode);
+    for (std::size_t level = 1; level < mlp.GetNumberOfLevels(); ++level)
+    {
+        if (microcode.GetNumberOfCells(level) != mlp.GetNumberOfCells(level))
+        {
+            util::Log(logWARNING) << path.string() << " does not match the partition, "
+                                  << "customizing all cells by search.";
+            return false;
+        }
+    }
+
+    for (std::size_t level = 1; level < mlp.GetNumberOfLevels(); ++level)
+    {
+        util::Log() << "Level " << level << ": " << microcode.GetNumberOfPrograms(level)
+                    << " of " << mlp.GetNumberOfCells(level) << " cells have a microcode program";
+    }
+    return true;
+}
+
+// Reads the metrics of the previous customization if they belong to the same graph and cells
+bool readPreviousMetrics(const std::filesystem::path &path,
+                         const std::string &metric_name,
+                         const partitioner::CellStorage &storage,
+                         const std::size_t num_exclude_classes,
+                         const std::uint32_t connectivity_checksum,
+                         std::vector<CellMetric> &metrics,
+                         std::vector<NodeID> &previous_updated_nodes)
+{
+    if (!std::filesystem::exists(path))
+    {
+        util::Log(logWARNING) << path.string() << " does not exist, customizing all cells";
+        return false;
+    }
+
+    std::uint32_t previous_connectivity_checksum = 0;
+    if (!files::readCustomizationState(
+            path, previous_connectivity_checksum, previous_updated_nodes))
+    {
+        util::Log(logWARNING) << path.string()
+                              << " was written without the customization state, customizing all "
+                                 "cells";
+        return false;
+    }
+
+    if (previous_connectivity_checksum != connectivity_checksum)
+    {
+        util::Log(logWARNING) << path.string()
+                              << " was customized for a different graph, customizing all cells";
+        return false;
+    }
+
+    std::unordered_map<std::string, std::vector<CellMetric>> previous_metrics = {
+        {metric_name, {}},
+    };
+    try
+    {
+        files::readCellMetrics(path, previous_metrics);
+    }
+    catch (const util::exception &e)
+    {
+        util::Log(logWARNING) << e.what() << ", customizing all cells";
+        return false;
+    }
+    metrics = std::move(previous_metrics[metric_name]);
+
+    const auto metric_size = storage.GetMetricSize();
+    if (metrics.size() != num_exclude_classes ||
+        std::any_of(metrics.begin(),
+                    metrics.end(),
+                    [&](const auto &metric)
+                    {
+                        return metric.weights.size() != metric_size ||
+                               metric.durations.size() != metric_size ||
+                               metric.distances.size() != metric_size;
+                    }))
+    {
+        util::Log(logWARNING) << path.string()
+                              << " does not match the cells or exclude classes, customizing all "
+                                 "cells";
+        return false;
+    }
+
+    return true;
+}
+// Assigns the profiles of their segments to the edge-based nodes and finds the cells without
+// any node that has a profile, whose shortcuts are valid at any time of the week
+SpeedProfiles loadSpeedProfiles(const CustomizationConfig &config,
+                                const partitioner::MultiLevelPartition &mlp,
+                                const extractor::EdgeBasedNodeDataContainer &node_data,
+                                const std::size_t number_of_nodes)
+{
+    const auto dictionary = updater::csv::readSpeedProfiles(config.speed_profile_lookup_paths);
+    const auto segment_profiles =
+        updater::csv::readSegmentProfiles(config.segment_profile_lookup_paths);
+
+    // lookup tables are sorted in descending order
+    SpeedProfiles profiles;
+    std::unordered_map<std::uint32_t, std::uint32_t> profile_index;
+    for (auto entry = dictionary.lookup.rbegin(); entry != dictionary.lookup.rend(); ++entry)
+    {
+        const auto &[key, value] = *entry;
+        if (key.time >= SECONDS_PER_WEEK)
+        {
+            throw util::exception(
+                std::format("Speed profile {} has a breakpoint after the end of the week at {}s",
+                            key.profile,
+                            key.time) +
+                SOURCE_REF);
+        }
+        if (!(value.speed > 0))
+        {
+            throw util::exception(std::format("Speed profile {} has no positive speed at {}s",
+                                              key.profile,
+                                              key.time) +
+                                  SOURCE_REF);
+        }
+        if (profile_index.emplace(key.profile, profile_index.size()).second)
+        {
+            profiles.profile_offsets.push_back(profiles.breakpoints.size());
+        }
+        profiles.breakpoints.push_back({key.time, static_cast<float>(value.speed)});
+    }
+    profiles.profile_offsets.push_back(profiles.breakpoints.size());
+
+    for (const auto &[segment, value] : segment_profiles.lookup)
+    {
+        if (!profile_index.contains(value.profile))
+        {
+            throw util::exception(std::format("Segment {},{} uses the undefined speed profile {}",
+                                              segment.from,
+                                              segment.to,
+                                              value.profile) +
+                                  SOURCE_REF);
+        }
+    }
+
+    extractor::SegmentDataContainer segment_data;
+    extractor::files::readSegmentData(config.updater_config.GetPath(".osrm.geometry"),
+                                      segment_data);
+    std::vector<util::Coordinate> coordinates;
+    extractor::PackedOSMIDs osm_node_ids;
+    extractor::files::readNodes(
+        config.updater_config.GetPath(".osrm.nbg_nodes"), coordinates, osm_node_ids);
+
+    // A node uses the first profile of its segments, they are usually all the same because
+    // profiles are assigned per road
+    std::size_t profiled_nodes = 0;
+    std::size_t mixed_nodes = 0;
+    profiles.node_profiles.resize(number_of_nodes, INVALID_SPEED_PROFILE_ID);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        const auto geometry_id = node_data.GetGeometryID(node);
+        auto &node_profile = profiles.node_profiles[node];
+        bool mixed = false;
+        auto geometry = segment_data.GetForwardGeometry(geometry_id.id);
+        util::for_each_pair(geometry,
+                            [&](const auto u, const auto v)
+                            {
+                                const auto from = osm_node_ids[geometry_id.forward ? u : v];
+                                const auto to = osm_node_ids[geometry_id.forward ? v : u];
+                                const auto value = segment_profiles({from, to});
+                                if (!value)
+                                    return;
+
+                                const auto profile = profile_index.at(value->profile);
+                                mixed = mixed || (node_profile != INVALID_SPEED_PROFILE_ID &&
+                                                  node_profile != profile);
+                                if (node_profile == INVALID_SPEED_PROFILE_ID)
+                                    node_profile = profile;
+                            });
+        profiled_nodes += node_profile != INVALID_SPEED_PROFILE_ID;
+        mixed_nodes += mixed;
+    }
+
+    const auto number_of_levels = mlp.GetNumberOfLevels();
+    std::vector<std::vector<bool>> cell_has_profile(number_of_levels);
+    for (LevelID level = 1; level < number_of_levels; ++level)
+    {
+        cell_has_profile[level].resize(mlp.GetNumberOfCells(level), false);
+    }
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        if (profiles.node_profiles[node] == INVALID_SPEED_PROFILE_ID)
+            continue;
+        for (LevelID level = 1; level < number_of_levels; ++level)
+        {
+            cell_has_profile[level][mlp.GetCell(level, node)] = true;
+        }
+    }
+
+    // cells are nested, so all cells above the first one with a profile have one as well
+    profiles.static_levels.resize(number_of_nodes, number_of_levels - 1);
+    for (const auto node : util::irange<NodeID>(0, number_of_nodes))
+    {
+        for (LevelID level = 1; level < number_of_levels; ++level)
+        {
+            if (cell_has_profile[level][mlp.GetCell(level, node)])
+            {
+                profiles.static_levels[node] = level - 1;
+                break;
+            }
+        }
+    }
+
+    util::Log() << "Assigned " << profiles.GetNumberOfProfiles() << " speed profiles to "
+                << profiled_nodes << " of " << number_of_nodes << " nodes";
+    if (mixed_nodes > 0)
+    {
+        util::Log(logWARNING) << mixed_nodes
+                              << " nodes have segments with different speed profiles, using the "
+                                 "first one";
+    }
+    for (LevelID level = 1; level < number_of_levels; ++level)
+    {
+        util::Log() << "Level " << static_cast<unsigned>(level) << ": "
+                    << std::count(cell_has_profile[level].begin(),
+                                  cell_has_profile[level].end(),
+                                  true)
+                    << " of " << mlp.GetNumberOfCells(level)
+                    << " cells are searched at query time for speed profiles";
+    }
+
+    return profiles;
+}
 } // namespace
 
 int Customizer::Run(const CustomizationConfig &config)
 {
     tbb::global_control gc(tbb::global_control::max_allowed_parallelism,
                            config.requested_num_threads);
+    util::PhaseTimer customize_phase("customize");
 
     TIMER_START(loading_data);
+    util::PhaseTimer loading_data_phase("loading data");
 
     partitioner::MultiLevelPartition mlp;
     partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
@@ -129,9 +392,17 @@ int Customizer::Run(const CustomizationConfig &config)
     std::vector<EdgeWeight> node_weights;
     std::vector<EdgeDuration> node_durations; // TODO: remove when durations are optional
     std::vector<EdgeDistance> node_distances; // TODO: remove when distances are optional
+    std::vector<NodeID> updated_nodes;
+    std::vector<NodeID> weight_changed_nodes;
     std::uint32_t connectivity_checksum = 0;
-    auto graph = LoadAndUpdateEdgeExpandedGraph(
-        config, mlp, node_weights, node_durations, node_distances, connectivity_checksum);
+    auto graph = LoadAndUpdateEdgeExpandedGraph(config,
+                                                mlp,
+                                                node_weights,
+                                                node_durations,
+                                                node_distances,
+                                                updated_nodes,
+                                                weight_changed_nodes,
+                                                connectivity_checksum);
     BOOST_ASSERT(graph.GetNumberOfNodes() == node_weights.size());
     std::for_each(
         node_weights.begin(), node_weights.end(), [](auto &w) { w &= EdgeWeight{0x7fffffff}; });
@@ -140,6 +411,7 @@ int Customizer::Run(const CustomizationConfig &config)
 
     partitioner::CellStorage storage;
     partitioner::files::readCells(config.GetPath(".osrm.cells"), storage);
+    loading_data_phase.Stop();
     TIMER_STOP(loading_data);
 
     extractor::EdgeBasedNodeDataContainer node_data;
@@ -151,8 +423,68 @@ int Customizer::Run(const CustomizationConfig &config)
     util::Log() << "Loading partition data took " << TIMER_SEC(loading_data) << " seconds";
 
     TIMER_START(cell_customize);
+    util::PhaseTimer cell_customize_phase("cell customization");
     auto filter = util::excludeFlagsToNodeFilter(graph.GetNumberOfNodes(), node_data, properties);
-    auto metrics = customizeFilteredMetrics(graph, storage, CellCustomizer{mlp}, filter);
+    partitioner::CellMicrocode microcode;
+    const bool use_microcode =
+        config.microcode &&
+        readMicrocode(config.GetPath(".osrm.cell_microcode"), mlp, microcode);
+    const auto customizer = use_microcode ? CellCustomizer{mlp, microcode} : CellCustomizer{mlp};
+    std::vector<CellMetric> metrics;
+    std::vector<NodeID> previous_updated_nodes;
+    if (config.incremental && readPreviousMetrics(config.GetOutputPath(".osrm.cell_metrics"),
+                                                  properties.GetWeightName(),
+                                                  storage,
+                                                  filter.size(),
+                                                  connectivity_checksum,
+                                                  metrics,
+                                                  previous_updated_nodes))
+    {
+        // Edges that are not part of this update fall back to their extracted weights, so the
+        // edges of the previous update changed as well.
+        std::vector<NodeID> changed_nodes;
+        if (config.skip_unchanged_cells)
+        {
+            // Edges updated by only one of both updates got their weights from a different
+            // source, all others only changed if their segments or turns changed.
+            std::vector<NodeID> updated_once;
+            std::set_symmetric_difference(updated_nodes.begin(),
+                                          updated_nodes.end(),
+                                          previous_updated_nodes.begin(),
+                                          previous_updated_nodes.end(),
+                                          std::back_inserter(updated_once));
+            std::set_union(weight_changed_nodes.begin(),
+                           weight_changed_nodes.end(),
+                           updated_once.begin(),
+                           updated_once.end(),
+                           std::back_inserter(changed_nodes));
+        }
+        else
+        {
+            std::set_union(updated_nodes.begin(),
+                           updated_nodes.end(),
+                           previous_updated_nodes.begin(),
+                           previous_updated_nodes.end(),
+                           std::back_inserter(changed_nodes));
+        }
+
+        const auto level_cells = customizer.GetCellsContaining(changed_nodes);
+        for (std::size_t level = 1; level < mlp.GetNumberOfLevels(); ++level)
+        {
+            util::Log() << "Level " << level << ": recustomizing " << level_cells[level].size()
+                        << " of " << mlp.GetNumberOfCells(level) << " cells";
+        }
+
+        for (std::size_t index = 0; index < filter.size(); ++index)
+        {
+            customizer.Customize(graph, storage, filter[index], metrics[index], level_cells);
+        }
+    }
+    else
+    {
+        metrics = customizeFilteredMetrics(graph, storage, customizer, filter);
+    }
+    cell_customize_phase.Stop();
     TIMER_STOP(cell_customize);
     util::Log() << "Cells customization took " << TIMER_SEC(cell_customize) << " seconds";
 
@@ -163,20 +495,43 @@ int Customizer::Run(const CustomizationConfig &config)
     }
 
     TIMER_START(writing_mld_data);
+    util::PhaseTimer writing_mld_data_phase("writing metrics");
     std::unordered_map<std::string, std::vector<CellMetric>> metric_exclude_classes = {
         {properties.GetWeightName(), std::move(metrics)},
     };
-    files::writeCellMetrics(config.GetOutputPath(".osrm.cell_metrics"), metric_exclude_classes);
+    files::writeCellMetrics(config.GetOutputPath(".osrm.cell_metrics"),
+                            metric_exclude_classes,
+                            connectivity_checksum,
+                            updated_nodes);
+    writing_mld_data_phase.Stop();
     TIMER_STOP(writing_mld_data);
     util::Log() << "MLD customization writing took " << TIMER_SEC(writing_mld_data) << " seconds";
 
+    if (!config.speed_profile_lookup_paths.empty())
+    {
+        TIMER_START(speed_profiles);
+        util::PhaseTimer speed_profiles_phase("speed profiles");
+        const auto profiles = loadSpeedProfiles(config, mlp, node_data, graph.GetNumberOfNodes());
+        files::writeSpeedProfiles(config.GetOutputPath(".osrm.speed_profiles"), profiles);
+        speed_profiles_phase.Stop();
+        TIMER_STOP(speed_profiles);
+        util::Log() << "Speed profiles took " << TIMER_SEC(speed_profiles) << " seconds";
+    }
+    else if (std::filesystem::exists(config.GetOutputPath(".osrm.speed_profiles")))
+    {
+        // the profiles of a previous run would still be applied to departure time queries
+        std::filesystem::remove(config.GetOutputPath(".osrm.speed_profiles"));
+    }
+
     TIMER_START(writing_graph);
+    util::PhaseTimer writing_graph_phase("writing graph");
     MultiLevelEdgeBasedGraph shaved_graph{std::move(graph),
                                           std::move(node_weights),
                                           std::move(node_durations),
                                           std::move(node_distances)};
     customizer::files::writeGraph(
         config.GetOutputPath(".osrm.mldgr"), shaved_graph, connectivity_checksum);
+    writing_graph_phase.Stop();
     TIMER_STOP(writing_graph);
     util::Log() << "Graph writing took " << TIMER_SEC(writing_graph) << " seconds";
 
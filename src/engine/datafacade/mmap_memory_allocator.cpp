@@ -4,14 +4,21 @@
 #include "storage/io.hpp"
 #include "storage/serialization.hpp"
 #include "storage/storage.hpp"
+#include "storage/tar.hpp"
 
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/huge_pages.hpp"
 #include "util/log.hpp"
 #include "util/mmap_file.hpp"
 
+#include <algorithm>
+
 namespace osrm::engine::datafacade
 {
 
-MMapMemoryAllocator::MMapMemoryAllocator(const storage::StorageConfig &config)
+MMapMemoryAllocator::MMapMemoryAllocator(const storage::StorageConfig &config,
+                                         const bool huge_pages)
 {
     storage::Storage storage(config);
     std::vector<storage::SharedDataIndex::AllocatedRegion> allocated_regions;
@@ -56,8 +63,32 @@ MMapMemoryAllocator::MMapMemoryAllocator(const storage::StorageConfig &config)
         {
             std::unique_ptr<storage::BaseDataLayout> layout =
                 std::make_unique<storage::TarDataLayout>();
+            {
+                storage::tar::FileReader reader(file.second,
+                                                storage::tar::FileReader::VerifyFingerprint);
+                std::vector<storage::tar::FileReader::FileEntry> entries;
+                reader.List(std::back_inserter(entries));
+                if (std::any_of(entries.begin(),
+                                entries.end(),
+                                [](const auto &entry) { return entry.compressed; }))
+                {
+                    throw util::exception(file.second.string() +
+                                          " contains compressed blocks, which cannot be memory "
+                                          "mapped. Load it without --mmap or run osrm-compress "
+                                          "--decompress first." +
+                                          SOURCE_REF);
+                }
+            }
+
             boost::iostreams::mapped_file_source mapped_memory_file;
             auto data = util::mmapFile<char>(file.second, mapped_memory_file).data();
+            // File backed mappings only get huge pages if the kernel supports them for the
+            // file system (CONFIG_READ_ONLY_THP_FOR_FS), which is reported by LogPageStats.
+            if (huge_pages)
+            {
+                util::AdviseHugePages(const_cast<char *>(data), mapped_memory_file.size());
+            }
+            util::LogPageStats(file.second.string(), data, mapped_memory_file.size());
             mapped_memory_files.push_back(std::move(mapped_memory_file));
             storage::populateLayoutFromFile(file.second, *layout);
             allocated_regions.push_back({const_cast<char *>(data), std::move(layout)});
@@ -1,10 +1,14 @@
 #include "engine/datafacade/process_memory_allocator.hpp"
 #include "storage/storage.hpp"
 
+#include "util/huge_pages.hpp"
+#include "util/log.hpp"
+
 namespace osrm::engine::datafacade
 {
 
-ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config)
+ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &config,
+                                               const bool huge_pages)
 {
     storage::Storage storage(config);
 
@@ -18,8 +22,16 @@ ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &con
     storage.PopulateLayout(*layout, static_files);
     storage.PopulateLayout(*layout, updatable_files);
 
-    // Allocate the memory block, then load data from files into it
-    internal_memory = std::make_unique<char[]>(layout->GetSizeOfLayout());
+    // Allocate the memory block, then load data from files into it. Every byte is overwritten
+    // by the loaders, so skip zero-initialising it; this also lets the loader threads be the
+    // first to touch the pages they fill.
+    const auto memory_size = layout->GetSizeOfLayout();
+    internal_memory = std::make_unique_for_overwrite<char[]>(memory_size);
+    // Has to happen before the first touch so the pages are faulted in as huge pages
+    if (huge_pages && !util::AdviseHugePages(internal_memory.get(), memory_size))
+    {
+        util::Log(logWARNING) << "transparent huge pages are not available";
+    }
 
     std::vector<storage::SharedDataIndex::AllocatedRegion> regions;
     regions.push_back({internal_memory.get(), std::move(layout)});
@@ -27,6 +39,8 @@ ProcessMemoryAllocator::ProcessMemoryAllocator(const storage::StorageConfig &con
 
     storage.PopulateStaticData(index);
     storage.PopulateUpdatableData(index);
+
+    util::LogPageStats("process memory", internal_memory.get(), memory_size);
 }
 
 ProcessMemoryAllocator::~ProcessMemoryAllocator() {}
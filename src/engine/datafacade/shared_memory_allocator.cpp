@@ -2,6 +2,7 @@
 
 #include "storage/serialization.hpp"
 
+#include "util/huge_pages.hpp"
 #include "util/log.hpp"
 
 #include "boost/assert.hpp"
@@ -15,23 +16,41 @@ SharedMemoryAllocator::SharedMemoryAllocator(const std::vector<storage::ProjID>
 
     for (const auto proj_id : proj_ids)
     {
-        util::Log(logDEBUG) << "Loading new data for region " << (int)proj_id;
-        BOOST_ASSERT(storage::RegionExists(proj_id));
-        auto mem = storage::makeSharedMemory(proj_id);
-
-        storage::io::BufferReader reader(reinterpret_cast<char *>(mem->Ptr()), mem->Size());
-        std::unique_ptr<storage::BaseDataLayout> layout =
-            std::make_unique<storage::ContiguousDataLayout>();
-        storage::serialization::read(reader, *layout);
-        auto layout_size = reader.GetPosition();
-
-        regions.push_back({reinterpret_cast<char *>(mem->Ptr()) + layout_size, std::move(layout)});
-        memory_regions.push_back(std::move(mem));
+        MapRegion(proj_id, regions);
     }
 
     index = storage::SharedDataIndex{std::move(regions)};
 }
 
+void SharedMemoryAllocator::MapRegion(
+    const storage::ProjID proj_id, std::vector<storage::SharedDataIndex::AllocatedRegion> &regions)
+{
+    util::Log(logDEBUG) << "Loading new data for region " << (int)proj_id;
+    BOOST_ASSERT(storage::RegionExists(proj_id));
+    auto mem = storage::makeSharedMemory(proj_id);
+
+    storage::io::BufferReader reader(reinterpret_cast<char *>(mem->Ptr()), mem->Size());
+    std::unique_ptr<storage::BaseDataLayout> layout =
+        std::make_unique<storage::ContiguousDataLayout>();
+    storage::serialization::read(reader, *layout);
+    auto layout_size = reader.GetPosition();
+    auto *data_ptr = reinterpret_cast<char *>(mem->Ptr()) + layout_size;
+
+    // The region only holds what changed relative to its base, which therefore has to come
+    // first so the blocks of this region override it.
+    if (layout->HasBlock(storage::BASE_REGION_BLOCK))
+    {
+        const auto base_proj_id = *reinterpret_cast<const storage::ProjID *>(
+            layout->GetBlockPtr(data_ptr, storage::BASE_REGION_BLOCK));
+        MapRegion(base_proj_id, regions);
+    }
+
+    util::LogPageStats("shared memory region " + std::to_string(proj_id), mem->Ptr(), mem->Size());
+
+    regions.push_back({data_ptr, std::move(layout)});
+    memory_regions.push_back(std::move(mem));
+}
+
 SharedMemoryAllocator::~SharedMemoryAllocator() {}
 
 const storage::SharedDataIndex &SharedMemoryAllocator::GetIndex() { return index; }
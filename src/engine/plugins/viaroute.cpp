@@ -46,6 +46,23 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
             result);
     }
 
+    if (route_parameters.depart_at)
+    {
+        if (!algorithms.HasTimeDependentSearch())
+        {
+            return Error("NotImplemented",
+                         "Routes with a departure time are not implemented for the chosen search "
+                         "algorithm.",
+                         result);
+        }
+        if (route_parameters.coordinates.size() > 2)
+        {
+            return Error("InvalidValue",
+                         "depart_at is only supported for routes between two coordinates.",
+                         result);
+        }
+    }
+
     if (max_locations_viaroute > 0 &&
         (static_cast<int>(route_parameters.coordinates.size()) > max_locations_viaroute))
     {
@@ -108,7 +125,15 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
     // Alternatives do not support vias, only direct s,t queries supported
     // See the implementation notes and high-level outline.
     // https://github.com/Project-OSRM/osrm-backend/issues/3905
-    if (2 == snapped_phantoms.size() && algorithms.HasAlternativePathSearch() && wants_alternatives)
+    // Speed profiles change the weights with the departure time, which the alternatives do not
+    // take into account
+    if (route_parameters.depart_at)
+    {
+        routes = algorithms.TimeDependentShortestPathSearch(
+            {snapped_phantoms[0], snapped_phantoms[1]}, *route_parameters.depart_at);
+    }
+    else if (2 == snapped_phantoms.size() && algorithms.HasAlternativePathSearch() &&
+             wants_alternatives)
     {
         routes = algorithms.AlternativePathSearch({snapped_phantoms[0], snapped_phantoms[1]},
                                                   number_of_alternatives);
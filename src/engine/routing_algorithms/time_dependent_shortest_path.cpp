@@ -0,0 +1,382 @@
+#include "engine/routing_algorithms/time_dependent_shortest_path.hpp"
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/routing_algorithms/routing_base_mld.hpp"
+
+#include "customizer/speed_profiles.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <tuple>
+
+namespace osrm::engine::routing_algorithms
+{
+
+namespace
+{
+using Heap = SearchEngineData<mld::Algorithm>::TimeDependentQueryHeap;
+
+template <typename T> T scale(const T value, const double factor)
+{ return to_alias<T>(std::lround(from_alias<double>(value) * factor)); }
+
+// Cells that contain a road with a speed profile are searched on the level below, because
+// their shortcuts only hold for the static speeds
+LevelID getNodeLevel(const DataFacade<mld::Algorithm> &facade,
+                     const NodeID node,
+                     const PhantomEndpointCandidates &endpoint_candidates)
+{
+    return std::min(
+        mld::getNodeQueryLevel(facade.GetMultiLevelPartition(), node, endpoint_candidates),
+        facade.GetSpeedProfiles().GetStaticLevel(node));
+}
+
+// Factor of the weight and duration of a node that is entered after travelling for the
+// duration of a heap entry
+double getFactor(const DataFacade<mld::Algorithm> &facade,
+                 const std::int64_t departure_time,
+                 const NodeID node,
+                 const EdgeDuration duration)
+{
+    const auto &profiles = facade.GetSpeedProfiles();
+    if (profiles.GetProfile(node) == customizer::INVALID_SPEED_PROFILE_ID)
+        return 1.;
+
+    // durations are stored in deciseconds
+    const auto entry_time = departure_time + from_alias<std::int64_t>(duration) / 10;
+    return profiles.GetFactor(node,
+                              facade.GetNodeDuration(node),
+                              facade.GetNodeDistance(node),
+                              customizer::toTimeOfWeek(entry_time));
+}
+
+// A source is seeded with the negated part of its node that lies behind it, so the graph part
+// of the weight of a heap entry is only negative on the node it started on. Only the part of a
+// node that is actually travelled is scaled.
+template <typename T> T travel(const T graph_value, const T node_value, const double factor)
+{
+    return std::max(graph_value, T{0}) + scale(node_value + std::min(graph_value, T{0}), factor);
+}
+
+struct Candidate
+{
+    EdgeWeight weight = INVALID_EDGE_WEIGHT;
+    NodeID target = SPECIAL_NODEID;
+    // set if the path has to come back to the node it started on
+    NodeID loop_parent = SPECIAL_NODEID;
+};
+
+void insertSources(const DataFacade<mld::Algorithm> &facade,
+                   Heap &heap,
+                   const PhantomNodeCandidates &sources)
+{
+    const auto insert = [&](const NodeID node,
+                            const EdgeWeight weight,
+                            const EdgeDuration duration,
+                            const PhantomNode &source)
+    {
+        if (facade.ExcludeNode(node))
+            return;
+        mld::insertOrUpdate(
+            heap,
+            node,
+            weight,
+            {node, false, duration, source.approach_weight, source.approach_duration});
+    };
+
+    for (const auto &source : sources)
+    {
+        if (source.IsValidForwardSource())
+        {
+            insert(source.forward_segment_id.id,
+                   source.GetForwardWeightAsSource(),
+                   source.GetForwardDurationAsSource(),
+                   source);
+        }
+        if (source.IsValidReverseSource())
+        {
+            insert(source.reverse_segment_id.id,
+                   source.GetReverseWeightAsSource(),
+                   source.GetReverseDurationAsSource(),
+                   source);
+        }
+    }
+}
+
+// Weight of the path that ends on a target at the node of a heap entry. The last road keeps its
+// static weight up to the target, as in scalePath().
+std::optional<EdgeWeight> getTargetWeight(const NodeID node,
+                                          const EdgeWeight weight,
+                                          const Heap::DataType &data,
+                                          const PhantomNodeCandidates &targets)
+{
+    std::optional<EdgeWeight> best;
+    const auto graph_weight = weight - data.approach;
+
+    const auto check = [&](const EdgeWeight target_weight, const PhantomNode &target)
+    {
+        // the target lies behind the source on the same node
+        if (graph_weight + target_weight < EdgeWeight{0})
+            return;
+        const auto path_weight = weight + target.approach_weight + target_weight;
+        if (!best || path_weight < *best)
+            best = path_weight;
+    };
+
+    for (const auto &target : targets)
+    {
+        if (target.IsValidForwardTarget() && target.forward_segment_id.id == node)
+            check(target.GetForwardWeightPlusOffset(), target);
+        if (target.IsValidReverseTarget() && target.reverse_segment_id.id == node)
+            check(target.GetReverseWeightPlusOffset(), target);
+    }
+    return best;
+}
+
+void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
+                        Heap &heap,
+                        const Heap::HeapNode &heap_node,
+                        const std::int64_t departure_time,
+                        const PhantomEndpointCandidates &endpoint_candidates,
+                        Candidate &best)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &cells = facade.GetCellStorage();
+    const auto &metric = facade.GetCellMetric();
+
+    const auto node = heap_node.node;
+    const auto &data = heap_node.data;
+    const auto level = getNodeLevel(facade, node, endpoint_candidates);
+
+    // Shortcuts of cells without speed profiles keep their static weights. The nodes of the
+    // sources are searched on level 0, so shortcuts never start on a partially travelled node.
+    if (level >= 1 && !data.from_clique_arc)
+    {
+        const auto &cell = cells.GetCell(metric, level, partition.GetCell(level, node));
+        auto destination = cell.GetDestinationNodes().begin();
+        auto shortcut_duration = cell.GetOutDuration(node).begin();
+        for (auto shortcut_weight : cell.GetOutWeight(node))
+        {
+            BOOST_ASSERT(destination != cell.GetDestinationNodes().end());
+            const NodeID to = *destination;
+            if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
+            {
+                mld::insertOrUpdate(heap,
+                                    to,
+                                    heap_node.weight + shortcut_weight,
+                                    {node,
+                                     true,
+                                     data.duration + *shortcut_duration,
+                                     data.approach,
+                                     data.approach_duration});
+            }
+            ++destination;
+            ++shortcut_duration;
+        }
+    }
+
+    const auto graph_weight = heap_node.weight - data.approach;
+    const auto graph_duration = data.duration - data.approach_duration;
+    const auto factor = getFactor(facade,
+                                  departure_time,
+                                  node,
+                                  data.approach_duration +
+                                      std::max(graph_duration, EdgeDuration{0}));
+    const auto node_weight = travel(graph_weight, facade.GetNodeWeight(node), factor);
+    const auto node_duration = travel(graph_duration, facade.GetNodeDuration(node), factor);
+
+    for (const auto edge : facade.GetBorderEdgeRange(level, node))
+    {
+        if (!facade.IsForwardEdge(edge))
+            continue;
+
+        const NodeID to = facade.GetTarget(edge);
+        if (facade.ExcludeNode(to))
+            continue;
+
+        const auto turn_id = facade.GetEdgeData(edge).turn_id;
+        const auto to_weight = data.approach + node_weight +
+                               alias_cast<EdgeWeight>(facade.GetWeightPenaltyForEdgeID(turn_id));
+        const auto to_duration =
+            data.approach_duration + node_duration +
+            alias_cast<EdgeDuration>(facade.GetDurationPenaltyForEdgeID(turn_id));
+
+        const auto to_node = heap.GetHeapNodeIfWasInserted(to);
+        if (to_node && to_node->WasRemoved())
+        {
+            // A node is only settled once, so a path that comes back to the node it started
+            // on has to be completed here
+            const auto target_weight =
+                getTargetWeight(to,
+                                to_weight,
+                                {node, false, to_duration, data.approach, data.approach_duration},
+                                endpoint_candidates.target_phantoms);
+            if (target_weight && *target_weight < best.weight)
+            {
+                best = {*target_weight, to, node};
+            }
+            continue;
+        }
+
+        mld::insertOrUpdate(
+            heap, to, to_weight, {node, false, to_duration, data.approach, data.approach_duration});
+    }
+}
+
+// Unpacks the shortcuts on a path of heap entries with a static search inside their cells
+void unpackPath(SearchEngineData<mld::Algorithm> &engine_working_data,
+                const DataFacade<mld::Algorithm> &facade,
+                const PhantomEndpointCandidates &endpoint_candidates,
+                const std::vector<std::tuple<NodeID, NodeID, bool>> &packed_path,
+                std::vector<NodeID> &unpacked_nodes,
+                std::vector<EdgeID> &unpacked_edges)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    auto &forward_heap = *engine_working_data.forward_heap_1;
+    auto &reverse_heap = *engine_working_data.reverse_heap_1;
+
+    for (const auto &[from, to, from_clique_arc] : packed_path)
+    {
+        if (!from_clique_arc)
+        {
+            unpacked_nodes.push_back(to);
+            unpacked_edges.push_back(facade.FindEdge(from, to));
+            continue;
+        }
+
+        const auto level = getNodeLevel(facade, from, endpoint_candidates);
+        const auto parent_cell = partition.GetCell(level, from);
+        BOOST_ASSERT(parent_cell == partition.GetCell(level, to));
+
+        forward_heap.Clear();
+        reverse_heap.Clear();
+        forward_heap.Insert(from, {0}, {from});
+        reverse_heap.Insert(to, {0}, {to});
+        const auto subpath = mld::search(engine_working_data,
+                                         facade,
+                                         forward_heap,
+                                         reverse_heap,
+                                         {},
+                                         INVALID_EDGE_WEIGHT,
+                                         static_cast<LevelID>(level - 1),
+                                         parent_cell);
+        BOOST_ASSERT(subpath.nodes.size() > 1);
+        BOOST_ASSERT(subpath.nodes.front() == from);
+        BOOST_ASSERT(subpath.nodes.back() == to);
+        unpacked_nodes.insert(
+            unpacked_nodes.end(), std::next(subpath.nodes.begin()), subpath.nodes.end());
+        unpacked_edges.insert(unpacked_edges.end(), subpath.edges.begin(), subpath.edges.end());
+    }
+}
+
+// Annotation uses the static segment durations, so they are scaled to the profiles again.
+// Turns and the last road up to the target keep their static values, as in getTargetWeight().
+void scalePath(const DataFacade<mld::Algorithm> &facade,
+               const std::int64_t departure_time,
+               const PhantomNode &source,
+               const NodeID target_node,
+               std::vector<PathData> &path)
+{
+    // A path that comes back to the node it started on has points on the target node before
+    // its last turn as well, only the ones after it are on the last road
+    const auto last_road = std::find_if(path.rbegin(),
+                                        path.rend(),
+                                        [&](const PathData &point)
+                                        { return point.from_edge_based_node != target_node; })
+                               .base();
+
+    auto elapsed = source.approach_duration;
+    auto node = SPECIAL_NODEID;
+    double factor = 1.;
+    for (auto point = path.begin(); point != last_road; ++point)
+    {
+        if (point->from_edge_based_node != node)
+        {
+            node = point->from_edge_based_node;
+            factor = getFactor(facade, departure_time, node, elapsed);
+        }
+
+        const auto duration = scale(point->duration_until_turn - point->duration_of_turn, factor);
+        const auto weight = scale(point->weight_until_turn - point->weight_of_turn, factor);
+        point->duration_until_turn = duration + point->duration_of_turn;
+        point->weight_until_turn = weight + point->weight_of_turn;
+        elapsed += point->duration_until_turn;
+    }
+}
+} // namespace
+
+template <>
+InternalRouteResult
+timeDependentShortestPathSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                const DataFacade<mld::Algorithm> &facade,
+                                const PhantomEndpointCandidates &endpoint_candidates,
+                                const std::int64_t departure_time)
+{
+    engine_working_data.InitializeOrClearTimeDependentThreadLocalStorage(
+        facade.GetNumberOfNodes(), facade.GetMaxBorderNodeID() + 1);
+    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes(),
+                                                                 facade.GetMaxBorderNodeID() + 1);
+    auto &heap = *engine_working_data.time_dependent_heap;
+
+    insertSources(facade, heap, endpoint_candidates.source_phantoms);
+
+    // Weights only grow along a path, so the search is done once the smallest weight in the
+    // heap can not improve the best path anymore
+    Candidate best;
+    while (!heap.Empty() && heap.MinKey() < best.weight)
+    {
+        const auto heap_node = heap.DeleteMinGetHeapNode();
+        const auto target_weight = getTargetWeight(heap_node.node,
+                                                    heap_node.weight,
+                                                    heap_node.data,
+                                                    endpoint_candidates.target_phantoms);
+        if (target_weight && *target_weight < best.weight)
+        {
+            best = {*target_weight, heap_node.node, SPECIAL_NODEID};
+        }
+
+        relaxOutgoingEdges(facade, heap, heap_node, departure_time, endpoint_candidates, best);
+    }
+
+    if (best.target == SPECIAL_NODEID)
+    {
+        return {};
+    }
+
+    // packed path as edges {from node ID, to node ID, from_clique_arc}
+    std::vector<std::tuple<NodeID, NodeID, bool>> packed_path;
+    auto current = best.target;
+    if (best.loop_parent != SPECIAL_NODEID)
+    {
+        packed_path.emplace_back(best.loop_parent, best.target, false);
+        current = best.loop_parent;
+    }
+    for (auto parent = heap.GetData(current).parent; parent != current;
+         current = parent, parent = heap.GetData(current).parent)
+    {
+        packed_path.emplace_back(parent, current, heap.GetData(current).from_clique_arc);
+    }
+    std::reverse(packed_path.begin(), packed_path.end());
+
+    std::vector<NodeID> unpacked_nodes{current};
+    std::vector<EdgeID> unpacked_edges;
+    unpackPath(engine_working_data,
+               facade,
+               endpoint_candidates,
+               packed_path,
+               unpacked_nodes,
+               unpacked_edges);
+
+    auto route =
+        extractRoute(facade, best.weight, endpoint_candidates, unpacked_nodes, unpacked_edges);
+    if (route.is_valid())
+    {
+        scalePath(facade,
+                  departure_time,
+                  route.leg_endpoints.front().source_phantom,
+                  unpacked_nodes.back(),
+                  route.unpacked_path_segments.front());
+    }
+    return route;
+}
+
+} // namespace osrm::engine::routing_algorithms
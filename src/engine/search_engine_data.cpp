@@ -123,6 +123,8 @@ thread_local SearchEngineData<MLD>::MapMatchingHeapPtr
 thread_local SearchEngineData<MLD>::MapMatchingHeapPtr
     SearchEngineData<MLD>::map_matching_reverse_heap_1;
 thread_local SearchEngineData<MLD>::ManyToManyHeapPtr SearchEngineData<MLD>::many_to_many_heap;
+thread_local SearchEngineData<MLD>::TimeDependentHeapPtr
+    SearchEngineData<MLD>::time_dependent_heap;
 thread_local SearchEngineData<MLD>::UnpackingCachePtr SearchEngineData<MLD>::unpacking_cache;
 thread_local unsigned SearchEngineData<MLD>::unpacking_cache_node_count = 0;
 thread_local unsigned SearchEngineData<MLD>::unpacking_cache_edge_count = 0;
@@ -185,6 +187,21 @@ void SearchEngineData<MLD>::InitializeOrClearManyToManyThreadLocalStorage(
         many_to_many_heap.reset(new ManyToManyQueryHeap(number_of_nodes, number_of_boundary_nodes));
     }
 }
+
+void SearchEngineData<MLD>::InitializeOrClearTimeDependentThreadLocalStorage(
+    unsigned number_of_nodes, unsigned number_of_boundary_nodes)
+{
+    if (time_dependent_heap.get())
+    {
+        time_dependent_heap->Clear();
+    }
+    else
+    {
+        time_dependent_heap.reset(
+            new TimeDependentQueryHeap(number_of_nodes, number_of_boundary_nodes));
+    }
+}
+
 void SearchEngineData<MLD>::InitializeUnpackingCache(unsigned number_of_nodes,
                                                      unsigned number_of_edges)
 {
@@ -55,7 +55,7 @@ void AreaManager::way(const osmium::Way &way)
 
     util::Log(logDEBUG) << "Registering way: " << way.get_value_by_key("name", "")
                         << " id: " << way.id();
-    registered_closed_ways.push_back(way.id());
+    registered_closed_ways.insert(way.id());
     ++number_of_ways;
 }
 
@@ -115,20 +115,18 @@ void AreaManager::relation(const osmium::Relation &relation)
 /**
  * @brief Sort the members databases to prepare them for reading.
  *
- * Usually this is called between the first and second pass reading through an OSM data
- * file.
+ * This is called after the relations have been registered and before the pass that
+ * processes the ways. Closed ways can still be registered during that pass.
  */
-void AreaManager::prepare_for_lookup()
-{
-    RelationsManager::prepare_for_lookup();
-    std::sort(registered_closed_ways.begin(), registered_closed_ways.end());
-}
+void AreaManager::prepare_for_lookup() { RelationsManager::prepare_for_lookup(); }
 
 /**
  * @brief Return true if the given id belongs to a registered way.
+ *
+ * This function is thread-safe.
  */
 inline bool AreaManager::is_registered_closed_way(osmium::object_id_type osm_id) const
-{ return std::binary_search(registered_closed_ways.begin(), registered_closed_ways.end(), osm_id); }
+{ return registered_closed_ways.contains(osm_id); }
 
 /**
  * @brief Return the registered relations for the given way.
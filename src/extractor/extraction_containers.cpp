@@ -10,6 +10,7 @@
 
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
+#include "util/external_sort.hpp"
 #include "util/for_each_indexed.hpp"
 #include "util/for_each_pair.hpp"
 #include "util/log.hpp"
@@ -22,11 +23,19 @@
 #include <tbb/parallel_sort.h>
 
 #include <limits>
+#include <optional>
 
 namespace
 {
 namespace oe = osrm::extractor;
 
+struct CmpNodeByID
+{
+    using value_type = oe::QueryNode;
+    bool operator()(const value_type &lhs, const value_type &rhs) const
+    { return lhs.node_id < rhs.node_id; }
+};
+
 struct CmpEdgeByOSMStartID
 {
     using value_type = oe::InternalExtractorEdge;
@@ -374,7 +383,9 @@ get_via_node_path_from_OSM_ids(const std::string &turn_relation_type,
 namespace osrm::extractor
 {
 
-ExtractionContainers::ExtractionContainers()
+ExtractionContainers::ExtractionContainers(const std::size_t sort_memory_budget,
+                                           std::filesystem::path sort_directory)
+    : sort_memory_budget(sort_memory_budget), sort_directory(std::move(sort_directory))
 {
     // Insert four empty strings offsets for name, ref, destination, pronunciation, and exits
     name_offsets.push_back(0);
@@ -412,7 +423,35 @@ void ExtractionContainers::PrepareData(ScriptingEnvironment &scripting_environme
     way_node_id_offsets.clear();
     way_node_id_offsets.shrink_to_fit();
 
-    PrepareNodes();
+    if (sort_memory_budget > 0)
+    {
+        // The edges are not needed to prepare the nodes, so they wait on disk in the order
+        // in which they are processed first.
+        util::ExternalSorter<InternalExtractorEdge, CmpEdgeByOSMStartID> edges_by_start(
+            sort_directory, sort_memory_budget);
+        {
+            util::UnbufferedLog log;
+            log << "Spilling edges by start   ... " << std::flush;
+            TIMER_START(spill_edges);
+            edges_by_start.Spill(all_edges_list);
+            TIMER_STOP(spill_edges);
+            log << "ok, after " << TIMER_SEC(spill_edges) << "s, "
+                << edges_by_start.NumberOfRuns() << " runs";
+        }
+
+        PrepareNodes();
+
+        util::UnbufferedLog log;
+        log << "Merging edges by start    ... " << std::flush;
+        TIMER_START(merge_edges);
+        edges_by_start.Merge(all_edges_list);
+        TIMER_STOP(merge_edges);
+        log << "ok, after " << TIMER_SEC(merge_edges) << "s";
+    }
+    else
+    {
+        PrepareNodes();
+    }
     PrepareEdges(scripting_environment);
     scripting_environment.m_obstacle_map.fixupNodes(used_node_id_list);
 
@@ -441,6 +480,8 @@ void ExtractionContainers::PrepareNodes()
         util::UnbufferedLog log;
         log << "Sorting used nodes        ... " << std::flush;
         TIMER_START(sorting_used_nodes);
+        // Stays in memory even with a sort memory budget: the list is merged back into the
+        // same vector, so spilling it would not lower the peak memory.
         tbb::parallel_sort(used_node_id_list.begin(), used_node_id_list.end());
         TIMER_STOP(sorting_used_nodes);
         log << "ok, after " << TIMER_SEC(sorting_used_nodes) << "s";
@@ -456,14 +497,22 @@ void ExtractionContainers::PrepareNodes()
         log << "ok, after " << TIMER_SEC(erasing_dups) << "s";
     }
 
+    // With a sort memory budget the nodes stay on disk and are only read back while they are
+    // matched against the used nodes.
+    std::optional<util::ExternalSorter<QueryNode, CmpNodeByID>> sorted_nodes;
     {
         util::UnbufferedLog log;
         log << "Sorting all nodes         ... " << std::flush;
         TIMER_START(sorting_nodes);
-        tbb::parallel_sort(all_nodes_list.begin(),
-                           all_nodes_list.end(),
-                           [](const auto &left, const auto &right)
-                           { return left.node_id < right.node_id; });
+        if (sort_memory_budget > 0)
+        {
+            sorted_nodes.emplace(sort_directory, sort_memory_budget);
+            sorted_nodes->Spill(all_nodes_list);
+        }
+        else
+        {
+            tbb::parallel_sort(all_nodes_list.begin(), all_nodes_list.end(), CmpNodeByID());
+        }
         TIMER_STOP(sorting_nodes);
         log << "ok, after " << TIMER_SEC(sorting_nodes) << "s";
     }
@@ -473,34 +522,38 @@ void ExtractionContainers::PrepareNodes()
         log << "Building node id map      ... " << std::flush;
         TIMER_START(id_map);
         const auto original_used_count = used_node_id_list.size();
-        auto node_iter = all_nodes_list.begin();
         auto ref_iter = used_node_id_list.begin();
         auto used_nodes_iter = used_node_id_list.begin();
-        const auto all_nodes_list_end = all_nodes_list.end();
         const auto used_node_id_list_end = used_node_id_list.end();
 
-        // compute the intersection of nodes that were referenced and nodes we actually have
-        while (node_iter != all_nodes_list_end && ref_iter != used_node_id_list_end)
+        // compute the intersection of nodes that were referenced and nodes we actually have,
+        // both are sorted by their OSM id
+        const auto match_node = [&](const QueryNode &node)
         {
-            if (node_iter->node_id < *ref_iter)
+            while (ref_iter != used_node_id_list_end && *ref_iter < node.node_id)
             {
-                node_iter++;
-                continue;
+                ref_iter++;
             }
-            if (node_iter->node_id > *ref_iter)
+            if (ref_iter != used_node_id_list_end && *ref_iter == node.node_id)
             {
+                *used_nodes_iter = *ref_iter;
+                used_nodes_iter++;
                 ref_iter++;
-                continue;
+                used_nodes.push_back(node);
             }
-            BOOST_ASSERT(node_iter->node_id == *ref_iter);
-            *used_nodes_iter = *ref_iter;
-            used_nodes_iter++;
-            node_iter++;
-            ref_iter++;
+        };
+        if (sorted_nodes)
+        {
+            sorted_nodes->Merge(match_node);
+        }
+        else
+        {
+            std::for_each(all_nodes_list.begin(), all_nodes_list.end(), match_node);
         }
 
         // Remove unused nodes and check maximal internal node id
         used_node_id_list.resize(std::distance(used_node_id_list.begin(), used_nodes_iter));
+        BOOST_ASSERT(used_nodes.size() == used_node_id_list.size());
         const auto dropped_count = original_used_count - used_node_id_list.size();
         if (dropped_count > 0)
         {
@@ -518,35 +571,6 @@ void ExtractionContainers::PrepareNodes()
         TIMER_STOP(id_map);
         log << "ok, after " << TIMER_SEC(id_map) << "s";
     }
-    {
-        util::UnbufferedLog log;
-        log << "Confirming/Writing used nodes     ... ";
-        TIMER_START(write_nodes);
-        // identify all used nodes by a merging step of two sorted lists
-        auto node_iterator = all_nodes_list.begin();
-        const auto all_nodes_list_end = all_nodes_list.end();
-
-        for (const auto node_id : used_node_id_list)
-        {
-            BOOST_ASSERT(node_iterator != all_nodes_list_end);
-            BOOST_ASSERT(node_id >= node_iterator->node_id);
-            while (node_id > node_iterator->node_id && node_iterator != all_nodes_list_end)
-            {
-                ++node_iterator;
-            }
-            if (node_iterator == all_nodes_list_end || node_id < node_iterator->node_id)
-            {
-                throw util::exception("Invalid OSM data: Referenced non-existing node with ID " +
-                                      std::to_string(static_cast<std::uint64_t>(node_id)));
-            }
-            BOOST_ASSERT(node_id == node_iterator->node_id);
-
-            used_nodes.emplace_back(*node_iterator++);
-        }
-
-        TIMER_STOP(write_nodes);
-        log << "ok, after " << TIMER_SEC(write_nodes) << "s";
-    }
 
     all_nodes_list.clear();
     all_nodes_list.shrink_to_fit();
@@ -556,7 +580,9 @@ void ExtractionContainers::PrepareNodes()
 
 void ExtractionContainers::PrepareEdges(ScriptingEnvironment &scripting_environment)
 {
-    // Sort edges by start.
+    // Sort edges by start. With a sort memory budget they are already sorted, because they were
+    // merged back in this order after the nodes were prepared.
+    if (sort_memory_budget == 0)
     {
         util::UnbufferedLog log;
         log << "Sorting edges by start    ... " << std::flush;
@@ -11,7 +11,7 @@
 #include "extractor/files.hpp"
 #include "extractor/maneuver_override_relation_parser.hpp"
 #include "extractor/node_based_graph_factory.hpp"
-#include "extractor/node_locations_for_ways.hpp"
+#include "extractor/node_location_index.hpp"
 #include "extractor/node_restriction_map.hpp"
 #include "extractor/profile_properties.hpp"
 #include "extractor/restriction_graph.hpp"
@@ -30,6 +30,7 @@
 #include "util/exception_utils.hpp"
 #include "util/integer_range.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
 #include "util/tarjan_scc.hpp"
@@ -44,8 +45,6 @@
 #include <oneapi/tbb/parallel_for_each.h>
 #include <oneapi/tbb/parallel_pipeline.h>
 
-#include <osmium/handler/node_locations_for_ways.hpp>
-#include <osmium/index/map/flex_mem.hpp>
 #include <osmium/io/any_input.hpp>
 #include <osmium/io/xml_output.hpp>
 #include <osmium/storage/item_stash.hpp>
@@ -53,7 +52,10 @@
 #include <osmium/visitor.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -212,6 +214,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
 
     tbb::global_control gc(tbb::global_control::max_allowed_parallelism,
                            config.requested_num_threads);
+    util::PhaseTimer extract_phase("extract");
 
     auto parsed_osm_data = ParseOSMData(scripting_environment, number_of_threads);
 
@@ -231,6 +234,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     std::uint32_t ebg_connectivity_checksum = 0;
 
     // Create a node-based graph from the OSRM file
+    util::PhaseTimer node_based_graph_phase("node-based graph");
     NodeBasedGraphFactory node_based_graph_factory(scripting_environment,
                                                    parsed_osm_data.turn_restrictions,
                                                    parsed_osm_data.unresolved_maneuver_overrides,
@@ -239,14 +243,18 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                                                    parsed_osm_data.edge_list,
                                                    std::move(parsed_osm_data.annotation_data));
 
+    node_based_graph_phase.Stop();
+
     StringTable string_table;
     files::readNames(config.GetPath(".osrm.names"), string_table);
 
     util::Log() << "Find segregated edges in node-based graph ..." << std::flush;
     TIMER_START(segregated);
+    util::PhaseTimer segregated_phase("segregated edges");
 
     auto segregated_edges = guidance::findSegregatedNodes(node_based_graph_factory, string_table);
 
+    segregated_phase.Stop();
     TIMER_STOP(segregated);
     util::Log() << "ok, after " << TIMER_SEC(segregated) << "s";
     util::Log() << "Segregated edges count = " << segregated_edges.size();
@@ -275,14 +283,17 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     edge_based_nodes_container =
         EdgeBasedNodeDataContainer({}, std::move(node_based_graph_factory.GetAnnotationData()));
 
+    util::PhaseTimer restrictions_phase("restriction graph");
     parsed_osm_data.turn_restrictions =
         removeInvalidTurnPaths(std::move(parsed_osm_data.turn_restrictions), node_based_graph);
     parsed_osm_data.unresolved_maneuver_overrides = removeInvalidTurnPaths(
         std::move(parsed_osm_data.unresolved_maneuver_overrides), node_based_graph);
     auto restriction_graph = constructRestrictionGraph(parsed_osm_data.turn_restrictions);
+    restrictions_phase.Stop();
 
     const auto number_of_node_based_nodes = node_based_graph.GetNumberOfNodes();
 
+    util::PhaseTimer expansion_phase("edge expansion");
     const auto number_of_edge_based_nodes =
         BuildEdgeExpandedGraph(node_based_graph,
                                coordinates,
@@ -300,7 +311,9 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                                edge_based_node_distances,
                                edge_based_edge_list,
                                ebg_connectivity_checksum);
+    expansion_phase.Stop();
 
+    util::PhaseTimer guidance_phase("guidance");
     ProcessGuidanceTurns(node_based_graph,
                          edge_based_nodes_container,
                          coordinates,
@@ -309,6 +322,7 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
                          string_table,
                          std::move(parsed_osm_data.turn_lane_map),
                          scripting_environment);
+    guidance_phase.Stop();
 
     TIMER_STOP(expansion);
 
@@ -327,25 +341,31 @@ int Extractor::run(ScriptingEnvironment &scripting_environment)
     util::Log() << "Done writing. (" << TIMER_SEC(timer_write_node_weights) << ")";
 
     util::Log() << "Computing strictly connected components ...";
+    util::PhaseTimer components_phase("components");
     FindComponents(number_of_edge_based_nodes,
                    edge_based_edge_list,
                    edge_based_node_segments,
                    edge_based_nodes_container);
+    components_phase.Stop();
 
     util::Log() << "Building r-tree ...";
     TIMER_START(rtree);
+    util::PhaseTimer rtree_phase("r-tree");
     BuildRTree(std::move(edge_based_node_segments), coordinates);
 
+    rtree_phase.Stop();
     TIMER_STOP(rtree);
 
     files::writeNodeData(config.GetPath(".osrm.ebg_nodes"), edge_based_nodes_container);
 
     util::Log() << "Writing edge-based-graph edges       ... " << std::flush;
     TIMER_START(write_edges);
+    util::PhaseTimer write_edges_phase("writing edge-based graph");
     files::writeEdgeBasedGraph(config.GetPath(".osrm.ebg"),
                                number_of_edge_based_nodes,
                                edge_based_edge_list,
                                ebg_connectivity_checksum);
+    write_edges_phase.Stop();
     TIMER_STOP(write_edges);
     util::Log() << "ok, after " << TIMER_SEC(write_edges) << "s";
 
@@ -368,6 +388,7 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
                                                  const unsigned number_of_threads)
 {
     TIMER_START(extracting);
+    util::PhaseTimer extracting_phase("parsing");
 
     util::Log() << "Input file: " << config.input_path.filename().string();
     if (!config.profile_path.empty())
@@ -412,7 +433,10 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
     ProfileProperties profile_properties = scripting_environment.GetProfileProperties();
 
     // Extraction containers and restriction parser
-    ExtractionContainers extraction_containers;
+    const auto sort_directory =
+        config.sort_directory.empty() ? config.base_path.parent_path() : config.sort_directory;
+    ExtractionContainers extraction_containers(
+        std::size_t{config.sort_memory_budget} * 1024 * 1024, sort_directory);
     ExtractorCallbacks::ClassesMap classes_map;
     LaneDescriptionMap turn_lane_map;
     auto extractor_callbacks = std::make_unique<ExtractorCallbacks>(
@@ -441,19 +465,24 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
             });
     };
 
-    // Node locations cache (assumes nodes are placed before ways)
-    using osmium_index_type =
-        osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
-    using osmium_location_handler_type = osmium::handler::NodeLocationsForWays<osmium_index_type>;
-
-    osmium_index_type location_cache;
-    osmium_location_handler_type location_handler(location_cache);
+    // Node locations cache (assumes nodes are placed before ways). The nodes are stored in input
+    // order, after which the ways of a buffer can be completed in parallel.
+    std::optional<NodeLocationIndex> location_index;
+    std::atomic<std::size_t> number_of_missing_locations{0};
 
-    tbb::filter<OsmiumBuffer, OsmiumBuffer> location_cache_filter(
+    tbb::filter<OsmiumBuffer, OsmiumBuffer> store_locations_filter(
         tbb::filter_mode::serial_in_order,
-        [&location_handler](const OsmiumBuffer &buffer)
+        [&location_index](const OsmiumBuffer &buffer)
+        {
+            location_index->Store(*buffer);
+            return buffer;
+        });
+
+    tbb::filter<OsmiumBuffer, OsmiumBuffer> way_locations_filter(
+        tbb::filter_mode::parallel,
+        [&location_index, &number_of_missing_locations](const OsmiumBuffer &buffer)
         {
-            osmium::apply(buffer->begin(), buffer->end(), location_handler);
+            number_of_missing_locations += location_index->SetWayLocations(*buffer);
             return buffer;
         });
 
@@ -470,26 +499,28 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
             return results;
         });
 
-    // OSM elements Lua parser
-    tbb::filter<OsmiumBuffer, void> process_relation_filter(
-        tbb::filter_mode::parallel,
-        [&](const OsmiumBuffer &buffer) -> void
-        {
-            ScriptingResults results;
-            // keeps the buffer alive until the end of the pipe
-            results.osmium_buffer = buffer;
-            scripting_environment.ProcessRelation(results);
-        });
-
     // Parsed nodes and ways handler
     unsigned number_of_nodes = 0;
     unsigned number_of_ways = 0;
     unsigned number_of_restrictions = 0;
     unsigned number_of_maneuver_overrides = 0;
+    auto &area_manager = scripting_environment.m_area_manager;
+    bool collect_areas = false;
     tbb::filter<ScriptingResults, void> extractor_callbacks_filter(
         tbb::filter_mode::serial_in_order,
         [&](const ScriptingResults &results)
         {
+            // The profile has registered the closed ways of this buffer by now, so the area
+            // manager can collect them and the member ways of its relations in the same pass
+            if (collect_areas)
+            {
+                auto &area_handler = area_manager.handler();
+                for (const auto &way : results.osmium_buffer->select<osmium::Way>())
+                {
+                    area_handler.way(way);
+                }
+            }
+
             number_of_nodes += results.resulting_nodes.size();
             // put parsed objects thru extractor callbacks
             for (const auto &result : results.resulting_nodes)
@@ -517,13 +548,10 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
         });
 
     osmium::TagsFilter tags_filter{false};
-    tbb::filter<OsmiumBuffer, void> stash_relations_filter(
+    tbb::filter<OsmiumBuffer, OsmiumBuffer> stash_relations_filter(
         tbb::filter_mode::parallel,
-        [&](const OsmiumBuffer &buffer) -> void
+        [&](const OsmiumBuffer &buffer)
         {
-            if (!buffer)
-                return;
-
             for (const osmium::Relation &rel : buffer->select<osmium::Relation>())
             {
                 if (osmium::tags::match_any_of(rel.tags(), tags_filter))
@@ -531,6 +559,35 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
                     scripting_environment.m_relations_stash.add_relation(rel);
                 }
             };
+            return buffer;
+        });
+
+    // Only multipolygon relations can be registered as areas, so these are the only ones that
+    // are kept for LUA's process_relation function
+    std::vector<OsmiumBuffer> area_relations;
+    tbb::filter<OsmiumBuffer, OsmiumBuffer> keep_area_relations_filter(
+        tbb::filter_mode::serial_out_of_order,
+        [&](const OsmiumBuffer &buffer)
+        {
+            if (!area_manager.is_enabled())
+                return buffer;
+
+            auto kept = std::make_shared<osmium::memory::Buffer>(
+                1024, osmium::memory::Buffer::auto_grow::yes);
+            for (const osmium::Relation &rel : buffer->select<osmium::Relation>())
+            {
+                const char *type = rel.get_value_by_key("type");
+                if (type != nullptr && std::strcmp(type, "multipolygon") == 0)
+                {
+                    kept->add_item(rel);
+                    kept->commit();
+                }
+            }
+            if (kept->committed() > 0)
+            {
+                area_relations.push_back(std::move(kept));
+            }
+            return buffer;
         });
 
     // Parse OSM elements with parallel transformer
@@ -553,102 +610,106 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
             tags_filter.add_rule(true, osmium::TagMatcher("type", rel_type));
             util::Log() << "  " << rel_type;
         }
+    }
+    // Every read of the input decompresses all of its blocks, so each consumer of the relations
+    // is served by a single read: the stash, the candidates for pedestrian areas and the
+    // restrictions and maneuver overrides. Without it the relations are read with the ways.
+    const bool read_relations_first = !relation_types.empty() || area_manager.is_enabled();
+    if (read_relations_first)
+    {
         // Read the relations configured in `profile.relation_types`. We must read them
         // first because they are passed as argument to the LUA process_* functions.
         TIMER_START(parse_relations);
+        util::PhaseTimer relations_phase("relations");
 
         osmium::io::Reader reader(input_file, pool, osmium::osm_entity_bits::relation, read_meta);
-        tbb::parallel_pipeline(num_threads, reader_source(reader) & stash_relations_filter);
+        tbb::parallel_pipeline(num_threads,
+                               reader_source(reader) & stash_relations_filter &
+                                   keep_area_relations_filter & process_elements_filter &
+                                   extractor_callbacks_filter);
 
         TIMER_STOP(parse_relations);
         util::Log() << "... " << scripting_environment.m_relations_stash.get_relations_num()
                     << " relations in " << TIMER_SEC(parse_relations) << " seconds";
     }
-    auto &area_manager = scripting_environment.m_area_manager;
     if (area_manager.is_enabled())
     {
-        // Next we read the relations again and pass them to LUA's process_relation
-        // function, so they can be registered for meshing.  Unfortunately we cannot
-        // combine this run with the run above because we need its results, for example:
-        // The user may want to mesh only those areas that are part of a hiking route.
+        // Next we pass the kept relations to LUA's process_relation function, so they can
+        // be registered for meshing. This has to wait until all relations are stashed
+        // because it may need them, for example: The user may want to mesh only those
+        // areas that are part of a hiking route.
         util::Log() << "Register pedestrian areas ...";
-        TIMER_START(areas_first_pass);
-
-        osmium::io::Reader reader(input_file, pool, osmium::osm_entity_bits::relation, read_meta);
-        tbb::parallel_pipeline(num_threads, reader_source(reader) & process_relation_filter);
-
-        TIMER_STOP(areas_first_pass);
+        TIMER_START(register_areas);
+        util::PhaseTimer register_areas_phase("area registration");
+
+        tbb::parallel_for_each(area_relations,
+                               [&](const OsmiumBuffer &buffer)
+                               {
+                                   ScriptingResults results;
+                                   results.osmium_buffer = buffer;
+                                   scripting_environment.ProcessRelation(results);
+                               });
+        area_relations.clear();
+
+        TIMER_STOP(register_areas);
         util::Log() << "... " << area_manager.number_of_relations << " pedestrian areas in "
-                    << TIMER_SEC(areas_first_pass) << " seconds";
+                    << TIMER_SEC(register_areas) << " seconds";
         // At this point we know the relations and the way ids of their members.
+        area_manager.prepare_for_lookup();
+        collect_areas = true;
     }
     {
-        util::Log() << "Parse ways and nodes and restrictions ...";
+        util::Log() << (read_relations_first ? "Parse ways and nodes ..."
+                                             : "Parse ways and nodes and restrictions ...");
         TIMER_START(parse_ways);
-        osmium::io::Reader reader(input_file,
-                                  pool,
-                                  osmium::osm_entity_bits::node | osmium::osm_entity_bits::way |
-                                      osmium::osm_entity_bits::relation,
-                                  read_meta);
-
-        const auto pipeline =
-            scripting_environment.HasLocationDependentData() && config.use_locations_cache
-                ? reader_source(reader) & location_cache_filter & process_elements_filter &
-                      extractor_callbacks_filter
-                : reader_source(reader) & process_elements_filter & extractor_callbacks_filter;
-        tbb::parallel_pipeline(num_threads, pipeline);
-        TIMER_STOP(parse_ways);
-        util::Log() << "... in " << TIMER_SEC(parse_ways) << " seconds";
-    }
-
-    if (area_manager.number_of_ways + area_manager.number_of_relations)
-    {
-        util::Log() << "Parse pedestrian areas ...";
-        TIMER_START(areas_second_pass);
-
-        area_manager.prepare_for_lookup();
-
-        // After the first pass the manager knows which ways and which relations we want
-        // to mesh. In the second pass it will complete the relations with ways, nodes
-        // and locations. This is the second pass.
-
-        tbb::filter<OsmiumBuffer, void> manager_second_pass_filter(
-            tbb::filter_mode::serial_out_of_order,
-            [&area_manager](const OsmiumBuffer &buffer)
-            { osmium::apply(buffer->begin(), buffer->end(), area_manager.handler()); });
-
-        osmium::io::Reader reader(input_file, pool, osmium::osm_entity_bits::way, read_meta);
-        if (config.use_locations_cache)
+        util::PhaseTimer ways_phase("ways");
+        const auto entity_bits = read_relations_first ? osmium::osm_entity_bits::node |
+                                                            osmium::osm_entity_bits::way
+                                                      : osmium::osm_entity_bits::node |
+                                                            osmium::osm_entity_bits::way |
+                                                            osmium::osm_entity_bits::relation;
+        osmium::io::Reader reader(input_file, pool, entity_bits, read_meta);
+
+        // Without the cache the locations have been added to the ways of the OSM file
+        if ((scripting_environment.HasLocationDependentData() || collect_areas) &&
+            config.use_locations_cache)
         {
-            auto area_location_handler = NodeLocationsForWays(extraction_containers.all_nodes_list);
-            area_location_handler.prepare_for_lookup();
-
-            tbb::filter<OsmiumBuffer, OsmiumBuffer> area_location_cache_filter(
-                tbb::filter_mode::parallel,
-                [&area_location_handler](const OsmiumBuffer &buffer)
-                {
-                    osmium::apply(buffer->begin(), buffer->end(), area_location_handler);
-                    return buffer;
-                });
-
+            if (config.use_locations_cache_file)
+            {
+                location_index.emplace(sort_directory);
+            }
+            else
+            {
+                location_index.emplace();
+            }
             tbb::parallel_pipeline(num_threads,
-                                   reader_source(reader) & area_location_cache_filter &
-                                       manager_second_pass_filter);
+                                   reader_source(reader) & store_locations_filter &
+                                       way_locations_filter & process_elements_filter &
+                                       extractor_callbacks_filter);
+            location_index.reset();
+            if (number_of_missing_locations > 0)
+            {
+                util::Log(logWARNING) << number_of_missing_locations
+                                      << " way nodes are missing from the input file";
+            }
         }
         else
         {
-            // location data has been provided by preprocessing the OSM file
-            tbb::parallel_pipeline(num_threads, reader_source(reader) & manager_second_pass_filter);
+            tbb::parallel_pipeline(num_threads,
+                                   reader_source(reader) & process_elements_filter &
+                                       extractor_callbacks_filter);
         }
-        reader.close();
-        TIMER_STOP(areas_second_pass);
-
-        util::Log() << "... " << area_manager.number_of_relations << " multipolygon relations and "
-                    << area_manager.number_of_ways << " closed ways in "
-                    << TIMER_SEC(areas_second_pass) << " seconds";
+        TIMER_STOP(parse_ways);
+        util::Log() << "... in " << TIMER_SEC(parse_ways) << " seconds";
+        // the meshed areas go through the same filters
+        collect_areas = false;
+    }
 
+    if (area_manager.number_of_ways + area_manager.number_of_relations)
+    {
         util::Log() << "Mesh pedestrian areas ...";
         TIMER_START(mesh);
+        util::PhaseTimer mesh_phase("area meshing");
         // The manager has collected all information and assembled it into osmium::areas
         // in a big buffer.
 
@@ -686,6 +747,7 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
 
     TIMER_STOP(parsing);
     util::Log() << "Parsing finished after " << TIMER_SEC(parsing) << " seconds";
+    scripting_environment.LogStatistics();
 
     util::Log() << "Raw input contains " << number_of_nodes << " nodes, " << number_of_ways
                 << " ways, and " << scripting_environment.m_relations_stash.get_relations_num()
@@ -699,14 +761,17 @@ Extractor::ParsedOSMData Extractor::ParseOSMData(ScriptingEnvironment &scripting
                               SOURCE_REF);
     }
 
+    util::PhaseTimer prepare_phase("preparing data");
     extraction_containers.PrepareData(scripting_environment,
                                       config.GetPath(".osrm.names").string());
+    prepare_phase.Stop();
 
     SetClassNames(scripting_environment.GetClassNames(), classes_map, profile_properties);
     auto excludable_classes = scripting_environment.GetExcludableClasses();
     SetExcludableClasses(classes_map, excludable_classes, profile_properties);
     files::writeProfileProperties(config.GetPath(".osrm.properties").string(), profile_properties);
 
+    extracting_phase.Stop();
     TIMER_STOP(extracting);
     util::Log() << "extraction finished after " << TIMER_SEC(extracting) << "s";
 
@@ -835,9 +900,12 @@ EdgeID Extractor::BuildEdgeExpandedGraph(
     const auto create_edge_based_edges = [&]()
     {
         // scoped to release intermediate data structures right after the call
+        TIMER_START(restriction_maps);
         RestrictionMap unconditional_node_restriction_map(restriction_graph);
         ConditionalRestrictionMap conditional_node_restriction_map(restriction_graph);
         WayRestrictionMap via_way_restriction_map(restriction_graph);
+        TIMER_STOP(restriction_maps);
+        util::Log() << "Constructed restriction maps after " << TIMER_SEC(restriction_maps) << "s";
         edge_based_graph_factory.Run(scripting_environment,
                                      config.GetPath(".osrm.turn_weight_penalties").string(),
                                      config.GetPath(".osrm.turn_duration_penalties").string(),
@@ -1019,6 +1087,7 @@ void Extractor::ProcessGuidanceTurns(
         RestrictionMap unconditional_node_restriction_map(restriction_graph);
         WayRestrictionMap way_restriction_map(restriction_graph);
 
+        util::PhaseTimer annotation_phase("annotation");
         osrm::guidance::annotateTurns(node_based_graph,
                                       edge_based_node_container,
                                       node_coordinates,
@@ -1,38 +1,77 @@
 #include "extractor/location_dependent_data.hpp"
 
 #include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/geojson_validation.hpp"
 
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
 
-#include "util/iterator_adapters.hpp"
-#include <boost/geometry/algorithms/equals.hpp>
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <numeric>
 #include <string>
 
 namespace osrm::extractor
 {
 
+namespace
+{
+// Liang-Barsky clipping of the segment against the box, true if any part of it is in the box
+bool intersects(const LocationDependentData::segment_t &segment,
+                const LocationDependentData::box_t &box)
+{
+    const auto from_x = segment.first.x(), from_y = segment.first.y();
+    const auto dx = segment.second.x() - from_x, dy = segment.second.y() - from_y;
+
+    double enter = 0, leave = 1;
+    const auto clip = [&](const double p, const double q)
+    {
+        if (p == 0)
+            return q >= 0;
+        const auto t = q / p;
+        if (p < 0)
+            enter = std::max(enter, t);
+        else
+            leave = std::min(leave, t);
+        return enter <= leave;
+    };
+
+    return clip(-dx, from_x - box.min_corner().x()) && clip(dx, box.max_corner().x() - from_x) &&
+           clip(-dy, from_y - box.min_corner().y()) && clip(dy, box.max_corner().y() - from_y);
+}
+
+// polygons without coordinates have an envelope with min > max
+bool isEmpty(const LocationDependentData::box_t &box)
+{ return box.min_corner().x() > box.max_corner().x(); }
+} // namespace
+
 LocationDependentData::LocationDependentData(const std::vector<std::filesystem::path> &file_paths)
 {
-    std::vector<rtree_t::value_type> bounding_boxes;
+    std::vector<std::vector<segment_t>> polygon_segments;
     for (const auto &path : file_paths)
     {
-        loadLocationDependentData(path, bounding_boxes);
+        loadLocationDependentData(path, polygon_segments);
     }
 
-    // Create R-tree for bounding boxes of collected polygons
-    rtree = rtree_t(bounding_boxes);
+    buildCellIndex(polygon_segments);
     util::Log() << "Parsed " << properties.size() << " location-dependent features with "
-                << polygons.size() << " GeoJSON polygons";
+                << polygons.size() << " GeoJSON polygons into " << columns << "x" << rows
+                << " cells";
 }
 
 void LocationDependentData::loadLocationDependentData(
-    const std::filesystem::path &file_path, std::vector<rtree_t::value_type> &bounding_boxes)
+    const std::filesystem::path &file_path, std::vector<std::vector<segment_t>> &polygon_segments)
 {
     if (file_path.empty())
         return;
@@ -88,7 +127,7 @@ void LocationDependentData::loadLocationDependentData(
         return index;
     };
 
-    auto index_polygon = [this, &bounding_boxes](const auto &rings, auto properties_index)
+    auto index_polygon = [this, &polygon_segments](const auto &rings, auto properties_index)
     {
         // At least an outer ring in polygon https://tools.ietf.org/html/rfc7946#section-3.1.6
         BOOST_ASSERT(rings.Size() > 0);
@@ -106,8 +145,8 @@ void LocationDependentData::loadLocationDependentData(
             using coord_t = boost::geometry::traits::coordinate_type<point_t>::type;
             auto x_min = std::numeric_limits<coord_t>::max();
             auto y_min = std::numeric_limits<coord_t>::max();
-            auto x_max = std::numeric_limits<coord_t>::min();
-            auto y_max = std::numeric_limits<coord_t>::min();
+            auto x_max = std::numeric_limits<coord_t>::lowest();
+            auto y_max = std::numeric_limits<coord_t>::lowest();
             if (!coordinates_array.Empty())
             {
                 point_t curr = to_point(coordinates_array[0]), next;
@@ -126,7 +165,6 @@ void LocationDependentData::loadLocationDependentData(
         };
 
         auto envelop = append_ring_segments(rings[0].GetArray());
-        bounding_boxes.emplace_back(envelop, polygons.size());
         for (rapidjson::SizeType iring = 1; iring < rings.Size(); ++iring)
         {
             append_ring_segments(rings[iring].GetArray());
@@ -164,7 +202,8 @@ void LocationDependentData::loadLocationDependentData(
             }
         }
 
-        polygons.emplace_back(std::make_pair(bands, properties_index));
+        polygons.push_back({envelop, std::move(bands), properties_index});
+        polygon_segments.push_back(std::move(segments));
     };
 
     for (rapidjson::SizeType ifeature = 0; ifeature < features_array.Size(); ifeature++)
@@ -210,75 +249,245 @@ LocationDependentData::FindByKey(const std::vector<std::size_t> &property_indexe
     return property_t{};
 }
 
-std::vector<std::size_t> LocationDependentData::GetPropertyIndexes(const point_t &point) const
+void LocationDependentData::buildCellIndex(
+    const std::vector<std::vector<segment_t>> &polygon_segments)
 {
-    std::vector<std::size_t> result;
-    auto inserter = [this, &result](const rtree_t::value_type &rtree_entry)
-    {
-        const auto properties_index = polygons[rtree_entry.second].second;
-        result.push_back(properties_index);
-    };
+    if (polygons.empty())
+        return;
 
-    // Search the R-tree and collect a Lua table of tags that correspond to the location
-    rtree.query(
-        boost::geometry::index::intersects(point) &&
-            boost::geometry::index::satisfies(
-                [this, &point](const rtree_t::value_type &v)
-                {
-                    // Simple point-in-polygon algorithm adapted from
-                    // https://www.ecse.rpi.edu/Homepages/wrf/Research/Short_Notes/pnpoly.html
+    if (polygons.size() >= BOUNDARY_CELL)
+    {
+        throw osrm::util::exception("Too many location-dependent polygons" + SOURCE_REF);
+    }
 
-                    const auto &envelop = v.first;
-                    const auto &bands = polygons[v.second].first;
+    point_t min_corner{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    point_t max_corner{std::numeric_limits<double>::lowest(),
+                       std::numeric_limits<double>::lowest()};
+    for (const auto &polygon : polygons)
+    {
+        if (isEmpty(polygon.envelope))
+            continue;
+        min_corner.x(std::min(min_corner.x(), polygon.envelope.min_corner().x()));
+        min_corner.y(std::min(min_corner.y(), polygon.envelope.min_corner().y()));
+        max_corner.x(std::max(max_corner.x(), polygon.envelope.max_corner().x()));
+        max_corner.y(std::max(max_corner.y(), polygon.envelope.max_corner().y()));
+    }
+    if (min_corner.x() > max_corner.x())
+        return;
+    grid_envelope = box_t{min_corner, max_corner};
+    const auto width = grid_envelope.max_corner().x() - grid_envelope.min_corner().x();
+    const auto height = grid_envelope.max_corner().y() - grid_envelope.min_corner().y();
+    cell_size = std::max(width, height) / MAX_CELLS_PER_SIDE;
+    const auto cells_per_side = [this](const double extent)
+    {
+        if (cell_size <= 0)
+            return std::size_t{1};
+        return std::clamp<std::size_t>(std::ceil(extent / cell_size), 1, MAX_CELLS_PER_SIDE);
+    };
+    columns = cells_per_side(width);
+    rows = cells_per_side(height);
 
-                    const auto y_min = envelop.min_corner().y();
-                    const auto y_max = envelop.max_corner().y();
-                    const auto dy = (y_max - y_min) / bands.size();
+    const auto cell_box = [this](const std::size_t column, const std::size_t row)
+    {
+        // grown a little, so that points that are rounded into a neighbouring cell are still
+        // classified by the boundary test of that cell
+        const auto margin = cell_size * 1e-6;
+        const auto x = grid_envelope.min_corner().x() + column * cell_size;
+        const auto y = grid_envelope.min_corner().y() + row * cell_size;
+        return box_t{{x - margin, y - margin}, {x + cell_size + margin, y + cell_size + margin}};
+    };
 
-                    std::size_t band = (point.y() - y_min) / dy;
-                    if (band >= bands.size())
+    // the cells of every polygon, with BOUNDARY_CELL set on the cells its boundary crosses
+    std::vector<std::vector<std::pair<std::uint32_t, bool>>> polygon_cells(polygons.size());
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, polygons.size()),
+        [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            for (auto position = range.begin(); position != range.end(); ++position)
+            {
+                const auto &envelope = polygons[position].envelope;
+                if (isEmpty(envelope))
+                    continue;
+
+                const auto first_column = GetColumn(envelope.min_corner().x());
+                const auto last_column = GetColumn(envelope.max_corner().x());
+                const auto first_row = GetRow(envelope.min_corner().y());
+                const auto last_row = GetRow(envelope.max_corner().y());
+                const auto envelope_columns = last_column - first_column + 1;
+
+                std::vector<bool> boundary(envelope_columns * (last_row - first_row + 1));
+                for (const auto &segment : polygon_segments[position])
+                {
+                    const auto [min_x, max_x] = std::minmax(segment.first.x(), segment.second.x());
+                    const auto [min_y, max_y] = std::minmax(segment.first.y(), segment.second.y());
+                    // the neighbouring cells are included for their margin
+                    const auto from_column = std::max(GetColumn(min_x), first_column + 1) - 1;
+                    const auto to_column = std::min(GetColumn(max_x) + 1, last_column);
+                    const auto from_row = std::max(GetRow(min_y), first_row + 1) - 1;
+                    const auto to_row = std::min(GetRow(max_y) + 1, last_row);
+                    for (auto row = from_row; row <= to_row; ++row)
                     {
-                        band = bands.size() - 1;
+                        for (auto column = from_column; column <= to_column; ++column)
+                        {
+                            const auto cell = (row - first_row) * envelope_columns +
+                                              (column - first_column);
+                            if (!boundary[cell] && intersects(segment, cell_box(column, row)))
+                                boundary[cell] = true;
+                        }
                     }
+                }
 
-                    bool inside = false;
-
-                    for (const auto &segment : bands[band])
+                // cells that no boundary crosses are either inside or outside of the polygon
+                auto &cells = polygon_cells[position];
+                for (auto row = first_row; row <= last_row; ++row)
+                {
+                    for (auto column = first_column; column <= last_column; ++column)
                     {
-                        const auto point_x = point.x(), point_y = point.y();
-                        const auto from_x = segment.first.x(), from_y = segment.first.y();
-                        const auto to_x = segment.second.x(), to_y = segment.second.y();
-
-                        if (to_y == from_y)
-                        { // handle horizontal segments: check if on boundary or skip
-                            if ((to_y == point_y) &&
-                                (from_x == point_x || (to_x > point_x) != (from_x > point_x)))
-                                return true;
-                            continue;
+                        const auto cell = static_cast<std::uint32_t>(row * columns + column);
+                        const auto index =
+                            (row - first_row) * envelope_columns + (column - first_column);
+                        if (boundary[index])
+                        {
+                            cells.emplace_back(cell, true);
                         }
-
-                        if ((to_y > point_y) != (from_y > point_y))
+                        else
                         {
-                            const auto ax = to_x - from_x;
-                            const auto ay = to_y - from_y;
-                            const auto tx = point_x - from_x;
-                            const auto ty = point_y - from_y;
+                            const point_t center{
+                                grid_envelope.min_corner().x() + (column + 0.5) * cell_size,
+                                grid_envelope.min_corner().y() + (row + 0.5) * cell_size};
+                            if (IsInside(center, position))
+                                cells.emplace_back(cell, false);
+                        }
+                    }
+                }
+            }
+        });
+
+    // flatten the cells, the polygons of a cell stay in their order
+    std::size_t number_of_entries = 0;
+    for (const auto &cells : polygon_cells)
+    {
+        number_of_entries += cells.size();
+    }
+    if (number_of_entries > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw osrm::util::exception("Too many cells of location-dependent polygons" + SOURCE_REF);
+    }
+    cell_offsets.assign(columns * rows + 1, 0);
+    for (const auto &cells : polygon_cells)
+    {
+        for (const auto &[cell, boundary] : cells)
+            ++cell_offsets[cell + 1];
+    }
+    std::partial_sum(cell_offsets.begin(), cell_offsets.end(), cell_offsets.begin());
 
-                            const auto cross_product = tx * ay - ax * ty;
+    auto positions = cell_offsets;
+    cell_entries.resize(cell_offsets.back());
+    for (const auto position : util::irange<std::size_t>(0, polygon_cells.size()))
+    {
+        for (const auto &[cell, boundary] : polygon_cells[position])
+        {
+            cell_entries[positions[cell]++] =
+                static_cast<std::uint32_t>(position) | (boundary ? BOUNDARY_CELL : 0);
+        }
+    }
+}
 
-                            if (cross_product == 0)
-                                return true;
+std::size_t LocationDependentData::GetColumn(const double x) const
+{
+    if (cell_size <= 0)
+        return 0;
+    const auto column = std::floor((x - grid_envelope.min_corner().x()) / cell_size);
+    return std::clamp<double>(column, 0, columns - 1);
+}
 
-                            if ((ay > 0) == (cross_product > 0))
-                            {
-                                inside = !inside;
-                            }
-                        }
-                    }
+std::size_t LocationDependentData::GetRow(const double y) const
+{
+    if (cell_size <= 0)
+        return 0;
+    const auto row = std::floor((y - grid_envelope.min_corner().y()) / cell_size);
+    return std::clamp<double>(row, 0, rows - 1);
+}
+
+bool LocationDependentData::IsInside(const point_t &point, const polygon_position_t position) const
+{
+    // Simple point-in-polygon algorithm adapted from
+    // https://www.ecse.rpi.edu/Homepages/wrf/Research/Short_Notes/pnpoly.html
+
+    const auto &envelop = polygons[position].envelope;
+    const auto &bands = polygons[position].bands;
+
+    if (point.x() < envelop.min_corner().x() || point.x() > envelop.max_corner().x() ||
+        point.y() < envelop.min_corner().y() || point.y() > envelop.max_corner().y())
+        return false;
+
+    const auto y_min = envelop.min_corner().y();
+    const auto y_max = envelop.max_corner().y();
+    const auto dy = (y_max - y_min) / bands.size();
+
+    std::size_t band = (point.y() - y_min) / dy;
+    if (band >= bands.size())
+    {
+        band = bands.size() - 1;
+    }
+
+    bool inside = false;
 
-                    return inside;
-                }),
-        osrm::util::make_function_output_iterator(std::ref(inserter)));
+    for (const auto &segment : bands[band])
+    {
+        const auto point_x = point.x(), point_y = point.y();
+        const auto from_x = segment.first.x(), from_y = segment.first.y();
+        const auto to_x = segment.second.x(), to_y = segment.second.y();
+
+        if (to_y == from_y)
+        { // handle horizontal segments: check if on boundary or skip
+            if ((to_y == point_y) &&
+                (from_x == point_x || (to_x > point_x) != (from_x > point_x)))
+                return true;
+            continue;
+        }
+
+        if ((to_y > point_y) != (from_y > point_y))
+        {
+            const auto ax = to_x - from_x;
+            const auto ay = to_y - from_y;
+            const auto tx = point_x - from_x;
+            const auto ty = point_y - from_y;
+
+            const auto cross_product = tx * ay - ax * ty;
+
+            if (cross_product == 0)
+                return true;
+
+            if ((ay > 0) == (cross_product > 0))
+            {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+std::vector<std::size_t> LocationDependentData::GetPropertyIndexes(const point_t &point) const
+{
+    std::vector<std::size_t> result;
+    if (cell_offsets.empty() || point.x() < grid_envelope.min_corner().x() ||
+        point.x() > grid_envelope.max_corner().x() || point.y() < grid_envelope.min_corner().y() ||
+        point.y() > grid_envelope.max_corner().y())
+        return result;
+
+    const auto cell = GetRow(point.y()) * columns + GetColumn(point.x());
+    for (auto index = cell_offsets[cell]; index < cell_offsets[cell + 1]; ++index)
+    {
+        const auto entry = cell_entries[index];
+        const auto position = entry & ~BOUNDARY_CELL;
+        // only polygons whose boundary crosses the cell need the exact test
+        if (!(entry & BOUNDARY_CELL) || IsInside(point, position))
+        {
+            result.push_back(polygons[position].properties_index);
+        }
+    }
 
     return result;
 }
@@ -0,0 +1,343 @@
+#include "extractor/native_way_handlers.hpp"
+
+#include "extractor/travel_mode.hpp"
+
+#include <osmium/osm/way.hpp>
+
+#include <cstring>
+
+namespace osrm::extractor
+{
+
+namespace
+{
+
+// Like way:get_value_by_key in the profiles, which returns nil for empty values
+const char *getValue(const osmium::Way &way, const std::string &key)
+{
+    const char *value = way.get_value_by_key(key.c_str());
+    return (value && *value) ? value : nullptr;
+}
+
+bool equals(const char *value, const char *expected)
+{ return value != nullptr && std::strcmp(value, expected) == 0; }
+
+bool contains(const std::unordered_set<std::string> &set, const std::optional<std::string> &value)
+{ return value && set.contains(*value); }
+
+// the characters matched by %s in Lua patterns
+bool isLuaSpace(const char character) { return std::strchr(" \t\n\v\f\r", character) != nullptr; }
+
+} // namespace
+
+NativeWayHandlers::NativeWayHandlers(NativeWayHandlersConfig config_) : config(std::move(config_))
+{
+    const auto directional = [](const std::string &key)
+    { return DirectionalKey{key, key + ":forward", key + ":backward"}; };
+
+    for (const auto &key : config.access_tags_hierarchy)
+    {
+        access_keys.push_back(directional(key));
+    }
+    for (const auto &restriction : config.restrictions)
+    {
+        oneway_keys.push_back("oneway:" + restriction);
+    }
+    toll_key = directional("toll");
+    route_key = directional("route");
+}
+
+// Picks the most permissive of the values of an access tag with several values, as
+// resolve_access in profiles/lib/access.lua
+std::optional<std::string> NativeWayHandlers::ResolveAccess(const char *value) const
+{
+    if (value == nullptr)
+        return std::nullopt;
+
+    const std::string_view values(value);
+    if (values.find(';') == std::string_view::npos)
+        return std::string(values);
+
+    const auto classify = [this](const std::string &part)
+    {
+        if (config.access_tag_whitelist.contains(part))
+            return 3;
+        if (config.restricted_access_tag_list.contains(part))
+            return 2;
+        if (config.access_tag_blacklist.contains(part))
+            return 1;
+        return 0;
+    };
+
+    std::optional<std::string> best;
+    int best_priority = -1;
+    std::size_t begin = 0;
+    while (begin < values.size())
+    {
+        auto end = values.find(';', begin);
+        if (end == std::string_view::npos)
+            end = values.size();
+
+        if (end > begin)
+        {
+            auto first = begin;
+            auto last = end;
+            while (first < last && isLuaSpace(values[first]))
+                ++first;
+            while (last > first && isLuaSpace(values[last - 1]))
+                --last;
+
+            std::string part(values.substr(first, last - first));
+            const auto priority = classify(part);
+            if (priority > best_priority)
+            {
+                best = std::move(part);
+                best_priority = priority;
+            }
+        }
+        begin = end + 1;
+    }
+
+    return best ? best : std::string(values);
+}
+
+bool NativeWayHandlers::Access(const osmium::Way &way,
+                               ExtractionWay &result,
+                               NativeWayHandlersData &data) const
+{
+    // Tags.get_forward_backward_by_set
+    const char *forward = nullptr;
+    const char *backward = nullptr;
+    for (const auto &key : access_keys)
+    {
+        if (!forward)
+            forward = getValue(way, key.forward);
+        if (!backward)
+            backward = getValue(way, key.backward);
+        if (!forward || !backward)
+        {
+            const auto common = getValue(way, key.key);
+            forward = forward ? forward : common;
+            backward = backward ? backward : common;
+        }
+        if (forward && backward)
+            break;
+    }
+
+    data.forward_access = ResolveAccess(forward);
+    data.backward_access = ResolveAccess(backward);
+
+    // only allow a subset of roads to be treated as restricted
+    if (contains(config.restricted_highway_whitelist, data.highway))
+    {
+        if (contains(config.restricted_access_tag_list, data.forward_access))
+            result.forward_restricted = true;
+        if (contains(config.restricted_access_tag_list, data.backward_access))
+            result.backward_restricted = true;
+    }
+
+    // blacklist access tags that aren't marked as restricted
+    if (contains(config.access_tag_blacklist, data.forward_access) && !result.forward_restricted)
+        result.forward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+    if (contains(config.access_tag_blacklist, data.backward_access) && !result.backward_restricted)
+        result.backward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+
+    return result.forward_travel_mode != TRAVEL_MODE_INACCESSIBLE ||
+           result.backward_travel_mode != TRAVEL_MODE_INACCESSIBLE;
+}
+
+bool NativeWayHandlers::Oneway(const osmium::Way &way,
+                               ExtractionWay &result,
+                               NativeWayHandlersData &data) const
+{
+    using OnewayHandling = NativeWayHandlersConfig::OnewayHandling;
+    if (config.oneway_handling == OnewayHandling::Disabled)
+        return true;
+
+    // Tags.get_value_by_prefixed_sequence
+    const auto specific_oneway = [&]() -> const char *
+    {
+        for (const auto &key : oneway_keys)
+        {
+            if (const auto value = getValue(way, key))
+                return value;
+        }
+        return nullptr;
+    };
+    const auto any_oneway = [&]
+    {
+        const auto value = specific_oneway();
+        return value ? value : getValue(way, "oneway");
+    };
+
+    const char *oneway = nullptr;
+    switch (config.oneway_handling)
+    {
+    case OnewayHandling::All:
+        oneway = any_oneway();
+        break;
+    case OnewayHandling::Specific:
+        oneway = specific_oneway();
+        break;
+    case OnewayHandling::Conditional:
+        // takes the weakest of oneway and oneway:conditional, see WayHandlers.oneway
+        oneway = getValue(way, "oneway:conditional") ? "no" : any_oneway();
+        break;
+    default:
+        break;
+    }
+
+    data.oneway = oneway ? std::optional<std::string>(oneway) : std::nullopt;
+
+    if (equals(oneway, "-1"))
+    {
+        data.is_reverse_oneway = true;
+        result.forward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+    }
+    else if (equals(oneway, "yes") || equals(oneway, "1") || equals(oneway, "true"))
+    {
+        data.is_forward_oneway = true;
+        result.backward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+    }
+    else if (config.oneway_handling == OnewayHandling::All)
+    {
+        const auto junction = getValue(way, "junction");
+        if ((data.highway == "motorway" || equals(junction, "roundabout") ||
+             equals(junction, "circular")) &&
+            !equals(oneway, "no"))
+        {
+            // implied oneway
+            data.is_forward_oneway = true;
+            result.backward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+        }
+    }
+
+    return true;
+}
+
+bool NativeWayHandlers::Speed(const osmium::Way &way,
+                              ExtractionWay &result,
+                              NativeWayHandlersData &data) const
+{
+    // abort if already set, eg. by a route
+    if (result.forward_speed != -1)
+        return true;
+
+    // Tags.get_constant_by_key_value
+    std::optional<double> speed;
+    for (const auto &[key, speeds] : config.speeds)
+    {
+        const auto value = getValue(way, key);
+        if (!value)
+            continue;
+        const auto found = speeds.find(value);
+        if (found != speeds.end())
+        {
+            speed = found->second;
+            break;
+        }
+    }
+
+    if (speed)
+    {
+        // set speed by way type
+        result.forward_speed = *speed;
+        result.backward_speed = *speed;
+    }
+    else
+    {
+        // Set the avg speed on ways that are marked accessible, or whose access tag is not
+        // blacklisted
+        if (contains(config.access_tag_whitelist, data.forward_access) ||
+            (data.forward_access && !contains(config.access_tag_blacklist, data.forward_access)))
+            result.forward_speed = config.default_speed;
+        else if (!data.forward_access && data.backward_access)
+            result.forward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+
+        if (contains(config.access_tag_whitelist, data.backward_access) ||
+            (data.backward_access && !contains(config.access_tag_blacklist, data.backward_access)))
+            result.backward_speed = config.default_speed;
+        else if (!data.backward_access && data.forward_access)
+            result.backward_travel_mode = TRAVEL_MODE_INACCESSIBLE;
+    }
+
+    return result.forward_speed != -1 || result.backward_speed != -1 || result.duration > 0;
+}
+
+bool NativeWayHandlers::Classes(const osmium::Way &way,
+                                ExtractionWay &result,
+                                NativeWayHandlersData &data) const
+{
+    if (!config.classes)
+        return true;
+    const auto &allowed_classes = *config.classes;
+
+    // Tags.get_forward_backward_by_key
+    const auto forward_backward = [&](const DirectionalKey &key)
+    {
+        auto forward = getValue(way, key.forward);
+        auto backward = getValue(way, key.backward);
+        if (!forward || !backward)
+        {
+            const auto common = getValue(way, key.key);
+            if (data.is_forward_oneway)
+            {
+                forward = forward ? forward : common;
+            }
+            else if (data.is_reverse_oneway)
+            {
+                backward = backward ? backward : common;
+            }
+            else
+            {
+                forward = forward ? forward : common;
+                backward = backward ? backward : common;
+            }
+        }
+        return std::make_pair(forward, backward);
+    };
+
+    const auto [forward_toll, backward_toll] = forward_backward(toll_key);
+    const auto [forward_route, backward_route] = forward_backward(route_key);
+    const auto tunnel = getValue(way, "tunnel");
+
+    if (allowed_classes.contains("tunnel") && tunnel && !equals(tunnel, "no"))
+    {
+        result.forward_classes["tunnel"] = true;
+        result.backward_classes["tunnel"] = true;
+    }
+
+    if (allowed_classes.contains("toll"))
+    {
+        if (equals(forward_toll, "yes"))
+            result.forward_classes["toll"] = true;
+        if (equals(backward_toll, "yes"))
+            result.backward_classes["toll"] = true;
+    }
+
+    if (allowed_classes.contains("ferry"))
+    {
+        if (equals(forward_route, "ferry"))
+            result.forward_classes["ferry"] = true;
+        if (equals(backward_route, "ferry"))
+            result.backward_classes["ferry"] = true;
+    }
+
+    if (allowed_classes.contains("restricted"))
+    {
+        if (result.forward_restricted)
+            result.forward_classes["restricted"] = true;
+        if (result.backward_restricted)
+            result.backward_classes["restricted"] = true;
+    }
+
+    if (allowed_classes.contains("motorway") &&
+        (data.highway == "motorway" || data.highway == "motorway_link"))
+    {
+        result.forward_classes["motorway"] = true;
+        result.backward_classes["motorway"] = true;
+    }
+
+    return true;
+}
+} // namespace osrm::extractor
@@ -0,0 +1,135 @@
+#include "extractor/node_location_index.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/mmap_file.hpp"
+
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace osrm::extractor
+{
+
+namespace
+{
+// the file grows by at least this many entries at a time
+const constexpr std::uint64_t MIN_GROWTH = std::uint64_t{1} << 20;
+} // namespace
+
+NodeLocationIndex::NodeLocationIndex() = default;
+
+NodeLocationIndex::NodeLocationIndex(const std::filesystem::path &directory)
+{
+    std::random_device random;
+    path = directory / ("osrm-locations-" + std::to_string(random()));
+    entries = util::mmapFile<Entry>(path, region, MIN_GROWTH * sizeof(Entry));
+}
+
+NodeLocationIndex::~NodeLocationIndex()
+{
+    if (path.empty())
+        return;
+
+    region.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
+
+void NodeLocationIndex::Reserve(const std::uint64_t node_id)
+{
+    if (node_id < entries.size())
+        return;
+
+    const auto size = std::max<std::uint64_t>(
+        {node_id + 1, 2 * static_cast<std::uint64_t>(entries.size()), MIN_GROWTH});
+    region.close();
+    // extending a file keeps it sparse on filesystems that support sparse files
+    std::filesystem::resize_file(path, size * sizeof(Entry));
+    entries = util::mmapFile<Entry>(path, region);
+}
+
+void NodeLocationIndex::Set(const osmium::object_id_type node_id, const osmium::Location location)
+{
+    if (node_id < 0)
+    {
+        negative_locations.set(static_cast<osmium::unsigned_object_id_type>(-node_id), location);
+    }
+    else if (path.empty())
+    {
+        positive_locations.set(static_cast<osmium::unsigned_object_id_type>(node_id), location);
+    }
+    else
+    {
+        const auto index = static_cast<std::uint64_t>(node_id);
+        Reserve(index);
+        entries[index] = {static_cast<std::uint32_t>(location.x()) + COORDINATE_OFFSET,
+                          static_cast<std::uint32_t>(location.y()) + COORDINATE_OFFSET};
+    }
+}
+
+void NodeLocationIndex::Store(const osmium::memory::Buffer &buffer)
+{
+    for (const auto &item : buffer)
+    {
+        if (item.type() == osmium::item_type::way)
+        {
+            if (!seen_ways)
+            {
+                // the in-memory indexes need to be sorted for lookups, which is done once here
+                // as nothing is stored after the first way
+                positive_locations.sort();
+                negative_locations.sort();
+                seen_ways = true;
+            }
+        }
+        else if (item.type() == osmium::item_type::node)
+        {
+            if (seen_ways)
+            {
+                throw util::exception(
+                    "Nodes must be placed before ways in the input file, sort it first." +
+                    SOURCE_REF);
+            }
+
+            const auto &node = static_cast<const osmium::Node &>(item);
+            Set(node.id(), node.location());
+        }
+    }
+}
+
+osmium::Location NodeLocationIndex::Get(const osmium::object_id_type node_id) const
+{
+    if (node_id < 0)
+        return negative_locations.get_noexcept(
+            static_cast<osmium::unsigned_object_id_type>(-node_id));
+
+    const auto index = static_cast<std::uint64_t>(node_id);
+    if (path.empty())
+        return positive_locations.get_noexcept(index);
+
+    if (index >= entries.size() || entries[index].lon == 0)
+        return osmium::Location();
+
+    const auto &entry = entries[index];
+    return osmium::Location{static_cast<std::int32_t>(entry.lon - COORDINATE_OFFSET),
+                            static_cast<std::int32_t>(entry.lat - COORDINATE_OFFSET)};
+}
+
+std::size_t NodeLocationIndex::SetWayLocations(osmium::memory::Buffer &buffer) const
+{
+    std::size_t missing = 0;
+    for (auto &way : buffer.select<osmium::Way>())
+    {
+        for (auto &node_ref : way.nodes())
+        {
+            node_ref.set_location(Get(node_ref.ref()));
+            missing += !node_ref.location().is_defined();
+        }
+    }
+    return missing;
+}
+} // namespace osrm::extractor
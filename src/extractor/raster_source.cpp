@@ -6,11 +6,163 @@
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <fstream>
 
 namespace osrm::extractor
 {
 
+namespace
+{
+// Parses the next line of an ASCII grid into xdim values
+void readAsciiRow(storage::io::FileReader &file_reader,
+                  std::string &buffer,
+                  const std::size_t xdim,
+                  std::int32_t *row)
+{
+    buffer.resize(xdim * 11); // INT32_MAX = 2147483647 = 10 chars + 1 white space = 11
+    file_reader.ReadLine(buffer.data(), xdim * 11);
+    boost::algorithm::trim(buffer);
+
+    std::vector<std::string> result;
+    boost::split(result, buffer, boost::is_any_of(" \r\n\0"), boost::algorithm::token_compress_on);
+    unsigned int x = 0;
+    for (const auto &s : result)
+    {
+        if (x < xdim)
+            row[x] = atoi(s.c_str());
+        ++x;
+    }
+    BOOST_ASSERT(x == xdim);
+}
+} // namespace
+
+RasterGrid::RasterGrid(const std::filesystem::path &filepath, std::size_t _xdim, std::size_t _ydim)
+    : xdim(_xdim), ydim(_ydim)
+{
+    if (isTiledRaster(filepath))
+    {
+        MapTiles(filepath);
+    }
+    else
+    {
+        ReadAscii(filepath);
+    }
+}
+
+void RasterGrid::ReadAscii(const std::filesystem::path &filepath)
+{
+    _data.resize(ydim * xdim);
+
+    storage::io::FileReader file_reader(filepath, storage::io::FileReader::HasNoFingerprint);
+    std::string buffer;
+    for (std::size_t y = 0; y < ydim; y++)
+    {
+        readAsciiRow(file_reader, buffer, xdim, _data.data() + y * xdim);
+    }
+}
+
+void RasterGrid::MapTiles(const std::filesystem::path &filepath)
+{
+    mapping = std::make_shared<boost::iostreams::mapped_file_source>(filepath.string());
+
+    TiledRasterHeader header;
+    if (mapping->size() < sizeof(header))
+    {
+        throw util::exception("Tiled raster " + filepath.string() + " is truncated" + SOURCE_REF);
+    }
+    std::memcpy(&header, mapping->data(), sizeof(header));
+    if (header.version != TILED_RASTER_VERSION)
+    {
+        throw util::exception("Unsupported version " + std::to_string(header.version) +
+                              " of tiled raster " + filepath.string() + SOURCE_REF);
+    }
+    if (header.width != xdim || header.height != ydim)
+    {
+        throw util::exception("Tiled raster " + filepath.string() + " has " +
+                              std::to_string(header.height) + " rows and " +
+                              std::to_string(header.width) + " columns, but " +
+                              std::to_string(ydim) + " rows and " + std::to_string(xdim) +
+                              " columns were given" + SOURCE_REF);
+    }
+
+    tile_size = header.tile_size;
+    if (tile_size == 0)
+    {
+        throw util::exception("Tiled raster " + filepath.string() + " has no tile size" +
+                              SOURCE_REF);
+    }
+    xtiles = (xdim + tile_size - 1) / tile_size;
+    const auto ytiles = (ydim + tile_size - 1) / tile_size;
+    const auto tiles_size = xtiles * ytiles * tile_size * tile_size * sizeof(std::int32_t);
+    if (mapping->size() < sizeof(header) + tiles_size)
+    {
+        throw util::exception("Tiled raster " + filepath.string() + " is truncated" + SOURCE_REF);
+    }
+
+    // the header keeps the tiles aligned to their values
+    tiles = reinterpret_cast<const std::int32_t *>(mapping->data() + sizeof(header));
+}
+
+bool isTiledRaster(const std::filesystem::path &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[sizeof(TILED_RASTER_MAGIC)];
+    return file.read(magic, sizeof(magic)) &&
+           std::memcmp(magic, TILED_RASTER_MAGIC, sizeof(magic)) == 0;
+}
+
+void convertToTiledRaster(const std::filesystem::path &ascii_path,
+                          const std::filesystem::path &tiled_path,
+                          const std::size_t ncols,
+                          const std::size_t nrows,
+                          const std::uint32_t tile_size)
+{
+    if (tile_size == 0)
+    {
+        throw util::exception("The tile size of a raster must not be 0" + SOURCE_REF);
+    }
+
+    storage::io::FileReader file_reader(ascii_path, storage::io::FileReader::HasNoFingerprint);
+    storage::io::FileWriter file_writer(tiled_path, storage::io::FileWriter::HasNoFingerprint);
+
+    TiledRasterHeader header;
+    std::memcpy(header.magic, TILED_RASTER_MAGIC, sizeof(header.magic));
+    header.version = TILED_RASTER_VERSION;
+    header.tile_size = tile_size;
+    header.width = ncols;
+    header.height = nrows;
+    file_writer.WriteFrom(header);
+
+    const std::size_t xtiles = (ncols + tile_size - 1) / tile_size;
+    std::string buffer;
+    // one row of tiles, the columns are padded to whole tiles
+    std::vector<std::int32_t> rows(tile_size * xtiles * tile_size);
+    std::vector<std::int32_t> tile(tile_size * tile_size);
+    for (std::size_t first_row = 0; first_row < nrows; first_row += tile_size)
+    {
+        std::fill(rows.begin(), rows.end(), 0);
+        const auto last_row = std::min<std::size_t>(first_row + tile_size, nrows);
+        for (auto y = first_row; y < last_row; ++y)
+        {
+            readAsciiRow(
+                file_reader, buffer, ncols, rows.data() + (y - first_row) * xtiles * tile_size);
+        }
+
+        for (std::size_t tile_x = 0; tile_x < xtiles; ++tile_x)
+        {
+            for (std::size_t y = 0; y < tile_size; ++y)
+            {
+                const auto row = rows.begin() + y * xtiles * tile_size + tile_x * tile_size;
+                std::copy(row, row + tile_size, tile.begin() + y * tile_size);
+            }
+            file_writer.WriteFrom(tile.data(), tile.size());
+        }
+    }
+}
+
 RasterSource::RasterSource(RasterGrid _raster_data,
                            std::size_t _width,
                            std::size_t _height,
@@ -1,11 +1,19 @@
 #include "extractor/restriction_graph.hpp"
 #include "extractor/restriction.hpp"
 #include "extractor/turn_path.hpp"
+#include "util/integer_range.hpp"
 #include "util/node_based_graph.hpp"
+#include "util/permutation.hpp"
 #include "util/timing_util.hpp"
 #include <util/for_each_pair.hpp>
 
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include <numeric>
+#include <unordered_map>
 
 namespace osrm::extractor
 {
@@ -19,9 +27,11 @@ void insertEdge(RestrictionGraph &rg, const RestrictionID id, const RestrictionE
     auto &node = rg.nodes[id];
     if (node.edges_begin_idx + range.size() != rg.edges.size())
     {
-        // Most nodes will only have one edge, so this copy will be infrequent
+        // Most nodes will only have one edge, so this copy will be infrequent. The range points
+        // into rg.edges, so it is copied out before appending can reallocate.
+        const std::vector<RestrictionEdge> moved(range.begin(), range.end());
         node.edges_begin_idx = rg.edges.size();
-        std::copy(range.begin(), range.end(), std::back_inserter(rg.edges));
+        rg.edges.insert(rg.edges.end(), moved.begin(), moved.end());
     }
     rg.edges.push_back(edge);
     node.num_edges += 1;
@@ -36,8 +46,9 @@ void insertRestriction(RestrictionGraph &rg,
     if (node.restrictions_begin_idx + range.size() != rg.restrictions.size())
     {
         // Most nodes will only have zero or one restriction, so this copy will be infrequent
+        const std::vector<const TurnRestriction *> moved(range.begin(), range.end());
         node.restrictions_begin_idx = rg.restrictions.size();
-        std::copy(range.begin(), range.end(), std::back_inserter(rg.restrictions));
+        rg.restrictions.insert(rg.restrictions.end(), moved.begin(), moved.end());
     }
     rg.restrictions.push_back(restriction);
     node.num_restrictions += 1;
@@ -104,17 +115,26 @@ struct pathBuilder
 // transferBuilder adds the transfer edges between overlapping restriction paths. It does this
 // by tracking paths in the graph that can be equal to a suffix of a restriction path, and
 // attempting to connect the them with a new edge.
+//
+// The suffix paths are looked up in the graph of all prefix trees, which is not changed. Only the
+// tree of the restriction path gets new edges and restrictions, so the trees are independent.
+// Restrictions that a suffix path received from its own suffixes are not copied, but these are
+// suffixes of the restriction path as well and are copied from there directly.
 struct transferBuilder
 {
-    RestrictionGraph &rg;
+    const RestrictionGraph &rg;
+    RestrictionGraph &tree;
     std::vector<RestrictionID> suffix_nodes;
     RestrictionID cur_node;
 
-    transferBuilder(RestrictionGraph &rg_) : rg(rg_) { cur_node = SPECIAL_RESTRICTIONID; }
+    transferBuilder(const RestrictionGraph &rg_, RestrictionGraph &tree_) : rg(rg_), tree(tree_)
+    {
+        cur_node = SPECIAL_RESTRICTIONID;
+    }
 
     static std::string name() { return "transfer builder"; };
 
-    void start(NodeID from, NodeID to) { cur_node = getOrInsertStartNode(rg, from, to); }
+    void start(NodeID from, NodeID to) { cur_node = getOrInsertStartNode(tree, from, to); }
 
     void next_suffixes(NodeID from, NodeID to)
     {
@@ -153,7 +173,7 @@ struct transferBuilder
 
             // Check there are no unconditional restrictions at the current node that would prevent
             // the transfer
-            const auto &restrictions = rg.GetRestrictions(cur_node);
+            const auto &restrictions = tree.GetRestrictions(cur_node);
             const auto is_restricted =
                 std::any_of(restrictions.begin(),
                             restrictions.end(),
@@ -165,7 +185,7 @@ struct transferBuilder
             if (is_restricted)
                 continue;
 
-            const auto &edges = rg.GetEdges(cur_node);
+            const auto &edges = tree.GetEdges(cur_node);
             // Check that the suffix edge is not a next edge along the current path.
             const auto can_transfer = std::none_of(
                 edges.begin(),
@@ -173,7 +193,8 @@ struct transferBuilder
                 [&](auto &edge) { return edge.node_based_to == suffix_edge.node_based_to; });
             if (can_transfer)
             {
-                insertEdge(rg,
+                // the target is a node of the graph, not of the tree
+                insertEdge(tree,
                            cur_node,
                            RestrictionEdge{suffix_edge.node_based_to, suffix_edge.target, true});
             }
@@ -182,7 +203,7 @@ struct transferBuilder
 
     void next(NodeID from, NodeID to)
     {
-        const auto &edges = rg.GetEdges(cur_node);
+        const auto &edges = tree.GetEdges(cur_node);
         auto next_edge_itr = std::find_if(
             edges.begin(), edges.end(), [&](const auto edge) { return edge.node_based_to == to; });
 
@@ -201,7 +222,7 @@ struct transferBuilder
             // restriction graph.
             for (const auto &restriction : rg.GetRestrictions(suffix_node))
             {
-                insertRestriction(rg, cur_node, restriction);
+                insertRestriction(tree, cur_node, restriction);
             }
         }
     }
@@ -210,23 +231,87 @@ struct transferBuilder
 };
 
 template <typename builder_type>
-void buildGraph(RestrictionGraph &rg, const std::vector<TurnRestriction> &restrictions)
+void runBuilder(builder_type &builder, const TurnRestriction &restriction)
 {
-    const auto run_builder = [&](const auto &restriction)
+    builder.start(restriction.turn_path.From(), restriction.turn_path.FirstVia());
+    if (restriction.turn_path.Type() == TurnPathType::VIA_WAY_TURN_PATH)
     {
-        builder_type builder(rg);
+        const auto &via_way_path = restriction.turn_path.AsViaWayPath();
+        util::for_each_pair(via_way_path.via,
+                            [&](NodeID from, NodeID to) { builder.next(from, to); });
+    }
+    builder.end(restriction);
+}
 
-        builder.start(restriction.turn_path.From(), restriction.turn_path.FirstVia());
-        if (restriction.turn_path.Type() == TurnPathType::VIA_WAY_TURN_PATH)
+// Returns the restrictions grouped by their start edge, in the order in which the start edges
+// first appear. The restrictions of a group keep their order.
+std::vector<std::vector<const TurnRestriction *>>
+groupByStartEdge(const std::vector<TurnRestriction> &restrictions)
+{
+    std::unordered_map<RestrictionGraph::EdgeKey, std::size_t> group_of_start_edge;
+    std::vector<std::vector<const TurnRestriction *>> groups;
+    for (const auto &restriction : restrictions)
+    {
+        const auto [iter, inserted] = group_of_start_edge.insert(
+            {{restriction.turn_path.From(), restriction.turn_path.FirstVia()}, groups.size()});
+        if (inserted)
         {
-            const auto &via_way_path = restriction.turn_path.AsViaWayPath();
-            util::for_each_pair(via_way_path.via,
-                                [&](NodeID from, NodeID to) { builder.next(from, to); });
+            groups.emplace_back();
         }
-        builder.end(restriction);
-    };
+        groups[iter->second].push_back(&restriction);
+    }
+    return groups;
+}
+
+// Concatenates the nodes, edges and restrictions of the trees. The targets of the path edges of
+// a tree are offset by its first node, transfer edges already point to nodes of the graph.
+void concatenateTrees(RestrictionGraph &rg,
+                      const std::vector<RestrictionGraph> &trees,
+                      const std::vector<RestrictionID> &node_offsets)
+{
+    std::vector<std::size_t> edge_offsets(trees.size() + 1, 0);
+    std::vector<std::size_t> restriction_offsets(trees.size() + 1, 0);
+    for (const auto index : util::irange<std::size_t>(0, trees.size()))
+    {
+        edge_offsets[index + 1] = edge_offsets[index] + trees[index].edges.size();
+        restriction_offsets[index + 1] =
+            restriction_offsets[index] + trees[index].restrictions.size();
+    }
 
-    std::for_each(restrictions.begin(), restrictions.end(), run_builder);
+    rg.nodes.resize(node_offsets.back());
+    rg.edges.resize(edge_offsets.back());
+    rg.restrictions.resize(restriction_offsets.back());
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, trees.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto index = range.begin(); index < range.end(); ++index)
+                          {
+                              const auto &tree = trees[index];
+                              std::transform(tree.nodes.begin(),
+                                             tree.nodes.end(),
+                                             rg.nodes.begin() + node_offsets[index],
+                                             [&](auto node)
+                                             {
+                                                 node.edges_begin_idx += edge_offsets[index];
+                                                 node.restrictions_begin_idx +=
+                                                     restriction_offsets[index];
+                                                 return node;
+                                             });
+                              std::transform(tree.edges.begin(),
+                                             tree.edges.end(),
+                                             rg.edges.begin() + edge_offsets[index],
+                                             [&](auto edge)
+                                             {
+                                                 if (!edge.is_transfer)
+                                                     edge.target += node_offsets[index];
+                                                 return edge;
+                                             });
+                              std::copy(tree.restrictions.begin(),
+                                        tree.restrictions.end(),
+                                        rg.restrictions.begin() + restriction_offsets[index]);
+                          }
+                      });
 }
 } // namespace restriction_graph_details
 
@@ -237,10 +322,80 @@ RestrictionGraph constructRestrictionGraph(const std::vector<TurnRestriction> &t
     TIMER_START(construct_restriction_graph);
 
     namespace rgd = restriction_graph_details;
+
+    // The restrictions that share a start edge form a prefix tree, which is built on its own.
+    TIMER_START(prefix_trees);
+    const auto groups = rgd::groupByStartEdge(turn_restrictions);
+    std::vector<RestrictionGraph> trees;
+    trees.reserve(groups.size());
+    for (std::size_t index = 0; index < groups.size(); ++index)
+    {
+        trees.push_back(RestrictionGraph());
+    }
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, groups.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto index = range.begin(); index < range.end(); ++index)
+                          {
+                              rgd::pathBuilder builder(trees[index]);
+                              for (const auto restriction : groups[index])
+                              {
+                                  rgd::runBuilder(builder, *restriction);
+                              }
+                          }
+                      });
+
+    std::vector<RestrictionID> node_offsets(trees.size() + 1, 0);
+    for (const auto index : util::irange<std::size_t>(0, trees.size()))
+    {
+        node_offsets[index + 1] = node_offsets[index] + trees[index].nodes.size();
+    }
+
+    // The start node is the first node of every tree
+    RestrictionGraph prefix_graph;
+    prefix_graph.start_edge_to_node.reserve(trees.size());
+    for (const auto index : util::irange<std::size_t>(0, trees.size()))
+    {
+        BOOST_ASSERT(trees[index].start_edge_to_node.size() == 1);
+        BOOST_ASSERT(trees[index].start_edge_to_node.begin()->second == 0);
+        prefix_graph.start_edge_to_node.insert(
+            {trees[index].start_edge_to_node.begin()->first, node_offsets[index]});
+    }
+    rgd::concatenateTrees(prefix_graph, trees, node_offsets);
+    TIMER_STOP(prefix_trees);
+
+    // Transfers only change the tree of the restriction path, so the trees are extended in
+    // parallel and concatenated again.
+    TIMER_START(transfers);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, groups.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto index = range.begin(); index < range.end(); ++index)
+                          {
+                              for (const auto restriction : groups[index])
+                              {
+                                  rgd::transferBuilder builder(prefix_graph, trees[index]);
+                                  rgd::runBuilder(builder, *restriction);
+                              }
+                          }
+                      });
+
     RestrictionGraph rg;
-    rgd::buildGraph<rgd::pathBuilder>(rg, turn_restrictions);
-    rgd::buildGraph<rgd::transferBuilder>(rg, turn_restrictions);
+    rg.start_edge_to_node = std::move(prefix_graph.start_edge_to_node);
+    prefix_graph = RestrictionGraph();
+    rgd::concatenateTrees(rg, trees, node_offsets);
+    rg.via_edge_to_node.reserve(node_offsets.back() - trees.size());
+    for (const auto index : util::irange<std::size_t>(0, trees.size()))
+    {
+        for (const auto &entry : trees[index].via_edge_to_node)
+        {
+            rg.via_edge_to_node.insert({entry.first, entry.second + node_offsets[index]});
+        }
+    }
+    trees.clear();
+    TIMER_STOP(transfers);
 
+    TIMER_START(reorder);
     // Reorder nodes so that via nodes are at the front. This makes it easier to represent the
     // bijection between restriction graph via nodes and edge-based graph duplicate nodes.
     std::vector<bool> is_via_node(rg.nodes.size(), false);
@@ -266,9 +421,12 @@ RestrictionGraph constructRestrictionGraph(const std::vector<TurnRestriction> &t
     {
         entry.second = permutation[entry.second];
     }
+    TIMER_STOP(reorder);
 
     TIMER_STOP(construct_restriction_graph);
-    log << "ok, after " << TIMER_SEC(construct_restriction_graph) << "s";
+    log << "ok, after " << TIMER_SEC(construct_restriction_graph) << "s (prefix trees "
+        << TIMER_SEC(prefix_trees) << "s, transfers " << TIMER_SEC(transfers) << "s, reordering "
+        << TIMER_SEC(reorder) << "s)";
 
     return rg;
 }
@@ -9,6 +9,7 @@
 #include "extractor/extraction_way.hpp"
 #include "extractor/internal_extractor_edge.hpp"
 #include "extractor/maneuver_override_relation_parser.hpp"
+#include "extractor/native_way_handlers.hpp"
 #include "extractor/profile_properties.hpp"
 #include "extractor/query_node.hpp"
 #include "extractor/restriction_parser.hpp"
@@ -29,6 +30,9 @@
 #include <osmium/osm/way.hpp>
 #include <sol/sol.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 namespace sol
 {
 template <> struct is_container<osmium::OSMObject> : std::false_type
@@ -106,6 +110,123 @@ void handle_lua_error(const sol::protected_function_result &luares)
     }
     throw util::exception("Lua error (see stderr for traceback)");
 }
+
+// The conversions of the profile table for the native way handlers follow how the Lua
+// handlers read it: sequences with ipairs, sets by their keys with truthy values.
+std::vector<std::string> readSequence(const sol::table &profile, const char *name)
+{
+    std::vector<std::string> sequence;
+    sol::optional<sol::table> table = profile[name];
+    if (!table)
+        return sequence;
+
+    for (std::size_t index = 1;; ++index)
+    {
+        sol::optional<std::string> value = (*table)[index];
+        if (!value)
+            break;
+        sequence.push_back(std::move(*value));
+    }
+    return sequence;
+}
+
+std::unordered_set<std::string> readSet(const sol::table &profile, const char *name)
+{
+    std::unordered_set<std::string> set;
+    sol::optional<sol::table> table = profile[name];
+    if (!table)
+        return set;
+
+    for (const auto &[key, value] : *table)
+    {
+        if (key.get_type() == sol::type::string && value.as<bool>())
+            set.insert(key.as<std::string>());
+    }
+    return set;
+}
+
+NativeWayHandlersConfig makeNativeWayHandlersConfig(const sol::table &profile)
+{
+    NativeWayHandlersConfig config;
+    config.access_tags_hierarchy = readSequence(profile, "access_tags_hierarchy");
+    config.access_tag_whitelist = readSet(profile, "access_tag_whitelist");
+    config.access_tag_blacklist = readSet(profile, "access_tag_blacklist");
+    config.restricted_access_tag_list = readSet(profile, "restricted_access_tag_list");
+    config.restricted_highway_whitelist = readSet(profile, "restricted_highway_whitelist");
+    config.restrictions = readSequence(profile, "restrictions");
+    config.default_speed = profile.get_or("default_speed", 0.);
+
+    // keeps the order of pairs(), which decides between keys that a way has both of
+    sol::optional<sol::table> speeds = profile["speeds"];
+    if (speeds)
+    {
+        for (const auto &[key, values] : *speeds)
+        {
+            if (key.get_type() != sol::type::string || values.get_type() != sol::type::table)
+                continue;
+
+            std::unordered_map<std::string, double> speeds_by_value;
+            for (const auto &[value, speed] : values.as<sol::table>())
+            {
+                if (speed.get_type() != sol::type::number)
+                {
+                    throw util::exception("speeds." + key.as<std::string>() + "." +
+                                          value.as<std::string>() + " must be a number" +
+                                          SOURCE_REF);
+                }
+                speeds_by_value.emplace(value.as<std::string>(), speed.as<double>());
+            }
+            config.speeds.emplace_back(key.as<std::string>(), std::move(speeds_by_value));
+        }
+    }
+
+    using OnewayHandling = NativeWayHandlersConfig::OnewayHandling;
+    const sol::object oneway_handling = profile["oneway_handling"];
+    if (oneway_handling.get_type() == sol::type::boolean)
+    {
+        config.oneway_handling =
+            oneway_handling.as<bool>() ? OnewayHandling::All : OnewayHandling::Disabled;
+    }
+    else if (oneway_handling.get_type() == sol::type::string)
+    {
+        const auto value = oneway_handling.as<std::string>();
+        config.oneway_handling = value == "specific"      ? OnewayHandling::Specific
+                                 : value == "conditional" ? OnewayHandling::Conditional
+                                                          : OnewayHandling::Unknown;
+    }
+    else if (oneway_handling.valid() && oneway_handling.get_type() != sol::type::lua_nil)
+    {
+        config.oneway_handling = OnewayHandling::Unknown;
+    }
+
+    // classes are listed as the values of the table
+    sol::optional<sol::table> classes = profile["classes"];
+    if (classes)
+    {
+        config.classes.emplace();
+        for (const auto &[key, value] : *classes)
+        {
+            if (value.get_type() == sol::type::string)
+                config.classes->insert(value.as<std::string>());
+        }
+    }
+
+    return config;
+}
+
+std::optional<std::string> readString(const sol::table &data, const char *key)
+{
+    sol::optional<std::string> value = data[key];
+    return value ? std::optional<std::string>(std::move(*value)) : std::nullopt;
+}
+
+void writeString(sol::table &data, const char *key, const std::optional<std::string> &value)
+{
+    if (value)
+        data[key] = *value;
+    else
+        data[key] = sol::lua_nil;
+}
 } // namespace
 
 Sol2ScriptingEnvironment::Sol2ScriptingEnvironment(
@@ -242,7 +363,9 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
         "force_split_edges",
         &ProfileProperties::force_split_edges,
         "call_tagless_node_function",
-        &ProfileProperties::call_tagless_node_function);
+        &ProfileProperties::call_tagless_node_function,
+        "memoize_way_function",
+        &ProfileProperties::memoize_way_function);
 
     context.state.new_usertype<std::vector<std::string>>(
         "vector",
@@ -651,6 +774,55 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
     context.state.new_usertype<RasterDatum>(
         "RasterDatum", "datum", &RasterDatum::datum, "invalid_data", &RasterDatum::get_invalid);
 
+    // Drop-in replacements for WayHandlers.access, oneway, speed and classes. The profile table
+    // is converted on the first call, so the tables they read must not change after setup().
+    const auto native_handler = [&context](auto handler)
+    {
+        return [&context, handler](sol::table profile,
+                                   const osmium::Way &way,
+                                   ExtractionWay &result,
+                                   sol::table data,
+                                   sol::variadic_args) -> sol::optional<bool>
+        {
+            if (!context.native_way_handlers)
+            {
+                context.native_way_handlers =
+                    std::make_unique<NativeWayHandlers>(makeNativeWayHandlersConfig(profile));
+            }
+
+            NativeWayHandlersData native_data;
+            native_data.highway = readString(data, "highway");
+            native_data.forward_access = readString(data, "forward_access");
+            native_data.backward_access = readString(data, "backward_access");
+            native_data.oneway = readString(data, "oneway");
+            native_data.is_forward_oneway = data.get<sol::object>("is_forward_oneway").as<bool>();
+            native_data.is_reverse_oneway = data.get<sol::object>("is_reverse_oneway").as<bool>();
+
+            const auto &handlers = *context.native_way_handlers;
+            const bool routable = (handlers.*handler)(way, result, native_data);
+
+            writeString(data, "forward_access", native_data.forward_access);
+            writeString(data, "backward_access", native_data.backward_access);
+            writeString(data, "oneway", native_data.oneway);
+            if (native_data.is_forward_oneway)
+                data["is_forward_oneway"] = true;
+            if (native_data.is_reverse_oneway)
+                data["is_reverse_oneway"] = true;
+
+            // like the Lua handlers return false to stop processing and nil otherwise
+            return routable ? sol::optional<bool>{} : sol::optional<bool>{false};
+        };
+    };
+    context.state.create_named_table("native_way_handlers",
+                                     "access",
+                                     native_handler(&NativeWayHandlers::Access),
+                                     "oneway",
+                                     native_handler(&NativeWayHandlers::Oneway),
+                                     "speed",
+                                     native_handler(&NativeWayHandlers::Speed),
+                                     "classes",
+                                     native_handler(&NativeWayHandlers::Classes));
+
     // the "properties" global is only used in v1 of the api, but we don't know
     // the version until we have read the file. so we have to declare it in any case.
     // we will then clear it for v2 profiles after reading the file
@@ -787,6 +959,10 @@ void Sol2ScriptingEnvironment::InitContext(LuaScriptingContext &context)
                 properties["area_emit_visibility_graph"];
             if (area_emit_visibility_graph != sol::nullopt)
                 context.properties.area_emit_visibility_graph = area_emit_visibility_graph.value();
+
+            sol::optional<bool> memoize_way_function = properties["memoize_way_function"];
+            if (memoize_way_function != sol::nullopt)
+                context.properties.memoize_way_function = memoize_way_function.value();
         }
     };
 
@@ -1106,6 +1282,9 @@ void Sol2ScriptingEnvironment::ProcessElements(
     ExtractionNode result_node;
     ExtractionWay result_way;
     auto &local_context = this->GetSol2Context();
+    // the location of a way is not part of its tags
+    const bool memoize_ways =
+        local_context.properties.memoize_way_function && location_dependent_data.empty();
 
     for (auto entity = results.osmium_buffer->cbegin(), end = results.osmium_buffer->cend();
          entity != end;
@@ -1133,7 +1312,14 @@ void Sol2ScriptingEnvironment::ProcessElements(
             result_way.clear();
             if (local_context.has_way_function)
             {
-                local_context.ProcessWay(way, result_way, m_relations_stash);
+                if (memoize_ways && m_relations_stash.get_relations_for(way).empty())
+                {
+                    local_context.ProcessWayMemoized(way, result_way, m_relations_stash);
+                }
+                else
+                {
+                    local_context.ProcessWay(way, result_way, m_relations_stash);
+                }
             }
             results.resulting_ways.push_back({way, std::move(result_way)});
         }
@@ -1160,6 +1346,26 @@ void Sol2ScriptingEnvironment::ProcessElements(
     }
 }
 
+void Sol2ScriptingEnvironment::LogStatistics()
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t tag_sets = 0;
+    for (const auto &context : script_contexts)
+    {
+        hits += context->way_cache.hits;
+        misses += context->way_cache.misses;
+        tag_sets += context->way_cache.results.size();
+    }
+
+    if (hits + misses > 0)
+    {
+        util::Log() << "Memoized process_way for " << hits << " of " << hits + misses
+                    << " ways (" << 100. * hits / (hits + misses) << "%), " << tag_sets
+                    << " tag sets cached in " << script_contexts.size() << " threads";
+    }
+}
+
 std::vector<std::string>
 Sol2ScriptingEnvironment::GetStringListFromFunction(const std::string &function_name)
 {
@@ -1469,6 +1675,53 @@ void LuaScriptingContext::ProcessNode(const osmium::Node &node,
         handle_lua_error(luares);
 }
 
+const std::string &WayResultCache::MakeKey(const osmium::TagList &tags)
+{
+    sorted_tags.clear();
+    for (const auto &tag : tags)
+    {
+        sorted_tags.emplace_back(tag.key(), tag.value());
+    }
+    std::sort(sorted_tags.begin(),
+              sorted_tags.end(),
+              [](const auto &lhs, const auto &rhs)
+              {
+                  const auto compare_keys = std::strcmp(lhs.first, rhs.first);
+                  return compare_keys != 0 ? compare_keys < 0
+                                           : std::strcmp(lhs.second, rhs.second) < 0;
+              });
+
+    // keys and values cannot contain '\0', so the terminators keep the key unambiguous
+    key.clear();
+    for (const auto &[tag_key, tag_value] : sorted_tags)
+    {
+        key.append(tag_key).push_back('\0');
+        key.append(tag_value).push_back('\0');
+    }
+    return key;
+}
+
+void LuaScriptingContext::ProcessWayMemoized(const osmium::Way &way,
+                                             ExtractionWay &result,
+                                             const ExtractionRelationContainer &relations)
+{
+    const auto &key = way_cache.MakeKey(way.tags());
+    const auto cached = way_cache.results.find(key);
+    if (cached != way_cache.results.end())
+    {
+        ++way_cache.hits;
+        result = cached->second;
+        return;
+    }
+
+    ++way_cache.misses;
+    ProcessWay(way, result, relations);
+    if (way_cache.results.size() < WayResultCache::MAX_TAG_SETS)
+    {
+        way_cache.results.emplace(key, result);
+    }
+}
+
 void LuaScriptingContext::ProcessWay(const osmium::Way &way,
                                      ExtractionWay &result,
                                      const ExtractionRelationContainer &relations)
@@ -1,6 +1,7 @@
 #include "partitioner/partitioner.hpp"
 #include "partitioner/bisection_graph.hpp"
 #include "partitioner/bisection_to_partition.hpp"
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/cell_statistics.hpp"
 #include "partitioner/cell_storage.hpp"
 #include "partitioner/edge_based_graph_reader.hpp"
@@ -19,6 +20,7 @@
 #include "util/json_container.hpp"
 #include "util/log.hpp"
 #include "util/mmap_file.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 
 #include <boost/assert.hpp>
@@ -64,8 +66,11 @@ int Partitioner::Run(const PartitionerConfig &config)
 {
     tbb::global_control gc(tbb::global_control::max_allowed_parallelism,
                            config.requested_num_threads);
+    util::PhaseTimer partition_phase("partition");
 
+    util::PhaseTimer bisection_phase("bisection");
     const std::vector<BisectionID> &node_based_partition_ids = getGraphBisection(config);
+    bisection_phase.Stop();
 
     // Up until now we worked on the compressed node based graph.
     // But what we actually need is a partition for the edge based graph to work on.
@@ -73,6 +78,7 @@ int Partitioner::Run(const PartitionerConfig &config)
     // Then loads the edge based graph tanslates the partition and modifies it.
     // For details see #3205
 
+    util::PhaseTimer edge_based_partition_phase("edge-based partition");
     std::vector<extractor::NBGToEBG> mapping;
     extractor::files::readNBGMapping(config.GetPath(".osrm.cnbg_to_ebg").string(), mapping);
     util::Log() << "Loaded node based graph to edge based graph mapping";
@@ -112,6 +118,7 @@ int Partitioner::Run(const PartitionerConfig &config)
 
     auto num_unconnected = removeUnconnectedBoundaryNodes(edge_based_graph, partitions);
     util::Log() << "Fixed " << num_unconnected << " unconnected nodes";
+    edge_based_partition_phase.Stop();
 
     util::Log() << "Edge-based-graph annotation:";
     for (std::size_t level = 0; level < level_to_num_cells.size(); ++level)
@@ -121,7 +128,24 @@ int Partitioner::Run(const PartitionerConfig &config)
     }
 
     TIMER_START(renumber);
-    auto permutation = makePermutation(edge_based_graph, partitions);
+    util::PhaseTimer renumber_phase("renumbering");
+    std::vector<std::uint32_t> permutation;
+    if (config.hilbert_order)
+    {
+        std::vector<util::Coordinate> coordinates;
+        extractor::files::readNodeCoordinates(config.GetPath(".osrm.nbg_nodes"), coordinates);
+        boost::iostreams::mapped_file_source segment_region;
+        auto segments = util::mmapFile<extractor::EdgeBasedNodeSegment>(
+            config.GetPath(".osrm.fileIndex"), segment_region);
+        permutation = makePermutation(
+            edge_based_graph,
+            partitions,
+            makeHilbertCodes(edge_based_graph.GetNumberOfNodes(), segments, coordinates));
+    }
+    else
+    {
+        permutation = makePermutation(edge_based_graph, partitions);
+    }
     renumber(edge_based_graph, permutation);
     renumber(partitions, permutation);
     {
@@ -186,26 +210,56 @@ int Partitioner::Run(const PartitionerConfig &config)
                                  "osrm-contract after osrm-partition.";
         std::filesystem::remove(config.GetOutputPath(".osrm.hsgr"));
     }
+    renumber_phase.Stop();
     TIMER_STOP(renumber);
     util::Log() << "Renumbered data in " << TIMER_SEC(renumber) << " seconds";
 
     TIMER_START(packed_mlp);
+    util::PhaseTimer packed_mlp_phase("multi-level partition");
     MultiLevelPartition mlp{partitions, level_to_num_cells};
+    packed_mlp_phase.Stop();
     TIMER_STOP(packed_mlp);
     util::Log() << "MultiLevelPartition constructed in " << TIMER_SEC(packed_mlp) << " seconds";
 
     TIMER_START(cell_storage);
+    util::PhaseTimer cell_storage_phase("cell storage");
     CellStorage storage(mlp, edge_based_graph);
+    cell_storage_phase.Stop();
     TIMER_STOP(cell_storage);
     util::Log() << "CellStorage constructed in " << TIMER_SEC(cell_storage) << " seconds";
 
+    if (config.microcode_max_cell_size > 0)
+    {
+        TIMER_START(cell_microcode);
+        util::PhaseTimer cell_microcode_phase("cell microcode");
+        CellMicrocode microcode(mlp, storage, edge_based_graph, config.microcode_max_cell_size);
+        cell_microcode_phase.Stop();
+        TIMER_STOP(cell_microcode);
+        util::Log() << "Cell microcode with " << microcode.GetNumberOfInstructions()
+                    << " instructions constructed in " << TIMER_SEC(cell_microcode) << " seconds";
+        for (LevelID level = 1; level < mlp.GetNumberOfLevels(); ++level)
+        {
+            util::Log() << "  level " << (int)level << " microcode for "
+                        << microcode.GetNumberOfPrograms(level) << " of "
+                        << mlp.GetNumberOfCells(level) << " cells";
+        }
+        files::writeCellMicrocode(config.GetOutputPath(".osrm.cell_microcode"), microcode);
+    }
+    else if (std::filesystem::exists(config.GetOutputPath(".osrm.cell_microcode")))
+    {
+        // the microcode only fits the partition it was generated for
+        std::filesystem::remove(config.GetOutputPath(".osrm.cell_microcode"));
+    }
+
     TIMER_START(writing_mld_data);
+    util::PhaseTimer writing_mld_data_phase("writing");
     files::writePartition(config.GetOutputPath(".osrm.partition"), mlp);
     files::writeCells(config.GetOutputPath(".osrm.cells"), storage);
     extractor::files::writeEdgeBasedGraph(config.GetOutputPath(".osrm.ebg"),
                                           edge_based_graph.GetNumberOfNodes(),
                                           graphToEdges(edge_based_graph),
                                           edge_based_graph.connectivity_checksum);
+    writing_mld_data_phase.Stop();
     TIMER_STOP(writing_mld_data);
     util::Log() << "MLD data writing took " << TIMER_SEC(writing_mld_data) << " seconds";
 
@@ -1,7 +1,13 @@
 #include "partitioner/renumber.hpp"
 
+#include "util/coordinate_calculation.hpp"
+#include "util/hilbert_value.hpp"
 #include "util/permutation.hpp"
 
+#include <tbb/parallel_sort.h>
+
+#include <tuple>
+
 namespace osrm::partitioner
 {
 namespace
@@ -34,14 +40,12 @@ std::vector<LevelID> getHighestBorderLevel(const DynamicEdgeBasedGraph &graph,
 
     return border_level;
 }
-} // namespace
 
-std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
-                                           const std::vector<Partition> &partitions)
+// Sorts the given ordering by cell and border level, keeping the order of the input within them
+std::vector<std::uint32_t> sortByCellAndBorderLevel(const DynamicEdgeBasedGraph &graph,
+                                                    const std::vector<Partition> &partitions,
+                                                    std::vector<std::uint32_t> ordering)
 {
-    std::vector<std::uint32_t> ordering(graph.GetNumberOfNodes());
-    std::iota(ordering.begin(), ordering.end(), 0);
-
     // Sort the nodes by cell ID recursively:
     // Nodes in the same cell will be sorted by cell ID on the level below
     for (const auto &partition : partitions)
@@ -64,4 +68,68 @@ std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
 
     return util::orderingToPermutation(ordering);
 }
+} // namespace
+
+std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
+                                           const std::vector<Partition> &partitions)
+{
+    std::vector<std::uint32_t> ordering(graph.GetNumberOfNodes());
+    std::iota(ordering.begin(), ordering.end(), 0);
+
+    return sortByCellAndBorderLevel(graph, partitions, std::move(ordering));
+}
+
+std::vector<std::uint32_t> makePermutation(const DynamicEdgeBasedGraph &graph,
+                                           const std::vector<Partition> &partitions,
+                                           const std::vector<std::uint64_t> &hilbert_codes)
+{
+    BOOST_ASSERT(hilbert_codes.size() == graph.GetNumberOfNodes());
+
+    std::vector<std::uint32_t> ordering(graph.GetNumberOfNodes());
+    std::iota(ordering.begin(), ordering.end(), 0);
+
+    // Nodes with the same cells and border level keep this order, so neighbouring IDs
+    // are close to each other on the map as well
+    tbb::parallel_sort(ordering.begin(),
+                       ordering.end(),
+                       [&hilbert_codes](const auto lhs, const auto rhs)
+                       {
+                           return std::tie(hilbert_codes[lhs], lhs) <
+                                  std::tie(hilbert_codes[rhs], rhs);
+                       });
+
+    return sortByCellAndBorderLevel(graph, partitions, std::move(ordering));
+}
+
+std::vector<std::uint64_t>
+makeHilbertCodes(const std::size_t number_of_nodes,
+                 const util::vector_view<const extractor::EdgeBasedNodeSegment> &segments,
+                 const std::vector<util::Coordinate> &coordinates)
+{
+    std::vector<std::uint64_t> hilbert_codes(number_of_nodes, 0);
+    std::vector<bool> has_code(number_of_nodes, false);
+
+    const auto set_code = [&](const NodeID node, const std::uint64_t code)
+    {
+        BOOST_ASSERT(node < number_of_nodes);
+        if (!has_code[node])
+        {
+            hilbert_codes[node] = code;
+            has_code[node] = true;
+        }
+    };
+
+    // Like the static rtree, by the centroid of the first segment of every node
+    for (const auto &segment : segments)
+    {
+        const auto code = util::GetHilbertCode(
+            util::coordinate_calculation::centroid(coordinates[segment.u], coordinates[segment.v]));
+        if (segment.forward_segment_id.enabled)
+            set_code(segment.forward_segment_id.id, code);
+        if (segment.reverse_segment_id.enabled)
+            set_code(segment.reverse_segment_id.id, code);
+    }
+
+    return hilbert_codes;
+}
 } // namespace osrm::partitioner
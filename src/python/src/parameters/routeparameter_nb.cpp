@@ -61,6 +61,7 @@ void init_RouteParameters(nb::module_ &m)
                 geometries (string): Returned route geometry format - influences overview and per step.\n\
                 overview (string): Add overview geometry either full, simplified.\n\
                 continue_straight (bool): Forces the route to keep going straight at waypoints, constraining u-turns.\n\
+                depart_at (int): UNIX timestamp of the departure for roads with speed profiles (MLD only).\n\
                 BaseParameters (osrm.osrm_ext.BaseParameters): Attributes from parent class.")
         .def(
             "__init__",
@@ -124,6 +125,7 @@ void init_RouteParameters(nb::module_ &m)
         .def_rw("geometries", &RouteParameters::geometries)
         .def_rw("overview", &RouteParameters::overview)
         .def_rw("continue_straight", &RouteParameters::continue_straight)
+        .def_rw("depart_at", &RouteParameters::depart_at)
         .def("IsValid", &RouteParameters::IsValid);
 
     nb::class_<RouteParameters::GeometriesType>(m, "RouteGeometriesType")
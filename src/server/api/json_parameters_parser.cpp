@@ -481,6 +481,14 @@ std::optional<engine::api::RouteParameters> parseJSONParameters(const std::strin
     if (!parseRouteParameters(doc, params, error))
         return std::nullopt;
 
+    // depart_at: UNIX timestamp
+    if (const auto it = doc.FindMember("depart_at"); it != doc.MemberEnd())
+    {
+        if (!it->value.IsInt64())
+            return failOpt(error, "depart_at must be an integer");
+        params.depart_at = it->value.GetInt64();
+    }
+
     return params;
 }
 
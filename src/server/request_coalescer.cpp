@@ -0,0 +1,135 @@
+#include "server/request_coalescer.hpp"
+
+#include <boost/assert.hpp>
+
+#include <utility>
+#include <variant>
+
+namespace osrm::server
+{
+
+void CopyResult(const engine::api::ResultT &from, engine::api::ResultT &to)
+{
+    if (std::holds_alternative<flatbuffers::FlatBufferBuilder>(from))
+    {
+        // GetBufferPointer/GetSize are not const, but only read the finished buffer
+        auto &builder = const_cast<flatbuffers::FlatBufferBuilder &>(
+            std::get<flatbuffers::FlatBufferBuilder>(from));
+        flatbuffers::FlatBufferBuilder copy(builder.GetSize());
+        copy.PushFlatBuffer(builder.GetBufferPointer(), builder.GetSize());
+        to = std::move(copy);
+    }
+    else if (std::holds_alternative<util::json::Object>(from))
+    {
+        to = std::get<util::json::Object>(from);
+    }
+    else
+    {
+        BOOST_ASSERT(std::holds_alternative<std::string>(from));
+        to = std::get<std::string>(from);
+    }
+}
+
+engine::Status RequestCoalescer::Run(const std::string &key,
+                                     const std::string &exact,
+                                     ResultT &result,
+                                     const QueryT &query)
+{
+    std::shared_ptr<Flight> flight;
+    bool is_leader = false;
+    {
+        std::lock_guard<std::mutex> lock(flights_mutex);
+        auto &entry = flights[key];
+        if (!entry)
+        {
+            entry = std::make_shared<Flight>();
+            entry->exact = exact;
+            is_leader = true;
+        }
+        else
+        {
+            // Guarded by flights_mutex: the leader reads it after removing the flight from the
+            // map, at which point no new follower can join.
+            ++entry->followers;
+        }
+        flight = entry;
+    }
+
+    if (is_leader)
+    {
+        engine::Status status = engine::Status::Error;
+        std::exception_ptr error;
+        try
+        {
+            status = query(result);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::size_t followers = 0;
+        {
+            std::lock_guard<std::mutex> lock(flights_mutex);
+            flights.erase(key);
+            followers = flight->followers;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            flight->status = status;
+            flight->error = error;
+            // Only pay for the copy if somebody is waiting for it
+            if (followers > 0 && !error)
+            {
+                CopyResult(result, flight->result);
+            }
+            flight->done = true;
+        }
+        flight->done_cv.notify_all();
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return status;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(flight->mutex);
+        flight->done_cv.wait(lock, [&] { return flight->done; });
+
+        const bool shareable = flight->status == engine::Status::Ok || flight->exact == exact;
+        if (shareable)
+        {
+            if (flight->error)
+            {
+                std::rethrow_exception(flight->error);
+            }
+            CopyResult(flight->result, result);
+            return flight->status;
+        }
+    }
+
+    // The leader failed on a request that only matched ours after normalisation
+    return query(result);
+}
+
+std::size_t RequestCoalescer::InFlight() const
+{
+    std::lock_guard<std::mutex> lock(flights_mutex);
+    return flights.size();
+}
+
+std::size_t RequestCoalescer::Waiting() const
+{
+    std::lock_guard<std::mutex> lock(flights_mutex);
+    std::size_t waiting = 0;
+    for (const auto &[key, flight] : flights)
+    {
+        waiting += flight->followers;
+    }
+    return waiting;
+}
+
+} // namespace osrm::server
@@ -10,10 +10,20 @@
 #include "server/api/parsed_url.hpp"
 #include "util/json_util.hpp"
 
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
 namespace osrm::server
 {
-ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(config)
+ServiceHandler::ServiceHandler(osrm::EngineConfig &config, bool coalesce_requests)
+    : routing_machine(config)
 {
+    if (coalesce_requests)
+    {
+        coalescer = std::make_unique<RequestCoalescer>();
+    }
+
     service_map["route"] = std::make_unique<service::RouteService>(routing_machine);
     service_map["table"] = std::make_unique<service::TableService>(routing_machine);
     service_map["nearest"] = std::make_unique<service::NearestService>(routing_machine);
@@ -53,6 +63,52 @@ resolveService(std::unordered_map<std::string, std::unique_ptr<service::BaseServ
 
     return service.get();
 }
+
+// Everything that selects the service and influences how errors are reported.
+std::string MakeKeyPrefix(const api::ParsedURL &parsed_url, const char method)
+{
+    return std::string(1, method) + parsed_url.service + '/' + std::to_string(parsed_url.version) +
+           '/' + parsed_url.profile + '/' + std::to_string(parsed_url.prefix_length) + '/';
+}
+
+// Options after the '?' are order-independent for all services, so "?steps=true&overview=full"
+// and "?overview=full&steps=true" describe the same query. Sorting is stable and by option name
+// only, so repeated options keep their relative order.
+std::string NormaliseQuery(const std::string &query)
+{
+    const auto options_begin = query.find('?');
+    if (options_begin == std::string::npos)
+        return query;
+
+    std::vector<std::string_view> options;
+    std::string_view rest(query);
+    rest.remove_prefix(options_begin + 1);
+    while (!rest.empty())
+    {
+        const auto separator = rest.find('&');
+        options.push_back(rest.substr(0, separator));
+        if (separator == std::string_view::npos)
+            break;
+        rest.remove_prefix(separator + 1);
+    }
+
+    const auto option_name = [](const std::string_view option)
+    { return option.substr(0, option.find('=')); };
+    std::stable_sort(options.begin(),
+                     options.end(),
+                     [&](const auto lhs, const auto rhs)
+                     { return option_name(lhs) < option_name(rhs); });
+
+    std::string normalised = query.substr(0, options_begin + 1);
+    normalised.reserve(query.size());
+    for (auto iter = options.begin(); iter != options.end(); ++iter)
+    {
+        if (iter != options.begin())
+            normalised.push_back('&');
+        normalised.append(*iter);
+    }
+    return normalised;
+}
 } // namespace
 
 engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
@@ -62,7 +118,18 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
     if (!service)
         return engine::Status::Error;
 
-    return service->RunQuery(parsed_url.prefix_length, parsed_url.query, result);
+    if (!coalescer)
+        return service->RunQuery(parsed_url.prefix_length, parsed_url.query, result);
+
+    const auto prefix = MakeKeyPrefix(parsed_url, 'G');
+    return coalescer->Run(prefix + NormaliseQuery(parsed_url.query),
+                          prefix + parsed_url.query,
+                          result,
+                          [&](ResultT &query_result)
+                          {
+                              return service->RunQuery(
+                                  parsed_url.prefix_length, parsed_url.query, query_result);
+                          });
 }
 
 engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
@@ -73,6 +140,15 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
     if (!service)
         return engine::Status::Error;
 
-    return service->RunJSONQuery(json_body, result);
+    if (!coalescer)
+        return service->RunJSONQuery(json_body, result);
+
+    // JSON bodies are keyed verbatim
+    const auto key = MakeKeyPrefix(parsed_url, 'P') + json_body;
+    return coalescer->Run(key,
+                          key,
+                          result,
+                          [&](ResultT &query_result)
+                          { return service->RunJSONQuery(json_body, query_result); });
 }
 } // namespace osrm::server
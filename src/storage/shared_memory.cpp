@@ -1,5 +1,6 @@
 #include "storage/shared_memory.hpp"
 #include "storage/shared_datatype.hpp"
+#include "util/huge_pages.hpp"
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <cstdlib>
 #include <cstring>
@@ -32,7 +33,31 @@ struct OSRMLockFile
 
 #ifndef _WIN32
 
-SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size)
+#ifdef __linux__
+// Creates the segment on explicit huge pages before it is opened by boost. The kernel only
+// hands out huge pages from the pool reserved in /proc/sys/vm/nr_hugepages and requires the
+// size to be a multiple of the huge page size.
+bool createHugePageSegment(const xsi_key &key, const uint64_t size)
+{
+    const auto huge_page_size = util::GetHugePageSize();
+    if (huge_page_size == 0)
+    {
+        return false;
+    }
+
+    const auto rounded_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+    if (-1 == ::shmget(key.get_key(), rounded_size, IPC_CREAT | SHM_HUGETLB | 0644))
+    {
+        util::Log(logWARNING) << "could not allocate " << rounded_size
+                              << " bytes of shared memory on huge pages: " << strerror(errno)
+                              << ", using transparent huge pages instead";
+        return false;
+    }
+    return true;
+}
+#endif
+
+SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size, const bool huge_pages)
 {
     OSRMLockFile lock_file(proj_id);
     xsi_key xsi_key(lock_file, proj_id);
@@ -48,6 +73,13 @@ SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size)
     // open or create
     else
     {
+        bool explicit_huge_pages = false;
+#ifdef __linux__
+        if (huge_pages)
+        {
+            explicit_huge_pages = createHugePageSegment(xsi_key, size);
+        }
+#endif
         xsi_shared_memory xsi_shm(open_or_create, xsi_key, size);
         util::Log(logDEBUG) << "opening/creating " << xsi_shm.get_shmid() << " from id " << proj_id
                             << " with size " << size;
@@ -61,6 +93,12 @@ SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size)
         }
 #endif
         region = mapped_region(xsi_shm, read_write);
+
+        if (huge_pages && !explicit_huge_pages &&
+            !util::AdviseHugePages(region.get_address(), region.get_size()))
+        {
+            util::Log(logWARNING) << "transparent huge pages are not available for shared memory";
+        }
     }
 }
 
@@ -131,7 +169,7 @@ class OSRMShmName
     std::string name;
 };
 
-SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size)
+SharedMemory::SharedMemory(const ProjID proj_id, const uint64_t size, const bool /*huge_pages*/)
 {
     OSRMShmName name(proj_id);
     if (size == 0)
@@ -192,7 +230,8 @@ void WaitForDetach(const ProjID proj_id, int timeout)
 
 #endif
 
-std::unique_ptr<SharedMemory> makeSharedMemory(const ProjID proj_id, const uint64_t size)
+std::unique_ptr<SharedMemory>
+makeSharedMemory(const ProjID proj_id, const uint64_t size, const bool huge_pages)
 {
     OSRMLockFile lock_file(proj_id);
     try
@@ -208,7 +247,7 @@ std::unique_ptr<SharedMemory> makeSharedMemory(const ProjID proj_id, const uint6
                 std::ofstream ofs(lock_file.to_path());
             }
         }
-        return std::make_unique<SharedMemory>(proj_id, size);
+        return std::make_unique<SharedMemory>(proj_id, size, huge_pages);
     }
     catch (const interprocess_exception &e)
     {
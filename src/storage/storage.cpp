@@ -13,7 +13,9 @@
 #include "partitioner/files.hpp"
 
 #include "util/exception.hpp"
+#include "util/huge_pages.hpp"
 #include "util/log.hpp"
+#include "util/timing_util.hpp"
 
 #ifdef __linux__
 #include <sys/mman.h>
@@ -21,14 +23,23 @@
 
 #include <boost/interprocess/sync/file_lock.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
+#include <tbb/parallel_for_each.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <thread>
 
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iterator>
+#include <optional>
 #include <string>
+#include <unordered_set>
 
 namespace osrm::storage
 {
@@ -44,7 +55,8 @@ struct RegionHandle
 };
 
 RegionHandle setupRegion(SharedRegionRegister &shared_register,
-                         const storage::BaseDataLayout &layout)
+                         const storage::BaseDataLayout &layout,
+                         const bool huge_pages)
 {
     // This is safe because we have an exclusive lock for all osrm-datastore processes.
     ProjID proj_id = shared_register.ReserveKey();
@@ -69,7 +81,7 @@ RegionHandle setupRegion(SharedRegionRegister &shared_register,
     auto regions_size = encoded_static_layout.size() + layout.GetSizeOfLayout();
     util::Log() << "Data layout has a size of " << encoded_static_layout.size() << " bytes";
     util::Log() << "Allocating shared memory of " << regions_size << " bytes";
-    auto memory = makeSharedMemory(proj_id, regions_size);
+    auto memory = makeSharedMemory(proj_id, regions_size, huge_pages);
 
     // Copy memory static_layout to shared memory and populate data
     char *shared_memory_ptr = static_cast<char *>(memory->Ptr());
@@ -79,10 +91,18 @@ RegionHandle setupRegion(SharedRegionRegister &shared_register,
     return RegionHandle{std::move(memory), data_ptr, proj_id};
 }
 
+/**
+ * Publishes the new regions. `base_name` is the register entry of the region the new updatable
+ * data is based on (see BASE_REGION_BLOCK): with a `base_proj_id` that region is kept alive
+ * and registered, without one a previously registered base is no longer referenced and is
+ * removed together with the other replaced regions.
+ */
 bool swapData(Monitor &monitor,
               SharedRegionRegister &shared_register,
               const std::map<std::string, RegionHandle> &handles,
-              int max_wait)
+              int max_wait,
+              const std::string &base_name,
+              const std::optional<ProjID> base_proj_id)
 {
     std::vector<RegionHandle> old_handles;
 
@@ -125,13 +145,35 @@ bool swapData(Monitor &monitor,
             {
                 auto &shared_region = shared_register.GetRegion(region_id);
 
-                old_handles.push_back(RegionHandle{
-                    makeSharedMemory(shared_region.proj_id), nullptr, shared_region.proj_id});
+                // the old region lives on as the base of the new one
+                if (shared_region.proj_id != base_proj_id)
+                {
+                    old_handles.push_back(RegionHandle{
+                        makeSharedMemory(shared_region.proj_id), nullptr, shared_region.proj_id});
+                }
 
                 shared_region.proj_id = pair.second.proj_id;
                 shared_region.timestamp++;
             }
         }
+
+        const auto base_region_id = shared_register.Find(base_name);
+        if (base_proj_id)
+        {
+            if (base_region_id == SharedRegionRegister::INVALID_REGION_ID)
+            {
+                shared_register.Register(base_name, *base_proj_id);
+            }
+            BOOST_ASSERT(shared_register.GetRegion(shared_register.Find(base_name)).proj_id ==
+                         *base_proj_id);
+        }
+        else if (base_region_id != SharedRegionRegister::INVALID_REGION_ID)
+        {
+            const auto old_base_proj_id = shared_register.GetRegion(base_region_id).proj_id;
+            old_handles.push_back(
+                RegionHandle{makeSharedMemory(old_base_proj_id), nullptr, old_base_proj_id});
+            shared_register.Deregister(base_region_id);
+        }
     }
 
     util::Log() << "All data loaded. Notify all clients about new data in:";
@@ -165,6 +207,240 @@ bool swapData(Monitor &monitor,
 
     return true;
 }
+
+// Reads one dataset file into its blocks of an already allocated region.
+struct FileLoader
+{
+    std::filesystem::path path;
+    std::function<void()> load;
+};
+
+/**
+ * Runs the loaders concurrently. Each loader owns a disjoint set of blocks, so the only
+ * coordination needed is the work distribution: the largest files are started first so a
+ * single big file does not end up being read last on an otherwise idle machine.
+ */
+void runLoaders(const std::string &region_name, std::vector<FileLoader> &loaders)
+{
+    const auto file_size = [](const FileLoader &loader) -> std::uintmax_t
+    {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(loader.path, error);
+        return error ? 0 : size;
+    };
+    std::stable_sort(loaders.begin(),
+                     loaders.end(),
+                     [&](const auto &lhs, const auto &rhs)
+                     { return file_size(lhs) > file_size(rhs); });
+
+    util::Log() << "Loading " << loaders.size() << " " << region_name << " files using "
+                << tbb::this_task_arena::max_concurrency() << " threads";
+
+    TIMER_START(load_region);
+    std::atomic<std::size_t> finished{0};
+    tbb::parallel_for_each(loaders,
+                           [&](const FileLoader &loader)
+                           {
+                               TIMER_START(load_file);
+                               loader.load();
+                               TIMER_STOP(load_file);
+
+                               util::Log() << "[" << ++finished << "/" << loaders.size()
+                                           << "] loaded " << loader.path.filename().string()
+                                           << " (" << file_size(loader) / (1024 * 1024)
+                                           << " MiB) in " << TIMER_SEC(load_file) << "s";
+                           });
+    TIMER_STOP(load_region);
+
+    util::Log() << "Loaded " << region_name << " data in " << TIMER_SEC(load_region) << "s";
+}
+
+struct MappedRegion
+{
+    std::unique_ptr<SharedMemory> memory;
+    std::unique_ptr<BaseDataLayout> layout;
+    char *data_ptr;
+    ProjID proj_id;
+};
+
+MappedRegion mapRegion(const ProjID proj_id)
+{
+    auto memory = makeSharedMemory(proj_id);
+    std::unique_ptr<BaseDataLayout> layout = std::make_unique<ContiguousDataLayout>();
+    io::BufferReader reader(reinterpret_cast<char *>(memory->Ptr()), memory->Size());
+    serialization::read(reader, *layout);
+    auto *data_ptr = reinterpret_cast<char *>(memory->Ptr()) + reader.GetPosition();
+    return MappedRegion{std::move(memory), std::move(layout), data_ptr, proj_id};
+}
+
+// Compares a block in memory with the bytes of its tar entry, reading the file in chunks so the
+// comparison needs no more memory than one chunk. Compressed entries are inflated as a whole.
+bool isBlockUnchanged(tar::FileReader &reader,
+                      const std::filesystem::path &path,
+                      const tar::FileReader::FileEntry &entry,
+                      const char *block_ptr)
+{
+    constexpr std::size_t CHUNK_SIZE = 16 * 1024 * 1024;
+
+    if (entry.compressed)
+    {
+        std::vector<char> block(entry.size);
+        reader.ReadInto(entry.name, block.data(), block.size());
+        return std::memcmp(block.data(), block_ptr, block.size()) == 0;
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    stream.seekg(static_cast<std::streamoff>(entry.offset));
+    std::vector<char> buffer(std::min(CHUNK_SIZE, entry.size));
+    for (std::size_t offset = 0; offset < entry.size; offset += buffer.size())
+    {
+        const auto chunk_size = std::min(buffer.size(), entry.size - offset);
+        if (!stream.read(buffer.data(), static_cast<std::streamsize>(chunk_size)))
+        {
+            throw util::exception("Could not read " + entry.name + " from " + path.string());
+        }
+        if (std::memcmp(buffer.data(), block_ptr + offset, chunk_size) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct ChangedBlock
+{
+    std::filesystem::path path;
+    std::string name;
+};
+
+/**
+ * Builds the layout of an updatable region that only holds the blocks whose content differs
+ * from `base`, plus BASE_REGION_BLOCK. Returns an empty layout if the new data cannot be
+ * expressed relative to `base` because a block of the base is not part of the new files.
+ */
+std::unique_ptr<BaseDataLayout>
+populateDeltaLayout(const std::vector<std::pair<bool, std::filesystem::path>> &files,
+                    const MappedRegion &base,
+                    std::vector<ChangedBlock> &changed_blocks)
+{
+    auto layout = std::make_unique<ContiguousDataLayout>();
+    std::unordered_set<std::string> new_block_names;
+    std::uint64_t shared_bytes = 0;
+    std::uint64_t changed_bytes = 0;
+
+    for (const auto &file : files)
+    {
+        if (!std::filesystem::exists(file.second))
+            continue;
+
+        tar::FileReader reader(file.second, tar::FileReader::VerifyFingerprint);
+        std::vector<tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+
+        for (const auto &entry : entries)
+        {
+            // same selection as populateLayoutFromFile
+            if (entry.name.rfind(".meta") != std::string::npos)
+                continue;
+
+            new_block_names.insert(entry.name);
+            if (base.layout->HasBlock(entry.name) &&
+                base.layout->GetBlockSize(entry.name) == entry.size &&
+                isBlockUnchanged(
+                    reader,
+                    file.second,
+                    entry,
+                    static_cast<const char *>(base.layout->GetBlockPtr(base.data_ptr, entry.name))))
+            {
+                shared_bytes += entry.size;
+                continue;
+            }
+
+            layout->SetBlock(entry.name,
+                             Block{reader.ReadElementCount64(entry.name), entry.size, entry.offset});
+            changed_blocks.push_back({file.second, entry.name});
+            changed_bytes += entry.size;
+        }
+    }
+
+    std::vector<std::string> base_block_names;
+    base.layout->List("", std::back_inserter(base_block_names));
+    for (const auto &name : base_block_names)
+    {
+        if (name != BASE_REGION_BLOCK && !new_block_names.contains(name))
+        {
+            util::Log(logWARNING) << "Block " << name << " of region " << (int)base.proj_id
+                                  << " is not part of the new data, cannot share unchanged blocks";
+            changed_blocks.clear();
+            return {};
+        }
+    }
+
+    layout->SetBlock(BASE_REGION_BLOCK, make_block<ProjID>(1));
+
+    util::Log() << "Sharing " << (new_block_names.size() - changed_blocks.size()) << " of "
+                << new_block_names.size() << " updatable blocks (" << shared_bytes / (1024 * 1024)
+                << " MiB) with region " << (int)base.proj_id << ", " << changed_blocks.size()
+                << " changed blocks need " << changed_bytes / (1024 * 1024) << " MiB";
+
+    return layout;
+}
+
+// Copies the changed blocks verbatim from their tar entries, which is exactly what the regular
+// loaders (and the mmap allocator) end up with in memory.
+void populateChangedBlocks(const StorageConfig &config,
+                           const SharedDataIndex &index,
+                           const std::vector<ChangedBlock> &changed_blocks)
+{
+    std::map<std::filesystem::path, std::vector<std::string>> blocks_per_file;
+    for (const auto &block : changed_blocks)
+    {
+        blocks_per_file[block.path].push_back(block.name);
+    }
+
+    std::vector<FileLoader> loaders;
+    for (const auto &[path, names] : blocks_per_file)
+    {
+        loaders.push_back({path,
+                           [&]
+                           {
+                               tar::FileReader reader(path, tar::FileReader::VerifyFingerprint);
+                               for (const auto &name : names)
+                               {
+                                   reader.ReadInto(name,
+                                                   index.GetBlockPtr<char>(name),
+                                                   index.GetBlockSize(name));
+                               }
+                           }});
+    }
+    runLoaders("changed updatable", loaders);
+
+    // The graph has to match the static data it is used with, as in PopulateUpdatableData
+    if (config.IsRequiredConfiguredInput("osrm.edges"))
+    {
+        const auto turns_connectivity_checksum =
+            *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
+        for (const auto &[extension, block_name] :
+             {std::pair{".osrm.hsgr", "/ch/connectivity_checksum"},
+              std::pair{".osrm.mldgr", "/mld/connectivity_checksum"}})
+        {
+            if (!std::filesystem::exists(config.GetPath(extension)))
+                continue;
+
+            std::uint32_t graph_connectivity_checksum = 0;
+            tar::FileReader reader(config.GetPath(extension), tar::FileReader::VerifyFingerprint);
+            reader.ReadInto(block_name, graph_connectivity_checksum);
+            if (turns_connectivity_checksum != graph_connectivity_checksum)
+            {
+                throw util::exception(
+                    "Connectivity checksum " + std::to_string(graph_connectivity_checksum) +
+                    " in " + config.GetPath(extension).string() + " does not equal to checksum " +
+                    std::to_string(turns_connectivity_checksum) + " in " +
+                    config.GetPath(".osrm.edges").string());
+            }
+        }
+    }
+}
 } // namespace
 
 void populateLayoutFromFile(const std::filesystem::path &path, storage::BaseDataLayout &layout)
@@ -187,7 +463,11 @@ void populateLayoutFromFile(const std::filesystem::path &path, storage::BaseData
 
 Storage::Storage(StorageConfig config_) : config(std::move(config_)) {}
 
-int Storage::Run(int max_wait, const std::string &dataset_name, bool only_metric)
+int Storage::Run(int max_wait,
+                 const std::string &dataset_name,
+                 bool only_metric,
+                 bool share_unchanged_blocks,
+                 bool huge_pages)
 {
     BOOST_ASSERT_MSG(config.IsValid(), "Invalid storage config");
 
@@ -262,16 +542,51 @@ int Storage::Run(int max_wait, const std::string &dataset_name, bool only_metric
         Storage::PopulateLayoutWithOpenAreaRTree(*static_layout);
         std::vector<std::pair<bool, std::filesystem::path>> files = Storage::GetStaticFiles();
         Storage::PopulateLayout(*static_layout, files);
-        auto static_handle = setupRegion(shared_register, *static_layout);
+        auto static_handle = setupRegion(shared_register, *static_layout, huge_pages);
         regions.push_back({static_handle.data_ptr, std::move(static_layout)});
         handles[dataset_name + "/static"] = std::move(static_handle);
     }
 
-    std::unique_ptr<storage::BaseDataLayout> updatable_layout =
-        std::make_unique<storage::ContiguousDataLayout>();
     std::vector<std::pair<bool, std::filesystem::path>> files = Storage::GetUpdatableFiles();
-    Storage::PopulateLayout(*updatable_layout, files);
-    auto updatable_handle = setupRegion(shared_register, *updatable_layout);
+    std::unique_ptr<storage::BaseDataLayout> updatable_layout;
+
+    // With share_unchanged_blocks the new updatable region only holds the blocks that differ
+    // from the last fully loaded updatable region (the base), which stays in memory and is
+    // mapped by routed alongside the new region.
+    const auto base_name = dataset_name + "/updatable_base";
+    std::optional<MappedRegion> base_region;
+    std::vector<ChangedBlock> changed_blocks;
+    if (only_metric && share_unchanged_blocks)
+    {
+        auto region_id = shared_register.Find(dataset_name + "/updatable");
+        if (region_id == storage::SharedRegionRegister::INVALID_REGION_ID)
+        {
+            throw util::exception("Cannot update the metric to a dataset that does not exist yet.");
+        }
+        auto previous_region = mapRegion(shared_register.GetRegion(region_id).proj_id);
+        if (previous_region.layout->HasBlock(BASE_REGION_BLOCK))
+        {
+            base_region = mapRegion(*reinterpret_cast<const ProjID *>(
+                previous_region.layout->GetBlockPtr(previous_region.data_ptr, BASE_REGION_BLOCK)));
+        }
+        else
+        {
+            base_region = std::move(previous_region);
+        }
+
+        updatable_layout = populateDeltaLayout(files, *base_region, changed_blocks);
+        if (!updatable_layout)
+        {
+            base_region.reset();
+        }
+    }
+
+    if (!updatable_layout)
+    {
+        updatable_layout = std::make_unique<storage::ContiguousDataLayout>();
+        Storage::PopulateLayout(*updatable_layout, files);
+    }
+    auto updatable_handle = setupRegion(shared_register, *updatable_layout, huge_pages);
     regions.push_back({updatable_handle.data_ptr, std::move(updatable_layout)});
     handles[dataset_name + "/updatable"] = std::move(updatable_handle);
 
@@ -281,9 +596,25 @@ int Storage::Run(int max_wait, const std::string &dataset_name, bool only_metric
     {
         PopulateStaticData(index);
     }
-    PopulateUpdatableData(index);
 
-    swapData(monitor, shared_register, handles, max_wait);
+    std::optional<ProjID> base_proj_id;
+    if (base_region)
+    {
+        base_proj_id = base_region->proj_id;
+        *index.GetBlockPtr<ProjID>(BASE_REGION_BLOCK) = *base_proj_id;
+        populateChangedBlocks(config, index, changed_blocks);
+    }
+    else
+    {
+        PopulateUpdatableData(index);
+    }
+
+    for (const auto &[name, handle] : handles)
+    {
+        util::LogPageStats(name, handle.memory->Ptr(), handle.memory->Size());
+    }
+
+    swapData(monitor, shared_register, handles, max_wait, base_name, base_proj_id);
 
     return EXIT_SUCCESS;
 }
@@ -333,6 +664,7 @@ std::vector<std::pair<bool, std::filesystem::path>> Storage::GetUpdatableFiles()
     std::vector<std::pair<bool, std::filesystem::path>> files = {
         {IS_OPTIONAL, config.GetPath(".osrm.mldgr")},
         {IS_OPTIONAL, config.GetPath(".osrm.cell_metrics")},
+        {IS_OPTIONAL, config.GetPath(".osrm.speed_profiles")},
         {IS_OPTIONAL, config.GetPath(".osrm.hsgr")},
         {IS_REQUIRED, config.GetPath(".osrm.datasource_names")},
         {IS_REQUIRED, config.GetPath(".osrm.geometry")},
@@ -435,157 +767,194 @@ void Storage::PopulateStaticData(const SharedDataIndex &index)
         std::copy(absolute_path.begin(), absolute_path.end(), path_ptr);
     }
 
+    // Every file below is read into its own set of blocks, so they are loaded concurrently.
+    std::vector<FileLoader> loaders;
+
     // Timestamp mark
-    {
-        auto timestamp_ref = make_timestamp_view(index, "/common/timestamp");
-        std::string ts;
-        extractor::files::readTimestamp(config.GetPath(".osrm.timestamp"), ts);
-        if (!ts.empty())
-        {
-            memcpy(const_cast<char *>(timestamp_ref.data()), ts.data(), ts.size());
-        }
-    }
+    loaders.push_back({config.GetPath(".osrm.timestamp"),
+                       [&]
+                       {
+                           auto timestamp_ref = make_timestamp_view(index, "/common/timestamp");
+                           std::string ts;
+                           extractor::files::readTimestamp(config.GetPath(".osrm.timestamp"), ts);
+                           if (!ts.empty())
+                           {
+                               memcpy(const_cast<char *>(timestamp_ref.data()),
+                                      ts.data(),
+                                      ts.size());
+                           }
+                       }});
 
     // Turn lane data
     if (config.IsRequiredConfiguredInput(".osrm.tld"))
     {
-        auto turn_lane_data = make_lane_data_view(index, "/common/turn_lanes");
-        extractor::files::readTurnLaneData(config.GetPath(".osrm.tld"), turn_lane_data);
+        loaders.push_back({config.GetPath(".osrm.tld"),
+                           [&]
+                           {
+                               auto turn_lane_data =
+                                   make_lane_data_view(index, "/common/turn_lanes");
+                               extractor::files::readTurnLaneData(config.GetPath(".osrm.tld"),
+                                                                  turn_lane_data);
+                           }});
     }
 
     // Turn lane descriptions
     if (config.IsRequiredConfiguredInput(".osrm.tls"))
     {
-        auto views = make_turn_lane_description_views(index, "/common/turn_lanes");
-        extractor::files::readTurnLaneDescriptions(
-            config.GetPath(".osrm.tls"), std::get<0>(views), std::get<1>(views));
+        loaders.push_back(
+            {config.GetPath(".osrm.tls"),
+             [&]
+             {
+                 auto views = make_turn_lane_description_views(index, "/common/turn_lanes");
+                 extractor::files::readTurnLaneDescriptions(
+                     config.GetPath(".osrm.tls"), std::get<0>(views), std::get<1>(views));
+             }});
     }
 
     // Load intersection data
     if (config.IsRequiredConfiguredInput(".osrm.icd"))
     {
-        auto intersection_bearings_view =
-            make_intersection_bearings_view(index, "/common/intersection_bearings");
-        auto entry_classes = make_entry_classes_view(index, "/common/entry_classes");
-        extractor::files::readIntersections(
-            config.GetPath(".osrm.icd"), intersection_bearings_view, entry_classes);
+        loaders.push_back(
+            {config.GetPath(".osrm.icd"),
+             [&]
+             {
+                 auto intersection_bearings_view =
+                     make_intersection_bearings_view(index, "/common/intersection_bearings");
+                 auto entry_classes = make_entry_classes_view(index, "/common/entry_classes");
+                 extractor::files::readIntersections(
+                     config.GetPath(".osrm.icd"), intersection_bearings_view, entry_classes);
+             }});
     }
 
     // Name data
     if (config.IsRequiredConfiguredInput(".osrm.names"))
     {
-        auto string_table = make_string_table_view(index, "/common/names");
-        extractor::files::readNames(config.GetPath(".osrm.names"), string_table);
+        loaders.push_back({config.GetPath(".osrm.names"),
+                           [&]
+                           {
+                               auto string_table = make_string_table_view(index, "/common/names");
+                               extractor::files::readNames(config.GetPath(".osrm.names"),
+                                                           string_table);
+                           }});
     }
 
     // Load original edge data
     if (config.IsRequiredConfiguredInput(".osrm.edges"))
     {
-        auto turn_data = make_turn_data_view(index, "/common/turn_data");
-
-        auto connectivity_checksum_ptr =
-            index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
-
-        guidance::files::readTurnData(
-            config.GetPath(".osrm.edges"), turn_data, *connectivity_checksum_ptr);
+        loaders.push_back(
+            {config.GetPath(".osrm.edges"),
+             [&]
+             {
+                 auto turn_data = make_turn_data_view(index, "/common/turn_data");
+
+                 auto connectivity_checksum_ptr =
+                     index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
+
+                 guidance::files::readTurnData(
+                     config.GetPath(".osrm.edges"), turn_data, *connectivity_checksum_ptr);
+             }});
     }
 
     // Load edge-based nodes data
-    {
-        auto node_data = make_ebn_data_view(index, "/common/ebg_node_data");
-        extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
-    }
+    loaders.push_back({config.GetPath(".osrm.ebg_nodes"),
+                       [&]
+                       {
+                           auto node_data = make_ebn_data_view(index, "/common/ebg_node_data");
+                           extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"),
+                                                          node_data);
+                       }});
 
     // Loading list of coordinates
-    {
-        auto views = make_nbn_data_view(index, "/common/nbn_data");
-        extractor::files::readNodes(
-            config.GetPath(".osrm.nbg_nodes"), std::get<0>(views), std::get<1>(views));
-    }
+    loaders.push_back(
+        {config.GetPath(".osrm.nbg_nodes"),
+         [&]
+         {
+             auto views = make_nbn_data_view(index, "/common/nbn_data");
+             extractor::files::readNodes(
+                 config.GetPath(".osrm.nbg_nodes"), std::get<0>(views), std::get<1>(views));
+         }});
 
     // store search tree portion of rtree
-    {
-        auto rtree = make_search_tree_view(index, "/common/rtree");
-        extractor::files::readRamIndex(config.GetPath(".osrm.ramIndex"), rtree);
-    }
+    loaders.push_back({config.GetPath(".osrm.ramIndex"),
+                       [&]
+                       {
+                           auto rtree = make_search_tree_view(index, "/common/rtree");
+                           extractor::files::readRamIndex(config.GetPath(".osrm.ramIndex"), rtree);
+                       }});
 
     // the meshed open areas, and the r-tree that finds them.  Only present when the
     // profile meshed any, so everything downstream has to cope with their absence.
     if (std::filesystem::exists(config.GetPath(".osrm.openareas")))
     {
-        auto views = make_open_areas_view(index, "/common/open_areas");
-        extractor::files::readOpenAreas(config.GetPath(".osrm.openareas"),
-                                        std::get<0>(views),
-                                        std::get<1>(views),
-                                        std::get<2>(views),
-                                        std::get<3>(views));
-
-        auto rtree = make_open_area_tree_view(index, "/common/open_areas/rtree");
-        extractor::files::readRamIndex(
-            config.GetPath(".osrm.openareas.ramIndex"), rtree, "/common/open_areas/rtree");
+        loaders.push_back({config.GetPath(".osrm.openareas"),
+                           [&]
+                           {
+                               auto views = make_open_areas_view(index, "/common/open_areas");
+                               extractor::files::readOpenAreas(config.GetPath(".osrm.openareas"),
+                                                               std::get<0>(views),
+                                                               std::get<1>(views),
+                                                               std::get<2>(views),
+                                                               std::get<3>(views));
+                           }});
+        loaders.push_back(
+            {config.GetPath(".osrm.openareas.ramIndex"),
+             [&]
+             {
+                 auto rtree = make_open_area_tree_view(index, "/common/open_areas/rtree");
+                 extractor::files::readRamIndex(
+                     config.GetPath(".osrm.openareas.ramIndex"), rtree, "/common/open_areas/rtree");
+             }});
     }
 
-    // FIXME we only need to get the weight name
-    std::string metric_name;
     // load profile properties
-    {
-        const auto profile_properties_ptr =
-            index.GetBlockPtr<extractor::ProfileProperties>("/common/properties");
-        extractor::files::readProfileProperties(config.GetPath(".osrm.properties"),
-                                                *profile_properties_ptr);
-
-        metric_name = profile_properties_ptr->GetWeightName();
-    }
+    loaders.push_back({config.GetPath(".osrm.properties"),
+                       [&]
+                       {
+                           const auto profile_properties_ptr =
+                               index.GetBlockPtr<extractor::ProfileProperties>(
+                                   "/common/properties");
+                           extractor::files::readProfileProperties(
+                               config.GetPath(".osrm.properties"), *profile_properties_ptr);
+                       }});
 
     if (std::filesystem::exists(config.GetPath(".osrm.partition")))
     {
-        auto mlp = make_partition_view(index, "/mld/multilevelpartition");
-        partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
+        loaders.push_back(
+            {config.GetPath(".osrm.partition"),
+             [&]
+             {
+                 auto mlp = make_partition_view(index, "/mld/multilevelpartition");
+                 partitioner::files::readPartition(config.GetPath(".osrm.partition"), mlp);
+             }});
     }
 
     if (std::filesystem::exists(config.GetPath(".osrm.cells")))
     {
-        auto storage = make_cell_storage_view(index, "/mld/cellstorage");
-        partitioner::files::readCells(config.GetPath(".osrm.cells"), storage);
+        loaders.push_back({config.GetPath(".osrm.cells"),
+                           [&]
+                           {
+                               auto storage = make_cell_storage_view(index, "/mld/cellstorage");
+                               partitioner::files::readCells(config.GetPath(".osrm.cells"),
+                                                             storage);
+                           }});
     }
 
     // load maneuver overrides
-    {
-        auto views = make_maneuver_overrides_views(index, "/common/maneuver_overrides");
-        extractor::files::readManeuverOverrides(
-            config.GetPath(".osrm.maneuver_overrides"), std::get<0>(views), std::get<1>(views));
-    }
+    loaders.push_back(
+        {config.GetPath(".osrm.maneuver_overrides"),
+         [&]
+         {
+             auto views = make_maneuver_overrides_views(index, "/common/maneuver_overrides");
+             extractor::files::readManeuverOverrides(config.GetPath(".osrm.maneuver_overrides"),
+                                                     std::get<0>(views),
+                                                     std::get<1>(views));
+         }});
+
+    runLoaders("static", loaders);
 }
 
 void Storage::PopulateUpdatableData(const SharedDataIndex &index)
 {
-    // load compressed geometry
-    {
-        auto segment_data = make_segment_data_view(index, "/common/segment_data");
-        extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
-    }
-
-    {
-        const auto datasources_names_ptr =
-            index.GetBlockPtr<extractor::Datasources>("/common/data_sources_names");
-        extractor::files::readDatasources(config.GetPath(".osrm.datasource_names"),
-                                          *datasources_names_ptr);
-    }
-
-    // load turn weight penalties
-    {
-        auto turn_duration_penalties = make_turn_weight_view(index, "/common/turn_penalty");
-        extractor::files::readTurnWeightPenalty(config.GetPath(".osrm.turn_weight_penalties"),
-                                                turn_duration_penalties);
-    }
-
-    // load turn duration penalties
-    {
-        auto turn_duration_penalties = make_turn_duration_view(index, "/common/turn_penalty");
-        extractor::files::readTurnDurationPenalty(config.GetPath(".osrm.turn_duration_penalties"),
-                                                  turn_duration_penalties);
-    }
-
     // FIXME we only need to get the weight name
     std::string metric_name;
     // load profile properties
@@ -596,61 +965,141 @@ void Storage::PopulateUpdatableData(const SharedDataIndex &index)
         metric_name = properties.GetWeightName();
     }
 
-    if (std::filesystem::exists(config.GetPath(".osrm.hsgr")))
-    {
-        const std::string metric_prefix = "/ch/metrics/" + metric_name;
-        auto contracted_metric = make_contracted_metric_view(index, metric_prefix);
-        std::unordered_map<std::string, contractor::ContractedMetricView> metrics = {
-            {metric_name, std::move(contracted_metric)}};
+    std::vector<FileLoader> loaders;
 
-        std::uint32_t graph_connectivity_checksum = 0;
-        contractor::files::readGraph(
-            config.GetPath(".osrm.hsgr"), metrics, graph_connectivity_checksum);
+    // load compressed geometry
+    loaders.push_back(
+        {config.GetPath(".osrm.geometry"),
+         [&]
+         {
+             auto segment_data = make_segment_data_view(index, "/common/segment_data");
+             extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
+         }});
+
+    loaders.push_back({config.GetPath(".osrm.datasource_names"),
+                       [&]
+                       {
+                           const auto datasources_names_ptr =
+                               index.GetBlockPtr<extractor::Datasources>(
+                                   "/common/data_sources_names");
+                           extractor::files::readDatasources(
+                               config.GetPath(".osrm.datasource_names"), *datasources_names_ptr);
+                       }});
 
-        if (config.IsRequiredConfiguredInput("osrm.edges"))
-        {
-            auto turns_connectivity_checksum =
-                *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
-            if (turns_connectivity_checksum != graph_connectivity_checksum)
-            {
-                throw util::exception(
-                    "Connectivity checksum " + std::to_string(graph_connectivity_checksum) +
-                    " in " + config.GetPath(".osrm.hsgr").string() +
-                    " does not equal to checksum " + std::to_string(turns_connectivity_checksum) +
-                    " in " + config.GetPath(".osrm.edges").string());
-            }
-        }
+    // load turn weight penalties
+    loaders.push_back(
+        {config.GetPath(".osrm.turn_weight_penalties"),
+         [&]
+         {
+             auto turn_duration_penalties = make_turn_weight_view(index, "/common/turn_penalty");
+             extractor::files::readTurnWeightPenalty(config.GetPath(".osrm.turn_weight_penalties"),
+                                                     turn_duration_penalties);
+         }});
+
+    // load turn duration penalties
+    loaders.push_back({config.GetPath(".osrm.turn_duration_penalties"),
+                       [&]
+                       {
+                           auto turn_duration_penalties =
+                               make_turn_duration_view(index, "/common/turn_penalty");
+                           extractor::files::readTurnDurationPenalty(
+                               config.GetPath(".osrm.turn_duration_penalties"),
+                               turn_duration_penalties);
+                       }});
+
+    // The connectivity checks below read /common/connectivity_checksum, which belongs to the
+    // static region and is therefore complete before the updatable data is loaded.
+    if (std::filesystem::exists(config.GetPath(".osrm.hsgr")))
+    {
+        loaders.push_back(
+            {config.GetPath(".osrm.hsgr"),
+             [&]
+             {
+                 const std::string metric_prefix = "/ch/metrics/" + metric_name;
+                 auto contracted_metric = make_contracted_metric_view(index, metric_prefix);
+                 std::unordered_map<std::string, contractor::ContractedMetricView> metrics = {
+                     {metric_name, std::move(contracted_metric)}};
+
+                 std::uint32_t graph_connectivity_checksum = 0;
+                 contractor::files::readGraph(
+                     config.GetPath(".osrm.hsgr"), metrics, graph_connectivity_checksum);
+
+                 if (config.IsRequiredConfiguredInput("osrm.edges"))
+                 {
+                     auto turns_connectivity_checksum =
+                         *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
+                     if (turns_connectivity_checksum != graph_connectivity_checksum)
+                     {
+                         throw util::exception(
+                             "Connectivity checksum " +
+                             std::to_string(graph_connectivity_checksum) + " in " +
+                             config.GetPath(".osrm.hsgr").string() +
+                             " does not equal to checksum " +
+                             std::to_string(turns_connectivity_checksum) + " in " +
+                             config.GetPath(".osrm.edges").string());
+                     }
+                 }
+             }});
     }
 
     if (std::filesystem::exists(config.GetPath(".osrm.cell_metrics")))
     {
-        auto exclude_metrics = make_cell_metric_view(index, "/mld/metrics/" + metric_name);
-        std::unordered_map<std::string, std::vector<customizer::CellMetricView>> metrics = {
-            {metric_name, std::move(exclude_metrics)},
-        };
-        customizer::files::readCellMetrics(config.GetPath(".osrm.cell_metrics"), metrics);
+        loaders.push_back(
+            {config.GetPath(".osrm.cell_metrics"),
+             [&]
+             {
+                 auto exclude_metrics =
+                     make_cell_metric_view(index, "/mld/metrics/" + metric_name);
+                 std::unordered_map<std::string, std::vector<customizer::CellMetricView>>
+                     metrics = {
+                         {metric_name, std::move(exclude_metrics)},
+                     };
+                 customizer::files::readCellMetrics(config.GetPath(".osrm.cell_metrics"),
+                                                    metrics);
+             }});
     }
 
-    if (std::filesystem::exists(config.GetPath(".osrm.mldgr")))
+    if (std::filesystem::exists(config.GetPath(".osrm.speed_profiles")))
     {
-        auto graph_view = make_multi_level_graph_view(index, "/mld/multilevelgraph");
-        std::uint32_t graph_connectivity_checksum = 0;
-        customizer::files::readGraph(
-            config.GetPath(".osrm.mldgr"), graph_view, graph_connectivity_checksum);
+        loaders.push_back({config.GetPath(".osrm.speed_profiles"),
+                           [&]
+                           {
+                               auto profiles =
+                                   make_speed_profiles_view(index, "/mld/speed_profiles");
+                               customizer::files::readSpeedProfiles(
+                                   config.GetPath(".osrm.speed_profiles"), profiles);
+                           }});
+    }
 
-        if (config.IsRequiredConfiguredInput("osrm.edges"))
-        {
-            auto turns_connectivity_checksum =
-                *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
-            if (turns_connectivity_checksum != graph_connectivity_checksum)
-            {
-                throw util::exception(
-                    "Connectivity checksum " + std::to_string(graph_connectivity_checksum) +
-                    " in " + config.GetPath(".osrm.mldgr").string() +
-                    " does not equal to checksum " + std::to_string(turns_connectivity_checksum) +
-                    " in " + config.GetPath(".osrm.edges").string());
-            }
-        }
+    if (std::filesystem::exists(config.GetPath(".osrm.mldgr")))
+    {
+        loaders.push_back(
+            {config.GetPath(".osrm.mldgr"),
+             [&]
+             {
+                 auto graph_view = make_multi_level_graph_view(index, "/mld/multilevelgraph");
+                 std::uint32_t graph_connectivity_checksum = 0;
+                 customizer::files::readGraph(
+                     config.GetPath(".osrm.mldgr"), graph_view, graph_connectivity_checksum);
+
+                 if (config.IsRequiredConfiguredInput("osrm.edges"))
+                 {
+                     auto turns_connectivity_checksum =
+                         *index.GetBlockPtr<std::uint32_t>("/common/connectivity_checksum");
+                     if (turns_connectivity_checksum != graph_connectivity_checksum)
+                     {
+                         throw util::exception(
+                             "Connectivity checksum " +
+                             std::to_string(graph_connectivity_checksum) + " in " +
+                             config.GetPath(".osrm.mldgr").string() +
+                             " does not equal to checksum " +
+                             std::to_string(turns_connectivity_checksum) + " in " +
+                             config.GetPath(".osrm.edges").string());
+                     }
+                 }
+             }});
     }
+
+    runLoaders("updatable", loaders);
 }
 } // namespace osrm::storage
@@ -0,0 +1,202 @@
+#include "storage/storage.hpp"
+#include "storage/tar.hpp"
+#include "osrm/storage_config.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include "util/program_options_path.hpp"
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+using namespace osrm;
+
+// Rewrites one dataset file entry by entry. The new file is written next to the old one and
+// only replaces it once it is complete.
+void convertFile(const std::filesystem::path &path, const bool compress)
+{
+    const auto converted_path = std::filesystem::path(path.string() + ".tmp");
+    std::size_t compressed_blocks = 0;
+
+    TIMER_START(convert);
+    {
+        storage::tar::FileReader reader(path, storage::tar::FileReader::VerifyFingerprint);
+        std::vector<storage::tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+
+        storage::tar::FileWriter writer(converted_path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        compress ? storage::tar::FileWriter::CompressBlocks
+                                                 : storage::tar::FileWriter::Uncompressed);
+        std::vector<char> buffer;
+        for (const auto &entry : entries)
+        {
+            if (entry.name == "osrm_fingerprint.meta")
+                continue;
+
+            buffer.resize(entry.size);
+            reader.ReadInto(entry.name, buffer.data(), buffer.size());
+            writer.WriteFrom(entry.name, buffer.data(), buffer.size());
+
+            if (compress && entry.size >= storage::tar::detail::COMPRESSION_THRESHOLD &&
+                !entry.name.ends_with(".meta"))
+            {
+                ++compressed_blocks;
+            }
+        }
+    }
+    TIMER_STOP(convert);
+
+    const auto old_size = std::filesystem::file_size(path);
+    const auto new_size = std::filesystem::file_size(converted_path);
+    std::filesystem::rename(converted_path, path);
+
+    util::Log() << path.string() << ": " << old_size / (1024 * 1024) << " MiB -> "
+                << new_size / (1024 * 1024) << " MiB"
+                << (compress ? " (" + std::to_string(compressed_blocks) + " blocks compressed)"
+                             : "")
+                << " in " << TIMER_SEC(convert) << "s";
+}
+
+bool generateCompressOptions(const int argc,
+                             const char *argv[],
+                             std::string &verbosity,
+                             std::filesystem::path &base_path,
+                             bool &decompress)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("decompress",
+         boost::program_options::value<bool>(&decompress)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Store all blocks uncompressed again, e.g. to use the dataset with osrm-routed --mmap");
+
+    // hidden options, will be allowed on command line but will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("base,b",
+                                 boost::program_options::value<std::filesystem::path>(&base_path),
+                                 "base path to .osrm file");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        std::filesystem::path(executable).filename().string() + " [<options>] <base.osrm>");
+    visible_options.add(generic_options).add(config_options);
+
+    // print help options if no infile is specified
+    if (argc < 2)
+    {
+        util::Log() << visible_options;
+        return false;
+    }
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return false;
+    }
+
+    if (option_variables.contains("version"))
+    {
+        util::Log() << OSRM_VERSION;
+        return false;
+    }
+
+    if (option_variables.contains("help"))
+    {
+        util::Log() << visible_options;
+        return false;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    return true;
+}
+
+int main(const int argc, const char *argv[])
+try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::string verbosity;
+    std::filesystem::path base_path;
+    bool decompress = false;
+    if (!generateCompressOptions(argc, argv, verbosity, base_path, decompress))
+    {
+        return EXIT_SUCCESS;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(verbosity);
+
+    storage::StorageConfig config(base_path);
+    if (!config.IsValid())
+    {
+        util::Log(logERROR) << "Config contains invalid file paths. Exiting!";
+        return EXIT_FAILURE;
+    }
+    storage::Storage storage(config);
+
+    auto files = storage.GetStaticFiles();
+    const auto updatable_files = storage.GetUpdatableFiles();
+    files.insert(files.end(), updatable_files.begin(), updatable_files.end());
+
+    for (const auto &file : files)
+    {
+        if (std::filesystem::exists(file.second))
+        {
+            convertFile(file.second, !decompress);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const util::exception &e)
+{
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
@@ -3,6 +3,7 @@
 #include "osrm/contractor_config.hpp"
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timezones.hpp"
 #include "util/version.hpp"
 
@@ -31,6 +32,7 @@ enum class return_code : unsigned
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           std::filesystem::path &phase_profile_path,
                            contractor::ContractorConfig &contractor_config)
 {
     // declare a group of options that will be allowed only on command line
@@ -39,7 +41,10 @@ return_code parseArguments(int argc,
         "list-inputs", "List required and optional input file extensions")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-profile",
+        boost::program_options::value<std::filesystem::path>(&phase_profile_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed on command line
     boost::program_options::options_description config_options("Configuration");
@@ -74,6 +79,30 @@ return_code parseArguments(int argc,
         boost::program_options::value<std::string>(&contractor_config.updater_config.tz_file_path),
         "Required for conditional turn restriction parsing, provide a geojson file containing "
         "time zone boundaries")(
+        "cch",
+        boost::program_options::value<bool>(&contractor_config.cch)
+            ->default_value(false)
+            ->implicit_value(true),
+        "Build a customizable contraction hierarchy from the partition of osrm-partition once "
+        "and only customize it with the current weights on later runs")(
+        "metric-only",
+        boost::program_options::value<bool>(&contractor_config.metric_only)
+            ->default_value(false)
+            ->implicit_value(true),
+        "Reuse the node order and shortcuts of the existing .osrm.hsgr and only recompute their "
+        "weights for the current speeds and turn penalties")(
+        "repair-witnesses",
+        boost::program_options::value<bool>(&contractor_config.repair_witnesses)
+            ->default_value(false)
+            ->implicit_value(true),
+        "With --metric-only, add the shortcuts that the new weights require. Slower, but the "
+        "routes are as exact as after a full contraction")(
+        "share-exclude-contraction",
+        boost::program_options::value<bool>(&contractor_config.share_exclude_contraction)
+            ->default_value(false)
+            ->implicit_value(true),
+        "Contract the graph only for the exclude filter that allows the most nodes and reuse its "
+        "node order for the other filters of the profile instead of contracting once per filter")(
         "output,o",
         boost::program_options::value<std::filesystem::path>(&contractor_config.output_path),
         "Output base path for generated files (default: same as input)");
@@ -152,9 +181,11 @@ try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    std::filesystem::path phase_profile_path;
     contractor::ContractorConfig contractor_config;
 
-    const return_code result = parseArguments(argc, argv, verbosity, contractor_config);
+    const return_code result =
+        parseArguments(argc, argv, verbosity, phase_profile_path, contractor_config);
 
     if (return_code::fail == result)
     {
@@ -188,6 +219,18 @@ try
         contractor_config.output_path = path;
     }
 
+    if (contractor_config.cch && contractor_config.metric_only)
+    {
+        util::Log(logERROR) << "--cch and --metric-only can not be combined";
+        return EXIT_FAILURE;
+    }
+
+    if (contractor_config.repair_witnesses && !contractor_config.metric_only)
+    {
+        util::Log(logERROR) << "--repair-witnesses requires --metric-only";
+        return EXIT_FAILURE;
+    }
+
     if (1 > contractor_config.requested_num_threads)
     {
         util::Log(logERROR) << "Number of threads must be 1 or larger";
@@ -210,8 +253,18 @@ try
     util::Log() << "Input file: " << contractor_config.base_path.string() << ".osrm";
     util::Log() << "Threads: " << contractor_config.requested_num_threads;
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().Enable();
+    }
+
     osrm::contract(contractor_config);
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().WriteJSON(phase_profile_path, "osrm-contract");
+    }
+
     util::DumpMemoryStats();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,186 @@
+#include "extractor/raster_source.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+using namespace osrm;
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+return_code generateConvertOptions(const int argc,
+                                   const char *argv[],
+                                   std::string &verbosity,
+                                   std::string &input_path,
+                                   std::string &output_path,
+                                   std::size_t &rows,
+                                   std::size_t &columns,
+                                   std::uint32_t &tile_size)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         boost::program_options::value<std::string>(&output_path)->required(),
+         "Tiled raster file to write") //
+        ("rows",
+         boost::program_options::value<std::size_t>(&rows)->required(),
+         "Number of rows of the ASCII grid") //
+        ("columns",
+         boost::program_options::value<std::size_t>(&columns)->required(),
+         "Number of columns of the ASCII grid") //
+        ("tile-size",
+         boost::program_options::value<std::uint32_t>(&tile_size)
+             ->default_value(extractor::DEFAULT_RASTER_TILE_SIZE),
+         "Number of rows and columns of a tile");
+
+    // hidden options, will be allowed on command line but will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "input",
+        boost::program_options::value<std::string>(&input_path)->required(),
+        "ASCII grid to convert");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        std::filesystem::path(executable).filename().string() +
+        " [<options>] --rows <rows> --columns <columns> -o <output> <input.asc>");
+    visible_options.add(generic_options).add(config_options);
+
+    // print help options if no infile is specified
+    if (argc < 2)
+    {
+        util::Log() << visible_options;
+        return return_code::fail;
+    }
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (option_variables.contains("version"))
+    {
+        util::Log() << OSRM_VERSION;
+        return return_code::exit;
+    }
+
+    if (option_variables.contains("help"))
+    {
+        util::Log() << visible_options;
+        return return_code::exit;
+    }
+
+    try
+    {
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+
+int main(const int argc, const char *argv[])
+try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::string verbosity;
+    std::string input_path;
+    std::string output_path;
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+    std::uint32_t tile_size = extractor::DEFAULT_RASTER_TILE_SIZE;
+    const auto result = generateConvertOptions(
+        argc, argv, verbosity, input_path, output_path, rows, columns, tile_size);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(verbosity);
+
+    if (!std::filesystem::exists(input_path))
+    {
+        util::Log(logERROR) << "Input file " << input_path << " not found!";
+        return EXIT_FAILURE;
+    }
+
+    TIMER_START(convert);
+    extractor::convertToTiledRaster(input_path, output_path, columns, rows, tile_size);
+    TIMER_STOP(convert);
+
+    util::Log() << "Converted " << input_path << " to " << output_path << " ("
+                << std::filesystem::file_size(output_path) / 1024 << " KiB) in "
+                << TIMER_SEC(convert) << "s";
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const util::exception &e)
+{
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
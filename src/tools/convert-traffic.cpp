@@ -0,0 +1,198 @@
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace osrm;
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+return_code generateConvertOptions(const int argc,
+                                   const char *argv[],
+                                   std::string &verbosity,
+                                   std::vector<std::string> &input_paths,
+                                   std::string &output_path,
+                                   bool &turn_penalties,
+                                   bool &delta_encode)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("output,o",
+         boost::program_options::value<std::string>(&output_path)->required(),
+         "Binary file to write") //
+        ("turn-penalties",
+         boost::program_options::value<bool>(&turn_penalties)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Convert turn penalty files instead of segment speed files") //
+        ("delta-encode",
+         boost::program_options::value<bool>(&delta_encode)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Store the node IDs as differences, which makes the file about half as large but "
+         "decodes on a single thread");
+
+    // hidden options, will be allowed on command line but will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("input",
+                                 boost::program_options::value<std::vector<std::string>>(
+                                     &input_paths)
+                                     ->composing(),
+                                 "CSV or binary files to convert");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", -1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        std::filesystem::path(executable).filename().string() +
+        " [<options>] -o <output> <input.csv>...");
+    visible_options.add(generic_options).add(config_options);
+
+    // print help options if no infile is specified
+    if (argc < 2)
+    {
+        util::Log() << visible_options;
+        return return_code::fail;
+    }
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (option_variables.contains("version"))
+    {
+        util::Log() << OSRM_VERSION;
+        return return_code::exit;
+    }
+
+    if (option_variables.contains("help"))
+    {
+        util::Log() << visible_options;
+        return return_code::exit;
+    }
+
+    try
+    {
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (input_paths.empty())
+    {
+        util::Log(logERROR) << "No input files given";
+        return return_code::fail;
+    }
+
+    return return_code::ok;
+}
+
+int main(const int argc, const char *argv[])
+try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::string verbosity;
+    std::vector<std::string> input_paths;
+    std::string output_path;
+    bool turn_penalties = false;
+    bool delta_encode = false;
+    const auto result = generateConvertOptions(
+        argc, argv, verbosity, input_paths, output_path, turn_penalties, delta_encode);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(verbosity);
+
+    // Several input files are merged with the same precedence as on the command line of
+    // osrm-contract and osrm-customize, the later file wins.
+    TIMER_START(convert);
+    if (turn_penalties)
+    {
+        updater::binary::writeTurnValues(
+            output_path, updater::csv::readTurnValues(input_paths), delta_encode);
+    }
+    else
+    {
+        updater::binary::writeSegmentValues(
+            output_path, updater::csv::readSegmentValues(input_paths), delta_encode);
+    }
+    TIMER_STOP(convert);
+
+    util::Log() << "Converted " << input_paths.size() << " file(s) to " << output_path << " ("
+                << std::filesystem::file_size(output_path) / 1024 << " KiB) in "
+                << TIMER_SEC(convert) << "s";
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const util::exception &e)
+{
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
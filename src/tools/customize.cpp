@@ -3,6 +3,7 @@
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/version.hpp"
 
 #include "util/program_options_path.hpp"
@@ -26,6 +27,7 @@ enum class return_code : unsigned
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           std::filesystem::path &phase_profile_path,
                            customizer::CustomizationConfig &customization_config)
 {
     // declare a group of options that will be allowed only on command line
@@ -34,7 +36,10 @@ return_code parseArguments(int argc,
         "list-inputs", "List required and optional input file extensions")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-profile",
+        boost::program_options::value<std::filesystem::path>(&phase_profile_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -74,6 +79,30 @@ return_code parseArguments(int argc,
                 ->default_value(""),
             "Required for conditional turn restriction parsing, provide a geojson file containing "
             "time zone boundaries")(
+            "incremental",
+            boost::program_options::value<bool>(&customization_config.incremental)
+                ->default_value(false)
+                ->implicit_value(true),
+            "Only recustomize the cells containing segments changed by this or the previous "
+            "update, reusing the metrics of the previous run for all other cells")(
+            "microcode",
+            boost::program_options::value<bool>(&customization_config.microcode)
+                ->default_value(false)
+                ->implicit_value(true),
+            "Customize the cells covered by the .osrm.cell_microcode file written by "
+            "osrm-partition --microcode-max-cell-size instead of searching them")(
+            "speed-profile-file",
+            boost::program_options::value<std::vector<std::string>>(
+                &customization_config.speed_profile_lookup_paths)
+                ->composing(),
+            "Lookup files containing profile, second of the week and speed data of periodic speed "
+            "profiles for routes with a departure time")(
+            "segment-profile-file",
+            boost::program_options::value<std::vector<std::string>>(
+                &customization_config.segment_profile_lookup_paths)
+                ->composing(),
+            "Lookup files containing nodeA, nodeB, profile data to assign speed profiles to "
+            "segments. Use with `--speed-profile-file`")(
             "output,o",
             boost::program_options::value<std::filesystem::path>(&customization_config.output_path),
             "Output base path for generated files (default: same as input)");
@@ -152,9 +181,11 @@ try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    std::filesystem::path phase_profile_path;
     customizer::CustomizationConfig customization_config;
 
-    const auto result = parseArguments(argc, argv, verbosity, customization_config);
+    const auto result =
+        parseArguments(argc, argv, verbosity, phase_profile_path, customization_config);
 
     if (return_code::fail == result)
     {
@@ -189,6 +220,13 @@ try
         customization_config.output_path = path;
     }
 
+    if (!customization_config.segment_profile_lookup_paths.empty() &&
+        customization_config.speed_profile_lookup_paths.empty())
+    {
+        util::Log(logERROR) << "--segment-profile-file requires --speed-profile-file";
+        return EXIT_FAILURE;
+    }
+
     if (1 > customization_config.requested_num_threads)
     {
         util::Log(logERROR) << "Number of threads must be 1 or larger";
@@ -200,8 +238,18 @@ try
         return EXIT_FAILURE;
     }
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().Enable();
+    }
+
     auto exitcode = customizer::Customizer().Run(customization_config);
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().WriteJSON(phase_profile_path, "osrm-customize");
+    }
+
     util::DumpMemoryStats();
 
     return exitcode;
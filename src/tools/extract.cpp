@@ -4,6 +4,7 @@
 #include "util/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/version.hpp"
 
 #include "util/program_options_path.hpp"
@@ -26,6 +27,7 @@ enum class return_code : unsigned
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           std::filesystem::path &phase_profile_path,
                            extractor::ExtractorConfig &extractor_config)
 {
     // declare a group of options that will be allowed only on command line
@@ -34,7 +36,10 @@ return_code parseArguments(int argc,
         "list-inputs", "List required and optional input file extensions")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-profile",
+        boost::program_options::value<std::filesystem::path>(&phase_profile_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -76,11 +81,25 @@ return_code parseArguments(int argc,
             ->implicit_value(false)
             ->default_value(true),
         "Use internal nodes locations cache for location-dependent data lookups")(
+        "location-cache-file",
+        boost::program_options::bool_switch(&extractor_config.use_locations_cache_file)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Keep the nodes locations cache in a sparse file in the sort directory instead of in "
+        "memory. The file takes 8 bytes per ID up to the largest node ID")(
         "dump-nbg-graph",
         boost::program_options::bool_switch(&extractor_config.dump_nbg_graph)
             ->implicit_value(true)
             ->default_value(false),
         "Dump raw node-based graph to *.osrm file for debug purposes.")(
+        "sort-memory-budget",
+        boost::program_options::value<unsigned int>(&extractor_config.sort_memory_budget)
+            ->default_value(0),
+        "Memory in MiB for sorting the node and edge lists, which are spilled to disk in "
+        "sorted runs when set. 0 sorts them in memory")(
+        "sort-directory",
+        boost::program_options::value<std::filesystem::path>(&extractor_config.sort_directory),
+        "Directory for the sorted runs (default: directory of the output files)")(
         "output,o",
         boost::program_options::value<std::filesystem::path>(&extractor_config.output_path),
         "Output base path for generated files (default: derived from input file name)");
@@ -163,8 +182,10 @@ try
     util::LogPolicy::GetInstance().Unmute();
     extractor::ExtractorConfig extractor_config;
     std::string verbosity;
+    std::filesystem::path phase_profile_path;
 
-    const auto result = parseArguments(argc, argv, verbosity, extractor_config);
+    const auto result =
+        parseArguments(argc, argv, verbosity, phase_profile_path, extractor_config);
 
     if (return_code::fail == result)
     {
@@ -207,8 +228,18 @@ try
         return EXIT_FAILURE;
     }
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().Enable();
+    }
+
     osrm::extract(extractor_config);
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().WriteJSON(phase_profile_path, "osrm-extract");
+    }
+
     util::DumpMemoryStats();
 
     return EXIT_SUCCESS;
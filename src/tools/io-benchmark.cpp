@@ -2,6 +2,8 @@
 #pragma clang diagnostic ignored "-Wunreachable-code"
 #endif
 
+#include "storage/tar.hpp"
+
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/log.hpp"
@@ -17,18 +19,26 @@
 #include <unistd.h>
 #endif
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <numeric>
 #include <random>
+#include <string>
 #include <vector>
 
 namespace osrm::tools
 {
 
 const unsigned NUMBER_OF_ELEMENTS = 268435456;
+// Matches the chunk size osrm-datastore uses for large blocks
+const std::size_t PARALLEL_CHUNK_SIZE = 16 * 1024 * 1024;
 
 struct Statistics
 {
@@ -48,6 +58,90 @@ void runStatistics(std::vector<double> &timings_vector, Statistics &stats)
         timings_vector.begin(), timings_vector.end(), timings_vector.begin(), 0.0);
     stats.dev = std::sqrt(primary_sq_sum / timings_vector.size() - (stats.mean * stats.mean));
 }
+
+// Loads every block of a dataset file, then writes a compressed copy of it and loads that.
+// Drop the page cache between runs to compare cold loads.
+void compareCompressed(const std::filesystem::path &path)
+{
+    const std::string fingerprint_name = "osrm_fingerprint.meta";
+    const auto loadAll = [](const std::filesystem::path &file)
+    {
+        storage::tar::FileReader reader(file, storage::tar::FileReader::VerifyFingerprint);
+        std::vector<storage::tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+
+        std::map<std::string, std::vector<char>> blocks;
+        for (const auto &entry : entries)
+        {
+            auto &block = blocks[entry.name];
+            block.resize(entry.size);
+            reader.ReadInto(entry.name, block.data(), entry.size);
+        }
+        return blocks;
+    };
+
+    const auto compressed_path = std::filesystem::path(path.string() + ".compressed.tst");
+    if (std::filesystem::exists(compressed_path))
+    {
+        throw util::exception("Data file already exists: " + compressed_path.string() +
+                              SOURCE_REF);
+    }
+
+    TIMER_START(load_raw);
+    const auto blocks = loadAll(path);
+    TIMER_STOP(load_raw);
+
+    {
+        storage::tar::FileReader reader(path, storage::tar::FileReader::VerifyFingerprint);
+        std::vector<storage::tar::FileReader::FileEntry> entries;
+        reader.List(std::back_inserter(entries));
+
+        storage::tar::FileWriter writer(compressed_path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        storage::tar::FileWriter::CompressBlocks);
+        for (const auto &entry : entries)
+        {
+            if (entry.name != fingerprint_name)
+            {
+                const auto &block = blocks.at(entry.name);
+                writer.WriteFrom(entry.name, block.data(), block.size());
+            }
+        }
+    }
+
+    TIMER_START(load_compressed);
+    const auto decompressed_blocks = loadAll(compressed_path);
+    TIMER_STOP(load_compressed);
+
+    const auto raw_size = std::filesystem::file_size(path);
+    const auto compressed_size = std::filesystem::file_size(compressed_path);
+    std::filesystem::remove(compressed_path);
+
+    // the fingerprint of the copy is generated anew, all other blocks must be byte identical
+    for (const auto &[name, block] : blocks)
+    {
+        const auto decompressed = decompressed_blocks.find(name);
+        if (name != fingerprint_name &&
+            (decompressed == decompressed_blocks.end() || decompressed->second != block))
+        {
+            throw util::exception("Compressed copy of " + name + " does not match " +
+                                  path.string() + SOURCE_REF);
+        }
+    }
+    if (decompressed_blocks.size() != blocks.size())
+    {
+        throw util::exception("Compressed copy does not match " + path.string() + SOURCE_REF);
+    }
+
+    util::Log() << "raw: " << raw_size / (1024 * 1024) << " MiB loaded in "
+                << TIMER_SEC(load_raw) << "s (" << std::setprecision(5) << std::fixed
+                << raw_size / (1024. * 1024.) / TIMER_SEC(load_raw) << "MB/sec)";
+    util::Log() << "compressed: " << compressed_size / (1024 * 1024) << " MiB ("
+                << std::setprecision(1) << std::fixed << 100. * compressed_size / raw_size
+                << "%) loaded in " << std::setprecision(5) << TIMER_SEC(load_compressed)
+                << "s (" << raw_size / (1024. * 1024.) / TIMER_SEC(load_compressed)
+                << "MB/sec of raw data)";
+}
 } // namespace osrm::tools
 
 std::filesystem::path test_path;
@@ -68,9 +162,17 @@ int main(int argc, char *argv[])
     if (1 == argc)
     {
         osrm::util::Log(logWARNING) << "usage: " << argv[0] << " /path/on/device";
+        osrm::util::Log(logWARNING) << "       " << argv[0]
+                                    << " --compare-compressed <dataset file, e.g. map.osrm.hsgr>";
         return -1;
     }
 
+    if (3 == argc && std::string(argv[1]) == "--compare-compressed")
+    {
+        osrm::tools::compareCompressed(argv[2]);
+        return EXIT_SUCCESS;
+    }
+
     test_path = std::filesystem::path(argv[1]);
     test_path /= "osrm.tst";
     osrm::util::Log(logDEBUG) << "temporary file: " << test_path.string();
@@ -178,6 +280,49 @@ int main(int argc, char *argv[])
         osrm::util::Log() << "raw read performance: " << std::setprecision(5) << std::fixed
                           << 1024 * 1024 / TIMER_SEC(read_1gb) << "MB/sec";
 
+#ifdef __linux__
+        // Same amount of data, read the way osrm-datastore loads large blocks: fixed-size
+        // chunks fetched with concurrent positioned reads.
+        {
+            const std::size_t file_size = osrm::tools::NUMBER_OF_ELEMENTS * sizeof(unsigned);
+            const std::size_t number_of_chunks =
+                (file_size + osrm::tools::PARALLEL_CHUNK_SIZE - 1) /
+                osrm::tools::PARALLEL_CHUNK_SIZE;
+            const int parallel_desc = open(test_path.string().c_str(), O_RDONLY | O_DIRECT);
+            if (-1 == parallel_desc)
+            {
+                throw osrm::util::exception("Could not open random data file" +
+                                            test_path.string() + SOURCE_REF);
+            }
+
+            TIMER_START(parallel_read_1gb);
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, number_of_chunks, 1),
+                [&](const tbb::blocked_range<std::size_t> &range)
+                {
+                    for (auto chunk = range.begin(); chunk != range.end(); ++chunk)
+                    {
+                        const auto offset = chunk * osrm::tools::PARALLEL_CHUNK_SIZE;
+                        const auto size =
+                            std::min(osrm::tools::PARALLEL_CHUNK_SIZE, file_size - offset);
+                        if (0 > pread(parallel_desc, raw_array + offset, size, offset))
+                        {
+                            throw osrm::util::exception("parallel read error" + SOURCE_REF);
+                        }
+                    }
+                });
+            TIMER_STOP(parallel_read_1gb);
+            close(parallel_desc);
+
+            osrm::util::Log(logDEBUG) << "reading raw 1GB in parallel took "
+                                      << TIMER_SEC(parallel_read_1gb) << "s";
+            osrm::util::Log() << "parallel read performance (" << number_of_chunks << " chunks, "
+                              << tbb::this_task_arena::max_concurrency()
+                              << " threads): " << std::setprecision(5) << std::fixed
+                              << 1024 * 1024 / TIMER_SEC(parallel_read_1gb) << "MB/sec";
+        }
+#endif
+
         std::vector<double> timing_results_raw_random;
         osrm::util::Log(logDEBUG) << "running 1000 random I/Os of 4KB";
 
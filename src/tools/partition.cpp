@@ -1,9 +1,11 @@
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/partitioner.hpp"
 #include "partitioner/partitioner_config.hpp"
 
 #include "osrm/exception.hpp"
 #include "util/log.hpp"
 #include "util/meminfo.hpp"
+#include "util/phase_profiler.hpp"
 #include "util/timing_util.hpp"
 #include "util/version.hpp"
 
@@ -74,6 +76,7 @@ void validate(boost::any &v, const std::vector<std::string> &values, MaxCellSize
 return_code parseArguments(int argc,
                            char *argv[],
                            std::string &verbosity,
+                           std::filesystem::path &phase_profile_path,
                            partitioner::PartitionerConfig &config)
 {
     // declare a group of options that will be allowed only on command line
@@ -82,7 +85,10 @@ return_code parseArguments(int argc,
         "list-inputs", "List required and optional input file extensions")(
         "verbosity,l",
         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
-        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+        std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str())(
+        "phase-profile",
+        boost::program_options::value<std::filesystem::path>(&phase_profile_path),
+        "Write the wall time, CPU time, peak memory and I/O of every phase as JSON to this file");
 
     // declare a group of options that will be allowed both on command line
     boost::program_options::options_description config_options("Configuration");
@@ -116,7 +122,23 @@ return_code parseArguments(int argc,
          boost::program_options::value<MaxCellSizesArgument>()->default_value(
              MaxCellSizesArgument{config.max_cell_sizes}),
          "Maximum cell sizes starting from the level 1. The first cell size value is a bisection "
-         "termination criterion")(
+         "termination criterion")
+        //
+        ("microcode-max-cell-size",
+         boost::program_options::value<std::size_t>(&config.microcode_max_cell_size)
+             ->default_value(config.microcode_max_cell_size),
+         ("Precompute a customization microcode for all cells whose customization graph has at "
+          "most this many nodes, used by osrm-customize --microcode (0 disables it, at most " +
+          std::to_string(partitioner::CellMicrocode::MAX_CELL_VERTICES) +
+          "). Customizing a cell of n nodes takes " +
+          std::to_string(partitioner::CellMicrocode::SCRATCH_BYTES_PER_VERTEX_PAIR) +
+          " * n * n bytes of memory per thread")
+             .c_str())
+        //
+        ("hilbert-order",
+         boost::program_options::bool_switch(&config.hilbert_order)->default_value(false),
+         "Number the nodes of every cell along a Hilbert curve for a better memory locality of "
+         "the query graphs")(
             "output,o",
             boost::program_options::value<std::filesystem::path>(&config.output_path),
             "Output base path for generated files (default: same as input)");
@@ -197,6 +219,16 @@ return_code parseArguments(int argc,
         }
     }
 
+    if (config.microcode_max_cell_size > partitioner::CellMicrocode::MAX_CELL_VERTICES)
+    {
+        util::Log(logERROR) << "The microcode maximum cell size must be at most "
+                            << partitioner::CellMicrocode::MAX_CELL_VERTICES
+                            << ", its customization needs "
+                            << partitioner::CellMicrocode::SCRATCH_BYTES_PER_VERTEX_PAIR
+                            << " bytes per pair of cell nodes and thread.";
+        return return_code::fail;
+    }
+
     return return_code::ok;
 }
 
@@ -205,9 +237,11 @@ try
 {
     util::LogPolicy::GetInstance().Unmute();
     std::string verbosity;
+    std::filesystem::path phase_profile_path;
     partitioner::PartitionerConfig partition_config;
 
-    const auto result = parseArguments(argc, argv, verbosity, partition_config);
+    const auto result =
+        parseArguments(argc, argv, verbosity, phase_profile_path, partition_config);
 
     if (return_code::fail == result)
     {
@@ -270,11 +304,21 @@ try
 
     util::Log() << "Computing recursive bisection";
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().Enable();
+    }
+
     TIMER_START(bisect);
     auto exitcode = partitioner::Partitioner().Run(partition_config);
     TIMER_STOP(bisect);
     util::Log() << "Bisection took " << TIMER_SEC(bisect) << " seconds.";
 
+    if (!phase_profile_path.empty())
+    {
+        util::PhaseProfiler::GetInstance().WriteJSON(phase_profile_path, "osrm-partition");
+    }
+
     util::DumpMemoryStats();
 
     return exitcode;
@@ -112,7 +112,8 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              int &requested_thread_num,
                                              short &keepalive_timeout,
                                              unsigned &max_header_size,
-                                             std::uint64_t &max_body_size)
+                                             std::uint64_t &max_body_size,
+                                             bool &coalesce_requests)
 {
     using boost::program_options::value;
     using std::filesystem::path;
@@ -158,6 +159,10 @@ inline unsigned generateServerProgramOptions(const int argc,
             "mmap,m",
             value<bool>(&config.use_mmap)->implicit_value(true)->default_value(false),
             "Map datafiles directly, do not use any additional memory.") //
+        ("huge-pages",
+         value<bool>(&config.use_huge_pages)->implicit_value(true)->default_value(false),
+         "Back the data with transparent huge pages to reduce TLB misses. Has no effect with "
+         "--shared-memory, use osrm-datastore --huge-pages instead.") //
         ("dataset-name",
          value<std::string>(&config.dataset_name),
          "Name of the shared memory dataset to connect to.") //
@@ -200,7 +205,11 @@ inline unsigned generateServerProgramOptions(const int argc,
             "max-request-body-size",
             value<std::uint64_t>(&max_body_size)->default_value(0),
             "Maximum size in bytes of the HTTP request body (JSON POST requests). Default: auto "
-            "(based on maximum coordinates).");
+            "(based on maximum coordinates).")(
+            "coalesce-requests",
+            value<bool>(&coalesce_requests)->implicit_value(true)->default_value(false),
+            "Run concurrent requests with identical parameters only once and share the "
+            "response between them.");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -304,6 +313,7 @@ try
     // Size of 0 means: Determine automatically based on coordinate limits.
     unsigned max_header_size = 0;
     std::uint64_t max_body_size = 0;
+    bool coalesce_requests = false;
     const unsigned init_result = generateServerProgramOptions(argc,
                                                               argv,
                                                               base_path,
@@ -314,7 +324,8 @@ try
                                                               requested_thread_num,
                                                               keepalive_timeout,
                                                               max_header_size,
-                                                              max_body_size);
+                                                              max_body_size,
+                                                              coalesce_requests);
     if (init_result == INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -357,6 +368,7 @@ try
     util::Log() << "Keepalive timeout: " << keepalive_timeout;
     util::Log() << "Maximum header size: " << max_header_size;
     util::Log() << "Maximum request body size: " << max_body_size;
+    util::Log() << "Request coalescing: " << (coalesce_requests ? "on" : "off");
 
 #ifndef _WIN32
     int sig = 0;
@@ -368,7 +380,7 @@ try
     pthread_sigmask(SIG_BLOCK, &wait_mask, nullptr); // only block necessary signals
 #endif
 
-    auto service_handler = std::make_unique<server::ServiceHandler>(config);
+    auto service_handler = std::make_unique<server::ServiceHandler>(config, coalesce_requests);
     auto routing_server = server::Server::CreateServer(ip_address,
                                                        ip_port,
                                                        requested_thread_num,
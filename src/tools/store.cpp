@@ -104,6 +104,8 @@ bool generateDataStoreOptions(const int argc,
                               bool &list_datasets,
                               bool &list_blocks,
                               bool &only_metric,
+                              bool &share_unchanged_blocks,
+                              bool &huge_pages,
                               std::vector<storage::FeatureDataset> &disable_feature_dataset)
 {
     // declare a group of options that will be allowed only on command line
@@ -152,7 +154,19 @@ bool generateDataStoreOptions(const int argc,
                 ->implicit_value(true),
             "Only reload the metric data without updating the full dataset. This is an "
             "optimization "
-            "for traffic updates.");
+            "for traffic updates.")(
+            "share-unchanged-blocks",
+            boost::program_options::value<bool>(&share_unchanged_blocks)
+                ->default_value(false)
+                ->implicit_value(true),
+            "With --only-metric, only allocate the blocks that differ from the last full load "
+            "and share all others with it. Requires osrm-routed of the same version.")(
+            "huge-pages",
+            boost::program_options::value<bool>(&huge_pages)
+                ->default_value(false)
+                ->implicit_value(true),
+            "Back the shared memory regions with huge pages to reduce TLB misses. Uses the "
+            "reserved huge page pool if it is large enough, transparent huge pages otherwise.");
 
     // hidden options, will be allowed on command line but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -257,6 +271,8 @@ try
     bool list_datasets = false;
     bool list_blocks = false;
     bool only_metric = false;
+    bool share_unchanged_blocks = false;
+    bool huge_pages = false;
     std::vector<storage::FeatureDataset> disable_feature_dataset;
     if (!generateDataStoreOptions(argc,
                                   argv,
@@ -267,6 +283,8 @@ try
                                   list_datasets,
                                   list_blocks,
                                   only_metric,
+                                  share_unchanged_blocks,
+                                  huge_pages,
                                   disable_feature_dataset))
     {
         return EXIT_SUCCESS;
@@ -288,7 +306,12 @@ try
     }
     storage::Storage storage(std::move(config));
 
-    return storage.Run(max_wait, dataset_name, only_metric);
+    if (share_unchanged_blocks && !only_metric)
+    {
+        util::Log(logWARNING) << "--share-unchanged-blocks has no effect without --only-metric";
+    }
+
+    return storage.Run(max_wait, dataset_name, only_metric, share_unchanged_blocks, huge_pages);
 }
 catch (const osrm::RuntimeError &e)
 {
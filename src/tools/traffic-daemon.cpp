@@ -0,0 +1,419 @@
+#include "customizer/customizer.hpp"
+#include "storage/storage.hpp"
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+#include "osrm/storage_config.hpp"
+
+#include "osrm/exception.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include "util/program_options_path.hpp"
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct DaemonConfig
+{
+    std::filesystem::path base_path;
+    std::filesystem::path spool_directory;
+    std::filesystem::path state_path;
+    std::string dataset_name;
+    int max_wait = -1;
+    unsigned poll_interval = 5;
+    unsigned requested_num_threads = 0;
+    bool microcode = false;
+    bool once = false;
+};
+
+// The state file and all deltas are passed to the updater's reader together, which has a limit
+// of 255 files.
+constexpr std::size_t MAX_DELTAS_PER_UPDATE = 254;
+
+std::atomic<bool> stop_requested{false};
+
+// Only the daemon writes the state file, so every later update would fail on it the same way
+struct StateFileError : util::exception
+{
+    using util::exception::exception;
+};
+
+void requestStop(int) { stop_requested = true; }
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+return_code generateDaemonOptions(const int argc,
+                                  const char *argv[],
+                                  std::string &verbosity,
+                                  DaemonConfig &config)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         boost::program_options::value<std::string>(&verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("spool-dir",
+         boost::program_options::value<std::filesystem::path>(&config.spool_directory)
+             ->required(),
+         "Directory to watch for segment speed files, CSV or written by osrm-convert-traffic") //
+        ("state-file",
+         boost::program_options::value<std::filesystem::path>(&config.state_path),
+         "Binary file with the speeds of all updates so far (default: <spool-dir>/state/"
+         "traffic)") //
+        ("poll-interval",
+         boost::program_options::value<unsigned>(&config.poll_interval)->default_value(5),
+         "Number of seconds between two looks into the spool directory") //
+        ("once",
+         boost::program_options::value<bool>(&config.once)->default_value(false)->implicit_value(
+             true),
+         "Apply the files in the spool directory and exit") //
+        ("dataset-name",
+         boost::program_options::value<std::string>(&config.dataset_name)->default_value(""),
+         "Name of the dataset in shared memory to update") //
+        ("max-wait",
+         boost::program_options::value<int>(&config.max_wait)->default_value(-1),
+         "Maximum number of seconds to wait on a running data update before aquiring the lock "
+         "by force") //
+        ("threads,t",
+         boost::program_options::value<unsigned>(&config.requested_num_threads)
+             ->default_value(std::thread::hardware_concurrency()),
+         "Number of threads to use") //
+        ("microcode",
+         boost::program_options::value<bool>(&config.microcode)
+             ->default_value(false)
+             ->implicit_value(true),
+         "Customize the cells covered by .osrm.cell_microcode by evaluating their programs");
+
+    // hidden options, will be allowed on command line but will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "base,b",
+        boost::program_options::value<std::filesystem::path>(&config.base_path)->required(),
+        "base path to .osrm file");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    const auto *executable = argv[0];
+    boost::program_options::options_description visible_options(
+        std::filesystem::path(executable).filename().string() +
+        " [<options>] --spool-dir <directory> <base.osrm>");
+    visible_options.add(generic_options).add(config_options);
+
+    // print help options if no infile is specified
+    if (argc < 2)
+    {
+        util::Log() << visible_options;
+        return return_code::fail;
+    }
+
+    // parse command line options
+    boost::program_options::variables_map option_variables;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (option_variables.contains("version"))
+    {
+        util::Log() << OSRM_VERSION;
+        return return_code::exit;
+    }
+
+    if (option_variables.contains("help"))
+    {
+        util::Log() << visible_options;
+        return return_code::exit;
+    }
+
+    try
+    {
+        boost::program_options::notify(option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return return_code::fail;
+    }
+
+    if (config.state_path.empty())
+    {
+        config.state_path = config.spool_directory / "state" / "traffic";
+    }
+
+    return return_code::ok;
+}
+
+// Returns the files that are ready in the spool directory in the order they are applied.
+// Writers should create files under a name starting with '.' or ending with '.tmp' and rename
+// them once they are complete.
+std::vector<std::filesystem::path> listDeltas(const std::filesystem::path &spool_directory)
+{
+    std::vector<std::filesystem::path> deltas;
+    for (const auto &entry : std::filesystem::directory_iterator(spool_directory))
+    {
+        const auto name = entry.path().filename().string();
+        if (!entry.is_regular_file() || name.starts_with(".") || name.ends_with(".tmp") ||
+            name.ends_with(".failed"))
+        {
+            continue;
+        }
+        deltas.push_back(entry.path());
+    }
+    std::sort(deltas.begin(), deltas.end());
+    if (deltas.size() > MAX_DELTAS_PER_UPDATE)
+    {
+        deltas.resize(MAX_DELTAS_PER_UPDATE);
+    }
+    return deltas;
+}
+
+// Merges the deltas into the state file, a later value for a segment replaces an earlier one.
+// Files that cannot be read are renamed to <name>.failed and skipped, an unreadable state file
+// throws a StateFileError.
+void mergeDeltas(const std::filesystem::path &state_path,
+                 std::vector<std::filesystem::path> deltas)
+{
+    const auto read = [&](const std::vector<std::filesystem::path> &files)
+    {
+        std::vector<std::string> paths;
+        if (std::filesystem::exists(state_path))
+        {
+            paths.push_back(state_path.string());
+        }
+        for (const auto &file : files)
+        {
+            paths.push_back(file.string());
+        }
+        return updater::csv::readSegmentValues(paths);
+    };
+
+    updater::SegmentLookupTable values;
+    try
+    {
+        values = read(deltas);
+    }
+    catch (const util::exception &)
+    {
+        if (std::filesystem::exists(state_path))
+        {
+            try
+            {
+                updater::csv::readSegmentValues({state_path.string()});
+            }
+            catch (const util::exception &e)
+            {
+                throw StateFileError("Cannot read the state file " + state_path.string() +
+                                     ", move it away to start with an empty state: " + e.what());
+            }
+        }
+
+        // find the broken files and leave them out
+        std::vector<std::filesystem::path> readable;
+        for (const auto &delta : deltas)
+        {
+            try
+            {
+                updater::csv::readSegmentValues({delta.string()});
+                readable.push_back(delta);
+            }
+            catch (const util::exception &e)
+            {
+                util::Log(logERROR) << e.what();
+                std::filesystem::rename(delta, delta.string() + ".failed");
+            }
+        }
+        deltas = std::move(readable);
+        values = read(deltas);
+    }
+
+    std::filesystem::create_directories(state_path.parent_path());
+    const auto temporary_path = std::filesystem::path(state_path.string() + ".tmp");
+    updater::binary::writeSegmentValues(temporary_path.string(), values, false);
+    std::filesystem::rename(temporary_path, state_path);
+
+    for (const auto &delta : deltas)
+    {
+        std::filesystem::remove(delta);
+    }
+}
+
+// Customizes the cells whose weights changed and publishes the new metric to osrm-routed
+void publishUpdate(const DaemonConfig &config)
+{
+    customizer::CustomizationConfig customization_config;
+    customization_config.base_path = config.base_path;
+    customization_config.UseDefaultOutputNames(config.base_path);
+    customization_config.requested_num_threads = config.requested_num_threads;
+    customization_config.incremental = true;
+    customization_config.skip_unchanged_cells = true;
+    customization_config.microcode = config.microcode;
+    customization_config.updater_config.segment_speed_lookup_paths = {config.state_path.string()};
+    if (!customization_config.IsValid())
+    {
+        throw util::exception("Invalid customization config for " + config.base_path.string() +
+                              SOURCE_REF);
+    }
+
+    TIMER_START(customize);
+    customizer::Customizer().Run(customization_config);
+    TIMER_STOP(customize);
+
+    TIMER_START(publish);
+    storage::StorageConfig storage_config(config.base_path);
+    if (!storage_config.IsValid())
+    {
+        throw util::exception("Invalid storage config for " + config.base_path.string() +
+                              SOURCE_REF);
+    }
+    storage::Storage(std::move(storage_config))
+        .Run(config.max_wait, config.dataset_name, true, true, false);
+    TIMER_STOP(publish);
+
+    util::Log() << "Customized in " << TIMER_SEC(customize) << "s, published in "
+                << TIMER_SEC(publish) << "s";
+}
+} // namespace
+
+int main(const int argc, const char *argv[])
+try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    std::string verbosity;
+    DaemonConfig config;
+    const auto result = generateDaemonOptions(argc, argv, verbosity, config);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(verbosity);
+
+    if (!std::filesystem::is_directory(config.spool_directory))
+    {
+        util::Log(logERROR) << config.spool_directory.string() << " is not a directory";
+        return EXIT_FAILURE;
+    }
+
+    // finish the running update before exiting, so no shared memory lock is left behind
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    // a failed update is retried with the next poll even if no new files arrived
+    bool pending = false;
+    while (!stop_requested)
+    {
+        const auto deltas = listDeltas(config.spool_directory);
+        if (!deltas.empty() || pending)
+        {
+            TIMER_START(update);
+            try
+            {
+                if (!deltas.empty())
+                {
+                    util::Log() << "Applying " << deltas.size() << " file(s) from "
+                                << config.spool_directory.string();
+                    mergeDeltas(config.state_path, deltas);
+                }
+                pending = true;
+                publishUpdate(config);
+                pending = false;
+            }
+            catch (const StateFileError &e)
+            {
+                util::Log(logERROR) << e.what();
+                return EXIT_FAILURE;
+            }
+            catch (const std::exception &e)
+            {
+                // keep the daemon running on broken files or a dataset that is being replaced
+                util::Log(logERROR) << e.what();
+                if (config.once)
+                {
+                    return EXIT_FAILURE;
+                }
+            }
+            TIMER_STOP(update);
+            if (!pending)
+            {
+                util::Log() << "Traffic update took " << TIMER_SEC(update) << "s";
+            }
+        }
+
+        if (config.once)
+        {
+            break;
+        }
+
+        for (unsigned step = 0; step < config.poll_interval * 10 && !stop_requested; ++step)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const util::exception &e)
+{
+    util::Log(logERROR) << e.what();
+    return EXIT_FAILURE;
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
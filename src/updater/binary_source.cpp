@@ -0,0 +1,380 @@
+#include "updater/binary_source.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+
+namespace osrm::updater::binary
+{
+
+namespace
+{
+
+// A missing rate column makes the updater fall back to the speed, an empty one keeps the
+// existing weight. Both behave differently, but every non-finite rate keeps the existing
+// weight, so +inf is free to mark a missing rate and all other non-finite rates are stored
+// as NaN.
+constexpr double MISSING_RATE = std::numeric_limits<double>::infinity();
+
+struct SegmentRecord
+{
+    std::uint64_t from, to;
+    double speed, rate;
+};
+static_assert(sizeof(SegmentRecord) == 32, "segment record must not have padding");
+
+struct TurnRecord
+{
+    std::uint64_t from, via, to;
+    double duration, weight;
+};
+static_assert(sizeof(TurnRecord) == 40, "turn record must not have padding");
+
+std::uint64_t zigzag(const std::uint64_t from, const std::uint64_t to)
+{
+    const auto difference = static_cast<std::int64_t>(to - from);
+    return (static_cast<std::uint64_t>(difference) << 1) ^
+           static_cast<std::uint64_t>(difference >> 63);
+}
+
+std::uint64_t unzigzag(const std::uint64_t from, const std::uint64_t value)
+{
+    return from + ((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void writeVarint(std::vector<char> &buffer, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+template <typename T> void writeValue(std::vector<char> &buffer, const T &value)
+{
+    const auto offset = buffer.size();
+    buffer.resize(offset + sizeof(T));
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+// Reads delta encoded records and throws if they end in the middle of a record
+class DeltaReader
+{
+  public:
+    DeltaReader(const std::string &filename, const char *begin, const char *end)
+        : filename(filename), current(begin), end(end)
+    {
+    }
+
+    std::uint64_t readVarint()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (current == end)
+                throwTruncated();
+            const auto byte = static_cast<std::uint8_t>(*current++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw util::exception(
+            std::format("Binary traffic file {} contains an invalid varint", filename) +
+            SOURCE_REF);
+    }
+
+    double readDouble()
+    {
+        double value;
+        if (end - current < static_cast<std::ptrdiff_t>(sizeof(value)))
+            throwTruncated();
+        std::memcpy(&value, current, sizeof(value));
+        current += sizeof(value);
+        return value;
+    }
+
+    bool done() const { return current == end; }
+
+  private:
+    [[noreturn]] void throwTruncated() const
+    {
+        throw util::exception(std::format("Binary traffic file {} is truncated", filename) +
+                              SOURCE_REF);
+    }
+
+    const std::string &filename;
+    const char *current;
+    const char *end;
+};
+
+struct SegmentFormat
+{
+    using Key = Segment;
+    using Value = SpeedSource;
+    using Record = SegmentRecord;
+    static constexpr const char *magic = SEGMENT_SPEED_MAGIC;
+    static constexpr const char *name = "segment speed";
+
+    static std::pair<Key, Value> fromRecord(const Record &record)
+    {
+        std::pair<Key, Value> result{Key{record.from, record.to}, Value{}};
+        result.second.speed = record.speed;
+        if (record.rate != MISSING_RATE)
+            result.second.rate = record.rate;
+        return result;
+    }
+
+    static Record toRecord(const std::pair<Key, Value> &entry)
+    {
+        const auto &rate = entry.second.rate;
+        return {entry.first.from,
+                entry.first.to,
+                entry.second.speed,
+                !rate                   ? MISSING_RATE
+                : std::isfinite(*rate) ? *rate
+                                        : std::numeric_limits<double>::quiet_NaN()};
+    }
+
+    static void encode(std::vector<char> &buffer, const Record &record, const Record &previous)
+    {
+        writeVarint(buffer, record.from - previous.from);
+        writeVarint(buffer, zigzag(record.from, record.to));
+        writeValue(buffer, record.speed);
+        writeValue(buffer, record.rate);
+    }
+
+    static Record decode(DeltaReader &reader, const Record &previous)
+    {
+        Record record;
+        record.from = previous.from + reader.readVarint();
+        record.to = unzigzag(record.from, reader.readVarint());
+        record.speed = reader.readDouble();
+        record.rate = reader.readDouble();
+        return record;
+    }
+};
+
+struct TurnFormat
+{
+    using Key = Turn;
+    using Value = PenaltySource;
+    using Record = TurnRecord;
+    static constexpr const char *magic = TURN_PENALTY_MAGIC;
+    static constexpr const char *name = "turn penalty";
+
+    static std::pair<Key, Value> fromRecord(const Record &record)
+    {
+        std::pair<Key, Value> result{Key{record.from, record.via, record.to}, Value{}};
+        result.second.duration = record.duration;
+        result.second.weight = record.weight;
+        return result;
+    }
+
+    static Record toRecord(const std::pair<Key, Value> &entry)
+    {
+        return {entry.first.from,
+                entry.first.via,
+                entry.first.to,
+                entry.second.duration,
+                entry.second.weight};
+    }
+
+    // The nodes of a turn are neighbours, so via and to are encoded relative to the node
+    // before them instead of the previous turn.
+    static void encode(std::vector<char> &buffer, const Record &record, const Record &previous)
+    {
+        writeVarint(buffer, record.from - previous.from);
+        writeVarint(buffer, zigzag(record.from, record.via));
+        writeVarint(buffer, zigzag(record.via, record.to));
+        writeValue(buffer, record.duration);
+        writeValue(buffer, record.weight);
+    }
+
+    static Record decode(DeltaReader &reader, const Record &previous)
+    {
+        Record record;
+        record.from = previous.from + reader.readVarint();
+        record.via = unzigzag(record.from, reader.readVarint());
+        record.to = unzigzag(record.via, reader.readVarint());
+        record.duration = reader.readDouble();
+        record.weight = reader.readDouble();
+        return record;
+    }
+};
+
+template <typename Format>
+void readRecords(const std::string &filename,
+                 const char *data,
+                 const std::size_t size,
+                 std::vector<std::pair<typename Format::Key, typename Format::Value>> &records)
+{
+    using Record = typename Format::Record;
+
+    Header header;
+    if (size < sizeof(header))
+    {
+        throw util::exception(std::format("Binary traffic file {} is truncated", filename) +
+                              SOURCE_REF);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Format::magic, sizeof(header.magic)) != 0)
+    {
+        throw util::exception(
+            std::format("{} is not a binary {} file", filename, Format::name) + SOURCE_REF);
+    }
+    if (header.version != FORMAT_VERSION)
+    {
+        throw util::exception(std::format("Binary traffic file {} has version {}, expected {}",
+                                          filename,
+                                          header.version,
+                                          FORMAT_VERSION) +
+                              SOURCE_REF);
+    }
+    const bool delta_encoded = header.flags & DELTA_ENCODED;
+    // every delta encoded record takes at least one byte
+    const bool valid_records_size =
+        delta_encoded ? header.number_of_records <= header.records_size
+                      : header.records_size % sizeof(Record) == 0 &&
+                            header.records_size / sizeof(Record) == header.number_of_records;
+    if (header.records_size != size - sizeof(header) || !valid_records_size)
+    {
+        throw util::exception(
+            std::format("Binary traffic file {} does not match the size of its header", filename) +
+            SOURCE_REF);
+    }
+
+    const auto *first_record = data + sizeof(header);
+    records.resize(header.number_of_records);
+    if (delta_encoded)
+    {
+        DeltaReader reader(filename, first_record, data + size);
+        Record previous{};
+        for (auto &entry : records)
+        {
+            previous = Format::decode(reader, previous);
+            entry = Format::fromRecord(previous);
+        }
+        if (!reader.done())
+        {
+            throw util::exception(
+                std::format("Binary traffic file {} has trailing data", filename) + SOURCE_REF);
+        }
+    }
+    else
+    {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, records.size()),
+                          [&](const auto &range)
+                          {
+                              for (auto index = range.begin(); index < range.end(); ++index)
+                              {
+                                  Record record;
+                                  std::memcpy(&record,
+                                              first_record + index * sizeof(Record),
+                                              sizeof(Record));
+                                  records[index] = Format::fromRecord(record);
+                              }
+                          });
+    }
+}
+
+template <typename Format>
+void writeValues(const std::string &filename,
+                 const LookupTable<typename Format::Key, typename Format::Value> &values,
+                 const bool delta_encode)
+{
+    using Record = typename Format::Record;
+
+    // lookup tables are sorted in descending order
+    std::vector<Record> records;
+    records.reserve(values.lookup.size());
+    std::transform(values.lookup.rbegin(),
+                   values.lookup.rend(),
+                   std::back_inserter(records),
+                   [](const auto &entry) { return Format::toRecord(entry); });
+
+    std::vector<char> buffer;
+    if (delta_encode)
+    {
+        Record previous{};
+        for (const auto &record : records)
+        {
+            Format::encode(buffer, record, previous);
+            previous = record;
+        }
+    }
+    else
+    {
+        buffer.resize(records.size() * sizeof(Record));
+        std::memcpy(buffer.data(), records.data(), buffer.size());
+    }
+
+    Header header;
+    std::memcpy(header.magic, Format::magic, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.flags = delta_encode ? DELTA_ENCODED : 0;
+    header.number_of_records = records.size();
+    header.records_size = buffer.size();
+
+    std::ofstream stream(filename, std::ios::binary);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(buffer.data(), buffer.size());
+    stream.close();
+    if (!stream)
+    {
+        throw util::exception("Could not write " + filename + SOURCE_REF);
+    }
+
+    util::Log() << "Wrote " << records.size() << " " << Format::name << " values to "
+                << filename;
+}
+} // namespace
+
+bool isBinaryFile(const char *data, const std::size_t size)
+{
+    return size >= sizeof(Header) &&
+           (std::memcmp(data, SEGMENT_SPEED_MAGIC, sizeof(SEGMENT_SPEED_MAGIC)) == 0 ||
+            std::memcmp(data, TURN_PENALTY_MAGIC, sizeof(TURN_PENALTY_MAGIC)) == 0);
+}
+
+void readRecords(const std::string &filename,
+                 const char *data,
+                 const std::size_t size,
+                 std::vector<std::pair<Segment, SpeedSource>> &records)
+{
+    readRecords<SegmentFormat>(filename, data, size, records);
+}
+
+void readRecords(const std::string &filename,
+                 const char *data,
+                 const std::size_t size,
+                 std::vector<std::pair<Turn, PenaltySource>> &records)
+{
+    readRecords<TurnFormat>(filename, data, size, records);
+}
+
+void writeSegmentValues(const std::string &filename,
+                        const SegmentLookupTable &values,
+                        const bool delta_encode)
+{
+    writeValues<SegmentFormat>(filename, values, delta_encode);
+}
+
+void writeTurnValues(const std::string &filename,
+                     const TurnLookupTable &values,
+                     const bool delta_encode)
+{
+    writeValues<TurnFormat>(filename, values, delta_encode);
+}
+} // namespace osrm::updater::binary
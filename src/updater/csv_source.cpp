@@ -20,6 +20,13 @@ BOOST_FUSION_ADAPT_STRUCT(osrm::updater::Turn,
 BOOST_FUSION_ADAPT_STRUCT(osrm::updater::PenaltySource,
                           (decltype(osrm::updater::PenaltySource::duration), duration)
                           (decltype(osrm::updater::PenaltySource::weight), weight))
+BOOST_FUSION_ADAPT_STRUCT(osrm::updater::ProfileTime,
+                          (decltype(osrm::updater::ProfileTime::profile), profile)
+                          (decltype(osrm::updater::ProfileTime::time), time))
+BOOST_FUSION_ADAPT_STRUCT(osrm::updater::ProfileSpeedSource,
+                          (decltype(osrm::updater::ProfileSpeedSource::speed), speed))
+BOOST_FUSION_ADAPT_STRUCT(osrm::updater::ProfileSource,
+                          (decltype(osrm::updater::ProfileSource::profile), profile))
 // clang-format on
 
 namespace osrm::updater::csv
@@ -59,4 +66,18 @@ TurnLookupTable readTurnValues(const std::vector<std::string> &paths)
                                                x3::double_ >> -(',' >> x3::double_));
     return parser(paths);
 }
+SpeedProfileLookupTable readSpeedProfiles(const std::vector<std::string> &paths)
+{
+    const x3::real_parser<double, x3::ureal_policies<double>> unsigned_double;
+    CSVFilesParser<ProfileTime, ProfileSpeedSource> parser(
+        1, x3::uint32 >> ',' >> x3::uint32, unsigned_double);
+    return parser(paths);
+}
+
+SegmentProfileLookupTable readSegmentProfiles(const std::vector<std::string> &paths)
+{
+    CSVFilesParser<Segment, ProfileSource> parser(
+        1, x3::ulong_long >> ',' >> x3::ulong_long, x3::uint32);
+    return parser(paths);
+}
 } // namespace osrm::updater::csv
@@ -124,7 +124,8 @@ updateSegmentData(const UpdaterConfig &config,
                   const SegmentLookupTable &segment_speed_lookup,
                   extractor::SegmentDataContainer &segment_data,
                   std::vector<util::Coordinate> &coordinates,
-                  const extractor::PackedOSMIDs &osm_node_ids)
+                  const extractor::PackedOSMIDs &osm_node_ids,
+                  tbb::concurrent_vector<GeometryID> &changed_segments)
 {
     // vector to count used speeds for logging
     // size offset by one since index 0 is used for speeds not from external file
@@ -216,6 +217,7 @@ updateSegmentData(const UpdaterConfig &config,
                 auto fwd_durations_range = segment_data.GetForwardDurations(geometry_id);
                 auto fwd_datasources_range = segment_data.GetForwardDatasources(geometry_id);
                 bool fwd_was_updated = false;
+                bool fwd_was_changed = false;
                 for (const auto segment_offset :
                      util::irange<std::size_t>(0, fwd_weights_range.size()))
                 {
@@ -234,6 +236,9 @@ updateSegmentData(const UpdaterConfig &config,
                         auto new_weight = convertToWeight(
                             fwd_weights_range[segment_offset], *value, segment_length);
                         fwd_was_updated = true;
+                        fwd_was_changed = fwd_was_changed ||
+                                          fwd_weights_range[segment_offset] != new_weight ||
+                                          fwd_durations_range[segment_offset] != new_duration;
 
                         fwd_weights_range[segment_offset] = new_weight;
                         fwd_durations_range[segment_offset] = new_duration;
@@ -247,6 +252,8 @@ updateSegmentData(const UpdaterConfig &config,
                 }
                 if (fwd_was_updated)
                     updated_segments.push_back(GeometryID{geometry_id, true});
+                if (fwd_was_changed)
+                    changed_segments.push_back(GeometryID{geometry_id, true});
 
                 // In this case we want it oriented from in forward directions
                 auto rev_weights_range =
@@ -256,6 +263,7 @@ updateSegmentData(const UpdaterConfig &config,
                 auto rev_datasources_range =
                     segment_data.GetReverseDatasources(geometry_id) | std::views::reverse;
                 bool rev_was_updated = false;
+                bool rev_was_changed = false;
 
                 for (const auto segment_offset :
                      util::irange<std::size_t>(0, rev_weights_range.size()))
@@ -275,6 +283,9 @@ updateSegmentData(const UpdaterConfig &config,
                         auto new_weight = convertToWeight(
                             rev_weights_range[segment_offset], *value, segment_length);
                         rev_was_updated = true;
+                        rev_was_changed = rev_was_changed ||
+                                          rev_weights_range[segment_offset] != new_weight ||
+                                          rev_durations_range[segment_offset] != new_duration;
 
                         rev_weights_range[segment_offset] = new_weight;
                         rev_durations_range[segment_offset] = new_duration;
@@ -288,6 +299,8 @@ updateSegmentData(const UpdaterConfig &config,
                 }
                 if (rev_was_updated)
                     updated_segments.push_back(GeometryID{geometry_id, false});
+                if (rev_was_changed)
+                    changed_segments.push_back(GeometryID{geometry_id, false});
             }
         }); // parallel_for
 
@@ -419,7 +432,8 @@ updateTurnPenalties(const UpdaterConfig &config,
                     const TurnLookupTable &turn_penalty_lookup,
                     std::vector<TurnPenalty> &turn_weight_penalties,
                     std::vector<TurnPenalty> &turn_duration_penalties,
-                    const extractor::PackedOSMIDs &osm_node_ids)
+                    const extractor::PackedOSMIDs &osm_node_ids,
+                    std::vector<std::uint64_t> &changed_turns)
 {
     const auto weight_multiplier = profile_properties.GetWeightMultiplier();
 
@@ -460,6 +474,11 @@ updateTurnPenalties(const UpdaterConfig &config,
                                : from_alias<TurnPenalty::value_type>(turn_duration_penalty) *
                                      weight_multiplier / 10.))};
 
+            if (turn_duration_penalties[edge_index] != turn_duration_penalty ||
+                turn_weight_penalties[edge_index] != turn_weight_penalty)
+            {
+                changed_turns.push_back(edge_index);
+            }
             turn_duration_penalties[edge_index] = turn_duration_penalty;
             turn_weight_penalties[edge_index] = turn_weight_penalty;
             updated_turns.push_back(edge_index);
@@ -544,9 +563,41 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                         std::vector<EdgeWeight> &node_weights,
                                         std::vector<EdgeDuration> &node_durations,
                                         std::uint32_t &connectivity_checksum) const
+{
+    std::vector<NodeID> updated_nodes;
+    return LoadAndUpdateEdgeExpandedGraph(
+        edge_based_edge_list, node_weights, node_durations, updated_nodes, connectivity_checksum);
+}
+
+EdgeID
+Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                                        std::vector<EdgeWeight> &node_weights,
+                                        std::vector<EdgeDuration> &node_durations,
+                                        std::vector<NodeID> &updated_nodes,
+                                        std::uint32_t &connectivity_checksum) const
+{
+    std::vector<NodeID> changed_nodes;
+    return LoadAndUpdateEdgeExpandedGraph(edge_based_edge_list,
+                                          node_weights,
+                                          node_durations,
+                                          updated_nodes,
+                                          changed_nodes,
+                                          connectivity_checksum);
+}
+
+EdgeID
+Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                                        std::vector<EdgeWeight> &node_weights,
+                                        std::vector<EdgeDuration> &node_durations,
+                                        std::vector<NodeID> &updated_nodes,
+                                        std::vector<NodeID> &changed_nodes,
+                                        std::uint32_t &connectivity_checksum) const
 {
     TIMER_START(load_edges);
 
+    updated_nodes.clear();
+    changed_nodes.clear();
+
     EdgeID number_of_edge_based_nodes = 0;
     std::vector<util::Coordinate> coordinates;
     extractor::PackedOSMIDs osm_node_ids;
@@ -612,6 +663,23 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     }
 
     tbb::concurrent_vector<GeometryID> updated_segments;
+    tbb::concurrent_vector<GeometryID> changed_segments;
+    const auto append_turn_geometries =
+        [&node_data, &edge_based_edge_list](const std::vector<std::uint64_t> &turns,
+                                            tbb::concurrent_vector<GeometryID> &segments)
+    {
+        const auto offset = segments.size();
+        segments.resize(offset + turns.size());
+        std::transform(turns.begin(),
+                       turns.end(),
+                       segments.begin() + offset,
+                       [&](const std::uint64_t turn_id)
+                       {
+                           const auto node_id = edge_based_edge_list[turn_id].source;
+                           return node_data.GetGeometryID(node_id);
+                       });
+    };
+
     if (update_edge_weights)
     {
         auto segment_speed_lookup = csv::readSegmentValues(config.segment_speed_lookup_paths);
@@ -622,7 +690,8 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                              segment_speed_lookup,
                                              segment_data,
                                              coordinates,
-                                             osm_node_ids);
+                                             osm_node_ids,
+                                             changed_segments);
         // Now save out the updated compressed geometries
         extractor::files::writeSegmentData(config.GetPath(".osrm.geometry"), segment_data);
         TIMER_STOP(segment);
@@ -632,24 +701,18 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
     auto turn_penalty_lookup = csv::readTurnValues(config.turn_penalty_lookup_paths);
     if (update_turn_penalties)
     {
+        std::vector<std::uint64_t> changed_turn_penalties;
         auto updated_turn_penalties = updateTurnPenalties(config,
                                                           profile_properties,
                                                           turn_penalty_lookup,
                                                           turn_weight_penalties,
                                                           turn_duration_penalties,
-                                                          osm_node_ids);
-        const auto offset = updated_segments.size();
-        updated_segments.resize(offset + updated_turn_penalties.size());
+                                                          osm_node_ids,
+                                                          changed_turn_penalties);
         // we need to re-compute all edges that have updated turn penalties.
         // this marks it for re-computation
-        std::transform(updated_turn_penalties.begin(),
-                       updated_turn_penalties.end(),
-                       updated_segments.begin() + offset,
-                       [&node_data, &edge_based_edge_list](const std::uint64_t turn_id)
-                       {
-                           const auto node_id = edge_based_edge_list[turn_id].source;
-                           return node_data.GetGeometryID(node_id);
-                       });
+        append_turn_geometries(updated_turn_penalties, updated_segments);
+        append_turn_geometries(changed_turn_penalties, changed_segments);
     }
 
     if (update_conditional_turns)
@@ -664,24 +727,16 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
 
         auto updated_turn_penalties =
             updateConditionalTurns(turn_weight_penalties, conditional_turns, time_zone_handler);
-        const auto offset = updated_segments.size();
-        updated_segments.resize(offset + updated_turn_penalties.size());
         // we need to re-compute all edges that have updated turn penalties.
         // this marks it for re-computation
-        std::transform(updated_turn_penalties.begin(),
-                       updated_turn_penalties.end(),
-                       updated_segments.begin() + offset,
-                       [&node_data, &edge_based_edge_list](const std::uint64_t turn_id)
-                       {
-                           const auto node_id = edge_based_edge_list[turn_id].source;
-                           return node_data.GetGeometryID(node_id);
-                       });
+        append_turn_geometries(updated_turn_penalties, updated_segments);
+        append_turn_geometries(updated_turn_penalties, changed_segments);
     }
 
-    tbb::parallel_sort(updated_segments.begin(),
-                       updated_segments.end(),
-                       [](const GeometryID lhs, const GeometryID rhs)
-                       { return std::tie(lhs.id, lhs.forward) < std::tie(rhs.id, rhs.forward); });
+    const auto geometry_less = [](const GeometryID lhs, const GeometryID rhs)
+    { return std::tie(lhs.id, lhs.forward) < std::tie(rhs.id, rhs.forward); };
+    tbb::parallel_sort(updated_segments.begin(), updated_segments.end(), geometry_less);
+    tbb::parallel_sort(changed_segments.begin(), changed_segments.end(), geometry_less);
 
     using WeightAndDuration = std::tuple<EdgeWeight, EdgeDuration>;
     const auto compute_new_weight_and_duration =
@@ -834,6 +889,42 @@ Updater::LoadAndUpdateEdgeExpandedGraph(std::vector<extractor::EdgeBasedEdge> &e
                                   update_edge(edge_based_edge_list[index]);
                               }
                           });
+
+        // update_edge rewrote exactly the outgoing edges of the nodes on an updated geometry.
+        // Segment data and turn penalties are read from the output of the previous update, so
+        // a changed geometry got different values than the previous update gave it.
+        std::vector<std::uint8_t> is_updated(number_of_edge_based_nodes, 0);
+        std::vector<std::uint8_t> is_changed(number_of_edge_based_nodes, 0);
+        tbb::parallel_for(
+            tbb::blocked_range<NodeID>(0, number_of_edge_based_nodes),
+            [&](const auto &range)
+            {
+                for (auto node = range.begin(); node < range.end(); ++node)
+                {
+                    const auto geometry_id = node_data.GetGeometryID(node);
+                    is_updated[node] = std::binary_search(updated_segments.begin(),
+                                                          updated_segments.end(),
+                                                          geometry_id,
+                                                          geometry_less);
+                    is_changed[node] = std::binary_search(changed_segments.begin(),
+                                                          changed_segments.end(),
+                                                          geometry_id,
+                                                          geometry_less);
+                }
+            });
+        for (NodeID node = 0; node < number_of_edge_based_nodes; ++node)
+        {
+            if (is_updated[node])
+            {
+                updated_nodes.push_back(node);
+            }
+            if (is_changed[node])
+            {
+                changed_nodes.push_back(node);
+            }
+        }
+        util::Log() << "Updated the edges of " << updated_nodes.size() << " edge-based nodes, "
+                    << changed_nodes.size() << " of them changed";
     }
 
     if (update_turn_penalties || update_conditional_turns)
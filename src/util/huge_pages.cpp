@@ -0,0 +1,180 @@
+#include "util/huge_pages.hpp"
+
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace osrm::util
+{
+
+namespace
+{
+constexpr std::size_t KIB = 1024;
+constexpr std::size_t MIB = 1024 * 1024;
+
+struct PageStats
+{
+    std::size_t kernel_page_size = 0;
+    std::size_t mapped = 0;
+    std::size_t resident = 0;
+    std::size_t huge = 0;
+};
+
+#ifdef __linux__
+// Parses the "Key:   1234 kB" lines of /proc/self/smaps for every mapping overlapping the range
+PageStats readPageStats(const std::uintptr_t begin, const std::uintptr_t end)
+{
+    PageStats stats;
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_range = false;
+    while (std::getline(smaps, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key.empty())
+            continue;
+
+        if (key.back() != ':')
+        {
+            // a mapping header: "start-end perms offset dev inode path"
+            const auto dash = key.find('-');
+            if (dash == std::string::npos)
+                continue;
+            const auto start = std::stoull(key.substr(0, dash), nullptr, 16);
+            const auto stop = std::stoull(key.substr(dash + 1), nullptr, 16);
+            in_range = start < end && stop > begin;
+            if (in_range)
+            {
+                stats.mapped += std::min<std::uintptr_t>(stop, end) -
+                                std::max<std::uintptr_t>(start, begin);
+            }
+            continue;
+        }
+
+        if (!in_range)
+            continue;
+
+        std::size_t value_kb = 0;
+        fields >> value_kb;
+        const auto value = value_kb * KIB;
+        if (key == "KernelPageSize:")
+        {
+            stats.kernel_page_size = std::max(stats.kernel_page_size, value);
+        }
+        else if (key == "Rss:")
+        {
+            stats.resident += value;
+        }
+        else if (key == "AnonHugePages:" || key == "ShmemPmdMapped:" ||
+                 key == "FilePmdMapped:" || key == "Shared_Hugetlb:" ||
+                 key == "Private_Hugetlb:")
+        {
+            stats.huge += value;
+        }
+    }
+    return stats;
+}
+#endif
+} // namespace
+
+std::size_t GetHugePageSize()
+{
+#ifdef __linux__
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    while (meminfo >> key)
+    {
+        if (key == "Hugepagesize:")
+        {
+            std::size_t value_kb = 0;
+            meminfo >> value_kb;
+            return value_kb * KIB;
+        }
+        meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+#endif
+    return 0;
+}
+
+std::size_t GetNumaNodeCount()
+{
+    std::size_t nodes = 0;
+#ifdef __linux__
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec))
+    {
+        const auto name = entry.path().filename().string();
+        if (name.starts_with("node") &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos)
+        {
+            ++nodes;
+        }
+    }
+#endif
+    return std::max<std::size_t>(nodes, 1);
+}
+
+bool AdviseHugePages(void *ptr, std::size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const auto huge_page_size = GetHugePageSize();
+    if (huge_page_size == 0)
+        return false;
+
+    // madvise needs page aligned ranges, huge pages only ever cover huge page aligned ranges
+    const auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+    const auto aligned_begin = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    const auto aligned_end = (begin + size) & ~(huge_page_size - 1);
+    if (aligned_end <= aligned_begin)
+        return false;
+
+    return ::madvise(reinterpret_cast<void *>(aligned_begin),
+                     aligned_end - aligned_begin,
+                     MADV_HUGEPAGE) == 0;
+#else
+    (void)ptr;
+    (void)size;
+    return false;
+#endif
+}
+
+void LogPageStats(const std::string &name, const void *ptr, std::size_t size)
+{
+#ifdef __linux__
+    const auto begin = reinterpret_cast<std::uintptr_t>(ptr);
+    const auto stats = readPageStats(begin, begin + size);
+    if (stats.mapped == 0 || stats.kernel_page_size == 0)
+        return;
+
+    // Transparent huge pages are reported on top of a 4 KiB KernelPageSize, so every huge page
+    // saves (huge page size / base page size) page table entries.
+    const auto huge_page_size = std::max(GetHugePageSize(), stats.kernel_page_size);
+    const auto small_bytes = stats.mapped - std::min(stats.mapped, stats.huge);
+    const auto page_table_entries = stats.huge / huge_page_size +
+                                    (small_bytes + stats.kernel_page_size - 1) /
+                                        stats.kernel_page_size;
+
+    util::Log() << name << ": " << stats.mapped / MIB << " MiB mapped, "
+                << stats.resident / MIB << " MiB resident, " << stats.huge / MIB
+                << " MiB on huge pages, page size " << stats.kernel_page_size / KIB << " KiB, "
+                << page_table_entries << " page table entries, " << GetNumaNodeCount()
+                << " NUMA node(s)";
+#else
+    (void)name;
+    (void)ptr;
+    (void)size;
+#endif
+}
+
+} // namespace osrm::util
@@ -0,0 +1,194 @@
+#include "util/phase_profiler.hpp"
+
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/integer_range.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/meminfo.hpp"
+
+#include <tbb/global_control.h>
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace osrm::util
+{
+
+namespace
+{
+struct Usage
+{
+    double cpu_seconds = 0;
+    std::uint64_t blocks_read = 0;
+    std::uint64_t blocks_written = 0;
+    std::uint64_t major_page_faults = 0;
+};
+
+Usage readUsage()
+{
+    Usage usage;
+#ifndef _WIN32
+    rusage self;
+    getrusage(RUSAGE_SELF, &self);
+    const auto seconds = [](const timeval &time)
+    { return static_cast<double>(time.tv_sec) + 0.000001 * static_cast<double>(time.tv_usec); };
+    usage.cpu_seconds = seconds(self.ru_utime) + seconds(self.ru_stime);
+    usage.blocks_read = self.ru_inblock;
+    usage.blocks_written = self.ru_oublock;
+    usage.major_page_faults = self.ru_majflt;
+#endif
+    return usage;
+}
+} // namespace
+
+PhaseProfiler &PhaseProfiler::GetInstance()
+{
+    static PhaseProfiler profiler;
+    return profiler;
+}
+
+void PhaseProfiler::Enable()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = true;
+}
+
+void PhaseProfiler::Disable()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = false;
+}
+
+bool PhaseProfiler::IsEnabled() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return enabled;
+}
+
+void PhaseProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    records.clear();
+    open_phases.clear();
+}
+
+std::vector<PhaseRecord> PhaseProfiler::GetPhases() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<PhaseRecord> finished;
+    for (const auto index : irange<std::size_t>(0, records.size()))
+    {
+        const auto is_open = std::any_of(open_phases.begin(),
+                                         open_phases.end(),
+                                         [&](const auto &open) { return open.record == index; });
+        if (!is_open)
+            finished.push_back(records[index]);
+    }
+    return finished;
+}
+
+std::size_t PhaseProfiler::Start(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled)
+        return INVALID_PHASE;
+
+    PhaseRecord record;
+    record.name = open_phases.empty() ? name : records[open_phases.back().record].name + "/" + name;
+    record.depth = open_phases.size();
+    record.threads = static_cast<unsigned>(
+        tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism));
+    records.push_back(std::move(record));
+
+    const auto usage = readUsage();
+    open_phases.push_back({records.size() - 1,
+                           std::chrono::steady_clock::now(),
+                           usage.cpu_seconds,
+                           PeakRAMUsedInBytes(),
+                           usage.blocks_read,
+                           usage.blocks_written,
+                           usage.major_page_faults});
+    return records.size() - 1;
+}
+
+void PhaseProfiler::Stop(const std::size_t record)
+{
+    const auto wall_stop = std::chrono::steady_clock::now();
+    const auto usage = readUsage();
+    const auto peak_rss = PeakRAMUsedInBytes();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // the phase is gone if the profiler was cleared in the meantime
+    const auto open = std::find_if(open_phases.begin(),
+                                   open_phases.end(),
+                                   [&](const auto &phase) { return phase.record == record; });
+    if (open == open_phases.end())
+        return;
+
+    auto &phase = records[record];
+    phase.wall_seconds = std::chrono::duration<double>(wall_stop - open->wall_start).count();
+    phase.cpu_seconds = usage.cpu_seconds - open->cpu_start;
+    phase.peak_rss_bytes = peak_rss;
+    phase.peak_rss_delta_bytes = peak_rss - open->peak_rss_start;
+    phase.blocks_read = usage.blocks_read - open->blocks_read_start;
+    phase.blocks_written = usage.blocks_written - open->blocks_written_start;
+    phase.major_page_faults = usage.major_page_faults - open->major_page_faults_start;
+    open_phases.erase(open);
+}
+
+void PhaseProfiler::WriteJSON(const std::filesystem::path &path, const std::string &tool) const
+{
+    json::Array phases;
+    for (const auto &record : GetPhases())
+    {
+        json::Object phase;
+        phase.values["name"] = json::String(record.name);
+        phase.values["depth"] = json::Number(record.depth);
+        phase.values["threads"] = json::Number(record.threads);
+        phase.values["wall_seconds"] = json::Number(record.wall_seconds);
+        phase.values["cpu_seconds"] = json::Number(record.cpu_seconds);
+        phase.values["thread_utilisation"] = json::Number(record.ThreadUtilisation());
+        phase.values["peak_rss_bytes"] = json::Number(record.peak_rss_bytes);
+        phase.values["peak_rss_delta_bytes"] = json::Number(record.peak_rss_delta_bytes);
+        phase.values["blocks_read"] = json::Number(record.blocks_read);
+        phase.values["blocks_written"] = json::Number(record.blocks_written);
+        phase.values["major_page_faults"] = json::Number(record.major_page_faults);
+        phases.values.push_back(std::move(phase));
+    }
+
+    json::Object profile;
+    profile.values["tool"] = json::String(tool);
+    profile.values["hardware_threads"] = json::Number(std::thread::hardware_concurrency());
+    profile.values["peak_rss_bytes"] = json::Number(PeakRAMUsedInBytes());
+    profile.values["phases"] = std::move(phases);
+
+    std::ofstream out(path);
+    if (!out)
+    {
+        throw util::exception("Could not open " + path.string() + " for writing the phase profile" +
+                              SOURCE_REF);
+    }
+    json::render(out, profile);
+    out << std::endl;
+}
+
+PhaseTimer::PhaseTimer(const std::string &name) : record(PhaseProfiler::GetInstance().Start(name))
+{
+}
+
+PhaseTimer::~PhaseTimer() { Stop(); }
+
+void PhaseTimer::Stop()
+{
+    if (record == PhaseProfiler::INVALID_PHASE)
+        return;
+    PhaseProfiler::GetInstance().Stop(record);
+    record = PhaseProfiler::INVALID_PHASE;
+}
+} // namespace osrm::util
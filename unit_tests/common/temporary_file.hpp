@@ -43,4 +43,22 @@ struct TemporaryFile
     std::filesystem::path path;
 };
 
+// A unique directory in the system temp directory that is removed with all of its contents
+struct TemporaryDirectory
+{
+    TemporaryDirectory()
+        : path(std::filesystem::temp_directory_path() / ("osrm-test-" + random_string(8)))
+    {
+        std::filesystem::create_directories(path);
+    }
+
+    ~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+
+    std::filesystem::path path;
+};
+
 #endif // UNIT_TESTS_TEMPORARY_FILE_HPP
@@ -0,0 +1,145 @@
+#include "contractor/customizable_hierarchy.hpp"
+
+#include "helper.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+#include "partitioner/multi_level_partition.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+namespace
+{
+constexpr unsigned WIDTH = 8;
+constexpr unsigned HEIGHT = 8;
+
+NodeID gridNode(const unsigned x, const unsigned y) { return y * WIDTH + x; }
+
+// 2x2 blocks on level 1, 4x4 blocks on level 2 and halves on level 3
+partitioner::MultiLevelPartition makeGridPartition()
+{
+    std::vector<CellID> level_1(WIDTH * HEIGHT), level_2(WIDTH * HEIGHT), level_3(WIDTH * HEIGHT);
+    for (const auto y : util::irange(0u, HEIGHT))
+    {
+        for (const auto x : util::irange(0u, WIDTH))
+        {
+            level_1[gridNode(x, y)] = (y / 2) * (WIDTH / 2) + x / 2;
+            level_2[gridNode(x, y)] = (y / 4) * (WIDTH / 4) + x / 4;
+            level_3[gridNode(x, y)] = y / 4;
+        }
+    }
+    return partitioner::MultiLevelPartition{{level_1, level_2, level_3}, {16, 4, 2}};
+}
+
+// Weight of the edge from -> to in the hierarchy, as looked up when unpacking a path
+int findWeight(const std::vector<QueryEdge> &query_edges, const NodeID from, const NodeID to)
+{
+    int best = UNREACHABLE;
+    for (const auto &edge : query_edges)
+    {
+        if ((edge.source == from && edge.target == to && edge.data.forward) ||
+            (edge.source == to && edge.target == from && edge.data.backward))
+            best = std::min(best, from_alias<int>(edge.data.weight));
+    }
+    return best;
+}
+
+void checkHierarchy(const std::vector<extractor::EdgeBasedEdge> &edges,
+                    const std::vector<bool> &node_filter)
+{
+    const auto partition = makeGridPartition();
+    const CustomizableHierarchy hierarchy(partition, WIDTH * HEIGHT, edges);
+    BOOST_CHECK_EQUAL(hierarchy.GetNumberOfNodes(), WIDTH * HEIGHT);
+
+    const auto query_edges = hierarchy.Customize(edges, node_filter);
+    const auto query_graph = makeQueryGraph(WIDTH * HEIGHT, query_edges);
+    const auto edge_filter = allEdges(query_graph);
+
+    for (const auto source : util::irange<NodeID>(0, WIDTH * HEIGHT))
+    {
+        if (!node_filter[source])
+            continue;
+        const auto distances = dijkstra(edges, node_filter, source);
+        for (const auto target : util::irange<NodeID>(0, WIDTH * HEIGHT))
+        {
+            if (node_filter[target])
+                BOOST_CHECK_EQUAL(query(query_graph, edge_filter, source, target),
+                                  distances[target]);
+        }
+    }
+
+    // shortcuts unpack into edges of the hierarchy with the same total weight
+    for (const auto &edge : query_edges)
+    {
+        BOOST_CHECK(node_filter[edge.source] && node_filter[edge.target]);
+        if (!edge.data.shortcut)
+            continue;
+        const NodeID middle = edge.data.turn_id;
+        if (edge.data.forward)
+            BOOST_CHECK_EQUAL(from_alias<int>(edge.data.weight),
+                              findWeight(query_edges, edge.source, middle) +
+                                  findWeight(query_edges, middle, edge.target));
+        if (edge.data.backward)
+            BOOST_CHECK_EQUAL(from_alias<int>(edge.data.weight),
+                              findWeight(query_edges, edge.target, middle) +
+                                  findWeight(query_edges, middle, edge.source));
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(customizable_hierarchy)
+
+BOOST_AUTO_TEST_CASE(grid_distances)
+{
+    for (const auto seed : util::irange(0u, 5u))
+    {
+        checkHierarchy(makeGridEdges(WIDTH, HEIGHT, seed), std::vector<bool>(WIDTH * HEIGHT, true));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(grid_distances_with_excluded_nodes)
+{
+    std::vector<bool> node_filter(WIDTH * HEIGHT, true);
+    node_filter[gridNode(3, 3)] = false;
+    node_filter[gridNode(4, 3)] = false;
+    node_filter[gridNode(3, 4)] = false;
+    node_filter[gridNode(0, 7)] = false;
+
+    for (const auto seed : util::irange(0u, 5u))
+    {
+        checkHierarchy(makeGridEdges(WIDTH, HEIGHT, seed), node_filter);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(customization_is_metric_independent)
+{
+    const auto partition = makeGridPartition();
+    const auto edges = makeGridEdges(WIDTH, HEIGHT, 0);
+    const CustomizableHierarchy hierarchy(partition, WIDTH * HEIGHT, edges);
+
+    // the same hierarchy can be customized with the weights of another metric
+    auto updated_edges = edges;
+    for (auto &edge : updated_edges)
+    {
+        edge.data.weight = edge.data.weight + EdgeWeight{7};
+    }
+    const auto query_edges =
+        hierarchy.Customize(updated_edges, std::vector<bool>(WIDTH * HEIGHT, true));
+    const auto query_graph = makeQueryGraph(WIDTH * HEIGHT, query_edges);
+
+    const std::vector<bool> node_filter(WIDTH * HEIGHT, true);
+    const auto distances = dijkstra(updated_edges, node_filter, 0);
+    for (const auto target : util::irange<NodeID>(0, WIDTH * HEIGHT))
+    {
+        BOOST_CHECK_EQUAL(query(query_graph, allEdges(query_graph), 0, target), distances[target]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
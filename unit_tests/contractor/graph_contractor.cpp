@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <random>
 #include <tbb/global_control.h>
 #include <tuple>
 #include <vector>
@@ -48,20 +49,68 @@ bool byAllFields(const QueryEdge &lhs, const QueryEdge &rhs)
 // compaction pass to have something to reclaim.
 std::vector<TestEdge> makeGridEdges(const unsigned width, const unsigned height)
 {
-    const auto id = [width](const unsigned x, const unsigned y) { return y * width + x; };
-
     std::vector<TestEdge> edges;
-    for (const auto y : util::irange(0u, height))
+    forEachGridStreet(
+        width, height, [&](const NodeID from, const NodeID to) { edges.push_back({from, to, 1}); });
+    return edges;
+}
+
+std::vector<TestEdge> makeRandomGridEdges(const unsigned width, const unsigned height)
+{
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> weight(1, 20);
+    auto edges = makeGridEdges(width, height);
+    for (auto &edge : edges)
+        std::get<2>(edge) = weight(generator);
+    return edges;
+}
+
+// Every input edge counts as one original edge, so that the node priorities depend on the
+// shortcuts a contraction adds and not only on the depth of a node
+ContractorGraph makeGraphWithOriginalEdges(const std::vector<TestEdge> &edges)
+{
+    auto graph = makeGraph(edges);
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        for (const auto edge : graph.GetAdjacentEdgeRange(node))
+            graph.GetEdgeData(edge).originalEdges = 1;
+    }
+    return graph;
+}
+
+// Compares the distances of every filter of the contracted graph to a search on the graph
+void checkExcludableGraph(const std::vector<TestEdge> &edges,
+                          ContractorGraph graph,
+                          const std::vector<std::vector<bool>> &filters,
+                          const bool share_filter_groups)
+{
+    std::vector<ExcludeClassStatistics> statistics;
+    const auto [query_graph, edge_filters] =
+        contractExcludableGraph(std::move(graph), filters, share_filter_groups, statistics);
+    BOOST_REQUIRE_EQUAL(edge_filters.size(), filters.size());
+    BOOST_CHECK_EQUAL(statistics.size(), filters.size());
+
+    const NodeID number_of_nodes = query_graph.GetNumberOfNodes();
+    const auto directed_edges = toEdgeBasedEdges(edges);
+    for (const auto filter_index : util::irange<std::size_t>(0, filters.size()))
     {
-        for (const auto x : util::irange(0u, width))
+        const auto &filter = filters[filter_index];
+        for (const auto source : util::irange<NodeID>(0, number_of_nodes))
         {
-            if (x + 1 < width)
-                edges.push_back({id(x, y), id(x + 1, y), 1});
-            if (y + 1 < height)
-                edges.push_back({id(x, y), id(x, y + 1), 1});
+            if (!filter[source])
+                continue;
+            const auto distances = dijkstra(directed_edges, filter, source);
+            const auto &edge_filter = edge_filters[filter_index];
+            const auto forward = upwardSearch(query_graph, edge_filter, source, true);
+            for (const auto target : util::irange<NodeID>(0, number_of_nodes))
+            {
+                if (!filter[target])
+                    continue;
+                const auto backward = upwardSearch(query_graph, edge_filter, target, false);
+                BOOST_CHECK_EQUAL(meet(forward, backward), distances[target]);
+            }
         }
     }
-    return edges;
 }
 } // namespace
 
@@ -224,6 +273,40 @@ BOOST_AUTO_TEST_CASE(contract_excludable_graph)
     }
 }
 
+BOOST_AUTO_TEST_CASE(exclude_filters_are_exact)
+{
+    constexpr unsigned WIDTH = 8;
+    constexpr unsigned HEIGHT = 8;
+    const auto edges = makeRandomGridEdges(WIDTH, HEIGHT);
+
+    // like a profile with two excludable classes: nothing excluded, either class, both classes
+    std::vector<std::vector<bool>> filters(4, std::vector<bool>(WIDTH * HEIGHT, true));
+    for (const auto x : util::irange(1u, 7u))
+    {
+        filters[1][3 * WIDTH + x] = false;
+        filters[3][3 * WIDTH + x] = false;
+    }
+    for (const auto y : util::irange(2u, 8u))
+    {
+        filters[2][y * WIDTH + 5] = false;
+        filters[3][y * WIDTH + 5] = false;
+    }
+
+    checkExcludableGraph(edges, makeGraph(edges), filters, false);
+    checkExcludableGraph(edges, makeGraph(edges), filters, true);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_priority_updates_are_exact)
+{
+    // Large enough for several rounds of independent nodes with outdated priorities
+    constexpr unsigned WIDTH = 16;
+    constexpr unsigned HEIGHT = 16;
+    const auto edges = makeRandomGridEdges(WIDTH, HEIGHT);
+    const std::vector<std::vector<bool>> filters{std::vector<bool>(WIDTH * HEIGHT, true)};
+
+    checkExcludableGraph(edges, makeGraphWithOriginalEdges(edges), filters, false);
+}
+
 BOOST_AUTO_TEST_CASE(compaction_leaves_the_contracted_graph_unchanged)
 {
     // The contraction order decides which shortcuts are needed, so pin it to compare two runs.
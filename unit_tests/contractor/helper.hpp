@@ -2,6 +2,20 @@
 #define OSRM_UNIT_TESTS_CONTRACTOR_HELPER_HPP_
 
 #include "contractor/contractor_graph.hpp"
+#include "contractor/query_edge.hpp"
+#include "contractor/query_graph.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+#include "util/integer_range.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace osrm::unit_test
 {
@@ -36,6 +50,185 @@ inline contractor::ContractorGraph makeGraph(const std::vector<TestEdge> &edges)
 
     return contractor::ContractorGraph(max_id + 1, input_edges);
 }
+
+constexpr int UNREACHABLE = std::numeric_limits<int>::max();
+
+// Calls add(from, to) for the street between every pair of neighbouring nodes of a grid, the
+// nodes are numbered row by row
+template <typename AddStreet>
+void forEachGridStreet(const unsigned width, const unsigned height, AddStreet &&add)
+{
+    const auto id = [width](const unsigned x, const unsigned y) { return y * width + x; };
+    for (const auto y : util::irange(0u, height))
+    {
+        for (const auto x : util::irange(0u, width))
+        {
+            if (x + 1 < width)
+                add(id(x, y), id(x + 1, y));
+            if (y + 1 < height)
+                add(id(x, y), id(x, y + 1));
+        }
+    }
+}
+
+// Grid with random weights in both directions, some streets are one-way
+inline std::vector<extractor::EdgeBasedEdge>
+makeGridEdges(const unsigned width, const unsigned height, const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> weight(1, 20);
+    std::bernoulli_distribution oneway(0.2);
+
+    std::vector<extractor::EdgeBasedEdge> edges;
+    const auto add = [&](const NodeID source, const NodeID target)
+    {
+        const auto forward_weight = weight(generator);
+        edges.emplace_back(source,
+                           target,
+                           edges.size(),
+                           EdgeWeight{forward_weight},
+                           EdgeDuration{2 * forward_weight},
+                           EdgeDistance{1},
+                           true,
+                           false);
+        if (!oneway(generator))
+        {
+            const auto backward_weight = weight(generator);
+            edges.emplace_back(target,
+                               source,
+                               edges.size(),
+                               EdgeWeight{backward_weight},
+                               EdgeDuration{2 * backward_weight},
+                               EdgeDistance{1},
+                               true,
+                               false);
+        }
+    };
+    forEachGridStreet(width, height, add);
+    return edges;
+}
+
+// Both directions of every edge, as makeGraph() adds them
+inline std::vector<extractor::EdgeBasedEdge> toEdgeBasedEdges(const std::vector<TestEdge> &edges)
+{
+    std::vector<extractor::EdgeBasedEdge> result;
+    for (const auto &[start, target, weight] : edges)
+    {
+        for (const auto &[from, to] :
+             {std::make_pair(start, target), std::make_pair(target, start)})
+        {
+            result.emplace_back(from,
+                                to,
+                                result.size(),
+                                EdgeWeight{weight},
+                                EdgeDuration{2 * weight},
+                                EdgeDistance{1},
+                                true,
+                                false);
+        }
+    }
+    return result;
+}
+
+// Distances from source to all nodes of the filter, edges with an invalid weight are closed
+inline std::vector<int> dijkstra(const std::vector<extractor::EdgeBasedEdge> &edges,
+                                 const std::vector<bool> &node_filter,
+                                 const NodeID source)
+{
+    std::vector<int> distances(node_filter.size(), UNREACHABLE);
+    using WeightAndNode = std::pair<int, NodeID>;
+    std::priority_queue<WeightAndNode, std::vector<WeightAndNode>, std::greater<>> queue;
+    distances[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        const auto [distance, node] = queue.top();
+        queue.pop();
+        if (distance > distances[node])
+            continue;
+        for (const auto &edge : edges)
+        {
+            if (edge.source != node || !node_filter[edge.target] ||
+                edge.data.weight == INVALID_EDGE_WEIGHT)
+                continue;
+            const auto weight = distance + from_alias<int>(edge.data.weight);
+            if (weight < distances[edge.target])
+            {
+                distances[edge.target] = weight;
+                queue.emplace(weight, edge.target);
+            }
+        }
+    }
+    return distances;
+}
+
+// Hierarchy of the edges, in any order, that a customization or re-contraction returns
+inline contractor::QueryGraph makeQueryGraph(const NodeID number_of_nodes,
+                                             std::vector<contractor::QueryEdge> query_edges)
+{
+    std::sort(query_edges.begin(), query_edges.end());
+    return contractor::QueryGraph{number_of_nodes, query_edges};
+}
+
+inline std::vector<bool> allEdges(const contractor::QueryGraph &query_graph)
+{
+    return std::vector<bool>(query_graph.GetNumberOfEdges(), true);
+}
+
+// Upward search on the edges of one filter of the hierarchy in one direction
+inline std::vector<int> upwardSearch(const contractor::QueryGraph &query_graph,
+                                     const std::vector<bool> &edge_filter,
+                                     const NodeID source,
+                                     const bool forward)
+{
+    std::vector<int> distances(query_graph.GetNumberOfNodes(), UNREACHABLE);
+    using WeightAndNode = std::pair<int, NodeID>;
+    std::priority_queue<WeightAndNode, std::vector<WeightAndNode>, std::greater<>> queue;
+    distances[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        const auto [distance, node] = queue.top();
+        queue.pop();
+        if (distance > distances[node])
+            continue;
+        for (const auto edge : query_graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = query_graph.GetEdgeData(edge);
+            if (!edge_filter[edge] || !(forward ? data.forward : data.backward))
+                continue;
+            const auto target = query_graph.GetTarget(edge);
+            const auto weight = distance + from_alias<int>(data.weight);
+            if (weight < distances[target])
+            {
+                distances[target] = weight;
+                queue.emplace(weight, target);
+            }
+        }
+    }
+    return distances;
+}
+
+// Shortest route over a node that both upward searches reach
+inline int meet(const std::vector<int> &forward, const std::vector<int> &backward)
+{
+    int best = UNREACHABLE;
+    for (const auto node : util::irange<std::size_t>(0, forward.size()))
+    {
+        if (forward[node] != UNREACHABLE && backward[node] != UNREACHABLE)
+            best = std::min(best, forward[node] + backward[node]);
+    }
+    return best;
+}
+
+inline int query(const contractor::QueryGraph &query_graph,
+                 const std::vector<bool> &edge_filter,
+                 const NodeID source,
+                 const NodeID target)
+{
+    return meet(upwardSearch(query_graph, edge_filter, source, true),
+                upwardSearch(query_graph, edge_filter, target, false));
+}
 } // namespace osrm::unit_test
 
 #endif
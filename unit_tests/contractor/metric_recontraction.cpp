@@ -0,0 +1,202 @@
+#include "contractor/metric_recontraction.hpp"
+
+#include "contractor/graph_contractor.hpp"
+#include "contractor/graph_contractor_adaptors.hpp"
+#include "contractor/query_graph.hpp"
+#include "helper.hpp"
+
+#include "extractor/edge_based_edge.hpp"
+#include "util/integer_range.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::contractor;
+using namespace osrm::unit_test;
+
+namespace
+{
+constexpr unsigned WIDTH = 8;
+constexpr unsigned HEIGHT = 8;
+constexpr NodeID NUMBER_OF_NODES = WIDTH * HEIGHT;
+
+// Same edges with new random weights, like after a traffic update
+std::vector<extractor::EdgeBasedEdge>
+updateWeights(std::vector<extractor::EdgeBasedEdge> edges, const unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> weight(1, 50);
+    for (auto &edge : edges)
+    {
+        const auto new_weight = weight(generator);
+        edge.data.weight = EdgeWeight{new_weight};
+        edge.data.duration = 2 * new_weight;
+    }
+    return edges;
+}
+
+QueryGraph contract(const std::vector<extractor::EdgeBasedEdge> &edges)
+{
+    auto graph = toContractorGraph(NUMBER_OF_NODES, edges);
+    contractGraph(graph);
+    return QueryGraph{NUMBER_OF_NODES, toEdges<QueryEdge>(std::move(graph))};
+}
+
+struct RouteErrors
+{
+    // routes of the hierarchy that are longer than the shortest path
+    std::size_t longer = 0;
+    // pairs the graph connects but the hierarchy does not
+    std::size_t unreachable = 0;
+};
+
+// Compares all distances of the hierarchy to a search on the graph
+RouteErrors countRouteErrors(const std::vector<QueryEdge> &query_edges,
+                             const std::vector<extractor::EdgeBasedEdge> &edges)
+{
+    const auto query_graph = makeQueryGraph(NUMBER_OF_NODES, query_edges);
+    const auto edge_filter = allEdges(query_graph);
+    const std::vector<bool> node_filter(NUMBER_OF_NODES, true);
+
+    RouteErrors errors;
+    for (const auto source : util::irange<NodeID>(0, NUMBER_OF_NODES))
+    {
+        const auto distances = dijkstra(edges, node_filter, source);
+        for (const auto target : util::irange<NodeID>(0, NUMBER_OF_NODES))
+        {
+            const auto distance = query(query_graph, edge_filter, source, target);
+            // every route of the hierarchy is a path of the graph
+            BOOST_CHECK_GE(distance, distances[target]);
+            if (distance == UNREACHABLE && distances[target] != UNREACHABLE)
+                ++errors.unreachable;
+            else if (distance > distances[target])
+                ++errors.longer;
+        }
+    }
+    return errors;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(metric_recontraction)
+
+BOOST_AUTO_TEST_CASE(same_metric_is_exact)
+{
+    const auto edges = makeGridEdges(WIDTH, HEIGHT, 0);
+    const auto hierarchy = contract(edges);
+
+    RecontractionStatistics statistics;
+    const auto query_edges = recontractMetric(hierarchy,
+                                              allEdges(hierarchy),
+                                              edges,
+                                              std::vector<bool>(NUMBER_OF_NODES, true),
+                                              false,
+                                              statistics);
+    BOOST_CHECK_GT(statistics.reused_arcs, 0);
+    BOOST_CHECK_EQUAL(statistics.inserted_edges, 0);
+    const auto errors = countRouteErrors(query_edges, edges);
+    BOOST_CHECK_EQUAL(errors.longer, 0);
+    BOOST_CHECK_EQUAL(errors.unreachable, 0);
+}
+
+BOOST_AUTO_TEST_CASE(repaired_witnesses_are_exact)
+{
+    const auto edges = makeGridEdges(WIDTH, HEIGHT, 0);
+    const auto hierarchy = contract(edges);
+
+    std::size_t unrepaired_longer_routes = 0;
+    for (const auto seed : util::irange(1u, 6u))
+    {
+        const auto updated_edges = updateWeights(edges, seed);
+        RecontractionStatistics statistics;
+        const auto query_edges = recontractMetric(hierarchy,
+                                                  allEdges(hierarchy),
+                                                  updated_edges,
+                                                  std::vector<bool>(NUMBER_OF_NODES, true),
+                                                  true,
+                                                  statistics);
+        BOOST_CHECK_GT(statistics.witness_searches, 0);
+        const auto errors = countRouteErrors(query_edges, updated_edges);
+        BOOST_CHECK_EQUAL(errors.longer, 0);
+        BOOST_CHECK_EQUAL(errors.unreachable, 0);
+
+        // without repair a slower witness only makes routes longer, as it is still a path
+        RecontractionStatistics unrepaired_statistics;
+        const auto unrepaired_errors =
+            countRouteErrors(recontractMetric(hierarchy,
+                                              allEdges(hierarchy),
+                                              updated_edges,
+                                              std::vector<bool>(NUMBER_OF_NODES, true),
+                                              false,
+                                              unrepaired_statistics),
+                             updated_edges);
+        BOOST_CHECK_EQUAL(unrepaired_statistics.witness_searches, 0);
+        BOOST_CHECK_EQUAL(unrepaired_errors.unreachable, 0);
+        unrepaired_longer_routes += unrepaired_errors.longer;
+    }
+    BOOST_CHECK_GT(unrepaired_longer_routes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(repaired_witnesses_reconnect_closed_roads)
+{
+    const auto edges = makeGridEdges(WIDTH, HEIGHT, 0);
+    const auto hierarchy = contract(edges);
+
+    // closing every third edge breaks witnesses, but leaves most nodes connected
+    auto closed_edges = edges;
+    for (std::size_t index = 0; index < closed_edges.size(); index += 3)
+    {
+        closed_edges[index].data.weight = INVALID_EDGE_WEIGHT;
+    }
+
+    RecontractionStatistics statistics;
+    const auto errors = countRouteErrors(recontractMetric(hierarchy,
+                                                          allEdges(hierarchy),
+                                                          closed_edges,
+                                                          std::vector<bool>(NUMBER_OF_NODES, true),
+                                                          true,
+                                                          statistics),
+                                         closed_edges);
+    BOOST_CHECK_EQUAL(errors.longer, 0);
+    BOOST_CHECK_EQUAL(errors.unreachable, 0);
+
+    // without repair a closed witness disconnects the pair it stood in for
+    RecontractionStatistics unrepaired_statistics;
+    const auto unrepaired_errors =
+        countRouteErrors(recontractMetric(hierarchy,
+                                          allEdges(hierarchy),
+                                          closed_edges,
+                                          std::vector<bool>(NUMBER_OF_NODES, true),
+                                          false,
+                                          unrepaired_statistics),
+                         closed_edges);
+    BOOST_CHECK_GT(unrepaired_errors.unreachable, 0);
+}
+
+BOOST_AUTO_TEST_CASE(reopened_edges_are_inserted)
+{
+    auto edges = makeGridEdges(WIDTH, HEIGHT, 0);
+    auto closed_edges = edges;
+    for (const auto index : {3u, 17u, 42u})
+    {
+        closed_edges[index].data.weight = INVALID_EDGE_WEIGHT;
+    }
+    const auto hierarchy = contract(closed_edges);
+
+    RecontractionStatistics statistics;
+    const auto query_edges = recontractMetric(hierarchy,
+                                              allEdges(hierarchy),
+                                              edges,
+                                              std::vector<bool>(NUMBER_OF_NODES, true),
+                                              true,
+                                              statistics);
+    BOOST_CHECK_GT(statistics.inserted_edges, 0);
+    const auto errors = countRouteErrors(query_edges, edges);
+    BOOST_CHECK_EQUAL(errors.longer, 0);
+    BOOST_CHECK_EQUAL(errors.unreachable, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
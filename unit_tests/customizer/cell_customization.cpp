@@ -1,6 +1,7 @@
 #include "common/range_tools.hpp"
 
 #include "customizer/cell_customizer.hpp"
+#include "partitioner/cell_microcode.hpp"
 #include "partitioner/multi_level_graph.hpp"
 #include "partitioner/multi_level_partition.hpp"
 #include "util/static_graph.hpp"
@@ -428,4 +429,122 @@ BOOST_AUTO_TEST_CASE(exclude_test)
     CHECK_EQUAL_RANGE(cell_2_1.GetInWeight(5), EdgeWeight{1}, EdgeWeight{0});
 }
 
+BOOST_AUTO_TEST_CASE(incremental_test)
+{
+    // 0 --- 1 --- 5 --- 6
+    // |  /  |     |     |
+    // 2 ----3 --- 4 --- 7
+    // \__________/
+    std::vector<MockEdge> edges = {
+        {0, 1, {1}}, {0, 2, {1}},  {1, 0, {1}}, {1, 2, {10}}, {1, 3, {1}}, {1, 5, {1}},
+        {2, 0, {1}}, {2, 1, {10}}, {2, 3, {1}}, {2, 4, {1}},  {3, 1, {1}}, {3, 2, {1}},
+        {3, 4, {1}}, {4, 2, {1}},  {4, 3, {1}}, {4, 5, {1}},  {4, 7, {1}}, {5, 1, {1}},
+        {5, 4, {1}}, {5, 6, {1}},  {6, 5, {1}}, {6, 7, {1}},  {7, 4, {1}}, {7, 6, {1}},
+    };
+
+    // node:                0  1  2  3  4  5  6  7
+    std::vector<CellID> l1{{0, 0, 1, 1, 3, 2, 2, 3}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1}};
+    std::vector<CellID> l3{{0, 0, 0, 0, 0, 0, 0, 0}};
+    MultiLevelPartition mlp{{l1, l2, l3}, {4, 2, 1}};
+
+    auto graph = makeGraph(mlp, edges);
+    std::vector<bool> node_filter(graph.GetNumberOfNodes(), true);
+
+    CellCustomizer customizer(mlp);
+    CellStorage storage(mlp, graph);
+    auto metric = storage.MakeMetric();
+    customizer.Customize(graph, storage, node_filter, metric);
+
+    // slow down 1 -> 3, only the outgoing edges of node 1 change
+    edges[4].weight = EdgeWeight{5};
+    auto updated_graph = makeGraph(mlp, edges);
+
+    const auto level_cells = customizer.GetCellsContaining({1});
+    BOOST_REQUIRE_EQUAL(level_cells.size(), 4);
+    CHECK_EQUAL_RANGE(level_cells[1], 0);
+    CHECK_EQUAL_RANGE(level_cells[2], 0);
+    CHECK_EQUAL_RANGE(level_cells[3], 0);
+
+    auto incremental_metric = metric;
+    customizer.Customize(updated_graph, storage, node_filter, incremental_metric, level_cells);
+
+    auto full_metric = storage.MakeMetric();
+    customizer.Customize(updated_graph, storage, node_filter, full_metric);
+
+    // 1 -> 3 is now shorter via 0 and 2
+    CHECK_EQUAL_RANGE(storage.GetCell(metric, 2, 0).GetOutWeight(1),
+                      EdgeWeight{0},
+                      EdgeWeight{2},
+                      EdgeWeight{1});
+    CHECK_EQUAL_RANGE(storage.GetCell(incremental_metric, 2, 0).GetOutWeight(1),
+                      EdgeWeight{0},
+                      EdgeWeight{2},
+                      EdgeWeight{3});
+
+    CHECK_EQUAL_COLLECTIONS(incremental_metric.weights, full_metric.weights);
+    CHECK_EQUAL_COLLECTIONS(incremental_metric.durations, full_metric.durations);
+    CHECK_EQUAL_COLLECTIONS(incremental_metric.distances, full_metric.distances);
+}
+
+BOOST_AUTO_TEST_CASE(microcode_test)
+{
+    // 0 --- 1 --- 5 --- 6
+    // |  /  |     |     |
+    // 2 ----3 --- 4 --- 7
+    // \__________/
+    std::vector<MockEdge> edges = {
+        {0, 1, {1}}, {0, 2, {1}},  {1, 0, {1}}, {1, 2, {10}}, {1, 3, {1}}, {1, 5, {1}},
+        {2, 0, {1}}, {2, 1, {10}}, {2, 3, {1}}, {2, 4, {1}},  {3, 1, {1}}, {3, 2, {1}},
+        {3, 4, {1}}, {4, 2, {1}},  {4, 3, {1}}, {4, 5, {1}},  {4, 7, {1}}, {5, 1, {1}},
+        {5, 4, {1}}, {5, 6, {1}},  {6, 5, {1}}, {6, 7, {1}},  {7, 4, {1}}, {7, 6, {1}},
+    };
+
+    // node:                0  1  2  3  4  5  6  7
+    std::vector<CellID> l1{{0, 0, 1, 1, 3, 2, 2, 3}};
+    std::vector<CellID> l2{{0, 0, 0, 0, 1, 1, 1, 1}};
+    std::vector<CellID> l3{{0, 0, 0, 0, 0, 0, 0, 0}};
+    MultiLevelPartition mlp{{l1, l2, l3}, {4, 2, 1}};
+
+    auto graph = makeGraph(mlp, edges);
+    CellStorage storage(mlp, graph);
+
+    // all cells have a program
+    CellMicrocode microcode(mlp, storage, graph, 8);
+    BOOST_CHECK_EQUAL(microcode.GetNumberOfPrograms(1), 4);
+    BOOST_CHECK_EQUAL(microcode.GetNumberOfPrograms(2), 2);
+    BOOST_CHECK_EQUAL(microcode.GetNumberOfPrograms(3), 1);
+
+    // only the cells of the first level have a program, all others are searched
+    CellMicrocode partial_microcode(mlp, storage, graph, 2);
+    BOOST_CHECK_EQUAL(partial_microcode.GetNumberOfPrograms(1), 4);
+    BOOST_CHECK_EQUAL(partial_microcode.GetNumberOfPrograms(2), 0);
+    BOOST_CHECK_EQUAL(partial_microcode.GetNumberOfPrograms(3), 0);
+
+    const std::vector<std::vector<bool>> node_filters = {
+        std::vector<bool>(graph.GetNumberOfNodes(), true),
+        // exclude node 0, 3 and 7
+        {false, true, true, false, true, true, true, false},
+    };
+
+    CellCustomizer search_customizer(mlp);
+    CellCustomizer microcode_customizer(mlp, microcode);
+    CellCustomizer partial_microcode_customizer(mlp, partial_microcode);
+    for (const auto &node_filter : node_filters)
+    {
+        auto search_metric = storage.MakeMetric();
+        search_customizer.Customize(graph, storage, node_filter, search_metric);
+
+        for (const auto *customizer : {&microcode_customizer, &partial_microcode_customizer})
+        {
+            auto metric = storage.MakeMetric();
+            customizer->Customize(graph, storage, node_filter, metric);
+
+            CHECK_EQUAL_COLLECTIONS(metric.weights, search_metric.weights);
+            CHECK_EQUAL_COLLECTIONS(metric.durations, search_metric.durations);
+            CHECK_EQUAL_COLLECTIONS(metric.distances, search_metric.distances);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#include "customizer/speed_profiles.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace osrm;
+using namespace osrm::customizer;
+
+namespace
+{
+constexpr std::uint32_t HOUR = 60 * 60;
+constexpr std::uint32_t DAY = 24 * HOUR;
+
+// Profile 0 drops from 100 km/h to 50 km/h in the Monday morning peak, profile 1 has a constant
+// speed of 30 km/h. Node 1 uses profile 0, node 2 profile 1 and node 0 none.
+SpeedProfiles makeProfiles()
+{
+    SpeedProfiles profiles;
+    profiles.node_profiles = {INVALID_SPEED_PROFILE_ID, 0, 1};
+    profiles.profile_offsets = {0, 3, 4};
+    profiles.breakpoints = {{7 * HOUR, 100}, {8 * HOUR, 50}, {9 * HOUR, 100}, {0, 30}};
+    profiles.static_levels = {2, 0, 0};
+    return profiles;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(speed_profiles_tests)
+
+BOOST_AUTO_TEST_CASE(time_of_week)
+{
+    // 1970-01-01 was a Thursday
+    BOOST_CHECK_EQUAL(toTimeOfWeek(0), 3 * DAY);
+    // Monday 1970-01-05 08:30 UTC
+    BOOST_CHECK_EQUAL(toTimeOfWeek(4 * DAY + 8 * HOUR + 30 * 60), 8 * HOUR + 30 * 60);
+    BOOST_CHECK_EQUAL(toTimeOfWeek(4 * DAY + SECONDS_PER_WEEK), 0);
+    // Wednesday 1969-12-31 23:00 UTC
+    BOOST_CHECK_EQUAL(toTimeOfWeek(-std::int64_t{HOUR}), 3 * DAY - HOUR);
+}
+
+BOOST_AUTO_TEST_CASE(interpolated_speeds)
+{
+    const auto profiles = makeProfiles();
+    BOOST_CHECK_EQUAL(profiles.GetNumberOfProfiles(), 2);
+
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 7 * HOUR), 100);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 7 * HOUR + HOUR / 2), 75);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 8 * HOUR), 50);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 9 * HOUR), 100);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(1, 3 * DAY), 30);
+
+    // the speed after the last breakpoint of the week wraps around to the first one
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 2 * DAY), 100);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 0), 100);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, SECONDS_PER_WEEK - 1), 100);
+}
+
+BOOST_AUTO_TEST_CASE(wrap_around_the_week)
+{
+    SpeedProfiles profiles;
+    profiles.node_profiles = {0};
+    profiles.profile_offsets = {0, 2};
+    profiles.breakpoints = {{HOUR, 20}, {SECONDS_PER_WEEK - HOUR, 40}};
+    profiles.static_levels = {0};
+
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, 0), 30);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, SECONDS_PER_WEEK - HOUR / 2), 35);
+    BOOST_CHECK_EQUAL(profiles.GetSpeed(0, HOUR / 2), 25);
+}
+
+BOOST_AUTO_TEST_CASE(duration_factors)
+{
+    const auto profiles = makeProfiles();
+
+    // 1 km in 36s is 100 km/h
+    const EdgeDuration duration{360};
+    const EdgeDistance distance{1000};
+    BOOST_CHECK_EQUAL(profiles.GetFactor(0, duration, distance, 8 * HOUR), 1.);
+    BOOST_CHECK_CLOSE(profiles.GetFactor(1, duration, distance, 7 * HOUR), 1., 1e-6);
+    BOOST_CHECK_CLOSE(profiles.GetFactor(1, duration, distance, 8 * HOUR), 2., 1e-6);
+    BOOST_CHECK_CLOSE(profiles.GetFactor(2, duration, distance, 8 * HOUR), 100. / 30., 1e-6);
+    BOOST_CHECK_EQUAL(profiles.GetFactor(1, EdgeDuration{0}, distance, 8 * HOUR), 1.);
+
+    BOOST_CHECK_EQUAL(profiles.GetStaticLevel(0), 2);
+    BOOST_CHECK_EQUAL(profiles.GetStaticLevel(1), 0);
+    BOOST_CHECK_EQUAL(SpeedProfiles{}.GetStaticLevel(0), INVALID_LEVEL_ID);
+    BOOST_CHECK_EQUAL(SpeedProfiles{}.GetProfile(0), INVALID_SPEED_PROFILE_ID);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
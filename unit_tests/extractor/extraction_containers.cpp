@@ -0,0 +1,109 @@
+#include "extractor/extraction_containers.hpp"
+
+#include "../common/temporary_file.hpp"
+#include "../mocks/mock_scripting_environment.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+BOOST_AUTO_TEST_SUITE(extraction_containers_test)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+// A chain of ways over shuffled nodes, with more nodes and edges than the smallest runs of
+// the external sorter hold, and a few nodes that no way uses
+void fillContainers(ExtractionContainers &containers)
+{
+    const std::uint64_t number_of_nodes = 5000;
+    std::vector<std::uint64_t> node_ids(number_of_nodes + 10);
+    std::iota(node_ids.begin(), node_ids.end(), 1);
+    std::mt19937 generator(42);
+    std::shuffle(node_ids.begin(), node_ids.end(), generator);
+    for (const auto id : node_ids)
+    {
+        containers.all_nodes_list.push_back(
+            QueryNode{util::FixedLongitude{static_cast<std::int32_t>(id * 100)},
+                      util::FixedLatitude{static_cast<std::int32_t>(id * 50)},
+                      OSMNodeID{id}});
+    }
+
+    containers.all_edges_annotation_data_list.push_back(
+        {EMPTY_STRINGVIEWID, INVALID_LANE_DESCRIPTIONID, {}, TRAVEL_MODE_DRIVING, false});
+    const InternalExtractorEdge::WeightData speed{
+        InternalExtractorEdge::WeightData::by_meter, 10.};
+    for (std::uint64_t id = 1; id < number_of_nodes; ++id)
+    {
+        NodeBasedEdgeClassification flags;
+        flags.forward = true;
+        flags.backward = id % 3 != 0;
+        containers.all_edges_list.push_back(InternalExtractorEdge(
+            NodeBasedEdgeWithOSM{
+                OSMNodeID{id}, OSMNodeID{id + 1}, {0}, {0}, {0}, {}, 0, flags},
+            speed,
+            speed,
+            {}));
+
+        containers.used_node_id_list.push_back(OSMNodeID{id});
+        containers.used_node_id_list.push_back(OSMNodeID{id + 1});
+        containers.ways_list.push_back(OSMWayID{id});
+        containers.way_node_id_offsets.push_back(containers.used_node_id_list.size());
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(sort_memory_budget_gives_same_result)
+{
+    const TemporaryDirectory directory;
+    test::MockScriptingEnvironment scripting_environment;
+
+    ExtractionContainers in_memory;
+    fillContainers(in_memory);
+    in_memory.PrepareData(scripting_environment, (directory.path / "in_memory.names").string());
+
+    // runs of 1024 nodes and edges, which need several runs each
+    const auto sort_directory = directory.path / "runs";
+    std::filesystem::create_directories(sort_directory);
+    ExtractionContainers spilled(1, sort_directory);
+    fillContainers(spilled);
+    spilled.PrepareData(scripting_environment, (directory.path / "spilled.names").string());
+
+    // all runs are removed again
+    BOOST_CHECK(std::filesystem::is_empty(sort_directory));
+
+    BOOST_CHECK_EQUAL(spilled.max_internal_node_id, in_memory.max_internal_node_id);
+    BOOST_CHECK_EQUAL(in_memory.max_internal_node_id, 5000);
+    BOOST_CHECK(spilled.used_node_id_list == in_memory.used_node_id_list);
+
+    BOOST_REQUIRE_EQUAL(spilled.used_nodes.size(), in_memory.used_nodes.size());
+    for (std::size_t index = 0; index < in_memory.used_nodes.size(); ++index)
+    {
+        const auto &expected = in_memory.used_nodes[index];
+        const auto &node = spilled.used_nodes[index];
+        BOOST_CHECK(std::tie(node.node_id, node.lon, node.lat) ==
+                    std::tie(expected.node_id, expected.lon, expected.lat));
+    }
+
+    BOOST_REQUIRE_EQUAL(spilled.used_edges.size(), in_memory.used_edges.size());
+    BOOST_CHECK_EQUAL(in_memory.used_edges.size(), 4999);
+    for (std::size_t index = 0; index < in_memory.used_edges.size(); ++index)
+    {
+        const auto &expected = in_memory.used_edges[index];
+        const auto &edge = spilled.used_edges[index];
+        BOOST_CHECK_EQUAL(edge.source, expected.source);
+        BOOST_CHECK_EQUAL(edge.target, expected.target);
+        BOOST_CHECK_EQUAL(edge.weight, expected.weight);
+        BOOST_CHECK_EQUAL(edge.duration, expected.duration);
+        BOOST_CHECK_EQUAL(edge.flags.forward, expected.flags.forward);
+        BOOST_CHECK_EQUAL(edge.flags.backward, expected.flags.backward);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,9 +5,11 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cmath>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(location_dependent_data_tests)
 
@@ -183,4 +185,48 @@ BOOST_AUTO_TEST_CASE(staircase_polygon)
     BOOST_CHECK(data.GetPropertyIndexes(point_t(3.5, 2)).empty());
 }
 
+BOOST_AUTO_TEST_CASE(cell_index_tests)
+{
+    // cells inside of the outer ring and outside of the hole are resolved without a ring test
+    LocationDataFixture fixture(R"json({
+"type": "FeatureCollection",
+"features": [
+{
+    "type": "Feature",
+    "properties": { "answer": "a" },
+    "geometry": { "type": "Polygon", "coordinates": [
+        [ [3, 3], [-3, 3], [-3, -3], [3, -3], [3, 3] ],
+        [ [1, 1], [-1, 1], [-1, -1], [1, -1], [1, 1] ]
+    ] }
+},
+{
+    "type": "Feature",
+    "properties": { "answer": "b" },
+    "geometry": { "type": "Polygon", "coordinates": [ [ [1, 1], [-1, 1], [-1, -1], [1, -1], [1, 1] ] ] }
+}
+]})json");
+
+    LocationDependentData data({fixture.temporary_file.path});
+
+    for (double x = -4; x <= 4; x += 0.125)
+    {
+        for (double y = -4; y <= 4; y += 0.125)
+        {
+            const auto in_outer = std::abs(x) <= 3 && std::abs(y) <= 3;
+            const auto in_hole = std::abs(x) < 1 && std::abs(y) < 1;
+            const auto on_hole = std::abs(x) <= 1 && std::abs(y) <= 1;
+
+            std::vector<std::size_t> expected;
+            if (in_outer && !in_hole)
+                expected.push_back(0);
+            if (on_hole)
+                expected.push_back(1);
+
+            const auto indexes = data.GetPropertyIndexes(point_t(x, y));
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                indexes.begin(), indexes.end(), expected.begin(), expected.end());
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+#include "extractor/extraction_relation.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/maneuver_override_relation_parser.hpp"
+#include "extractor/restriction_parser.hpp"
+#include "extractor/scripting_environment_lua.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(native_way_handlers)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+
+using Tags = std::vector<std::pair<std::string, std::string>>;
+
+const std::vector<Tags> tag_sets = {
+    {{"highway", "primary"}},
+    {{"highway", "motorway"}, {"toll", "yes"}},
+    {{"highway", "motorway"}, {"oneway", "no"}},
+    {{"highway", "primary"}, {"junction", "roundabout"}, {"tunnel", "yes"}},
+    {{"highway", "residential"}, {"oneway", "-1"}, {"toll:backward", "yes"}},
+    {{"highway", "residential"}, {"oneway:motorcar", "yes"}, {"oneway", "no"}},
+    {{"highway", "residential"}, {"oneway:foot", "yes"}},
+    {{"highway", "service"}, {"access", "private"}},
+    {{"highway", "residential"}, {"access", "destination"}},
+    {{"highway", "residential"}, {"access", "no;destination"}},
+    {{"highway", "primary"}, {"access", "no"}},
+    {{"highway", "primary"}, {"motor_vehicle:backward", "no"}},
+    {{"highway", "track"}, {"access", "yes"}},
+    {{"highway", "track"}, {"vehicle:forward", "yes"}},
+    {{"highway", "unknown"}, {"foot", "designated"}},
+    {{"highway", "footway"}, {"foot", "no"}},
+    {{"highway", "cycleway"}, {"bicycle", "no ; yes"}},
+    {{"highway", "path"}, {"tunnel", "no"}},
+    {{"route", "ferry"}, {"duration", "00:30"}},
+};
+
+// Loads the profile through a wrapper that switches between native and Lua handlers
+std::string makeProfile(const char *profile, const bool use_native_way_handlers)
+{
+    const auto path =
+        std::filesystem::temp_directory_path() /
+        (std::string("native_way_handlers_") + (use_native_way_handlers ? "on" : "off") + ".lua");
+    std::ofstream out(path);
+    out << "api_version = 4\n"
+        << "package.path = '" OSRM_PROFILES_DIR "/?.lua;' .. package.path\n"
+        << "local functions = dofile('" << profile << "')\n"
+        << "local setup = functions.setup\n"
+        << "functions.setup = function()\n"
+        << "  local profile = setup()\n"
+        << "  profile.use_native_way_handlers = " << std::boolalpha << use_native_way_handlers
+        << "\n"
+        << "  return profile\n"
+        << "end\n"
+        << "return functions\n";
+    return path.string();
+}
+
+std::vector<ExtractionWay> processWays(const std::string &profile)
+{
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::object_id_type id = 1;
+    for (const auto &tags : tag_sets)
+    {
+        {
+            osmium::builder::WayBuilder way_builder{buffer};
+            way_builder.set_id(id++);
+            way_builder.add_node_refs({osmium::NodeRef{1}, osmium::NodeRef{2}});
+            osmium::builder::TagListBuilder tag_builder{way_builder};
+            for (const auto &[key, value] : tags)
+            {
+                tag_builder.add_tag(key, value);
+            }
+        }
+        buffer.commit();
+    }
+
+    Sol2ScriptingEnvironment scripting_environment(profile, {});
+    RestrictionParser restriction_parser(false, false, scripting_environment.GetRestrictions());
+    ManeuverOverrideRelationParser maneuver_override_parser;
+    ScriptingResults results;
+    results.osmium_buffer = std::make_shared<osmium::memory::Buffer>(std::move(buffer));
+
+    scripting_environment.ProcessElements(results, restriction_parser, maneuver_override_parser);
+
+    BOOST_REQUIRE_EQUAL(results.resulting_ways.size(), tag_sets.size());
+    std::vector<ExtractionWay> ways;
+    for (const auto &result : results.resulting_ways)
+    {
+        ways.push_back(result.second);
+    }
+    return ways;
+}
+
+void checkNativeEqualsLua(const char *profile)
+{
+    const auto native = processWays(makeProfile(profile, true));
+    const auto lua = processWays(makeProfile(profile, false));
+
+    for (std::size_t index = 0; index < tag_sets.size(); ++index)
+    {
+        BOOST_TEST_CONTEXT("tag set " << index)
+        {
+            const auto &native_way = native[index];
+            const auto &lua_way = lua[index];
+            BOOST_CHECK_EQUAL(native_way.forward_speed, lua_way.forward_speed);
+            BOOST_CHECK_EQUAL(native_way.backward_speed, lua_way.backward_speed);
+            BOOST_CHECK_EQUAL(native_way.forward_rate, lua_way.forward_rate);
+            BOOST_CHECK_EQUAL(native_way.backward_rate, lua_way.backward_rate);
+            BOOST_CHECK_EQUAL(native_way.duration, lua_way.duration);
+            BOOST_CHECK(native_way.forward_travel_mode == lua_way.forward_travel_mode);
+            BOOST_CHECK(native_way.backward_travel_mode == lua_way.backward_travel_mode);
+            BOOST_CHECK(native_way.forward_classes == lua_way.forward_classes);
+            BOOST_CHECK(native_way.backward_classes == lua_way.backward_classes);
+            BOOST_CHECK_EQUAL(native_way.forward_restricted, lua_way.forward_restricted);
+            BOOST_CHECK_EQUAL(native_way.backward_restricted, lua_way.backward_restricted);
+            BOOST_CHECK_EQUAL(native_way.roundabout, lua_way.roundabout);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(car_native_equals_lua)
+{
+    checkNativeEqualsLua(OSRM_PROFILES_DIR "/car.lua");
+}
+
+BOOST_AUTO_TEST_CASE(foot_native_equals_lua)
+{
+    checkNativeEqualsLua(OSRM_PROFILES_DIR "/foot.lua");
+}
+
+BOOST_AUTO_TEST_CASE(bicycle_native_equals_lua)
+{
+    checkNativeEqualsLua(OSRM_PROFILES_DIR "/bicycle.lua");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
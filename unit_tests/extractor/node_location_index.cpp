@@ -0,0 +1,135 @@
+#include "extractor/node_location_index.hpp"
+
+#include "../common/temporary_file.hpp"
+
+#include "util/exception.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <filesystem>
+#include <memory>
+
+BOOST_AUTO_TEST_SUITE(node_location_index_test)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+std::size_t countIndexFiles(const std::filesystem::path &directory)
+{
+    std::size_t count = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        count += entry.path().filename().string().starts_with("osrm-locations-");
+    }
+    return count;
+}
+
+// the index in memory and the index in a file
+std::unique_ptr<NodeLocationIndex> makeIndex(const bool in_file,
+                                             const std::filesystem::path &directory)
+{
+    return in_file ? std::make_unique<NodeLocationIndex>(directory)
+                   : std::make_unique<NodeLocationIndex>();
+}
+
+osmium::memory::Buffer makeWays()
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer ways{4096, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_way(ways, _id(10), _nodes({1, 2, -1, -2, 3}));
+    return ways;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(store_and_get)
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer nodes{4096, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(nodes, _id(1), _location(-180.0, -90.0));
+    osmium::builder::add_node(nodes, _id(2), _location(0.0, 0.0));
+    // beyond the initial size of the file
+    osmium::builder::add_node(nodes, _id(5000000), _location(180.0, 90.0));
+    const auto ways = makeWays();
+    const TemporaryDirectory directory;
+
+    for (const bool in_file : {false, true})
+    {
+        {
+            const auto index = makeIndex(in_file, directory.path);
+            BOOST_CHECK_EQUAL(countIndexFiles(directory.path), in_file ? 1 : 0);
+            index->Store(nodes);
+            index->Store(ways);
+
+            BOOST_CHECK_EQUAL(index->Get(1), osmium::Location(-180.0, -90.0));
+            BOOST_CHECK_EQUAL(index->Get(2), osmium::Location(0.0, 0.0));
+            BOOST_CHECK_EQUAL(index->Get(5000000), osmium::Location(180.0, 90.0));
+            BOOST_CHECK(!index->Get(3).is_defined());
+            BOOST_CHECK(!index->Get(6000000).is_defined());
+        }
+        BOOST_CHECK_EQUAL(countIndexFiles(directory.path), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(negative_ids)
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer nodes{4096, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(nodes, _id(1), _location(7.5, 50.1));
+    osmium::builder::add_node(nodes, _id(-1), _location(8.5, 51.1));
+    osmium::builder::add_node(nodes, _id(-2), _location(8.6, 51.2));
+    const auto ways = makeWays();
+    const TemporaryDirectory directory;
+
+    for (const bool in_file : {false, true})
+    {
+        const auto index = makeIndex(in_file, directory.path);
+        index->Store(nodes);
+        index->Store(ways);
+
+        // the negative IDs do not overwrite or shadow the positive ones
+        BOOST_CHECK_EQUAL(index->Get(1), osmium::Location(7.5, 50.1));
+        BOOST_CHECK_EQUAL(index->Get(-1), osmium::Location(8.5, 51.1));
+        BOOST_CHECK_EQUAL(index->Get(-2), osmium::Location(8.6, 51.2));
+        BOOST_CHECK(!index->Get(2).is_defined());
+        BOOST_CHECK(!index->Get(-3).is_defined());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(set_way_locations)
+{
+    using namespace osmium::builder::attr;
+    osmium::memory::Buffer nodes{4096, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(nodes, _id(1), _location(7.5, 50.1));
+    osmium::builder::add_node(nodes, _id(2), _location(7.6, 50.2));
+    osmium::builder::add_node(nodes, _id(-1), _location(7.7, 50.3));
+    osmium::builder::add_node(nodes, _id(-2), _location(7.8, 50.4));
+    const TemporaryDirectory directory;
+
+    for (const bool in_file : {false, true})
+    {
+        auto ways = makeWays();
+        const auto index = makeIndex(in_file, directory.path);
+        index->Store(nodes);
+        index->Store(ways);
+        BOOST_CHECK_EQUAL(index->SetWayLocations(ways), 1);
+
+        const auto &way = *ways.select<osmium::Way>().begin();
+        BOOST_CHECK_EQUAL(way.nodes()[0].location(), osmium::Location(7.5, 50.1));
+        BOOST_CHECK_EQUAL(way.nodes()[1].location(), osmium::Location(7.6, 50.2));
+        BOOST_CHECK_EQUAL(way.nodes()[2].location(), osmium::Location(7.7, 50.3));
+        BOOST_CHECK_EQUAL(way.nodes()[3].location(), osmium::Location(7.8, 50.4));
+        BOOST_CHECK(!way.nodes()[4].location().is_defined());
+
+        // the index cannot change anymore once the ways have started
+        BOOST_CHECK_THROW(index->Store(nodes), util::exception);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -80,4 +80,35 @@ BOOST_AUTO_TEST_CASE(raster_test)
         util::exception);
 }
 
+BOOST_AUTO_TEST_CASE(tiled_raster_test)
+{
+    // tiles of 4x4 values leave partial tiles at the right and bottom edge of the 10x10 raster
+    const auto tiled_path = std::filesystem::temp_directory_path() / "raster_data.tiled";
+    convertToTiledRaster(OSRM_FIXTURES_DIR "/raster_data.asc", tiled_path, 10, 10, 4);
+    BOOST_CHECK(isTiledRaster(tiled_path));
+    BOOST_CHECK(!isTiledRaster(OSRM_FIXTURES_DIR "/raster_data.asc"));
+
+    RasterContainer sources;
+    const auto ascii_id =
+        sources.LoadRasterSource(OSRM_FIXTURES_DIR "/raster_data.asc", 1, 1.09, 1, 1.09, 10, 10);
+    const auto tiled_id = sources.LoadRasterSource(tiled_path.string(), 1, 1.09, 1, 1.09, 10, 10);
+    BOOST_CHECK_NE(ascii_id, tiled_id);
+
+    for (double lon = 0.995; lon < 1.1; lon += 0.003)
+    {
+        for (double lat = 0.995; lat < 1.1; lat += 0.003)
+        {
+            BOOST_CHECK_EQUAL(sources.GetRasterDataFromSource(tiled_id, lon, lat).datum,
+                              sources.GetRasterDataFromSource(ascii_id, lon, lat).datum);
+            BOOST_CHECK_EQUAL(sources.GetRasterInterpolateFromSource(tiled_id, lon, lat).datum,
+                              sources.GetRasterInterpolateFromSource(ascii_id, lon, lat).datum);
+        }
+    }
+
+    // the dimensions have to match the header
+    BOOST_CHECK_THROW(RasterGrid(tiled_path, 9, 10), util::exception);
+
+    std::filesystem::remove(tiled_path);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
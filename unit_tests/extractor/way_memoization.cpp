@@ -0,0 +1,150 @@
+#include "extractor/extraction_relation.hpp"
+#include "extractor/extraction_way.hpp"
+#include "extractor/maneuver_override_relation_parser.hpp"
+#include "extractor/restriction_parser.hpp"
+#include "extractor/scripting_environment_lua.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(way_memoization)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+
+using Tags = std::vector<std::pair<std::string, std::string>>;
+
+osmium::memory::Buffer makeWays(const std::vector<Tags> &tag_sets)
+{
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::object_id_type id = 1;
+    for (const auto &tags : tag_sets)
+    {
+        {
+            osmium::builder::WayBuilder way_builder{buffer};
+            way_builder.set_id(id++);
+            way_builder.add_node_refs({osmium::NodeRef{1}, osmium::NodeRef{2}});
+            osmium::builder::TagListBuilder tag_builder{way_builder};
+            for (const auto &[key, value] : tags)
+            {
+                tag_builder.add_tag(key, value);
+            }
+        }
+        buffer.commit();
+    }
+    return buffer;
+}
+
+std::vector<ExtractionWay> processWays(const char *profile, const std::vector<Tags> &tag_sets)
+{
+    Sol2ScriptingEnvironment scripting_environment(profile, {});
+    BOOST_REQUIRE(scripting_environment.GetProfileProperties().memoize_way_function);
+    RestrictionParser restriction_parser(false, false, scripting_environment.GetRestrictions());
+    ManeuverOverrideRelationParser maneuver_override_parser;
+    ScriptingResults results;
+    results.osmium_buffer = std::make_shared<osmium::memory::Buffer>(makeWays(tag_sets));
+
+    scripting_environment.ProcessElements(results, restriction_parser, maneuver_override_parser);
+
+    BOOST_REQUIRE_EQUAL(results.resulting_ways.size(), tag_sets.size());
+    std::vector<ExtractionWay> ways;
+    for (const auto &result : results.resulting_ways)
+    {
+        ways.push_back(result.second);
+    }
+    return ways;
+}
+
+void checkEqual(const ExtractionWay &memoized, const ExtractionWay &processed)
+{
+    BOOST_CHECK_EQUAL(memoized.forward_speed, processed.forward_speed);
+    BOOST_CHECK_EQUAL(memoized.backward_speed, processed.backward_speed);
+    BOOST_CHECK_EQUAL(memoized.forward_rate, processed.forward_rate);
+    BOOST_CHECK_EQUAL(memoized.backward_rate, processed.backward_rate);
+    BOOST_CHECK_EQUAL(memoized.duration, processed.duration);
+    BOOST_CHECK_EQUAL(memoized.weight, processed.weight);
+    BOOST_CHECK_EQUAL(memoized.name, processed.name);
+    BOOST_CHECK_EQUAL(memoized.forward_ref, processed.forward_ref);
+    BOOST_CHECK_EQUAL(memoized.backward_ref, processed.backward_ref);
+    BOOST_CHECK_EQUAL(memoized.destinations, processed.destinations);
+    BOOST_CHECK_EQUAL(memoized.turn_lanes_forward, processed.turn_lanes_forward);
+    BOOST_CHECK_EQUAL(memoized.turn_lanes_backward, processed.turn_lanes_backward);
+    BOOST_CHECK(memoized.road_classification == processed.road_classification);
+    BOOST_CHECK(memoized.forward_travel_mode == processed.forward_travel_mode);
+    BOOST_CHECK(memoized.backward_travel_mode == processed.backward_travel_mode);
+    BOOST_CHECK(memoized.forward_classes == processed.forward_classes);
+    BOOST_CHECK(memoized.backward_classes == processed.backward_classes);
+    BOOST_CHECK_EQUAL(memoized.roundabout, processed.roundabout);
+    BOOST_CHECK_EQUAL(memoized.is_startpoint, processed.is_startpoint);
+    BOOST_CHECK_EQUAL(memoized.forward_restricted, processed.forward_restricted);
+    BOOST_CHECK_EQUAL(memoized.backward_restricted, processed.backward_restricted);
+}
+
+// Every tag set is processed in a buffer of its own by a new environment, which cannot have
+// a cached result, and compared to the results of processing all of them in one buffer.
+void checkMemoizedEqualsProcessed(const char *profile)
+{
+    const std::vector<Tags> tag_sets = {
+        {{"highway", "primary"}, {"name", "Main Street"}, {"maxspeed", "50"}},
+        {{"highway", "residential"}, {"oneway", "yes"}},
+        {{"maxspeed", "50"}, {"name", "Main Street"}, {"highway", "primary"}},
+        {{"highway", "primary"}, {"name", "Main Street"}, {"maxspeed", "60"}},
+        {{"oneway", "yes"}, {"highway", "residential"}},
+        {{"highway", "service"}, {"access", "private"}},
+        {{"highway", "residential"}, {"oneway", "-1"}},
+        {{"highway", "cycleway"}},
+        {{"highway", "service"}, {"access", "private"}},
+        {{"highway", "footway"}, {"surface", "gravel"}},
+        {{"highway", "cycleway"}},
+    };
+
+    const auto memoized = processWays(profile, tag_sets);
+    for (std::size_t index = 0; index < tag_sets.size(); ++index)
+    {
+        const auto processed = processWays(profile, {tag_sets[index]});
+        checkEqual(memoized[index], processed.front());
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(keys_ignore_tag_order)
+{
+    const auto buffer = makeWays({{{"highway", "primary"}, {"name", "Main Street"}},
+                                  {{"name", "Main Street"}, {"highway", "primary"}},
+                                  {{"highway", "primar"}, {"yname", "Main Street"}}});
+    std::vector<std::string> keys;
+    WayResultCache cache;
+    for (const auto &way : buffer.select<osmium::Way>())
+    {
+        keys.push_back(cache.MakeKey(way.tags()));
+    }
+    BOOST_CHECK_EQUAL(keys[0], keys[1]);
+    BOOST_CHECK_NE(keys[0], keys[2]);
+}
+
+BOOST_AUTO_TEST_CASE(car_memoized_equals_processed)
+{
+    checkMemoizedEqualsProcessed(OSRM_PROFILES_DIR "/car.lua");
+}
+
+BOOST_AUTO_TEST_CASE(bicycle_memoized_equals_processed)
+{
+    checkMemoizedEqualsProcessed(OSRM_PROFILES_DIR "/bicycle.lua");
+}
+
+BOOST_AUTO_TEST_CASE(foot_memoized_equals_processed)
+{
+    checkMemoizedEqualsProcessed(OSRM_PROFILES_DIR "/foot.lua");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
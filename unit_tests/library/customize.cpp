@@ -3,10 +3,116 @@
 #include "osrm/customizer.hpp"
 #include "osrm/customizer_config.hpp"
 
+#include "../common/temporary_file.hpp"
+#include "customizer/files.hpp"
+#include "extractor/files.hpp"
+#include "updater/updater.hpp"
+#include "util/for_each_pair.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(library_customize)
 
+namespace
+{
+using Segment = std::pair<OSMNodeID, OSMNodeID>;
+
+// Copy of the MLD test dataset that a test can update
+std::filesystem::path copyDataset(const std::filesystem::path &directory)
+{
+    std::filesystem::create_directories(directory);
+    for (const auto &entry : std::filesystem::directory_iterator(OSRM_TEST_DATA_DIR "/mld"))
+    {
+        const auto name = entry.path().filename().string();
+        if (name.starts_with("monaco.osrm"))
+            std::filesystem::copy_file(entry.path(), directory / name);
+    }
+    return directory / "monaco.osrm";
+}
+
+// The first segments of the compressed geometries as pairs of OSM node ids
+std::vector<Segment> readSegments(const std::filesystem::path &base, const std::size_t count)
+{
+    using namespace osrm;
+
+    extractor::SegmentDataContainer segment_data;
+    extractor::files::readSegmentData(base.string() + ".geometry", segment_data);
+    std::vector<util::Coordinate> coordinates;
+    extractor::PackedOSMIDs osm_node_ids;
+    extractor::files::readNodes(base.string() + ".nbg_nodes", coordinates, osm_node_ids);
+
+    std::vector<Segment> segments;
+    for (std::uint32_t id = 0;
+         id < segment_data.GetNumberOfGeometries() && segments.size() < count;
+         ++id)
+    {
+        auto geometry = segment_data.GetForwardGeometry(id);
+        util::for_each_pair(geometry,
+                            [&](const auto from, const auto to)
+                            { segments.emplace_back(osm_node_ids[from], osm_node_ids[to]); });
+    }
+    segments.resize(std::min(segments.size(), count));
+    return segments;
+}
+
+// Writes a speed for both directions of the segments in [first, last)
+void writeSpeeds(const std::filesystem::path &path,
+                 const std::vector<Segment> &segments,
+                 const std::size_t first,
+                 const std::size_t last,
+                 const std::function<unsigned(std::size_t)> &speed)
+{
+    std::ofstream csv(path);
+    for (auto index = first; index < last; ++index)
+    {
+        const auto [from, to] = segments[index];
+        csv << from << "," << to << "," << speed(index) << "\n";
+        csv << to << "," << from << "," << speed(index) << "\n";
+    }
+}
+
+void update(const std::filesystem::path &base,
+            const std::filesystem::path &speeds,
+            std::vector<NodeID> &updated_nodes,
+            std::vector<NodeID> &changed_nodes)
+{
+    osrm::updater::UpdaterConfig config;
+    config.base_path = base;
+    config.UseDefaultOutputNames(base);
+    config.segment_speed_lookup_paths = {speeds.string()};
+
+    std::vector<osrm::extractor::EdgeBasedEdge> edges;
+    std::vector<EdgeWeight> node_weights;
+    std::vector<EdgeDuration> node_durations;
+    std::uint32_t connectivity_checksum = 0;
+    osrm::updater::Updater(config).LoadAndUpdateEdgeExpandedGraph(
+        edges, node_weights, node_durations, updated_nodes, changed_nodes, connectivity_checksum);
+}
+
+void customize(const std::filesystem::path &base,
+               const std::filesystem::path &speeds,
+               const bool skip_unchanged_cells)
+{
+    osrm::CustomizationConfig config;
+    config.base_path = base;
+    config.UseDefaultOutputNames(base);
+    config.requested_num_threads = std::thread::hardware_concurrency();
+    config.incremental = skip_unchanged_cells;
+    config.skip_unchanged_cells = skip_unchanged_cells;
+    config.updater_config.segment_speed_lookup_paths = {speeds.string()};
+    osrm::customize(config);
+}
+} // namespace
+
 BOOST_AUTO_TEST_CASE(test_customize_with_invalid_config)
 {
     using namespace osrm;
@@ -17,4 +123,84 @@ BOOST_AUTO_TEST_CASE(test_customize_with_invalid_config)
                       std::exception); // including osrm::util::exception, etc.
 }
 
+BOOST_AUTO_TEST_CASE(test_updater_reports_changed_nodes)
+{
+    const TemporaryDirectory directory;
+    const auto base = copyDataset(directory.path);
+    const auto segments = readSegments(base, 200);
+    BOOST_REQUIRE_EQUAL(segments.size(), 200);
+
+    // 1 km/h is slower than any speed of the profile
+    const auto slow_speeds = directory.path / "slow.csv";
+    writeSpeeds(slow_speeds, segments, 0, segments.size(), [](auto) { return 1; });
+    const auto faster_speeds = directory.path / "faster.csv";
+    writeSpeeds(
+        faster_speeds, segments, 0, segments.size(), [](auto index) { return index < 10 ? 2 : 1; });
+
+    std::vector<NodeID> updated_nodes, changed_nodes;
+    update(base, slow_speeds, updated_nodes, changed_nodes);
+    BOOST_REQUIRE(!updated_nodes.empty());
+    BOOST_CHECK(!changed_nodes.empty());
+    BOOST_CHECK(std::includes(
+        updated_nodes.begin(), updated_nodes.end(), changed_nodes.begin(), changed_nodes.end()));
+    const auto first_updated_nodes = updated_nodes;
+
+    // the same speeds again update the same nodes, but change none of them
+    update(base, slow_speeds, updated_nodes, changed_nodes);
+    BOOST_CHECK(updated_nodes == first_updated_nodes);
+    BOOST_CHECK(changed_nodes.empty());
+
+    // only the nodes on the first segments change
+    update(base, faster_speeds, updated_nodes, changed_nodes);
+    BOOST_CHECK(updated_nodes == first_updated_nodes);
+    BOOST_CHECK(!changed_nodes.empty());
+    BOOST_CHECK_LT(changed_nodes.size(), updated_nodes.size());
+    BOOST_CHECK(std::includes(
+        updated_nodes.begin(), updated_nodes.end(), changed_nodes.begin(), changed_nodes.end()));
+}
+
+BOOST_AUTO_TEST_CASE(test_skip_unchanged_cells_matches_full_customization)
+{
+    const TemporaryDirectory directory;
+    const auto incremental_base = copyDataset(directory.path / "incremental");
+    const auto full_base = copyDataset(directory.path / "full");
+    const auto segments = readSegments(full_base, 300);
+    BOOST_REQUIRE_EQUAL(segments.size(), 300);
+
+    // The second update drops the first 50 segments, changes the speed of the next 50, keeps
+    // 150 and adds the last 50. Every way a node can differ from the previous update is covered.
+    const auto first_speeds = directory.path / "first.csv";
+    writeSpeeds(first_speeds, segments, 0, 250, [](auto index) { return 5 + index % 7; });
+    const auto second_speeds = directory.path / "second.csv";
+    writeSpeeds(second_speeds,
+                segments,
+                50,
+                300,
+                [](auto index) { return index < 100 ? 90 : 5 + index % 7; });
+
+    customize(incremental_base, first_speeds, true);
+    customize(incremental_base, second_speeds, true);
+    customize(full_base, first_speeds, false);
+    customize(full_base, second_speeds, false);
+
+    std::unordered_map<std::string, std::vector<osrm::customizer::CellMetric>>
+        incremental_metrics, full_metrics;
+    osrm::customizer::files::readCellMetrics(incremental_base.string() + ".cell_metrics",
+                                             incremental_metrics);
+    osrm::customizer::files::readCellMetrics(full_base.string() + ".cell_metrics", full_metrics);
+
+    BOOST_REQUIRE_EQUAL(incremental_metrics.size(), full_metrics.size());
+    for (const auto &[name, metrics] : full_metrics)
+    {
+        const auto &incremental = incremental_metrics.at(name);
+        BOOST_REQUIRE_EQUAL(incremental.size(), metrics.size());
+        for (std::size_t index = 0; index < metrics.size(); ++index)
+        {
+            BOOST_CHECK(incremental[index].weights == metrics[index].weights);
+            BOOST_CHECK(incremental[index].durations == metrics[index].durations);
+            BOOST_CHECK(incremental[index].distances == metrics[index].distances);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
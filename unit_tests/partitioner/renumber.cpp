@@ -83,4 +83,28 @@ BOOST_AUTO_TEST_CASE(unsplitable_case)
     CHECK_EQUAL_RANGE(permutation, 0, 7, 8, 5, 6, 11, 4, 3, 9, 10, 1, 2);
 }
 
+BOOST_AUTO_TEST_CASE(hilbert_order_within_cells)
+{
+    // node:          0  1  2  3  4  5
+    // cell:          0  1  0  1  0  1
+    // border:                   x  x
+    // hilbert code:  5  2  3  4  1  0
+    // order:         4  5  2  0  1  3
+    // permutation:   3  4  2  5  0  1
+    std::vector<CellID> l1{{0, 1, 0, 1, 0, 1}};
+    std::vector<std::uint64_t> hilbert_codes{5, 2, 3, 4, 1, 0};
+
+    std::vector<MockEdge> edges = {{0, 2}, {2, 4}, {4, 5}, {5, 1}, {1, 3}};
+
+    auto graph = makeGraph(edges);
+    std::vector<Partition> partitions{l1};
+
+    auto permutation = makePermutation(graph, partitions, hilbert_codes);
+    CHECK_EQUAL_RANGE(permutation, 3, 4, 2, 5, 0, 1);
+
+    // without codes only cells and border levels change the order
+    permutation = makePermutation(graph, partitions);
+    CHECK_EQUAL_RANGE(permutation, 2, 4, 3, 5, 0, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
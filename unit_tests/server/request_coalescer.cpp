@@ -0,0 +1,203 @@
+#include "server/request_coalescer.hpp"
+
+#include "util/json_container.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(server_request_coalescer)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+engine::Status answer(engine::api::ResultT &result, const std::string &code)
+{
+    result = util::json::Object();
+    std::get<util::json::Object>(result).values["code"] = code;
+    return engine::Status::Ok;
+}
+
+std::string codeOf(const engine::api::ResultT &result)
+{
+    return std::get<util::json::String>(std::get<util::json::Object>(result).values.at("code"))
+        .value;
+}
+
+void waitFor(const RequestCoalescer &coalescer, std::size_t waiting)
+{
+    while (coalescer.Waiting() < waiting)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(sequential_requests_are_not_cached)
+{
+    RequestCoalescer coalescer;
+    int runs = 0;
+    const auto query = [&](engine::api::ResultT &result)
+    {
+        ++runs;
+        return answer(result, "Ok");
+    };
+
+    engine::api::ResultT first, second;
+    BOOST_CHECK(coalescer.Run("key", "key", first, query) == engine::Status::Ok);
+    BOOST_CHECK(coalescer.Run("key", "key", second, query) == engine::Status::Ok);
+
+    BOOST_CHECK_EQUAL(runs, 2);
+    BOOST_CHECK_EQUAL(coalescer.InFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(followers_share_the_leader_result)
+{
+    RequestCoalescer coalescer;
+    std::atomic<int> runs = 0;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    const auto query = [&](engine::api::ResultT &result)
+    {
+        ++runs;
+        released.wait();
+        return answer(result, "Shared");
+    };
+
+    constexpr std::size_t NUM_FOLLOWERS = 4;
+    engine::api::ResultT leader_result;
+    auto leader = std::async(std::launch::async,
+                             [&] { return coalescer.Run("key", "key", leader_result, query); });
+    while (coalescer.InFlight() == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<engine::api::ResultT> follower_results(NUM_FOLLOWERS);
+    std::vector<std::future<engine::Status>> followers;
+    for (auto &follower_result : follower_results)
+    {
+        followers.push_back(
+            std::async(std::launch::async,
+                       [&] { return coalescer.Run("key", "key", follower_result, query); }));
+    }
+    waitFor(coalescer, NUM_FOLLOWERS);
+    release.set_value();
+
+    BOOST_CHECK(leader.get() == engine::Status::Ok);
+    for (auto &follower : followers)
+    {
+        BOOST_CHECK(follower.get() == engine::Status::Ok);
+    }
+
+    BOOST_CHECK_EQUAL(runs, 1);
+    BOOST_CHECK_EQUAL(codeOf(leader_result), "Shared");
+    for (const auto &follower_result : follower_results)
+    {
+        BOOST_CHECK_EQUAL(codeOf(follower_result), "Shared");
+    }
+    BOOST_CHECK_EQUAL(coalescer.InFlight(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(errors_are_only_shared_with_exact_duplicates)
+{
+    RequestCoalescer coalescer;
+    std::atomic<int> runs = 0;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    const auto query = [&](engine::api::ResultT &result)
+    {
+        ++runs;
+        released.wait();
+        answer(result, "InvalidQuery");
+        return engine::Status::Error;
+    };
+
+    engine::api::ResultT leader_result, exact_result, normalised_result;
+    auto leader = std::async(std::launch::async,
+                             [&] { return coalescer.Run("key", "a&b", leader_result, query); });
+    while (coalescer.InFlight() == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto exact = std::async(std::launch::async,
+                            [&] { return coalescer.Run("key", "a&b", exact_result, query); });
+    auto normalised = std::async(
+        std::launch::async, [&] { return coalescer.Run("key", "b&a", normalised_result, query); });
+    waitFor(coalescer, 2);
+    release.set_value();
+
+    BOOST_CHECK(leader.get() == engine::Status::Error);
+    BOOST_CHECK(exact.get() == engine::Status::Error);
+    BOOST_CHECK(normalised.get() == engine::Status::Error);
+
+    // The leader and the re-run of the normalised duplicate
+    BOOST_CHECK_EQUAL(runs, 2);
+    BOOST_CHECK_EQUAL(codeOf(exact_result), "InvalidQuery");
+    BOOST_CHECK_EQUAL(codeOf(normalised_result), "InvalidQuery");
+}
+
+BOOST_AUTO_TEST_CASE(leader_exceptions_are_rethrown_in_followers)
+{
+    RequestCoalescer coalescer;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    const auto query = [&](engine::api::ResultT &) -> engine::Status
+    {
+        released.wait();
+        throw std::runtime_error("dataset gone");
+    };
+
+    engine::api::ResultT leader_result, follower_result;
+    auto leader = std::async(std::launch::async,
+                             [&] { return coalescer.Run("key", "key", leader_result, query); });
+    while (coalescer.InFlight() == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto follower = std::async(std::launch::async,
+                               [&] { return coalescer.Run("key", "key", follower_result, query); });
+    waitFor(coalescer, 1);
+    release.set_value();
+
+    BOOST_CHECK_THROW(leader.get(), std::runtime_error);
+    BOOST_CHECK_THROW(follower.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(copy_result_duplicates_every_alternative)
+{
+    engine::api::ResultT json_result;
+    answer(json_result, "Ok");
+    engine::api::ResultT json_copy;
+    CopyResult(json_result, json_copy);
+    BOOST_CHECK_EQUAL(codeOf(json_copy), "Ok");
+
+    engine::api::ResultT string_result = std::string("tile");
+    engine::api::ResultT string_copy;
+    CopyResult(string_result, string_copy);
+    BOOST_CHECK_EQUAL(std::get<std::string>(string_copy), "tile");
+
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(builder.CreateString("route"));
+    const std::vector<std::uint8_t> expected(builder.GetBufferPointer(),
+                                             builder.GetBufferPointer() + builder.GetSize());
+    engine::api::ResultT fb_result = std::move(builder);
+    engine::api::ResultT fb_copy;
+    CopyResult(fb_result, fb_copy);
+    auto &copied = std::get<flatbuffers::FlatBufferBuilder>(fb_copy);
+    const std::vector<std::uint8_t> actual(copied.GetBufferPointer(),
+                                           copied.GetBufferPointer() + copied.GetSize());
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), actual.begin(), actual.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,10 @@
 #include "util/iterator_adapters.hpp"
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
 BOOST_AUTO_TEST_SUITE(tar)
 
 using namespace osrm;
@@ -184,6 +188,86 @@ BOOST_AUTO_TEST_CASE(write_large_tar_file)
     CHECK_EQUAL_COLLECTIONS(result_64bit_vector, vector_64bit);
 }
 
+BOOST_AUTO_TEST_CASE(write_compressed_tar_file)
+{
+    TemporaryFile tmp{TEST_DATA_DIR "/tar_compressed_write_test.tar"};
+
+    // spans two frames and a partial third one
+    std::vector<std::uint64_t> large_vector(
+        storage::tar::detail::COMPRESSION_FRAME_SIZE / sizeof(std::uint64_t) * 2 + 100);
+    std::iota(large_vector.begin(), large_vector.end(), 0);
+    std::vector<std::uint32_t> small_vector = {0, 1, 2, 3, 4, 1 << 30, 0, 1 << 22, 0xFFFFFFFF};
+
+    {
+        storage::tar::FileWriter writer(tmp.path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        storage::tar::FileWriter::CompressBlocks);
+        writer.WriteElementCount64("large_vector", large_vector.size());
+        writer.WriteFrom("large_vector", large_vector.data(), large_vector.size());
+        writer.WriteElementCount64("small_vector", small_vector.size());
+        writer.WriteFrom("small_vector", small_vector.data(), small_vector.size());
+    }
+
+    storage::tar::FileReader reader(tmp.path, storage::tar::FileReader::VerifyFingerprint);
+
+    std::vector<storage::tar::FileReader::FileEntry> file_list;
+    reader.List(std::back_inserter(file_list));
+    BOOST_REQUIRE_EQUAL(file_list.size(), 5);
+    BOOST_CHECK_EQUAL(file_list[2].name, "large_vector");
+    BOOST_CHECK_EQUAL(file_list[2].size, large_vector.size() * sizeof(std::uint64_t));
+    BOOST_CHECK(file_list[2].compressed);
+    BOOST_CHECK_EQUAL(file_list[4].name, "small_vector");
+    BOOST_CHECK(!file_list[4].compressed);
+
+    std::vector<std::uint64_t> result_large_vector(reader.ReadElementCount64("large_vector"));
+    reader.ReadInto("large_vector", result_large_vector.data(), result_large_vector.size());
+    CHECK_EQUAL_COLLECTIONS(result_large_vector, large_vector);
+
+    std::vector<std::uint64_t> streamed_large_vector;
+    reader.ReadStreaming<std::uint64_t>("large_vector", std::back_inserter(streamed_large_vector));
+    CHECK_EQUAL_COLLECTIONS(streamed_large_vector, large_vector);
+
+    std::vector<std::uint32_t> result_small_vector(reader.ReadElementCount64("small_vector"));
+    reader.ReadInto("small_vector", result_small_vector.data(), result_small_vector.size());
+    CHECK_EQUAL_COLLECTIONS(result_small_vector, small_vector);
+}
+
+BOOST_AUTO_TEST_CASE(read_unsupported_frame_codec)
+{
+    TemporaryFile tmp{TEST_DATA_DIR "/tar_compressed_codec_test.tar"};
+
+    std::vector<std::uint64_t> large_vector(
+        storage::tar::detail::COMPRESSION_FRAME_SIZE / sizeof(std::uint64_t) + 100);
+    std::iota(large_vector.begin(), large_vector.end(), 0);
+    {
+        storage::tar::FileWriter writer(tmp.path,
+                                        storage::tar::FileWriter::GenerateFingerprint,
+                                        storage::tar::FileWriter::CompressBlocks);
+        writer.WriteFrom("large_vector", large_vector.data(), large_vector.size());
+    }
+
+    // replace the codec at the start of the frame index by one this version does not know
+    std::fstream file(tmp.path, std::ios::in | std::ios::out | std::ios::binary);
+    const std::string contents{std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>()};
+    const std::uint64_t header[] = {storage::tar::detail::FRAME_CODEC_ZLIB,
+                                    large_vector.size() * sizeof(std::uint64_t),
+                                    storage::tar::detail::COMPRESSION_FRAME_SIZE};
+    const auto position =
+        contents.find(std::string(reinterpret_cast<const char *>(header), sizeof(header)));
+    BOOST_REQUIRE(position != std::string::npos);
+    const std::uint64_t unknown_codec = 2;
+    file.seekp(position);
+    file.write(reinterpret_cast<const char *>(&unknown_codec), sizeof(unknown_codec));
+    file.close();
+
+    BOOST_CHECK_EXCEPTION(
+        storage::tar::FileReader(tmp.path, storage::tar::FileReader::VerifyFingerprint),
+        util::RuntimeError,
+        [](const util::RuntimeError &error)
+        { return std::string(error.what()).find("unsupported codec 2") != std::string::npos; });
+}
+
 // This test case is disabled by default because it needs 10 GiB of storage
 // Enable with ./storage-tests --run_test=tar/write_huge_tar_file
 BOOST_AUTO_TEST_CASE(write_huge_tar_file, *boost::unit_test::disabled())
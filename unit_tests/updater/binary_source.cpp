@@ -0,0 +1,137 @@
+#include "updater/binary_source.hpp"
+#include "updater/csv_source.hpp"
+
+#include "util/exception.hpp"
+
+#include "../common/temporary_file.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(binary_source)
+
+using namespace osrm;
+using namespace osrm::updater;
+
+namespace
+{
+void writeText(const std::filesystem::path &path, const std::string &text)
+{
+    std::ofstream stream(path, std::ios::binary);
+    stream << text;
+}
+
+void checkEqual(const SegmentLookupTable &lhs, const SegmentLookupTable &rhs)
+{
+    BOOST_REQUIRE_EQUAL(lhs.lookup.size(), rhs.lookup.size());
+    for (std::size_t index = 0; index < lhs.lookup.size(); ++index)
+    {
+        const auto &[lhs_key, lhs_value] = lhs.lookup[index];
+        const auto &[rhs_key, rhs_value] = rhs.lookup[index];
+        BOOST_CHECK(lhs_key == rhs_key);
+        BOOST_CHECK_EQUAL(lhs_value.speed, rhs_value.speed);
+        BOOST_CHECK_EQUAL(lhs_value.source, rhs_value.source);
+        BOOST_REQUIRE_EQUAL(lhs_value.rate.has_value(), rhs_value.rate.has_value());
+        if (lhs_value.rate)
+        {
+            BOOST_CHECK_EQUAL(std::isnan(*lhs_value.rate), std::isnan(*rhs_value.rate));
+            if (!std::isnan(*lhs_value.rate))
+                BOOST_CHECK_EQUAL(*lhs_value.rate, *rhs_value.rate);
+        }
+    }
+}
+} // namespace
+
+// Node IDs far apart and in both orders to cover negative and large differences
+const std::string SEGMENT_CSV = "10,11,50\n"
+                                "11,10,40,3.5\n"
+                                "8000000000,12,30,\n"
+                                "12,8000000000,20,1.5,comment\n"
+                                "5,6,0\n";
+
+BOOST_AUTO_TEST_CASE(segment_values_round_trip)
+{
+    TemporaryFile csv;
+    writeText(csv.path, SEGMENT_CSV);
+    const auto expected = csv::readSegmentValues({csv.path.string()});
+
+    for (const bool delta_encode : {false, true})
+    {
+        TemporaryFile binary_file;
+        binary::writeSegmentValues(binary_file.path.string(), expected, delta_encode);
+        const auto actual = csv::readSegmentValues({binary_file.path.string()});
+        checkEqual(expected, actual);
+
+        // a missing rate and an empty rate column are different
+        BOOST_CHECK(!actual({10, 11})->rate);
+        BOOST_CHECK(std::isnan(*actual({8000000000, 12})->rate));
+        BOOST_CHECK_EQUAL(*actual({12, 8000000000})->rate, 1.5);
+        BOOST_CHECK(!actual({6, 5}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(turn_values_round_trip)
+{
+    TemporaryFile csv;
+    writeText(csv.path, "3,2,1,5.5\n"
+                        "1,2,3,-1,2\n"
+                        "9000000000,2,9000000001,0.5\n");
+    const auto expected = csv::readTurnValues({csv.path.string()});
+
+    for (const bool delta_encode : {false, true})
+    {
+        TemporaryFile binary_file;
+        binary::writeTurnValues(binary_file.path.string(), expected, delta_encode);
+        const auto actual = csv::readTurnValues({binary_file.path.string()});
+        BOOST_REQUIRE_EQUAL(actual.lookup.size(), 3);
+        BOOST_CHECK_EQUAL(actual({1, 2, 3})->duration, -1);
+        BOOST_CHECK_EQUAL(actual({1, 2, 3})->weight, 2);
+        BOOST_CHECK_EQUAL(actual({3, 2, 1})->duration, 5.5);
+        BOOST_CHECK(std::isnan(actual({3, 2, 1})->weight));
+        BOOST_CHECK_EQUAL(actual({9000000000, 2, 9000000001})->duration, 0.5);
+        BOOST_CHECK(!actual({2, 2, 2}));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(binary_and_csv_files_are_merged)
+{
+    TemporaryFile csv, binary_file, override_csv;
+    writeText(csv.path, SEGMENT_CSV);
+    binary::writeSegmentValues(
+        binary_file.path.string(), csv::readSegmentValues({csv.path.string()}), true);
+    writeText(override_csv.path, "10,11,70\n");
+
+    // the later file wins, like for CSV files
+    const auto values =
+        csv::readSegmentValues({binary_file.path.string(), override_csv.path.string()});
+    BOOST_CHECK_EQUAL(values.lookup.size(), 5);
+    BOOST_CHECK_EQUAL(values({10, 11})->speed, 70);
+    BOOST_CHECK_EQUAL(values({10, 11})->source, 2);
+    BOOST_CHECK_EQUAL(values({11, 10})->speed, 40);
+    BOOST_CHECK_EQUAL(values({11, 10})->source, 1);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_binary_files)
+{
+    TemporaryFile csv, binary_file;
+    writeText(csv.path, SEGMENT_CSV);
+    const auto values = csv::readSegmentValues({csv.path.string()});
+
+    // a segment speed file is not a turn penalty file
+    binary::writeSegmentValues(binary_file.path.string(), values, false);
+    BOOST_CHECK_THROW(csv::readTurnValues({binary_file.path.string()}), util::exception);
+
+    for (const bool delta_encode : {false, true})
+    {
+        binary::writeSegmentValues(binary_file.path.string(), values, delta_encode);
+        std::filesystem::resize_file(binary_file.path,
+                                     std::filesystem::file_size(binary_file.path) - 1);
+        BOOST_CHECK_THROW(csv::readSegmentValues({binary_file.path.string()}), util::exception);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
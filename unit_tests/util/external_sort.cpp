@@ -0,0 +1,108 @@
+#include "util/external_sort.hpp"
+
+#include "../common/temporary_file.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+struct Pair
+{
+    unsigned key;
+    unsigned value;
+};
+
+struct CmpPairByKey
+{
+    bool operator()(const Pair &lhs, const Pair &rhs) const { return lhs.key < rhs.key; }
+};
+
+std::size_t countRunFiles(const std::filesystem::path &directory)
+{
+    std::size_t count = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(directory))
+    {
+        count += entry.path().filename().string().starts_with("osrm-sort-");
+    }
+    return count;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(external_sort_test)
+
+BOOST_AUTO_TEST_CASE(spill_and_merge)
+{
+    std::mt19937 generator(42);
+    std::vector<int> values(10000);
+    std::generate(values.begin(), values.end(), [&] { return generator() % 1000; });
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    // runs of 1024 elements
+    const TemporaryDirectory directory;
+    ExternalSorter<int> sorter(directory.path, 2 * 1024 * sizeof(int));
+    sorter.Spill(values);
+    BOOST_CHECK(values.empty());
+    BOOST_CHECK_EQUAL(sorter.Size(), expected.size());
+    BOOST_CHECK_EQUAL(sorter.NumberOfRuns(), 10);
+    BOOST_CHECK_EQUAL(countRunFiles(directory.path), 10);
+
+    sorter.Merge(values);
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(sorter.Size(), 0);
+    BOOST_CHECK_EQUAL(countRunFiles(directory.path), 0);
+}
+
+BOOST_AUTO_TEST_CASE(push_and_merge)
+{
+    const TemporaryDirectory directory;
+    ExternalSorter<Pair, CmpPairByKey> sorter(directory.path, 2 * 1024 * sizeof(Pair));
+    for (unsigned index = 0; index < 3000; ++index)
+    {
+        sorter.Push({(3000 - index) % 7, index});
+    }
+    // two full runs, the rest stays in memory
+    BOOST_CHECK_EQUAL(sorter.NumberOfRuns(), 2);
+    BOOST_CHECK_EQUAL(sorter.Size(), 3000);
+
+    std::vector<Pair> merged;
+    sorter.Merge([&](const Pair &pair) { merged.push_back(pair); });
+    BOOST_CHECK_EQUAL(merged.size(), 3000);
+    BOOST_CHECK(std::is_sorted(merged.begin(), merged.end(), CmpPairByKey()));
+
+    // equal keys keep the order of their runs
+    for (std::size_t index = 1; index < merged.size(); ++index)
+    {
+        if (merged[index - 1].key == merged[index].key)
+        {
+            BOOST_CHECK_LE(merged[index - 1].value / 1024, merged[index].value / 1024);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(small_input_stays_in_memory)
+{
+    const TemporaryDirectory directory;
+    ExternalSorter<int> sorter(directory.path, 1024 * 1024);
+    std::vector<int> values;
+    sorter.Merge(values);
+    BOOST_CHECK(values.empty());
+
+    sorter.Push(3);
+    sorter.Push(1);
+    sorter.Push(2);
+    BOOST_CHECK_EQUAL(sorter.NumberOfRuns(), 0);
+    sorter.Merge(values);
+    const std::vector<int> expected{1, 2, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
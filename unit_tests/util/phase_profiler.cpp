@@ -0,0 +1,86 @@
+#include "util/phase_profiler.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(phase_profiler)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(nothing_recorded_when_disabled)
+{
+    auto &profiler = PhaseProfiler::GetInstance();
+    profiler.Disable();
+    profiler.Clear();
+    {
+        PhaseTimer phase("ignored");
+    }
+    BOOST_CHECK(profiler.GetPhases().empty());
+}
+
+BOOST_AUTO_TEST_CASE(nested_phases)
+{
+    auto &profiler = PhaseProfiler::GetInstance();
+    profiler.Clear();
+    profiler.Enable();
+    {
+        PhaseTimer outer("outer");
+        {
+            PhaseTimer inner("inner");
+            // busy work, so the phase takes some CPU time
+            volatile std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < 10000000; ++i)
+                sum = sum + i;
+        }
+        BOOST_CHECK_EQUAL(profiler.GetPhases().size(), 1);
+        PhaseTimer stopped("stopped");
+        stopped.Stop();
+        stopped.Stop();
+    }
+    profiler.Disable();
+
+    const auto phases = profiler.GetPhases();
+    BOOST_REQUIRE_EQUAL(phases.size(), 3);
+    BOOST_CHECK_EQUAL(phases[0].name, "outer");
+    BOOST_CHECK_EQUAL(phases[0].depth, 0);
+    BOOST_CHECK_EQUAL(phases[1].name, "outer/inner");
+    BOOST_CHECK_EQUAL(phases[1].depth, 1);
+    BOOST_CHECK_EQUAL(phases[2].name, "outer/stopped");
+
+    BOOST_CHECK_GE(phases[0].wall_seconds, phases[1].wall_seconds);
+    BOOST_CHECK_GT(phases[1].cpu_seconds, 0);
+    BOOST_CHECK_GT(phases[1].ThreadUtilisation(), 0);
+    BOOST_CHECK_GT(phases[0].peak_rss_bytes, 0);
+    BOOST_CHECK_GE(phases[0].threads, 1);
+}
+
+BOOST_AUTO_TEST_CASE(write_json)
+{
+    auto &profiler = PhaseProfiler::GetInstance();
+    profiler.Clear();
+    profiler.Enable();
+    {
+        PhaseTimer phase("parsing");
+    }
+    profiler.Disable();
+
+    const auto path = std::filesystem::temp_directory_path() / "phase_profiler_test.json";
+    profiler.WriteJSON(path, "osrm-test");
+
+    std::ifstream in(path);
+    const std::string json{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::filesystem::remove(path);
+
+    BOOST_CHECK_EQUAL(json.front(), '{');
+    BOOST_CHECK(json.find("\"tool\":\"osrm-test\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"name\":\"parsing\"") != std::string::npos);
+    BOOST_CHECK(json.find("\"thread_utilisation\":") != std::string::npos);
+    BOOST_CHECK(json.find("\"peak_rss_delta_bytes\":") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()